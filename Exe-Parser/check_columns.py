@@ -0,0 +1,125 @@
+#!/usr/bin/env python3
+"""Checks columns files read back by pehdr --read against the scan and the single file prints.
+
+A directory is scanned into a columns file. Read back, the records have to be the ones the scan
+prints itself, and with --tables the section headers and imported DLLs of every file have to be
+the ones its own print shows, in the python and in the JSON view alike. Files named with bytes that
+are not UTF-8 have to give records that parse, with the path given back by os.fsencode().
+
+Usage: ./check_columns.py [directory of PE files], pip's bundled launchers by default
+"""
+
+import ast
+import json
+import os
+import subprocess
+import sys
+import tempfile
+
+PEHDR = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'pehdr')
+
+
+def samples_directory():
+    if len(sys.argv) > 1:
+        return sys.argv[1]
+    try:
+        import pip
+    except ImportError:
+        sys.exit('columns: no pip to take PE files from, give a directory of them')
+    return os.path.join(os.path.dirname(pip.__file__), '_vendor', 'distlib')
+
+
+def run(args):
+    return subprocess.run([PEHDR] + args, capture_output=True, check=True).stdout.decode('utf-8', 'surrogateescape')
+
+
+def tables_of(path):
+    """Returns ([(name, virtual size, virtual address, raw size, raw pointer)], [(dll, functions)]) as printed."""
+    printed = subprocess.run([PEHDR, path], capture_output=True)
+    if printed.returncode:
+        return [], []
+    sections, dlls = [], []
+    for entry in ast.literal_eval(printed.stdout.decode('utf-8', 'surrogateescape')):
+        if entry[0] == 'Section Headers':
+            sections = [(name.rstrip(' '),) + tuple(fields) for name, *fields in entry[3]]
+        elif entry[0] == 'Imports':
+            dlls = [(dll, len(functions)) for dll, functions in entry[3]]
+    return sections, dlls
+
+
+def check_names(directory):
+    """Returns the failures of scanning and reading back files whose names are not all UTF-8."""
+    sample = next((os.path.join(directory, name) for name in sorted(os.listdir(directory)) if name.endswith('.exe')), None)
+    if not sample:
+        return 0
+    failed = 0
+    names = [b'a\xffb.exe', 'é.exe'.encode(), b'c\xe2\x82.exe']
+    with tempfile.TemporaryDirectory() as temporary:
+        scanned = os.path.join(os.fsencode(temporary), b'names')
+        os.mkdir(scanned)
+        with open(sample, 'rb') as source:
+            image = source.read()
+        for name in names:
+            with open(os.path.join(scanned, name), 'wb') as copy:
+                copy.write(image)
+        columns = os.path.join(temporary, 'names.columns')
+        run(['--columns', columns, '--scan', os.fsdecode(scanned)])
+        expected = sorted(os.path.join(scanned, name) for name in names)
+        for args in (['--scan', os.fsdecode(scanned)], ['--read', columns]):
+            # strictly decoded, a byte that is not UTF-8 has to be escaped
+            try:
+                python = subprocess.run([PEHDR] + args, capture_output=True, check=True).stdout.decode('utf-8')
+                lines = subprocess.run([PEHDR, '--json'] + args, capture_output=True, check=True).stdout.decode('utf-8')
+                paths = [[os.fsencode(record[0]) for record in ast.literal_eval(python)],
+                    [os.fsencode(json.loads(line)['path']) for line in lines.splitlines()]]
+            except (UnicodeDecodeError, ValueError, SyntaxError) as error:
+                print('FAIL names %s: %s' % (args[0], error))
+                failed += 1
+                continue
+            for found in paths:
+                if sorted(found) != expected:
+                    print('FAIL names %s: %r' % (args[0], sorted(found)))
+                    failed += 1
+    return failed
+
+
+def main():
+    directory = samples_directory()
+    failed = 0
+    with tempfile.TemporaryDirectory() as temporary:
+        columns = os.path.join(temporary, 'scan.columns')
+        run(['--columns', columns, '--scan', directory])
+
+        # the records read back are the ones the scan prints
+        scanned = sorted(run(['--json', '--scan', directory]).splitlines())
+        read = sorted(run(['--json', '--read', columns]).splitlines())
+        if scanned != read:
+            print('FAIL records: %d scanned, %d read back differ' % (len(scanned), len(read)))
+            failed += 1
+
+        python = ast.literal_eval(run(['--tables', '--read', columns]))
+        lines = [json.loads(line) for line in run(['--json', '--tables', '--read', columns]).splitlines()]
+
+    for (path, sections, dlls), record in zip(python, lines):
+        from_json = (record['path'],
+            [tuple(section[key] for key in ('name', 'virtualSize', 'virtualAddress', 'sizeOfRawData', 'pointerToRawData',
+                'characteristics')) for section in record['sectionHeaders']],
+            [(dll['name'], dll['functions']) for dll in record['dlls']])
+        if from_json != (path, sections, dlls):
+            print('FAIL %s: python and JSON tables differ' % path)
+            failed += 1
+        # the single file print has no section characteristics
+        if ([(name.rstrip(' '),) + tuple(fields[:4]) for name, *fields in sections], dlls) != tables_of(path):
+            print('FAIL %s: tables differ from the print of the file' % path)
+            failed += 1
+    if len(python) != len(lines) or len(python) != len(scanned):
+        print('FAIL files: %d scanned, %d python and %d JSON tables' % (len(scanned), len(python), len(lines)))
+        failed += 1
+
+    failed += check_names(directory)
+    print('columns: %d files, %d failed' % (len(python), failed))
+    return 1 if failed or not python else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,368 @@
+/**
+ * @file check_exports.c
+ * @brief Checks the export lookups: every name of an export table is found by name and by hint, and misses are not
+ * @date 2026-10-16
+ *
+ * The table checked is one built here the way a linker lays it out, with names that need escaping
+ * when printed, a forwarder and an export by ordinal only, and the table of every image named on
+ * the command line. Each name is looked up with peExportByName() and with peExportByHint() given
+ * its own, a wrong and an out of range hint, and has to give the export peExportByNameIndex() does.
+ * The built image also has to read the same copied to an odd address, and with its PE32+ headers
+ * moved to an e_lfanew that is only DWORD aligned.
+ *
+ * Usage: check_exports [-o <file>] [image]...     -o writes the built image, for pehdr to print
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+
+#include "pehdr.h"
+#include "mapfile.h"
+#include "pe_view.h"
+#include "pe_exports.h"
+
+
+//*********************************************************************************
+// DECLARATIONS
+//*********************************************************************************
+
+// layout of the built image: headers, then one section holding the export directory
+#define BUILT_HEADERS_SIZE  0x400
+#define BUILT_SECTION_RVA   0x1000
+#define BUILT_CODE_RVA      0x10000     // functions point here, past the export section
+#define BUILT_ORDINAL_BASE  5
+#define BUILT_FUNCTIONS     160         // named ones, then one exported by ordinal only
+#define BUILT_FORWARDED     3           // function index of the forwarder
+
+/**
+ * @brief lookups that passed and failed
+ */
+typedef struct _CHECK_COUNTS {
+    unsigned    passed;
+    unsigned    failed;
+} CHECK_COUNTS, *PCHECK_COUNTS;
+
+/**
+ * @brief Builds a 64-bit DLL with an export table in memory
+ *
+ * @param[out] size Receives the size of the image
+ * @return The image, release with free() | NULL if out of memory
+ */
+static uint8_t *buildImage(uint64_t *size);
+
+/**
+ * @brief Checks that the image still reads the same at an odd address, and with its PE32+ headers
+ * only DWORD aligned, as the loader accepts them
+ *
+ * @param[in] image Built image, left as it was
+ */
+static void checkMisaligned(uint8_t *image, uint64_t size, PCHECK_COUNTS counts);
+
+/**
+ * @brief Looks up every name of an export table and names that are not in it
+ *
+ * @param[in] label Name of the image, for failure messages
+ */
+static void checkExports(PCPE_EXPORTS exports, const char *label, PCHECK_COUNTS counts);
+
+/**
+ * @brief Checks that the exports the built image was given are the ones read back
+ */
+static void checkBuiltExports(PCPE_EXPORTS exports, PCHECK_COUNTS counts);
+
+/**
+ * @brief Counts a check, printing a message if it failed
+ */
+static void expect(PCHECK_COUNTS counts, bool passed, const char *label, const char *what, const char *name);
+
+/**
+ * @brief Returns true if two lookups gave the same export
+ */
+static bool sameExport(const PE_EXPORT *found, const PE_EXPORT *expected);
+
+/**
+ * @brief Orders names as the linker sorts them, for qsort()
+ */
+static int compareNames(const void *left, const void *right);
+
+
+//*********************************************************************************
+// DEFINITIONS
+//********************************************************************************
+
+int main(int argc, char *argv[]) {
+
+    CHECK_COUNTS counts = { 0 };
+    const char *output = NULL;
+    int arg = 1;
+    if (arg + 1 < argc && !strcmp(argv[arg], "-o")) {
+        output = argv[arg + 1];
+        arg += 2;
+    }
+
+    uint64_t size;
+    uint8_t *image = buildImage(&size);
+    if (!image) {
+        fprintf(stderr, "Aborting, out of memory for the image.\n");
+        return 1;
+    }
+    PE_VIEW view;
+    PE_EXPORTS exports;
+    if (peOpen(&view, image, size) != PE_OK || !peOpenExports(&view, &exports)) {
+        fprintf(stderr, "Aborting, the built image does not open.\n");
+        free(image);
+        return 1;
+    }
+    checkBuiltExports(&exports, &counts);
+    checkExports(&exports, "built image", &counts);
+    checkMisaligned(image, size, &counts);
+
+    if (output) {
+        FILE *stream = fopen(output, "wb");
+        if (!stream || fwrite(image, size, 1, stream) != 1 || fclose(stream) != 0) {
+            fprintf(stderr, "ERROR: Write of the built image failed. File: '%s',  Error: %d\n", output, errno);
+            free(image);
+            return 1;
+        }
+    }
+    free(image);
+
+    for (; arg < argc; arg++) {
+        MAPPED_FILE file;
+        if (mapFile(argv[arg], &file) != 0) {
+            fprintf(stderr, "ERROR: Map input file for read failed. File: '%s',  Error: %d\n", argv[arg], errno);
+            counts.failed++;
+            continue;
+        }
+        if (peOpen(&view, file.base, file.size) != PE_OK || !peOpenExports(&view, &exports)) {
+            fprintf(stderr, "FAIL %s: no export table\n", argv[arg]);
+            counts.failed++;
+        }
+        else {
+            checkExports(&exports, argv[arg], &counts);
+        }
+        unmapFile(&file);
+    }
+
+    printf("exports: %u lookups passed, %u failed\n", counts.passed, counts.failed);
+    return counts.failed ? 1 : 0;
+}
+
+
+static uint8_t *buildImage(uint64_t *size) {
+
+    // names as a linker sorts them, bytes compared; some need escaping in a python string
+    char names[BUILT_FUNCTIONS][16];
+    const char *special[] = { "Quote'Name", "Back\\slash", "New\nLine", "A" };
+    uint32_t namedCount = BUILT_FUNCTIONS - 1;
+    for (uint32_t idx = 0; idx < namedCount; idx++) {
+        if (idx < sizeof(special) / sizeof(*special)) {
+            snprintf(names[idx], sizeof(names[idx]), "%s", special[idx]);
+        }
+        else {
+            snprintf(names[idx], sizeof(names[idx]), "Function%03u", idx * 7 % 1000);
+        }
+    }
+    qsort(names, namedCount, sizeof(*names), compareNames);
+
+    // directory, functions, names, name ordinals, then the strings
+    const char *dllName = "check'\n.dll";
+    const char *forwarder = "OTHER.Function";
+    uint32_t functionsRva = BUILT_SECTION_RVA + sizeof(IMAGE_EXPORT_DIRECTORY);
+    uint32_t namesRva = functionsRva + BUILT_FUNCTIONS * sizeof(uint32_t);
+    uint32_t ordinalsRva = namesRva + namedCount * sizeof(uint32_t);
+    uint32_t stringsRva = ordinalsRva + namedCount * sizeof(uint16_t);
+    uint32_t stringsSize = (uint32_t) (strlen(dllName) + strlen(forwarder) + 2 + namedCount * sizeof(*names));
+    uint32_t sectionSize = stringsRva + stringsSize - BUILT_SECTION_RVA;
+
+    *size = BUILT_HEADERS_SIZE + sectionSize;
+    uint8_t *image = calloc(1, *size);
+    if (!image) {
+        return NULL;
+    }
+
+    PIMAGE_DOS_HEADER dosHeader = (PIMAGE_DOS_HEADER) image;
+    dosHeader->e_magic = IMAGE_DOS_SIGNATURE;
+    dosHeader->e_lfanew = sizeof(IMAGE_DOS_HEADER);
+    PIMAGE_NT_HEADERS64 ntHeaders = (PIMAGE_NT_HEADERS64) (image + dosHeader->e_lfanew);
+    ntHeaders->Signature = IMAGE_NT_SIGNATURE;
+    ntHeaders->FileHeader.Machine = IMAGE_FILE_MACHINE_AMD64;
+    ntHeaders->FileHeader.NumberOfSections = 1;
+    ntHeaders->FileHeader.SizeOfOptionalHeader = sizeof(IMAGE_OPTIONAL_HEADER64);
+    PIMAGE_OPTIONAL_HEADER64 optionalHeader = &ntHeaders->OptionalHeader;
+    optionalHeader->Magic = IMAGE_NT_OPTIONAL_HDR64_MAGIC;
+    optionalHeader->ImageBase = 0x180000000ull;
+    optionalHeader->SectionAlignment = 0x1000;
+    optionalHeader->FileAlignment = 0x200;
+    optionalHeader->SizeOfImage = BUILT_CODE_RVA + 0x1000;
+    optionalHeader->SizeOfHeaders = BUILT_HEADERS_SIZE;
+    optionalHeader->NumberOfRvaAndSizes = IMAGE_NUMBEROF_DIRECTORY_ENTRIES;
+    optionalHeader->DataDirectory[IMAGE_DIRECTORY_ENTRY_EXPORT].VirtualAddress = BUILT_SECTION_RVA;
+    optionalHeader->DataDirectory[IMAGE_DIRECTORY_ENTRY_EXPORT].Size = sectionSize;
+
+    PIMAGE_SECTION_HEADER section = (PIMAGE_SECTION_HEADER) (ntHeaders + 1);
+    memcpy(section->Name, ".edata", 6);
+    section->Misc.VirtualSize = sectionSize;
+    section->VirtualAddress = BUILT_SECTION_RVA;
+    section->SizeOfRawData = sectionSize;
+    section->PointerToRawData = BUILT_HEADERS_SIZE;
+
+    // RVAs of the section are at the same distance from its file offset
+    uint8_t *data = image + BUILT_HEADERS_SIZE - BUILT_SECTION_RVA;
+    PIMAGE_EXPORT_DIRECTORY directory = (PIMAGE_EXPORT_DIRECTORY) (data + BUILT_SECTION_RVA);
+    directory->Name = stringsRva;
+    directory->Base = BUILT_ORDINAL_BASE;
+    directory->NumberOfFunctions = BUILT_FUNCTIONS;
+    directory->NumberOfNames = namedCount;
+    directory->AddressOfFunctions = functionsRva;
+    directory->AddressOfNames = namesRva;
+    directory->AddressOfNameOrdinals = ordinalsRva;
+
+    uint32_t next = stringsRva;
+    strcpy((char *) data + next, dllName);
+    next += (uint32_t) strlen(dllName) + 1;
+    uint32_t forwarderRva = next;
+    strcpy((char *) data + next, forwarder);
+    next += (uint32_t) strlen(forwarder) + 1;
+
+    // functions in an order other than the names', so a name ordinal is not its own index
+    uint32_t *functions = (uint32_t *) (data + functionsRva);
+    uint32_t *nameRvas = (uint32_t *) (data + namesRva);
+    uint16_t *nameOrdinals = (uint16_t *) (data + ordinalsRva);
+    for (uint32_t idx = 0; idx < BUILT_FUNCTIONS; idx++) {
+        functions[idx] = idx == BUILT_FORWARDED ? forwarderRva : BUILT_CODE_RVA + 0x10 * idx;
+    }
+    for (uint32_t idx = 0; idx < namedCount; idx++) {
+        nameOrdinals[idx] = (uint16_t) (namedCount - 1 - idx);
+        nameRvas[idx] = next;
+        strcpy((char *) data + next, names[idx]);
+        next += (uint32_t) strlen(names[idx]) + 1;
+    }
+    return image;
+}
+
+
+static void checkMisaligned(uint8_t *image, uint64_t size, PCHECK_COUNTS counts) {
+
+    PE_VIEW view;
+    PE_EXPORTS exports;
+    IMAGE_SECTION_HEADER section;
+
+    // every header, array and name one byte off its alignment
+    uint8_t *odd = malloc(size + 1);
+    if (!odd) {
+        expect(counts, false, "odd address", "allocation", "");
+        return;
+    }
+    memcpy(odd + 1, image, size);
+    bool opened = peOpen(&view, odd + 1, size) == PE_OK && peOpenExports(&view, &exports);
+    expect(counts, opened, "odd address", "image opens", "");
+    if (opened) {
+        checkBuiltExports(&exports, counts);
+        checkExports(&exports, "odd address", counts);
+    }
+    free(odd);
+
+    // DWORD aligned is all the loader asks of e_lfanew, also for the 64-bit fields of PE32+ headers
+    PIMAGE_DOS_HEADER dosHeader = (PIMAGE_DOS_HEADER) image;
+    size_t headersSize = sizeof(IMAGE_NT_HEADERS64) + sizeof(IMAGE_SECTION_HEADER);
+    memmove(image + dosHeader->e_lfanew + sizeof(uint32_t), image + dosHeader->e_lfanew, headersSize);
+    dosHeader->e_lfanew += sizeof(uint32_t);
+    opened = peOpen(&view, image, size) == PE_OK;
+    expect(counts, opened && view.bits == 64 && view.fileHeader.Machine == IMAGE_FILE_MACHINE_AMD64
+        && view.imageBase == 0x180000000ull && view.numberOfSections == 1, "shifted headers", "headers", "");
+    expect(counts, opened && peSectionByName(&view, ".edata", &section) && section.VirtualAddress == BUILT_SECTION_RVA,
+        "shifted headers", "section", ".edata");
+    if (opened && peOpenExports(&view, &exports)) {
+        checkBuiltExports(&exports, counts);
+    }
+    else {
+        expect(counts, false, "shifted headers", "exports", "");
+    }
+    dosHeader->e_lfanew -= sizeof(uint32_t);
+    memmove(image + dosHeader->e_lfanew, image + dosHeader->e_lfanew + sizeof(uint32_t), headersSize);
+}
+
+
+static void checkBuiltExports(PCPE_EXPORTS exports, PCHECK_COUNTS counts) {
+
+    expect(counts, exports->dllName && !strcmp(exports->dllName, "check'\n.dll"), "built image", "DLL name", "");
+    for (uint32_t idx = 0; idx < exports->numberOfNames; idx++) {
+        PE_EXPORT export;
+        uint32_t function = exports->numberOfNames - 1 - idx;
+        bool read = peExportByNameIndex(exports, idx, &export);
+        bool forwarded = function == BUILT_FORWARDED;
+        expect(counts, read && export.ordinal == BUILT_ORDINAL_BASE + function
+            && (forwarded ? export.forwarder && !strcmp(export.forwarder, "OTHER.Function")
+                : !export.forwarder && export.rva == BUILT_CODE_RVA + 0x10 * function),
+            "built image", "export as built", read ? export.name : "?");
+    }
+
+    // the last function has no name
+    PE_EXPORT export;
+    expect(counts, peExportByOrdinal(exports, BUILT_ORDINAL_BASE + BUILT_FUNCTIONS - 1, &export) && !export.name
+        && export.rva == BUILT_CODE_RVA + 0x10 * (BUILT_FUNCTIONS - 1), "built image", "export by ordinal", "");
+}
+
+
+static void checkExports(PCPE_EXPORTS exports, const char *label, PCHECK_COUNTS counts) {
+
+    uint32_t names = exports->numberOfNames;
+    PE_EXPORT expected, found;
+    for (uint32_t idx = 0; idx < names; idx++) {
+        if (!peExportByNameIndex(exports, idx, &expected)) {
+            expect(counts, false, label, "name index", "?");
+            continue;
+        }
+        const char *name = expected.name;
+        expect(counts, peExportByName(exports, name, &found) && sameExport(&found, &expected), label, "by name", name);
+        expect(counts, peExportByHint(exports, (uint16_t) idx, name, &found) && sameExport(&found, &expected), label, "by hint", name);
+        expect(counts, peExportByHint(exports, (uint16_t) ((idx + 1) % names), name, &found) && sameExport(&found, &expected),
+            label, "by wrong hint", name);
+        expect(counts, peExportByHint(exports, UINT16_MAX, name, &found) && sameExport(&found, &expected),
+            label, "by hint out of range", name);
+    }
+
+    // names before, between and after the exported ones; a longer name sorts right after its prefix
+    char miss[PE_MAX_NAME_LENGTH + 2];
+    expect(counts, !peExportByName(exports, "", &found), label, "miss", "");
+    for (uint32_t idx = 0; idx < names; idx++) {
+        if (!peExportByNameIndex(exports, idx, &expected) || expected.nameLength > PE_MAX_NAME_LENGTH) {
+            continue;
+        }
+        snprintf(miss, sizeof(miss), "%s\x7f", expected.name);
+        bool exported = false;
+        for (uint32_t other = 0; other < names && !exported; other++) {
+            exported = peExportByNameIndex(exports, other, &found) && !strcmp(found.name, miss);
+        }
+        if (!exported) {
+            expect(counts, !peExportByName(exports, miss, &found) && !peExportByHint(exports, (uint16_t) idx, miss, &found),
+                label, "miss", miss);
+        }
+    }
+}
+
+
+static void expect(PCHECK_COUNTS counts, bool passed, const char *label, const char *what, const char *name) {
+    if (passed) {
+        counts->passed++;
+        return;
+    }
+    counts->failed++;
+    fprintf(stderr, "FAIL %s: %s '%s'\n", label, what, name);
+}
+
+
+static bool sameExport(const PE_EXPORT *found, const PE_EXPORT *expected) {
+    return found->name == expected->name && found->ordinal == expected->ordinal && found->rva == expected->rva
+        && found->forwarder == expected->forwarder;
+}
+
+
+static int compareNames(const void *left, const void *right) {
+    return strcmp(left, right);
+}
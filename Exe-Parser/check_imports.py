@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+"""Checks the import index of pehdr --scan against the single file prints.
+
+Every file pehdr prints must be python readable, import names included. For every DLL, every
+function imported by name or ordinal, a pair of functions and a miss, the files a scan with
+--imports lists must be exactly the files whose own print shows the imports, and so must the files
+a read of the scan's columns file lists from its import index.
+
+Usage: ./check_imports.py [directory of PE files], pip's bundled launchers by default
+"""
+
+import ast
+import json
+import os
+import subprocess
+import sys
+import tempfile
+
+PEHDR = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'pehdr')
+
+
+def samples_directory():
+    if len(sys.argv) > 1:
+        return sys.argv[1]
+    try:
+        import pip
+    except ImportError:
+        sys.exit('imports: no pip to take PE files from, give a directory of them')
+    return os.path.join(os.path.dirname(pip.__file__), '_vendor', 'distlib')
+
+
+def imports_of(path):
+    """Returns the set of (dll, name or ordinal) a file imports, None if pehdr rejects it."""
+    printed = subprocess.run([PEHDR, path], capture_output=True)
+    if printed.returncode:
+        return None
+    imports = set()
+    for entry in ast.literal_eval(printed.stdout.decode('utf-8', 'surrogateescape')):
+        if entry[0] != 'Imports':
+            continue
+        for dll, functions in entry[3]:
+            for name, hint_or_ordinal, _ in functions:
+                imports.add((dll.lower(), name if name is not None else '#%u' % hint_or_ordinal))
+    return imports
+
+
+def listed(queries, source):
+    """Returns the set of paths pehdr with --imports lists from source, ['--scan', directory] or ['--read', columns]."""
+    args = [PEHDR, '--json']
+    for query in queries:
+        args += ['--imports', query]
+    printed = subprocess.run(args + source, capture_output=True, check=True)
+    return {json.loads(line)['path'] for line in printed.stdout.decode('utf-8', 'surrogateescape').splitlines()}
+
+
+def main():
+    directory = samples_directory()
+    files = {}
+    for parent, _, names in os.walk(directory):
+        for name in names:
+            path = os.path.join(parent, name)
+            imports = imports_of(path)
+            if imports is not None:
+                files[path] = imports
+
+    # a DLL query matches any of its functions, a function query only that one
+    symbols = sorted(set().union(*files.values()))
+    queries = [[dll] for dll in sorted({dll for dll, _ in symbols})]
+    queries += [[dll + (function if function.startswith('#') else '!' + function)] for dll, function in symbols]
+    if len(symbols) > 1:
+        queries.append([symbols[0][0] + '!' + symbols[0][1], symbols[-1][0] + '!' + symbols[-1][1]])
+    queries.append(['nosuch.dll!Nothing'])
+
+    temporary = tempfile.TemporaryDirectory()
+    columns = os.path.join(temporary.name, 'scan.columns')
+    subprocess.run([PEHDR, '--columns', columns, '--scan', directory], capture_output=True, check=True)
+
+    failed = 0
+    for query in queries:
+        expected = set()
+        for path, imports in files.items():
+            wanted = []
+            for text in query:
+                dll, separator, function = text.partition('!')
+                if not separator:
+                    dll, separator, function = text.partition('#')
+                    function = separator + function if separator else None
+                wanted.append(any(d == dll.lower() and (function is None or f == function) for d, f in imports))
+            if all(wanted):
+                expected.add(path)
+        for source in (['--scan', directory], ['--read', columns]):
+            found = listed(query, source)
+            if found != expected:
+                print('FAIL %s %s: expected %s, got %s' % (source[0], ' '.join(query), sorted(expected), sorted(found)))
+                failed += 1
+    temporary.cleanup()
+
+    print('imports: %d files, %d queries, %d failed' % (len(files), len(queries), failed))
+    return 1 if failed or not files else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,140 @@
+/**
+ * @file mapfile.c
+ * @brief Read-only file mappings on Windows (CreateFileMapping) and POSIX (mmap)
+ * @date 2026-10-16
+ */
+
+#include <stdint.h>
+#include <errno.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "mapfile.h"
+
+
+//*********************************************************************************
+// DEFINITIONS
+//********************************************************************************
+
+#ifdef _WIN32
+
+int mapFile(const char *path, PMAPPED_FILE file) {
+
+    file->base = NULL;
+    file->size = 0;
+
+    HANDLE hFile = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, NULL);
+    if (hFile == INVALID_HANDLE_VALUE) {
+        errno = ENOENT;
+        return -1;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(hFile, &size)) {
+        CloseHandle(hFile);
+        errno = EIO;
+        return -1;
+    }
+    file->size = (uint64_t) size.QuadPart;
+
+    // empty files cannot be mapped, they have no headers to parse anyway
+    if (file->size == 0) {
+        CloseHandle(hFile);
+        return 0;
+    }
+
+    // the mapping and the view keep the file open, the handles are only needed to create them
+    HANDLE hMapping = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(hFile);
+    if (hMapping == NULL) {
+        errno = EACCES;
+        return -1;
+    }
+    file->base = (const uint8_t *) MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(hMapping);
+    if (file->base == NULL) {
+        errno = ENOMEM;
+        return -1;
+    }
+    return 0;
+}
+
+
+void unmapFile(PMAPPED_FILE file) {
+    if (file->base) {
+        UnmapViewOfFile((LPCVOID) file->base);
+    }
+    file->base = NULL;
+    file->size = 0;
+}
+
+#else
+
+int mapFile(const char *path, PMAPPED_FILE file) {
+
+    file->base = NULL;
+    file->size = 0;
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        goto cleanup;
+    }
+    if (!S_ISREG(st.st_mode)) {
+        errno = EINVAL;
+        goto cleanup;
+    }
+    file->size = (uint64_t) st.st_size;
+
+    // empty files cannot be mapped, they have no headers to parse anyway
+    if (file->size == 0) {
+        close(fd);
+        return 0;
+    }
+    if (file->size > SIZE_MAX) {
+        errno = EFBIG;
+        goto cleanup;
+    }
+
+    void *view = mmap(NULL, (size_t) file->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (view == MAP_FAILED) {
+        goto cleanup;
+    }
+    close(fd);
+
+    // headers are scattered reads, reading around them would pull in the whole file
+    madvise(view, (size_t) file->size, MADV_RANDOM);
+    file->base = (const uint8_t *) view;
+    return 0;
+
+cleanup:
+    {
+        int error = errno;
+        close(fd);
+        file->size = 0;
+        errno = error;
+    }
+    return -1;
+}
+
+
+void unmapFile(PMAPPED_FILE file) {
+    if (file->base) {
+        munmap((void *) file->base, (size_t) file->size);
+    }
+    file->base = NULL;
+    file->size = 0;
+}
+
+#endif
@@ -0,0 +1,37 @@
+//-------------------------------------------------------------------------------------------------
+// mapfile.h
+//
+// Read-only file mappings on Windows (CreateFileMapping) and POSIX (mmap)
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+#include <stdint.h>
+
+
+/**
+ * @brief a file mapped read-only into memory, pages are only read from disk when touched
+ */
+typedef struct _MAPPED_FILE {
+    const uint8_t   *base;      // start of the view, NULL for an empty file
+    uint64_t        size;       // size of the file and of the view in bytes
+} MAPPED_FILE, *PMAPPED_FILE;
+
+
+/**
+ * @brief Maps a whole file read-only, without reading it
+ * @remark The view is advised for random access, so touching the headers does not read ahead through
+ * the rest of the file. The file handle is closed before returning, the view keeps the file alive.
+ * Use unmapFile() when done.
+ *
+ * @param[in] path Name and path of the file to map
+ * @param[out] file Receives the view and the file size
+ * @return 0 = SUCCESS | -1 = ERROR (errno set)
+ */
+int mapFile(const char *path, PMAPPED_FILE file);
+
+/**
+ * @brief Unmaps a view created by mapFile()
+ *
+ * @param[in,out] file Mapped file, cleared on return
+ */
+void unmapFile(PMAPPED_FILE file);
@@ -0,0 +1,50 @@
+/**
+ * @file pe_clock.c
+ * @brief Monotonic clock on Windows (QueryPerformanceCounter) and POSIX (clock_gettime)
+ * @date 2026-10-16
+ *
+ * Kept apart from pehdr.h, which redefines winnt.h types that windows.h brings along.
+ */
+
+#include <stdint.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include "pe_clock.h"
+
+
+//*********************************************************************************
+// DEFINITIONS
+//********************************************************************************
+
+#ifdef _WIN32
+
+uint64_t peClock(void) {
+
+    static LARGE_INTEGER frequency;
+    if (!frequency.QuadPart) {
+        QueryPerformanceFrequency(&frequency);
+    }
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+
+    // split the conversion so counter * 1e9 does not overflow after a few hours at 10 MHz
+    uint64_t seconds = (uint64_t) counter.QuadPart / (uint64_t) frequency.QuadPart;
+    uint64_t rest = (uint64_t) counter.QuadPart % (uint64_t) frequency.QuadPart;
+    return seconds * 1000000000ull + rest * 1000000000ull / (uint64_t) frequency.QuadPart;
+}
+
+#else
+
+uint64_t peClock(void) {
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000ull + (uint64_t) now.tv_nsec;
+}
+
+#endif
@@ -0,0 +1,15 @@
+//-------------------------------------------------------------------------------------------------
+// pe_clock.h
+//
+// Monotonic clock for timing the decoders, QueryPerformanceCounter on Windows and
+// clock_gettime(CLOCK_MONOTONIC) on POSIX
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+#include <stdint.h>
+
+
+/**
+ * @brief Returns the time in nanoseconds since an unspecified start, only differences are meaningful
+ */
+uint64_t peClock(void);
@@ -0,0 +1,803 @@
+/**
+ * @file pe_columns.c
+ * @brief Columnar records of many images, built in memory, written to a file and read back in place
+ * @date 2026-10-16
+ *
+ * Every column is described once in COLUMNS: its name in the file, its table, its width, where its
+ * array is in PE_COLUMNS and where its field is in the row structure of the table. Adding, reading,
+ * writing and opening rows all walk that table, so a column added there is handled everywhere.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+
+#include "pe_columns.h"
+
+
+//*********************************************************************************
+// DECLARATIONS
+//*********************************************************************************
+
+#define FNV_OFFSET_BASIS    0x811C9DC5u
+#define FNV_PRIME           0x01000193u
+
+// rows a table holds before it first grows
+#define INITIAL_ROWS        1024
+
+// bytes of the string pool before it first grows
+#define INITIAL_POOL        (64u * 1024)
+
+// arrays of a columns file start at multiples of this
+#define COLUMN_ALIGNMENT    8
+
+/**
+ * @brief a column: name in the file, table, element width, array in PE_COLUMNS and field in the row
+ * @remark A string column holds 32-bit string ids, its row field is a const char *
+ */
+typedef struct _COLUMN {
+    const char      *name;
+    PE_COLUMN_TABLE table;
+    uint32_t        width;
+    bool            string;
+    size_t          array;      // offset of the array pointer in PE_COLUMNS
+    size_t          field;      // offset of the field in PE_FILE_ROW, PE_SECTION_ROW or PE_DLL_ROW
+} COLUMN;
+
+#define COLUMN_OF(table, name, array, rowType, field, string) \
+    { name, table, sizeof(*((PCPE_COLUMNS) NULL)->array), string, offsetof(PE_COLUMNS, array), offsetof(rowType, field) }
+
+#define FILE_COLUMN(field)              COLUMN_OF(PE_TABLE_FILES, "files." #field, field, PE_FILE_ROW, field, false)
+#define FILE_STRING(field)              COLUMN_OF(PE_TABLE_FILES, "files." #field, field, PE_FILE_ROW, field, true)
+#define SECTION_COLUMN(array, field)    COLUMN_OF(PE_TABLE_SECTIONS, "sections." #field, array, PE_SECTION_ROW, field, false)
+#define DLL_COLUMN(array, field)        COLUMN_OF(PE_TABLE_DLLS, "dlls." #field, array, PE_DLL_ROW, field, false)
+
+// every column, in the order they are written
+static const COLUMN COLUMNS[] = {
+    FILE_STRING(path),
+    FILE_STRING(error),
+    FILE_COLUMN(fileSize),
+    FILE_COLUMN(imageBase),
+    FILE_COLUMN(timeDateStamp),
+    FILE_COLUMN(addressOfEntryPoint),
+    FILE_COLUMN(sizeOfImage),
+    FILE_COLUMN(checkSum),
+    FILE_COLUMN(importDlls),
+    FILE_COLUMN(importFunctions),
+    FILE_COLUMN(exports),
+    FILE_COLUMN(firstSection),
+    FILE_COLUMN(firstDll),
+    FILE_COLUMN(machine),
+    FILE_COLUMN(characteristics),
+    FILE_COLUMN(subsystem),
+    FILE_COLUMN(dllCharacteristics),
+    FILE_COLUMN(numberOfSections),
+    FILE_COLUMN(bits),
+    COLUMN_OF(PE_TABLE_SECTIONS, "sections.name", sectionName, PE_SECTION_ROW, name, true),
+    SECTION_COLUMN(virtualSize, virtualSize),
+    SECTION_COLUMN(virtualAddress, virtualAddress),
+    SECTION_COLUMN(sizeOfRawData, sizeOfRawData),
+    SECTION_COLUMN(pointerToRawData, pointerToRawData),
+    SECTION_COLUMN(sectionCharacteristics, characteristics),
+    COLUMN_OF(PE_TABLE_DLLS, "dlls.name", dllName, PE_DLL_ROW, name, true),
+    DLL_COLUMN(dllFunctions, functions),
+};
+
+#define COLUMN_COUNT (sizeof(COLUMNS) / sizeof(COLUMNS[0]))
+
+/**
+ * @brief a record being formatted, snprintf() style: length counts what did not fit too
+ */
+typedef struct _ROW_WRITER {
+    char    *buffer;
+    size_t  size;
+    size_t  length;
+} ROW_WRITER, *PROW_WRITER;
+
+/**
+ * @brief Adds a row to a table, interning its strings
+ *
+ * @param[in] row PE_FILE_ROW, PE_SECTION_ROW or PE_DLL_ROW of the table
+ * @return 0 = SUCCESS | -1 = ERROR (out of memory, no column is changed)
+ */
+static int addRow(PPE_COLUMNS_BUILDER builder, PE_COLUMN_TABLE table, const void *row);
+
+/**
+ * @brief Reads a row of a table into its row structure
+ */
+static void readRow(PCPE_COLUMNS columns, PE_COLUMN_TABLE table, uint64_t index, void *row);
+
+/**
+ * @brief Makes room for one more row in every column of a table
+ *
+ * @return 0 = SUCCESS | -1 = ERROR (out of memory, or row ids would not fit 32 bits)
+ */
+static int reserveRow(PPE_COLUMNS_BUILDER builder, PE_COLUMN_TABLE table);
+
+/**
+ * @brief Returns the id of a string, adding it to the pool if it is not there yet
+ *
+ * @return String id | PE_COLUMNS_NONE for NULL, or if out of memory (errno set)
+ */
+static uint32_t internString(PPE_COLUMNS_BUILDER builder, const char *string);
+
+/**
+ * @brief Doubles the hash table of the pool, placing every string again
+ */
+static int growSlots(PPE_COLUMNS_BUILDER builder);
+
+/**
+ * @brief Returns the range of rows a file owns in the sections or DLLs table
+ */
+static uint32_t fileRange(PCPE_COLUMNS columns, const uint32_t *firsts, PE_COLUMN_TABLE table, uint64_t file, uint32_t *first);
+
+/**
+ * @brief Returns the array of a column, within a PE_COLUMNS
+ */
+static inline const void **columnArray(PCPE_COLUMNS columns, const COLUMN *column);
+
+/**
+ * @brief Writes bytes to a stream, and zeros up to the next multiple of COLUMN_ALIGNMENT
+ *
+ * @return 0 = SUCCESS | -1 = ERROR
+ */
+static int writeAligned(FILE *stream, const void *data, uint64_t size);
+
+/**
+ * @brief Appends formatted text to a record
+ */
+static void writeFormat(PROW_WRITER writer, const char *format, ...);
+
+/**
+ * @brief Appends a string to a record, quoted and escaped for the format, NULL as None or null
+ */
+static void writeString(PROW_WRITER writer, const char *text, PE_ROW_FORMAT format);
+
+/**
+ * @brief Appends one character to a record
+ */
+static inline void writeChar(PROW_WRITER writer, char c);
+
+/**
+ * @brief Returns the length of the well-formed UTF-8 sequence a string starts with | 0 if it is not one
+ */
+static inline int utf8Length(const unsigned char *text);
+
+static inline uint32_t hashString(const char *string, size_t *length);
+
+static inline uint64_t alignUp(uint64_t offset);
+
+
+//*********************************************************************************
+// DEFINITIONS
+//********************************************************************************
+
+int peColumnsInit(PPE_COLUMNS_BUILDER builder) {
+
+    memset(builder, 0, sizeof(*builder));
+    builder->pool = malloc(INITIAL_POOL);
+    builder->slots = calloc(INITIAL_ROWS, sizeof(*builder->slots));
+    if (!builder->pool || !builder->slots) {
+        peColumnsFree(builder);
+        errno = ENOMEM;
+        return -1;
+    }
+    builder->poolCapacity = INITIAL_POOL;
+    builder->mask = INITIAL_ROWS - 1;
+    builder->columns.strings = builder->pool;
+    return 0;
+}
+
+
+void peColumnsFree(PPE_COLUMNS_BUILDER builder) {
+    for (size_t idx = 0; idx < COLUMN_COUNT; idx++) {
+        free((void *) *columnArray(&builder->columns, &COLUMNS[idx]));
+    }
+    free(builder->pool);
+    free(builder->slots);
+    memset(builder, 0, sizeof(*builder));
+}
+
+
+int peColumnsAddSection(PPE_COLUMNS_BUILDER builder, PCPE_SECTION_ROW section) {
+    return addRow(builder, PE_TABLE_SECTIONS, section);
+}
+
+
+int peColumnsAddDll(PPE_COLUMNS_BUILDER builder, PCPE_DLL_ROW dll) {
+    return addRow(builder, PE_TABLE_DLLS, dll);
+}
+
+
+int peColumnsAddFile(PPE_COLUMNS_BUILDER builder, PCPE_FILE_ROW file) {
+
+    PE_FILE_ROW row = *file;
+    row.firstSection = builder->nextSection;
+    row.firstDll = builder->nextDll;
+    if (addRow(builder, PE_TABLE_FILES, &row) != 0) {
+        return -1;
+    }
+    builder->nextSection = (uint32_t) builder->columns.rows[PE_TABLE_SECTIONS];
+    builder->nextDll = (uint32_t) builder->columns.rows[PE_TABLE_DLLS];
+    return 0;
+}
+
+
+int peColumnsAppend(PPE_COLUMNS_BUILDER builder, PCPE_COLUMNS columns) {
+
+    PE_FILE_ROW file;
+    PE_SECTION_ROW section;
+    PE_DLL_ROW dll;
+    for (uint64_t idx = 0; idx < columns->rows[PE_TABLE_FILES]; idx++) {
+        uint32_t first;
+        uint32_t count = peFileSections(columns, idx, &first);
+        for (uint32_t row = first; row < first + count; row++) {
+            peColumnsSection(columns, row, &section);
+            if (peColumnsAddSection(builder, &section) != 0) {
+                return -1;
+            }
+        }
+        count = peFileDlls(columns, idx, &first);
+        for (uint32_t row = first; row < first + count; row++) {
+            peColumnsDll(columns, row, &dll);
+            if (peColumnsAddDll(builder, &dll) != 0) {
+                return -1;
+            }
+        }
+        peColumnsFile(columns, idx, &file);
+        if (peColumnsAddFile(builder, &file) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+
+int peColumnsWrite(const PE_COLUMNS_BUILDER *builder, PCPE_IMPORT_INDEX index, FILE *stream) {
+
+    PCPE_COLUMNS columns = &builder->columns;
+    PE_COLUMNS_HEADER header = { .version = PE_COLUMNS_VERSION, .columnCount = COLUMN_COUNT + (index ? 1 : 0) };
+    memcpy(header.magic, PE_COLUMNS_MAGIC, sizeof(header.magic));
+    memcpy(header.rows, columns->rows, sizeof(header.rows));
+
+    // lay the arrays out after the column entries, then the pool and the index
+    PE_COLUMN_ENTRY entries[COLUMN_COUNT + 1];
+    uint64_t offset = alignUp(sizeof(header) + header.columnCount * sizeof(entries[0]));
+    memset(entries, 0, sizeof(entries));
+    for (size_t idx = 0; idx < COLUMN_COUNT; idx++) {
+        strncpy(entries[idx].name, COLUMNS[idx].name, sizeof(entries[idx].name) - 1);
+        entries[idx].table = COLUMNS[idx].table;
+        entries[idx].width = COLUMNS[idx].width;
+        entries[idx].offset = offset;
+        offset = alignUp(offset + columns->rows[COLUMNS[idx].table] * COLUMNS[idx].width);
+    }
+    header.stringsOffset = offset;
+    header.stringsSize = columns->stringsSize;
+    strncpy(entries[COLUMN_COUNT].name, PE_COLUMNS_INDEX_ENTRY, sizeof(entries[COLUMN_COUNT].name) - 1);
+    entries[COLUMN_COUNT].table = PE_COLUMN_TABLES;
+    entries[COLUMN_COUNT].width = 1;
+    entries[COLUMN_COUNT].offset = alignUp(offset + columns->stringsSize);
+
+    if (writeAligned(stream, &header, sizeof(header)) != 0
+            || writeAligned(stream, entries, header.columnCount * sizeof(entries[0])) != 0) {
+        return -1;
+    }
+    for (size_t idx = 0; idx < COLUMN_COUNT; idx++) {
+        if (writeAligned(stream, *columnArray(columns, &COLUMNS[idx]), columns->rows[COLUMNS[idx].table] * COLUMNS[idx].width) != 0) {
+            return -1;
+        }
+    }
+    if (index ? writeAligned(stream, columns->strings, columns->stringsSize) != 0 || peIndexWrite(index, stream) != 0
+            : columns->stringsSize && fwrite(columns->strings, columns->stringsSize, 1, stream) != 1) {
+        return -1;
+    }
+    return fflush(stream) == 0 ? 0 : -1;
+}
+
+
+bool peOpenColumns(const uint8_t *base, uint64_t size, PPE_COLUMNS columns) {
+
+    memset(columns, 0, sizeof(*columns));
+    PCPE_COLUMNS_HEADER header = (PCPE_COLUMNS_HEADER) base;
+    if (size < sizeof(*header) || memcmp(header->magic, PE_COLUMNS_MAGIC, sizeof(header->magic))
+            || header->version != PE_COLUMNS_VERSION
+            || header->columnCount > (size - sizeof(*header)) / sizeof(PE_COLUMN_ENTRY)) {
+        return false;
+    }
+    for (unsigned table = 0; table < PE_COLUMN_TABLES; table++) {
+        if (header->rows[table] > UINT32_MAX) {
+            return false;
+        }
+        columns->rows[table] = header->rows[table];
+    }
+
+    // the pool ends in a terminator, so every id within it reads a terminated string
+    if (header->stringsOffset > size || header->stringsSize > size - header->stringsOffset
+            || (header->stringsSize && base[header->stringsOffset + header->stringsSize - 1])) {
+        return false;
+    }
+    columns->strings = (const char *) base + header->stringsOffset;
+    columns->stringsSize = header->stringsSize;
+
+    PCPE_COLUMN_ENTRY entries = (PCPE_COLUMN_ENTRY) (header + 1);
+    for (size_t idx = 0; idx < COLUMN_COUNT; idx++) {
+        const COLUMN *column = &COLUMNS[idx];
+        PCPE_COLUMN_ENTRY entry = NULL;
+        for (uint32_t find = 0; find < header->columnCount && !entry; find++) {
+            if (!strncmp(entries[find].name, column->name, sizeof(entries[find].name))) {
+                entry = &entries[find];
+            }
+        }
+        if (!entry || entry->table != column->table || entry->width != column->width || entry->offset > size
+                || columns->rows[column->table] > (size - entry->offset) / column->width
+                || (uintptr_t) (base + entry->offset) % column->width) {
+            return false;
+        }
+        *columnArray(columns, column) = base + entry->offset;
+    }
+
+    // the index is only placed here, it is checked when it is opened
+    for (uint32_t find = 0; find < header->columnCount; find++) {
+        PCPE_COLUMN_ENTRY entry = &entries[find];
+        if (!strncmp(entry->name, PE_COLUMNS_INDEX_ENTRY, sizeof(entry->name))) {
+            if (entry->table != PE_COLUMN_TABLES || entry->offset > size || (uintptr_t) (base + entry->offset) % COLUMN_ALIGNMENT) {
+                return false;
+            }
+            columns->importIndex = base + entry->offset;
+            columns->importIndexSize = size - entry->offset;
+        }
+    }
+    return true;
+}
+
+
+bool peColumnsIndex(PCPE_COLUMNS columns, PPE_IMPORT_INDEX index) {
+    if (!columns->importIndex) {
+        memset(index, 0, sizeof(*index));
+        return false;
+    }
+    return peOpenIndex(columns->importIndex, columns->importIndexSize, (uint32_t) columns->rows[PE_TABLE_FILES], index);
+}
+
+
+const char *peColumnsString(PCPE_COLUMNS columns, uint32_t id) {
+    return id < columns->stringsSize ? columns->strings + id : NULL;
+}
+
+
+void peColumnsFile(PCPE_COLUMNS columns, uint64_t file, PPE_FILE_ROW row) {
+    readRow(columns, PE_TABLE_FILES, file, row);
+}
+
+
+void peColumnsSection(PCPE_COLUMNS columns, uint64_t section, PPE_SECTION_ROW row) {
+    readRow(columns, PE_TABLE_SECTIONS, section, row);
+}
+
+
+void peColumnsDll(PCPE_COLUMNS columns, uint64_t dll, PPE_DLL_ROW row) {
+    readRow(columns, PE_TABLE_DLLS, dll, row);
+}
+
+
+uint32_t peFileSections(PCPE_COLUMNS columns, uint64_t file, uint32_t *first) {
+    return fileRange(columns, columns->firstSection, PE_TABLE_SECTIONS, file, first);
+}
+
+
+uint32_t peFileDlls(PCPE_COLUMNS columns, uint64_t file, uint32_t *first) {
+    return fileRange(columns, columns->firstDll, PE_TABLE_DLLS, file, first);
+}
+
+
+void peFileRowHeaders(PCPE_VIEW view, PPE_FILE_ROW row) {
+
+    row->machine = view->fileHeader.Machine;
+    row->characteristics = view->fileHeader.Characteristics;
+    row->timeDateStamp = view->fileHeader.TimeDateStamp;
+    row->numberOfSections = view->numberOfSections;
+    row->bits = view->bits;
+    row->imageBase = view->imageBase;
+
+    // peOpen() validated the optional header of the view's width up to its data directories
+    if (view->bits == 32) {
+        const IMAGE_OPTIONAL_HEADER32 *optional = &view->ntHeaders32.OptionalHeader;
+        row->addressOfEntryPoint = optional->AddressOfEntryPoint;
+        row->sizeOfImage = optional->SizeOfImage;
+        row->checkSum = optional->CheckSum;
+        row->subsystem = optional->Subsystem;
+        row->dllCharacteristics = optional->DllCharacteristics;
+    }
+    else {
+        const IMAGE_OPTIONAL_HEADER64 *optional = &view->ntHeaders64.OptionalHeader;
+        row->addressOfEntryPoint = optional->AddressOfEntryPoint;
+        row->sizeOfImage = optional->SizeOfImage;
+        row->checkSum = optional->CheckSum;
+        row->subsystem = optional->Subsystem;
+        row->dllCharacteristics = optional->DllCharacteristics;
+    }
+}
+
+
+size_t peFormatFileRow(char *buffer, size_t size, PCPE_FILE_ROW row, PE_ROW_FORMAT format) {
+
+    ROW_WRITER writer = { buffer, size, 0 };
+    if (format == PE_ROW_JSON) {
+        writeFormat(&writer, "{\"path\": ");
+        writeString(&writer, row->path, format);
+        writeFormat(&writer, ", \"fileSize\": %llu, ", (unsigned long long) row->fileSize);
+        if (row->error) {
+            writeFormat(&writer, "\"machine\": null, \"bits\": null, \"sections\": null, \"timeDateStamp\": null, "
+                "\"importDlls\": null, \"importFunctions\": null, \"exports\": null, \"error\": ");
+            writeString(&writer, row->error, format);
+        }
+        else {
+            writeFormat(&writer, "\"machine\": %u, \"bits\": %u, \"sections\": %u, \"timeDateStamp\": %u, "
+                "\"importDlls\": %u, \"importFunctions\": %u, \"exports\": %u, \"error\": null", row->machine, row->bits,
+                row->numberOfSections, row->timeDateStamp, row->importDlls, row->importFunctions, row->exports);
+        }
+        writeFormat(&writer, "}\n");
+    }
+    else {
+        writeFormat(&writer, "(");
+        writeString(&writer, row->path, format);
+        if (row->error) {
+            writeFormat(&writer, ", %llu, None, None, None, None, None, None, None, ", (unsigned long long) row->fileSize);
+            writeString(&writer, row->error, format);
+        }
+        else {
+            writeFormat(&writer, ", %llu, 0x%04X, %u, %u, 0x%08X, %u, %u, %u, None", (unsigned long long) row->fileSize,
+                row->machine, row->bits, row->numberOfSections, row->timeDateStamp, row->importDlls, row->importFunctions, row->exports);
+        }
+        writeFormat(&writer, "),\n");
+    }
+    if (size) {
+        buffer[writer.length < size ? writer.length : size - 1] = '\0';
+    }
+    return writer.length;
+}
+
+
+size_t peFormatFileTables(char *buffer, size_t size, PCPE_COLUMNS columns, uint64_t file, PE_ROW_FORMAT format) {
+
+    ROW_WRITER writer = { buffer, size, 0 };
+    bool json = format == PE_ROW_JSON;
+    PE_FILE_ROW row;
+    peColumnsFile(columns, file, &row);
+    writeFormat(&writer, json ? "{\"path\": " : "(");
+    writeString(&writer, row.path, format);
+
+    uint32_t first;
+    uint32_t count = peFileSections(columns, file, &first);
+    writeFormat(&writer, json ? ", \"sectionHeaders\": [" : ", [");
+    for (uint32_t idx = 0; idx < count; idx++) {
+        PE_SECTION_ROW section;
+        peColumnsSection(columns, first + idx, &section);
+        writeFormat(&writer, idx ? (json ? ", {\"name\": " : ", (") : (json ? "{\"name\": " : "("));
+        writeString(&writer, section.name, format);
+        writeFormat(&writer, json ? ", \"virtualSize\": %u, \"virtualAddress\": %u, \"sizeOfRawData\": %u, \"pointerToRawData\": %u, "
+            "\"characteristics\": %u}" : ", 0x%06X, 0x%06X, 0x%06X, 0x%06X, 0x%08X)", section.virtualSize, section.virtualAddress,
+            section.sizeOfRawData, section.pointerToRawData, section.characteristics);
+    }
+
+    count = peFileDlls(columns, file, &first);
+    writeFormat(&writer, json ? "], \"dlls\": [" : "], [");
+    for (uint32_t idx = 0; idx < count; idx++) {
+        PE_DLL_ROW dll;
+        peColumnsDll(columns, first + idx, &dll);
+        writeFormat(&writer, idx ? (json ? ", {\"name\": " : ", (") : (json ? "{\"name\": " : "("));
+        writeString(&writer, dll.name, format);
+        writeFormat(&writer, json ? ", \"functions\": %u}" : ", %u)", dll.functions);
+    }
+    writeFormat(&writer, json ? "]}\n" : "]),\n");
+    if (size) {
+        buffer[writer.length < size ? writer.length : size - 1] = '\0';
+    }
+    return writer.length;
+}
+
+
+static int addRow(PPE_COLUMNS_BUILDER builder, PE_COLUMN_TABLE table, const void *row) {
+
+    if (reserveRow(builder, table) != 0) {
+        return -1;
+    }
+
+    // strings first, a row that cannot be interned leaves the columns as they were
+    uint32_t ids[COLUMN_COUNT];
+    for (size_t idx = 0; idx < COLUMN_COUNT; idx++) {
+        const COLUMN *column = &COLUMNS[idx];
+        if (column->table == table && column->string) {
+            const char *string = *(const char * const *) ((const uint8_t *) row + column->field);
+            ids[idx] = internString(builder, string);
+            if (string && ids[idx] == PE_COLUMNS_NONE) {
+                return -1;
+            }
+        }
+    }
+
+    uint64_t index = builder->columns.rows[table];
+    for (size_t idx = 0; idx < COLUMN_COUNT; idx++) {
+        const COLUMN *column = &COLUMNS[idx];
+        if (column->table != table) {
+            continue;
+        }
+        uint8_t *array = (uint8_t *) *columnArray(&builder->columns, column);
+        const void *value = column->string ? (const void *) &ids[idx] : (const uint8_t *) row + column->field;
+        memcpy(array + index * column->width, value, column->width);
+    }
+    builder->columns.rows[table]++;
+    return 0;
+}
+
+
+static void readRow(PCPE_COLUMNS columns, PE_COLUMN_TABLE table, uint64_t index, void *row) {
+    for (size_t idx = 0; idx < COLUMN_COUNT; idx++) {
+        const COLUMN *column = &COLUMNS[idx];
+        if (column->table != table) {
+            continue;
+        }
+        const uint8_t *value = (const uint8_t *) *columnArray(columns, column) + index * column->width;
+        if (column->string) {
+            uint32_t id;
+            memcpy(&id, value, sizeof(id));
+            *(const char **) ((uint8_t *) row + column->field) = peColumnsString(columns, id);
+        }
+        else {
+            memcpy((uint8_t *) row + column->field, value, column->width);
+        }
+    }
+}
+
+
+static int reserveRow(PPE_COLUMNS_BUILDER builder, PE_COLUMN_TABLE table) {
+
+    uint64_t rows = builder->columns.rows[table];
+    if (rows < builder->capacity[table]) {
+        return 0;
+    }
+    if (rows >= UINT32_MAX / 2) {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    // a column that grew before another failed keeps its larger array, the capacity is the smallest
+    uint64_t capacity = rows ? 2 * rows : INITIAL_ROWS;
+    for (size_t idx = 0; idx < COLUMN_COUNT; idx++) {
+        if (COLUMNS[idx].table != table) {
+            continue;
+        }
+        const void **array = columnArray(&builder->columns, &COLUMNS[idx]);
+        void *grown = realloc((void *) *array, capacity * COLUMNS[idx].width);
+        if (!grown) {
+            errno = ENOMEM;
+            return -1;
+        }
+        *array = grown;
+    }
+    builder->capacity[table] = capacity;
+    return 0;
+}
+
+
+static uint32_t internString(PPE_COLUMNS_BUILDER builder, const char *string) {
+
+    if (!string) {
+        return PE_COLUMNS_NONE;
+    }
+    size_t length;
+    uint32_t hash = hashString(string, &length);
+    uint32_t slot = hash & builder->mask;
+    for (; builder->slots[slot]; slot = (slot + 1) & builder->mask) {
+        if (!strcmp(builder->pool + builder->slots[slot] - 1, string)) {
+            return builder->slots[slot] - 1;
+        }
+    }
+
+    // ids are offsets into the pool, PE_COLUMNS_NONE is never one
+    size_t used = builder->columns.stringsSize;
+    if (length >= PE_COLUMNS_NONE - used) {
+        errno = ENOMEM;
+        return PE_COLUMNS_NONE;
+    }
+    while (builder->poolCapacity - used < length + 1) {
+        char *grown = realloc(builder->pool, builder->poolCapacity * 2);
+        if (!grown) {
+            errno = ENOMEM;
+            return PE_COLUMNS_NONE;
+        }
+        builder->pool = grown;
+        builder->poolCapacity *= 2;
+        builder->columns.strings = grown;
+    }
+    if (builder->stringCount + 1 > (builder->mask + 1) / 2) {
+        if (growSlots(builder) != 0) {
+            return PE_COLUMNS_NONE;
+        }
+        slot = hash & builder->mask;
+        while (builder->slots[slot]) {
+            slot = (slot + 1) & builder->mask;
+        }
+    }
+
+    memcpy(builder->pool + used, string, length + 1);
+    builder->columns.stringsSize = used + length + 1;
+    builder->slots[slot] = (uint32_t) used + 1;
+    builder->stringCount++;
+    return (uint32_t) used;
+}
+
+
+static int growSlots(PPE_COLUMNS_BUILDER builder) {
+
+    if (builder->mask > UINT32_MAX / 4) {
+        errno = ENOMEM;
+        return -1;
+    }
+    uint32_t mask = builder->mask * 2 + 1;
+    uint32_t *slots = calloc((size_t) mask + 1, sizeof(*slots));
+    if (!slots) {
+        errno = ENOMEM;
+        return -1;
+    }
+    for (uint32_t old = 0; old <= builder->mask; old++) {
+        if (!builder->slots[old]) {
+            continue;
+        }
+        size_t length;
+        uint32_t slot = hashString(builder->pool + builder->slots[old] - 1, &length) & mask;
+        while (slots[slot]) {
+            slot = (slot + 1) & mask;
+        }
+        slots[slot] = builder->slots[old];
+    }
+    free(builder->slots);
+    builder->slots = slots;
+    builder->mask = mask;
+    return 0;
+}
+
+
+static uint32_t fileRange(PCPE_COLUMNS columns, const uint32_t *firsts, PE_COLUMN_TABLE table, uint64_t file, uint32_t *first) {
+
+    // a file's rows end where the next file's start, the last file's at the end of the table
+    uint64_t end = file + 1 < columns->rows[PE_TABLE_FILES] ? firsts[file + 1] : columns->rows[table];
+    *first = firsts[file];
+    if (*first > end || end > columns->rows[table]) {
+        return 0;
+    }
+    return (uint32_t) (end - *first);
+}
+
+
+static inline const void **columnArray(PCPE_COLUMNS columns, const COLUMN *column) {
+    return (const void **) ((const uint8_t *) columns + column->array);
+}
+
+
+static int writeAligned(FILE *stream, const void *data, uint64_t size) {
+
+    static const uint8_t ZEROS[COLUMN_ALIGNMENT] = { 0 };
+    if (size && fwrite(data, (size_t) size, 1, stream) != 1) {
+        return -1;
+    }
+    size_t padding = (size_t) (alignUp(size) - size);
+    if (padding && fwrite(ZEROS, padding, 1, stream) != 1) {
+        return -1;
+    }
+    return 0;
+}
+
+
+static void writeFormat(PROW_WRITER writer, const char *format, ...) {
+
+    va_list args;
+    va_start(args, format);
+    size_t available = writer->length < writer->size ? writer->size - writer->length : 0;
+    int length = vsnprintf(available ? writer->buffer + writer->length : NULL, available, format, args);
+    va_end(args);
+    writer->length += length > 0 ? (size_t) length : 0;
+}
+
+
+static void writeString(PROW_WRITER writer, const char *text, PE_ROW_FORMAT format) {
+
+    if (!text) {
+        writeFormat(writer, format == PE_ROW_JSON ? "null" : "None");
+        return;
+    }
+
+    // control characters as escapes, UTF-8 as it is so names stay readable; a byte that is not part
+    // of UTF-8 is escaped as the lone surrogate python's surrogateescape decodes it to, os.fsencode()
+    // gives the path back from either format
+    char quote = format == PE_ROW_JSON ? '"' : '\'';
+    writeChar(writer, quote);
+    for (const char *next = text; *next; ) {
+        unsigned char byte = (unsigned char) *next;
+        int length = byte < 0x80 ? 1 : utf8Length((const unsigned char *) next);
+        if (*next == quote || *next == '\\') {
+            writeChar(writer, '\\');
+            writeChar(writer, *next);
+        }
+        else if (byte < 0x20) {
+            writeFormat(writer, format == PE_ROW_JSON ? "\\u%04x" : "\\x%02x", byte);
+        }
+        else if (!length) {
+            writeFormat(writer, "\\u%04x", 0xdc00 | byte);
+            length = 1;
+        }
+        else {
+            for (int idx = 0; idx < length; idx++) {
+                writeChar(writer, next[idx]);
+            }
+        }
+        next += length;
+    }
+    writeChar(writer, quote);
+}
+
+
+static inline void writeChar(PROW_WRITER writer, char c) {
+    if (writer->length + 1 < writer->size) {
+        writer->buffer[writer->length] = c;
+    }
+    writer->length++;
+}
+
+
+static inline int utf8Length(const unsigned char *text) {
+
+    // the lead byte gives the length and the lowest code point, overlong forms and the surrogates
+    // are not UTF-8; a NUL ends the string, so no continuation byte is read past it
+    int length;
+    uint32_t code, lowest;
+    if (text[0] >= 0xc2 && text[0] <= 0xdf) {
+        length = 2;
+        code = text[0] & 0x1f;
+        lowest = 0x80;
+    }
+    else if (text[0] >= 0xe0 && text[0] <= 0xef) {
+        length = 3;
+        code = text[0] & 0x0f;
+        lowest = 0x800;
+    }
+    else if (text[0] >= 0xf0 && text[0] <= 0xf4) {
+        length = 4;
+        code = text[0] & 0x07;
+        lowest = 0x10000;
+    }
+    else {
+        return 0;
+    }
+    for (int idx = 1; idx < length; idx++) {
+        if ((text[idx] & 0xc0) != 0x80) {
+            return 0;
+        }
+        code = code << 6 | (text[idx] & 0x3f);
+    }
+    if (code < lowest || code > 0x10ffff || (code >= 0xd800 && code <= 0xdfff)) {
+        return 0;
+    }
+    return length;
+}
+
+
+static inline uint32_t hashString(const char *string, size_t *length) {
+    uint32_t hash = FNV_OFFSET_BASIS;
+    const char *next = string;
+    for (; *next; next++) {
+        hash = (hash ^ (uint8_t) *next) * FNV_PRIME;
+    }
+    *length = (size_t) (next - string);
+    return hash;
+}
+
+
+static inline uint64_t alignUp(uint64_t offset) {
+    return (offset + COLUMN_ALIGNMENT - 1) & ~(uint64_t) (COLUMN_ALIGNMENT - 1);
+}
@@ -0,0 +1,365 @@
+//-------------------------------------------------------------------------------------------------
+// pe_columns.h
+//
+// Columnar records of many images: one table of files, one of section headers and one of imported
+// DLLs, each stored as an array per field, with section and DLL names, paths and errors interned in
+// a string pool. A table is built in memory, written to a file and memory-mapped back, and then
+// queried in place: a field of every file is one contiguous array.
+//
+// A file's sections are the rows from its firstSection to the next file's, its DLLs likewise:
+//
+//      for (f = 0; f < columns.rows[PE_TABLE_FILES]; f++) if (columns.machine[f] == 0x8664) ...
+//      count = peFileSections(&columns, f, &first);    sections first to first + count - 1
+//
+// The file is little endian, laid out as:
+//
+//      PE_COLUMNS_HEADER
+//      PE_COLUMN_ENTRY[columnCount]            name, table, width and offset of each array
+//      arrays, each 8-byte aligned             rows[table] * width bytes
+//      string pool                             NUL terminated strings, ids are offsets into it
+//      import index, 8-byte aligned            optional, a written PE_IMPORT_INDEX of the files
+//
+// The import index is found like a column, by an entry named PE_COLUMNS_INDEX_ENTRY; its table is
+// PE_COLUMN_TABLES, as it is a block sized by its own header rather than an array of rows. Its
+// samples are file rows, so "which files import X" is answered from the mapped file alone.
+//
+// The python and JSON records are views of one PE_FILE_ROW, whether it was just parsed or read
+// back from columns. The sections and DLLs of a file read back have records of their own.
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "pe_view.h"
+#include "pe_index.h"
+
+// "PECOLUMN", first bytes of a columns file
+#define PE_COLUMNS_MAGIC "PECOLUMN"
+
+// bumped when a column changes meaning, adding a column keeps the version
+#define PE_COLUMNS_VERSION 1
+
+// string id of no string, e.g. the error of a file that parsed
+#define PE_COLUMNS_NONE UINT32_MAX
+
+// longest column name, with its terminator
+#define PE_COLUMN_NAME_SIZE 32
+
+// name of the entry of the import index
+#define PE_COLUMNS_INDEX_ENTRY "index.imports"
+
+// fields of a record printed by peFormatFileRow(), for a comment above the python list
+#define PE_ROW_FIELDS "path, file size, machine, bits, sections, time date stamp, import DLLs, imported functions, named exports, error"
+
+// fields of a record printed by peFormatFileTables()
+#define PE_TABLE_FIELDS "path, [(section name, virtual size, virtual address, size of raw data, pointer to raw data, characteristics)], " \
+    "[(import DLL, imported functions)]"
+
+
+/**
+ * @brief tables of a columns file
+ */
+typedef enum _PE_COLUMN_TABLE {
+    PE_TABLE_FILES,
+    PE_TABLE_SECTIONS,
+    PE_TABLE_DLLS,
+    PE_COLUMN_TABLES
+} PE_COLUMN_TABLE;
+
+/**
+ * @brief first bytes of a columns file
+ */
+typedef struct _PE_COLUMNS_HEADER {
+    char        magic[8];                   // PE_COLUMNS_MAGIC, not NUL terminated
+    uint32_t    version;                    // PE_COLUMNS_VERSION
+    uint32_t    columnCount;                // entries following the header
+    uint64_t    rows[PE_COLUMN_TABLES];     // rows of each table
+    uint64_t    stringsOffset;              // of the string pool
+    uint64_t    stringsSize;
+} PE_COLUMNS_HEADER, *PPE_COLUMNS_HEADER;
+
+typedef const PE_COLUMNS_HEADER* PCPE_COLUMNS_HEADER;
+
+/**
+ * @brief where the array of one column is
+ */
+typedef struct _PE_COLUMN_ENTRY {
+    char        name[PE_COLUMN_NAME_SIZE];  // "table.field", NUL terminated
+    uint32_t    table;                      // PE_COLUMN_TABLE
+    uint32_t    width;                      // bytes per row, 1, 2, 4 or 8
+    uint64_t    offset;                     // of the array, from the start of the file
+} PE_COLUMN_ENTRY, *PPE_COLUMN_ENTRY;
+
+typedef const PE_COLUMN_ENTRY* PCPE_COLUMN_ENTRY;
+
+/**
+ * @brief the columns of the three tables, in a builder or in a mapped file
+ * @remark String columns hold string ids, see peColumnsString(). Arrays of a mapped file point into it.
+ */
+typedef struct _PE_COLUMNS {
+    uint64_t        rows[PE_COLUMN_TABLES];
+
+    // files, an image that could not be parsed has an error and zeros in the header fields
+    const uint32_t  *path;
+    const uint32_t  *error;
+    const uint64_t  *fileSize;
+    const uint64_t  *imageBase;
+    const uint32_t  *timeDateStamp;
+    const uint32_t  *addressOfEntryPoint;
+    const uint32_t  *sizeOfImage;
+    const uint32_t  *checkSum;
+    const uint32_t  *importDlls;
+    const uint32_t  *importFunctions;
+    const uint32_t  *exports;               // named exports
+    const uint32_t  *firstSection;
+    const uint32_t  *firstDll;
+    const uint16_t  *machine;
+    const uint16_t  *characteristics;
+    const uint16_t  *subsystem;
+    const uint16_t  *dllCharacteristics;
+    const uint16_t  *numberOfSections;
+    const uint8_t   *bits;
+
+    // sections
+    const uint32_t  *sectionName;
+    const uint32_t  *virtualSize;
+    const uint32_t  *virtualAddress;
+    const uint32_t  *sizeOfRawData;
+    const uint32_t  *pointerToRawData;
+    const uint32_t  *sectionCharacteristics;
+
+    // DLLs, named as imported
+    const uint32_t  *dllName;
+    const uint32_t  *dllFunctions;
+
+    const char      *strings;
+    uint64_t        stringsSize;
+
+    // written import index, to be opened with peColumnsIndex(), NULL if the file has none
+    const uint8_t   *importIndex;
+    uint64_t        importIndexSize;    // bytes from importIndex to the end of the file
+} PE_COLUMNS, *PPE_COLUMNS;
+
+typedef const PE_COLUMNS* PCPE_COLUMNS;
+
+/**
+ * @brief one file, as added to a builder or read back from columns
+ */
+typedef struct _PE_FILE_ROW {
+    const char  *path;
+    const char  *error;                 // NULL if the image parsed
+    uint64_t    fileSize;
+    uint64_t    imageBase;
+    uint32_t    timeDateStamp;
+    uint32_t    addressOfEntryPoint;
+    uint32_t    sizeOfImage;
+    uint32_t    checkSum;
+    uint32_t    importDlls;
+    uint32_t    importFunctions;
+    uint32_t    exports;
+    uint32_t    firstSection;           // set by peColumnsAddFile()
+    uint32_t    firstDll;               // set by peColumnsAddFile()
+    uint16_t    machine;
+    uint16_t    characteristics;
+    uint16_t    subsystem;
+    uint16_t    dllCharacteristics;
+    uint16_t    numberOfSections;
+    uint8_t     bits;
+} PE_FILE_ROW, *PPE_FILE_ROW;
+
+typedef const PE_FILE_ROW* PCPE_FILE_ROW;
+
+/**
+ * @brief one section header
+ */
+typedef struct _PE_SECTION_ROW {
+    const char  *name;
+    uint32_t    virtualSize;
+    uint32_t    virtualAddress;
+    uint32_t    sizeOfRawData;
+    uint32_t    pointerToRawData;
+    uint32_t    characteristics;
+} PE_SECTION_ROW, *PPE_SECTION_ROW;
+
+typedef const PE_SECTION_ROW* PCPE_SECTION_ROW;
+
+/**
+ * @brief one imported DLL
+ */
+typedef struct _PE_DLL_ROW {
+    const char  *name;
+    uint32_t    functions;
+} PE_DLL_ROW, *PPE_DLL_ROW;
+
+typedef const PE_DLL_ROW* PCPE_DLL_ROW;
+
+/**
+ * @brief columns being built, initialize with peColumnsInit() and release with peColumnsFree()
+ * @remark A builder is not thread safe; build one per thread and merge them with peColumnsAppend()
+ */
+typedef struct _PE_COLUMNS_BUILDER {
+    PE_COLUMNS  columns;
+    uint64_t    capacity[PE_COLUMN_TABLES];
+    uint32_t    nextSection;        // first section of the file added next
+    uint32_t    nextDll;            // first DLL of the file added next
+    char        *pool;
+    size_t      poolCapacity;
+    uint32_t    stringCount;
+
+    // open addressed hash table of string offset + 1, 0 = empty slot
+    uint32_t    *slots;
+    uint32_t    mask;
+} PE_COLUMNS_BUILDER, *PPE_COLUMNS_BUILDER;
+
+/**
+ * @brief format of a record printed by peFormatFileRow()
+ */
+typedef enum _PE_ROW_FORMAT {
+    PE_ROW_PYTHON,      // a python tuple and a comma, the element of a list
+    PE_ROW_JSON,        // a JSON object on one line, JSON Lines
+} PE_ROW_FORMAT;
+
+
+/**
+ * @brief Initializes an empty builder
+ *
+ * @return 0 = SUCCESS | -1 = ERROR (out of memory)
+ */
+int peColumnsInit(PPE_COLUMNS_BUILDER builder);
+
+/**
+ * @brief Releases everything a builder holds
+ */
+void peColumnsFree(PPE_COLUMNS_BUILDER builder);
+
+/**
+ * @brief Adds a section header of the file added next
+ *
+ * @return 0 = SUCCESS | -1 = ERROR (out of memory)
+ */
+int peColumnsAddSection(PPE_COLUMNS_BUILDER builder, PCPE_SECTION_ROW section);
+
+/**
+ * @brief Adds an imported DLL of the file added next
+ *
+ * @return 0 = SUCCESS | -1 = ERROR (out of memory)
+ */
+int peColumnsAddDll(PPE_COLUMNS_BUILDER builder, PCPE_DLL_ROW dll);
+
+/**
+ * @brief Adds a file, owning the sections and DLLs added since the file before
+ * @remark firstSection and firstDll of the row are ignored, the builder sets them
+ *
+ * @return 0 = SUCCESS | -1 = ERROR (out of memory, the file is not added)
+ */
+int peColumnsAddFile(PPE_COLUMNS_BUILDER builder, PCPE_FILE_ROW file);
+
+/**
+ * @brief Adds every file of other columns, with their sections and DLLs
+ *
+ * @return 0 = SUCCESS | -1 = ERROR (out of memory, the files added before stay)
+ */
+int peColumnsAppend(PPE_COLUMNS_BUILDER builder, PCPE_COLUMNS columns);
+
+/**
+ * @brief Writes the columns of a builder in the layout above
+ *
+ * @param[in] index Optional, imports of the files, its samples the file rows
+ * @param[in] stream Stream opened in binary mode
+ * @return 0 = SUCCESS | -1 = ERROR (errno set)
+ */
+int peColumnsWrite(const PE_COLUMNS_BUILDER *builder, PCPE_IMPORT_INDEX index, FILE *stream);
+
+/**
+ * @brief Validates a columns file in memory and points the columns into it
+ * @remark Every array and the string pool are checked to lie within size. Columns are found by name,
+ * so a file with more columns than this reader knows opens too. Nothing is copied.
+ *
+ * @param[in] base First byte of the file, 8-byte aligned, typically a mapped file
+ * @param[in] size Number of bytes readable at base
+ * @param[out] columns Receives the columns
+ * @return true if the file holds every known column
+ */
+bool peOpenColumns(const uint8_t *base, uint64_t size, PPE_COLUMNS columns);
+
+/**
+ * @brief Opens the import index of a columns file in place
+ * @remark The index is checked as a whole, see peOpenIndex(), its samples against the file rows
+ *
+ * @param[out] index Receives the read only index
+ * @return true | false if the file has no index or it is malformed
+ */
+bool peColumnsIndex(PCPE_COLUMNS columns, PPE_IMPORT_INDEX index);
+
+/**
+ * @brief Returns an interned string
+ *
+ * @return NUL terminated string | NULL for PE_COLUMNS_NONE or an id outside the pool
+ */
+const char *peColumnsString(PCPE_COLUMNS columns, uint32_t id);
+
+/**
+ * @brief Reads a file row
+ *
+ * @param[in] file Row, below rows[PE_TABLE_FILES]
+ */
+void peColumnsFile(PCPE_COLUMNS columns, uint64_t file, PPE_FILE_ROW row);
+
+/**
+ * @brief Reads a section row
+ *
+ * @param[in] section Row, below rows[PE_TABLE_SECTIONS]
+ */
+void peColumnsSection(PCPE_COLUMNS columns, uint64_t section, PPE_SECTION_ROW row);
+
+/**
+ * @brief Reads a DLL row
+ *
+ * @param[in] dll Row, below rows[PE_TABLE_DLLS]
+ */
+void peColumnsDll(PCPE_COLUMNS columns, uint64_t dll, PPE_DLL_ROW row);
+
+/**
+ * @brief Returns the section rows of a file
+ *
+ * @param[out] first Receives the first section row
+ * @return Number of sections | 0 if the file has none or its range lies outside the table
+ */
+uint32_t peFileSections(PCPE_COLUMNS columns, uint64_t file, uint32_t *first);
+
+/**
+ * @brief Returns the DLL rows of a file
+ *
+ * @param[out] first Receives the first DLL row
+ * @return Number of DLLs | 0 if the file has none or its range lies outside the table
+ */
+uint32_t peFileDlls(PCPE_COLUMNS columns, uint64_t file, uint32_t *first);
+
+/**
+ * @brief Fills the header fields of a file row from a validated image
+ * @remark The path, size, error and import and export counts are left to the caller
+ */
+void peFileRowHeaders(PCPE_VIEW view, PPE_FILE_ROW row);
+
+/**
+ * @brief Formats a file row as a record: path, file size, machine, bits, sections, time date stamp,
+ * import DLLs, imported functions, named exports and error
+ * @remark Works like snprintf(), the output is cut to size and always NUL terminated if size is not 0
+ *
+ * @return Length of the whole record, without the terminator
+ */
+size_t peFormatFileRow(char *buffer, size_t size, PCPE_FILE_ROW row, PE_ROW_FORMAT format);
+
+/**
+ * @brief Formats the section headers and imported DLLs of a file of columns as a record: its path, a
+ * list of (name, virtual size, virtual address, size of raw data, pointer to raw data, characteristics)
+ * and a list of (DLL, imported functions)
+ * @remark Works like peFormatFileRow()
+ *
+ * @param[in] file Row, below rows[PE_TABLE_FILES]
+ * @return Length of the whole record, without the terminator
+ */
+size_t peFormatFileTables(char *buffer, size_t size, PCPE_COLUMNS columns, uint64_t file, PE_ROW_FORMAT format);
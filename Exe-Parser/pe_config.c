@@ -0,0 +1,111 @@
+/**
+ * @file pe_config.c
+ * @brief TLS and load configuration directories of a PE view
+ * @date 2026-10-16
+ *
+ * The load config structure grew with every Windows release and its first field, Size, tells which
+ * version an image carries; the size in the data directory entry is not reliable for it. Only the
+ * fields an image declares are read, the guard function table is checked once and walked in place.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "pe_config.h"
+#include "pe_traits.h"
+
+
+//*********************************************************************************
+// DECLARATIONS
+//*********************************************************************************
+
+// readTls32(), nextVa32(), readLoadConfig32() and their 64-bit versions
+#define PE_BITS 32
+#include "pe_config_tmpl.h"
+#undef PE_BITS
+
+#define PE_BITS 64
+#include "pe_config_tmpl.h"
+#undef PE_BITS
+
+
+//*********************************************************************************
+// DEFINITIONS
+//********************************************************************************
+
+bool peOpenTls(PCPE_VIEW view, PPE_TLS tls) {
+
+    memset(tls, 0, sizeof(*tls));
+    tls->view = view;
+    return view->bits == 32 ? readTls32(view, tls) : readTls64(view, tls);
+}
+
+
+void peTlsCallbacks(const PE_TLS *tls, PPE_VA_ITERATOR it) {
+
+    it->view = tls->view;
+    it->rva = 0;
+    it->count = 0;
+    it->truncated = false;
+    if (tls->addressOfCallBacks && !peVaToRva(tls->view, tls->addressOfCallBacks, &it->rva)) {
+        it->truncated = true;
+    }
+}
+
+
+bool peNextTlsCallback(PPE_VA_ITERATOR it, uint64_t *va) {
+
+    if (!it->rva) {
+        return false;
+    }
+    if (it->count >= PE_MAX_TLS_CALLBACKS) {
+        it->truncated = true;
+        return false;
+    }
+    return it->view->bits == 32 ? nextVa32(it, va) : nextVa64(it, va);
+}
+
+
+bool peOpenLoadConfig(PCPE_VIEW view, PPE_LOAD_CONFIG config) {
+
+    memset(config, 0, sizeof(*config));
+    config->view = view;
+
+    PCIMAGE_DATA_DIRECTORY directory = peDataDirectory(view, IMAGE_DIRECTORY_ENTRY_LOAD_CONFIG);
+    if (!directory || !directory->VirtualAddress || !directory->Size) {
+        return false;
+    }
+    uint32_t size;
+    if (!peRvaCopy(view, directory->VirtualAddress, &size, sizeof(size)) || size < 2 * sizeof(uint32_t)) {
+        return false;
+    }
+    config->size = size;
+    return view->bits == 32
+        ? readLoadConfig32(view, directory->VirtualAddress, size, config)
+        : readLoadConfig64(view, directory->VirtualAddress, size, config);
+}
+
+
+void peGuardFunctions(const PE_LOAD_CONFIG *config, PPE_GUARD_ITERATOR it) {
+
+    it->next = NULL;
+    it->remaining = 0;
+    it->stride = sizeof(uint32_t) + ((config->guardFlags & IMAGE_GUARD_CF_FUNCTION_TABLE_SIZE_MASK) >> IMAGE_GUARD_CF_FUNCTION_TABLE_SIZE_SHIFT);
+    it->truncated = false;
+    if (!config->guardCFFunctionTable || !config->guardCFFunctionCount) {
+        return;
+    }
+
+    // a table too long for 32 bits of RVA space cannot be in the file
+    uint32_t rva;
+    uint64_t length = config->guardCFFunctionCount * it->stride;
+    if (config->guardCFFunctionCount > UINT32_MAX || length > UINT32_MAX
+        || !peVaToRva(config->view, config->guardCFFunctionTable, &rva)
+        || !(it->next = peRvaPointer(config->view, rva, (uint32_t) length))) {
+        it->truncated = true;
+        return;
+    }
+    it->remaining = config->guardCFFunctionCount;
+}
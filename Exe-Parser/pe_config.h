@@ -0,0 +1,134 @@
+//-------------------------------------------------------------------------------------------------
+// pe_config.h
+//
+// TLS and load configuration directories of a PE view: the TLS callback array and the load config
+// fields up to the Control Flow Guard tables, with the guard function table walked in place.
+// Addresses stored in the image as VAs are returned as VAs, widened to 64 bits for both widths.
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "pe_view.h"
+
+// TLS callbacks walked at most, a loader would stop long before
+#define PE_MAX_TLS_CALLBACKS 0x10000
+
+
+/**
+ * @brief the TLS directory, filled by peOpenTls()
+ */
+typedef struct _PE_TLS {
+    PCPE_VIEW   view;
+    uint64_t    startAddressOfRawData;      // VA
+    uint64_t    endAddressOfRawData;        // VA
+    uint64_t    addressOfIndex;             // VA
+    uint64_t    addressOfCallBacks;         // VA of a null terminated array of callback VAs
+    uint32_t    sizeOfZeroFill;
+    uint32_t    characteristics;
+} PE_TLS, *PPE_TLS;
+
+/**
+ * @brief the load configuration directory, filled by peOpenLoadConfig()
+ * @remark Fields past the size the image declares are 0, as the loader treats them
+ */
+typedef struct _PE_LOAD_CONFIG {
+    PCPE_VIEW   view;
+    uint32_t    size;                           // Size field of the directory, the version of the structure
+    uint32_t    timeDateStamp;
+    uint64_t    securityCookie;                 // VA
+    uint64_t    seHandlerTable;                 // VA, PE32 only
+    uint64_t    seHandlerCount;
+    uint64_t    guardCFCheckFunctionPointer;    // VA
+    uint64_t    guardCFDispatchFunctionPointer; // VA
+    uint64_t    guardCFFunctionTable;           // VA of GuardCFFunctionCount entries
+    uint64_t    guardCFFunctionCount;
+    uint32_t    guardFlags;                     // IMAGE_GUARD_*
+    uint64_t    guardLongJumpTargetTable;       // VA
+    uint64_t    guardLongJumpTargetCount;
+} PE_LOAD_CONFIG, *PPE_LOAD_CONFIG;
+
+/**
+ * @brief position in a null terminated array of VAs, such as the TLS callbacks
+ */
+typedef struct _PE_VA_ITERATOR {
+    PCPE_VIEW   view;
+    uint32_t    rva;            // next entry
+    uint32_t    count;          // entries returned so far
+    bool        truncated;      // the walk stopped at an entry outside the file
+} PE_VA_ITERATOR, *PPE_VA_ITERATOR;
+
+/**
+ * @brief position in the guard CF function table
+ */
+typedef struct _PE_GUARD_ITERATOR {
+    const uint8_t   *next;          // next entry, in the image
+    uint64_t        remaining;      // entries after next
+    uint32_t        stride;         // bytes per entry: an RVA and 0 or more bytes of flags
+    bool            truncated;      // the table is not within the file
+} PE_GUARD_ITERATOR, *PPE_GUARD_ITERATOR;
+
+
+/**
+ * @brief Reads the TLS directory of an image
+ *
+ * @param[in] view Validated image
+ * @param[out] tls Receives the directory
+ * @return true if the image has a TLS directory within the file
+ */
+bool peOpenTls(PCPE_VIEW view, PPE_TLS tls);
+
+/**
+ * @brief Starts a walk over the TLS callbacks
+ *
+ * @param[in] tls Directory read by peOpenTls()
+ * @param[out] it Iterator to start
+ */
+void peTlsCallbacks(const PE_TLS *tls, PPE_VA_ITERATOR it);
+
+/**
+ * @brief Returns the next TLS callback
+ *
+ * @param[in,out] it Iterator started by peTlsCallbacks()
+ * @param[out] va Receives the VA of the callback
+ * @return true if a callback was returned | false at the null entry or at malformed data (it->truncated set)
+ */
+bool peNextTlsCallback(PPE_VA_ITERATOR it, uint64_t *va);
+
+/**
+ * @brief Reads the load configuration directory of an image
+ *
+ * @param[in] view Validated image
+ * @param[out] config Receives the fields
+ * @return true if the image has a load configuration directory within the file
+ */
+bool peOpenLoadConfig(PCPE_VIEW view, PPE_LOAD_CONFIG config);
+
+/**
+ * @brief Starts a walk over the guard CF function table, the valid indirect call targets
+ * @remark The whole table is checked to lie within the image here, entries are then read without checks
+ *
+ * @param[in] config Directory read by peOpenLoadConfig()
+ * @param[out] it Iterator to start
+ */
+void peGuardFunctions(const PE_LOAD_CONFIG *config, PPE_GUARD_ITERATOR it);
+
+/**
+ * @brief Returns the next entry of the guard CF function table
+ *
+ * @param[in,out] it Iterator started by peGuardFunctions()
+ * @param[out] rva Receives the RVA of the function
+ * @param[out] flags Receives the first flags byte of the entry, 0 if entries have none
+ * @return true if an entry was returned | false at the end of the table
+ */
+static inline bool peNextGuardFunction(PPE_GUARD_ITERATOR it, uint32_t *rva, uint8_t *flags) {
+    if (!it->remaining) {
+        return false;
+    }
+    *rva = peRead32(it->next);
+    *flags = it->stride > sizeof(uint32_t) ? it->next[4] : 0;
+    it->next += it->stride;
+    it->remaining--;
+    return true;
+}
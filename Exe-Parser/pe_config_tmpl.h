@@ -0,0 +1,81 @@
+//-------------------------------------------------------------------------------------------------
+// pe_config_tmpl.h
+//
+// Width dependent TLS and load config decoding, included by pe_config.c once per PE_BITS (see
+// pe_traits.h). No include guard on purpose.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef PE_BITS
+#error "define PE_BITS as 32 or 64 before including pe_config_tmpl.h"
+#endif
+
+
+/**
+ * @brief Copies the TLS directory, widening its VAs
+ */
+static bool PE_FN(readTls)(PCPE_VIEW view, PPE_TLS tls) {
+
+    PE_TLS_DIRECTORY directory;
+    if (!PE_DIRECTORY(view, IMAGE_DIRECTORY_ENTRY_TLS, &directory)) {
+        return false;
+    }
+    tls->startAddressOfRawData = directory.StartAddressOfRawData;
+    tls->endAddressOfRawData = directory.EndAddressOfRawData;
+    tls->addressOfIndex = directory.AddressOfIndex;
+    tls->addressOfCallBacks = directory.AddressOfCallBacks;
+    tls->sizeOfZeroFill = directory.SizeOfZeroFill;
+    tls->characteristics = directory.Characteristics;
+    return true;
+}
+
+
+/**
+ * @brief Reads the VA at the iterator and advances past it
+ *
+ * @return true if a VA was returned | false at the null entry or at malformed data
+ */
+static bool PE_FN(nextVa)(PPE_VA_ITERATOR it, uint64_t *va) {
+
+    PE_THUNK entry;
+    if (!peRvaCopy(it->view, it->rva, &entry, sizeof(entry))) {
+        it->truncated = true;
+        return false;
+    }
+    if (!entry) {
+        return false;
+    }
+    *va = entry;
+    it->rva += sizeof(PE_THUNK);
+    it->count++;
+    return true;
+}
+
+
+/**
+ * @brief Copies the load config fields the image declares, widening its VAs and counts
+ */
+static bool PE_FN(readLoadConfig)(PCPE_VIEW view, uint32_t rva, uint32_t size, PPE_LOAD_CONFIG config) {
+
+    // fields past the declared size are left 0 by the zeroed copy
+    PE_LOAD_CONFIG_DIRECTORY directory;
+    memset(&directory, 0, sizeof(directory));
+    if (size > sizeof(directory)) {
+        size = sizeof(directory);
+    }
+    if (!peRvaCopy(view, rva, &directory, size)) {
+        return false;
+    }
+
+    config->timeDateStamp = directory.TimeDateStamp;
+    config->securityCookie = directory.SecurityCookie;
+    config->seHandlerTable = directory.SEHandlerTable;
+    config->seHandlerCount = directory.SEHandlerCount;
+    config->guardCFCheckFunctionPointer = directory.GuardCFCheckFunctionPointer;
+    config->guardCFDispatchFunctionPointer = directory.GuardCFDispatchFunctionPointer;
+    config->guardCFFunctionTable = directory.GuardCFFunctionTable;
+    config->guardCFFunctionCount = directory.GuardCFFunctionCount;
+    config->guardFlags = directory.GuardFlags;
+    config->guardLongJumpTargetTable = directory.GuardLongJumpTargetTable;
+    config->guardLongJumpTargetCount = directory.GuardLongJumpTargetCount;
+    return true;
+}
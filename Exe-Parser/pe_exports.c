@@ -0,0 +1,192 @@
+/**
+ * @file pe_exports.c
+ * @brief Export directory decoder over a PE view
+ * @date 2026-10-16
+ *
+ * peOpenExports() checks the three arrays against the image once. Name lookups then cost one string
+ * read per probe of the binary search, the same lookup the loader does for GetProcAddress.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "pe_exports.h"
+
+
+//*********************************************************************************
+// DECLARATIONS
+//*********************************************************************************
+
+/**
+ * @brief Fills an export from a function index, resolving a forwarder
+ *
+ * @return true if the function index is in the function array and a forwarder, if any, is readable
+ */
+static bool fillExport(PCPE_EXPORTS exports, uint32_t function, const char *name, uint32_t nameLength, PPE_EXPORT export);
+
+/**
+ * @brief Returns the n-th name | NULL if it is unreadable
+ */
+static inline const char *nameAt(PCPE_EXPORTS exports, uint32_t nameIndex, uint32_t *length);
+
+
+//*********************************************************************************
+// DEFINITIONS
+//********************************************************************************
+
+bool peOpenExports(PCPE_VIEW view, PPE_EXPORTS exports) {
+
+    memset(exports, 0, sizeof(*exports));
+    exports->view = view;
+
+    PCIMAGE_EXPORT_DIRECTORY directory = &exports->directory;
+    if (!PE_DIRECTORY(view, IMAGE_DIRECTORY_ENTRY_EXPORT, &exports->directory)) {
+        return false;
+    }
+    PCIMAGE_DATA_DIRECTORY entry = peDataDirectory(view, IMAGE_DIRECTORY_ENTRY_EXPORT);
+    exports->directoryRva = entry->VirtualAddress;
+    exports->directorySize = entry->Size;
+    exports->dllName = peRvaString(view, directory->Name, NULL);
+
+    IMAGE_SECTION_HEADER section;
+    uint64_t offset;
+    if (peSectionByRva(view, exports->directoryRva, &section) && section.SizeOfRawData
+            && peRvaToOffset(view, section.VirtualAddress, 1, &offset)) {
+        // as peRvaToOffset() does, bytes past the virtual size, the raw data or the file are not in the section
+        uint64_t available = view->size - offset;
+        uint32_t size = section.SizeOfRawData;
+        if (section.Misc.VirtualSize && section.Misc.VirtualSize < size) {
+            size = section.Misc.VirtualSize;
+        }
+        exports->sectionData = view->base + offset;
+        exports->sectionRva = section.VirtualAddress;
+        exports->sectionSize = size < available ? size : (uint32_t) available;
+    }
+    exports->base = directory->Base;
+
+    // the arrays are used without further checks, so all of each has to be in the file; an array
+    // too long for 32 bits of RVA space is rejected by the length overflowing
+    uint64_t functionsSize = (uint64_t) directory->NumberOfFunctions * sizeof(uint32_t);
+    uint64_t namesSize = (uint64_t) directory->NumberOfNames * sizeof(uint32_t);
+    uint64_t ordinalsSize = (uint64_t) directory->NumberOfNames * sizeof(uint16_t);
+    if (functionsSize > UINT32_MAX || namesSize > UINT32_MAX) {
+        return false;
+    }
+    if (directory->NumberOfFunctions) {
+        exports->functions = peRvaPointer(view, directory->AddressOfFunctions, (uint32_t) functionsSize);
+        if (!exports->functions) {
+            return false;
+        }
+    }
+    if (directory->NumberOfNames) {
+        exports->names = peRvaPointer(view, directory->AddressOfNames, (uint32_t) namesSize);
+        exports->nameOrdinals = peRvaPointer(view, directory->AddressOfNameOrdinals, (uint32_t) ordinalsSize);
+        if (!exports->names || !exports->nameOrdinals) {
+            return false;
+        }
+    }
+    exports->numberOfFunctions = directory->NumberOfFunctions;
+    exports->numberOfNames = directory->NumberOfNames;
+    return true;
+}
+
+
+bool peExportByName(PCPE_EXPORTS exports, const char *name, PPE_EXPORT export) {
+
+    // lower bound over the sorted names
+    uint32_t low = 0, high = exports->numberOfNames;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        const char *probe = nameAt(exports, mid, NULL);
+        if (!probe) {
+            return false;
+        }
+        int order = strcmp(probe, name);
+        if (order == 0) {
+            return peExportByNameIndex(exports, mid, export);
+        }
+        if (order < 0) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+    return false;
+}
+
+
+bool peExportByHint(PCPE_EXPORTS exports, uint16_t hint, const char *name, PPE_EXPORT export) {
+    if (hint < exports->numberOfNames) {
+        const char *probe = nameAt(exports, hint, NULL);
+        if (probe && !strcmp(probe, name)) {
+            return peExportByNameIndex(exports, hint, export);
+        }
+    }
+    return peExportByName(exports, name, export);
+}
+
+
+bool peExportByOrdinal(PCPE_EXPORTS exports, uint32_t ordinal, PPE_EXPORT export) {
+    if (ordinal < exports->base) {
+        return false;
+    }
+    return fillExport(exports, ordinal - exports->base, NULL, 0, export);
+}
+
+
+bool peExportByNameIndex(PCPE_EXPORTS exports, uint32_t nameIndex, PPE_EXPORT export) {
+    if (nameIndex >= exports->numberOfNames) {
+        return false;
+    }
+    uint32_t length;
+    const char *name = nameAt(exports, nameIndex, &length);
+    return name && fillExport(exports, peRead16(exports->nameOrdinals + (uint64_t) nameIndex * sizeof(uint16_t)), name, length, export);
+}
+
+
+static bool fillExport(PCPE_EXPORTS exports, uint32_t function, const char *name, uint32_t nameLength, PPE_EXPORT export) {
+
+    if (function >= exports->numberOfFunctions) {
+        return false;
+    }
+    export->name = name;
+    export->nameLength = nameLength;
+    export->ordinal = exports->base + function;
+    export->rva = peRead32(exports->functions + (uint64_t) function * sizeof(uint32_t));
+    export->forwarder = NULL;
+
+    // an RVA inside the export directory is the name of the function it forwards to
+    if (export->rva >= exports->directoryRva && export->rva - exports->directoryRva < exports->directorySize) {
+        export->forwarder = peRvaString(exports->view, export->rva, NULL);
+        return export->forwarder != NULL;
+    }
+    return true;
+}
+
+
+static inline const char *nameAt(PCPE_EXPORTS exports, uint32_t nameIndex, uint32_t *length) {
+
+    uint32_t rva = peRead32(exports->names + (uint64_t) nameIndex * sizeof(uint32_t));
+    uint32_t delta = rva - exports->sectionRva;
+    if (rva < exports->sectionRva || delta >= exports->sectionSize) {
+        return peRvaString(exports->view, rva, length);
+    }
+
+    // same bounds as peRvaString(), without looking the section up again
+    uint32_t available = exports->sectionSize - delta;
+    if (available > PE_MAX_NAME_LENGTH + 1) {
+        available = PE_MAX_NAME_LENGTH + 1;
+    }
+    const char *name = (const char *) exports->sectionData + delta;
+    const char *terminator = memchr(name, '\0', available);
+    if (!terminator) {
+        return NULL;
+    }
+    if (length) {
+        *length = (uint32_t) (terminator - name);
+    }
+    return name;
+}
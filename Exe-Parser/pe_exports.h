@@ -0,0 +1,96 @@
+//-------------------------------------------------------------------------------------------------
+// pe_exports.h
+//
+// Export directory decoder over a PE view: the function, name and name ordinal arrays are read in
+// place, lookups by name binary search the sorted name array and allocate nothing.
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "pe_view.h"
+
+
+/**
+ * @brief the export directory of an image, filled by peOpenExports()
+ * @remark The three arrays are checked to lie within the image, the names they point at are checked when
+ * read. The arrays may be at any alignment, their elements are read with peRead32() and peRead16().
+ */
+typedef struct _PE_EXPORTS {
+    PCPE_VIEW                   view;
+    IMAGE_EXPORT_DIRECTORY      directory;
+    const char                  *dllName;           // name the DLL was linked as | NULL if unreadable
+    const uint8_t               *functions;         // AddressOfFunctions, a uint32_t RVA per ordinal - Base
+    const uint8_t               *names;             // AddressOfNames, uint32_t RVAs of the names in ascending order
+    const uint8_t               *nameOrdinals;      // AddressOfNameOrdinals, the uint16_t function index of each name
+    uint32_t                    numberOfFunctions;
+    uint32_t                    numberOfNames;
+    uint32_t                    base;               // ordinal of functions[0]
+    uint32_t                    directoryRva;       // functions pointing into the directory are forwarders
+    uint32_t                    directorySize;
+
+    // raw data of the section holding the directory, where linkers put the names too; names in it
+    // are read without a section lookup
+    const uint8_t               *sectionData;       // byte at sectionRva
+    uint32_t                    sectionRva;
+    uint32_t                    sectionSize;        // bytes backed by the file
+} PE_EXPORTS, *PPE_EXPORTS;
+
+typedef const PE_EXPORTS* PCPE_EXPORTS;
+
+/**
+ * @brief one exported function
+ */
+typedef struct _PE_EXPORT {
+    const char  *name;          // NULL for a function exported by ordinal only
+    uint32_t    nameLength;
+    uint32_t    ordinal;        // Base + function index
+    uint32_t    rva;            // 0 for an unused ordinal
+    const char  *forwarder;     // "DLL.Function" or "DLL.#Ordinal" if the export is forwarded, else NULL
+} PE_EXPORT, *PPE_EXPORT;
+
+
+/**
+ * @brief Locates the export directory of an image and its arrays
+ *
+ * @param[in] view Validated image
+ * @param[out] exports Receives the directory
+ * @return true if the image has an export directory within the file
+ */
+bool peOpenExports(PCPE_VIEW view, PPE_EXPORTS exports);
+
+/**
+ * @brief Looks up an export by name, binary searching the name array: O(log n), no allocation
+ * @remark Names compare as bytes, case sensitive, as the linker sorts them
+ *
+ * @param[in] exports Export directory
+ * @param[in] name Name to look up
+ * @param[out] export Receives the export
+ * @return true if the name is exported
+ */
+bool peExportByName(PCPE_EXPORTS exports, const char *name, PPE_EXPORT export);
+
+/**
+ * @brief Looks up an export by name, trying the hint an import recorded before searching
+ *
+ * @param[in] hint Index into the name array the importer was linked against
+ * @return true if the name is exported
+ */
+bool peExportByHint(PCPE_EXPORTS exports, uint16_t hint, const char *name, PPE_EXPORT export);
+
+/**
+ * @brief Looks up an export by ordinal, O(1)
+ * @remark The name is not looked up and left NULL, it would take a scan of the name ordinals
+ *
+ * @return true if the ordinal is in the function array
+ */
+bool peExportByOrdinal(PCPE_EXPORTS exports, uint32_t ordinal, PPE_EXPORT export);
+
+/**
+ * @brief Returns the export behind the n-th name, for walking exports in name order
+ *
+ * @param[in] nameIndex 0 to numberOfNames - 1
+ * @return true if the name and its function are readable
+ */
+bool peExportByNameIndex(PCPE_EXPORTS exports, uint32_t nameIndex, PPE_EXPORT export);
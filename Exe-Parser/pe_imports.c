@@ -0,0 +1,99 @@
+/**
+ * @file pe_imports.c
+ * @brief Import directory walker over a PE view
+ * @date 2026-10-16
+ *
+ * Descriptors are walked up to the null descriptor the loader stops at, not up to the directory
+ * size, which linkers do not always fill in exactly. Every descriptor, thunk and name is read through
+ * the bounds-checked view, so a malformed table ends the walk with truncated set.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "pe_imports.h"
+#include "pe_traits.h"
+
+
+//*********************************************************************************
+// DECLARATIONS
+//*********************************************************************************
+
+// nextThunk32() and nextThunk64()
+#define PE_BITS 32
+#include "pe_imports_tmpl.h"
+#undef PE_BITS
+
+#define PE_BITS 64
+#include "pe_imports_tmpl.h"
+#undef PE_BITS
+
+
+//*********************************************************************************
+// DEFINITIONS
+//********************************************************************************
+
+void peImportDlls(PCPE_VIEW view, PPE_IMPORT_ITERATOR it) {
+
+    PCIMAGE_DATA_DIRECTORY directory = peDataDirectory(view, IMAGE_DIRECTORY_ENTRY_IMPORT);
+    it->view = view;
+    it->rva = directory && directory->Size ? directory->VirtualAddress : 0;
+    it->iatRva = 0;
+    it->count = 0;
+    it->truncated = false;
+}
+
+
+bool peNextImportDll(PPE_IMPORT_ITERATOR it, PPE_IMPORT_DLL dll) {
+
+    if (!it->rva) {
+        return false;
+    }
+    PCIMAGE_IMPORT_DESCRIPTOR descriptor = &dll->descriptor;
+    if (!peRvaCopy(it->view, it->rva, &dll->descriptor, sizeof(dll->descriptor))) {
+        it->truncated = true;
+        it->rva = 0;
+        return false;
+    }
+
+    // the loader stops at the first descriptor without name or IAT
+    if (!descriptor->Name || !descriptor->FirstThunk) {
+        it->rva = 0;
+        return false;
+    }
+    dll->name = peRvaString(it->view, descriptor->Name, &dll->nameLength);
+    if (!dll->name) {
+        it->truncated = true;
+        it->rva = 0;
+        return false;
+    }
+    dll->lookupRva = descriptor->OriginalFirstThunk ? descriptor->OriginalFirstThunk : descriptor->FirstThunk;
+    dll->iatRva = descriptor->FirstThunk;
+
+    it->rva += sizeof(*descriptor);
+    it->count++;
+    return true;
+}
+
+
+void peImportFunctions(PCPE_VIEW view, const PE_IMPORT_DLL *dll, PPE_IMPORT_ITERATOR it) {
+    it->view = view;
+    it->rva = dll->lookupRva;
+    it->iatRva = dll->iatRva;
+    it->count = 0;
+    it->truncated = false;
+}
+
+
+bool peNextImportFunction(PPE_IMPORT_ITERATOR it, PPE_IMPORT import) {
+
+    if (!it->rva || it->count >= PE_MAX_IMPORTS_PER_DLL) {
+        return false;
+    }
+    bool found = it->view->bits == 32 ? nextThunk32(it, import) : nextThunk64(it, import);
+    if (!found) {
+        it->rva = 0;
+    }
+    return found;
+}
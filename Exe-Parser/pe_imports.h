@@ -0,0 +1,97 @@
+//-------------------------------------------------------------------------------------------------
+// pe_imports.h
+//
+// Import directory walker over a PE view: import descriptors, their lookup (ILT) and address
+// (IAT) thunks and the hint/name entries they point at. Nothing is copied or allocated, names
+// point into the image.
+//
+//      PE_IMPORT_ITERATOR dlls, functions;
+//      PE_IMPORT_DLL dll;
+//      PE_IMPORT import;
+//      peImportDlls(&view, &dlls);
+//      while (peNextImportDll(&dlls, &dll)) {
+//          peImportFunctions(&view, &dll, &functions);
+//          while (peNextImportFunction(&functions, &import)) { ... }
+//      }
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "pe_view.h"
+
+// thunks walked per DLL at most, a crafted table could otherwise make every DLL walk the same huge array
+#define PE_MAX_IMPORTS_PER_DLL 0x10000
+
+
+/**
+ * @brief an imported DLL, one import descriptor
+ */
+typedef struct _PE_IMPORT_DLL {
+    IMAGE_IMPORT_DESCRIPTOR     descriptor;     // copied out of the image
+    const char                  *name;          // as written in the image, e.g. "KERNEL32.dll"
+    uint32_t                    nameLength;
+    uint32_t                    lookupRva;      // first lookup thunk: OriginalFirstThunk, or FirstThunk if there is none
+    uint32_t                    iatRva;         // first IAT slot: FirstThunk
+} PE_IMPORT_DLL, *PPE_IMPORT_DLL;
+
+/**
+ * @brief an imported function, one thunk
+ */
+typedef struct _PE_IMPORT {
+    const char  *name;          // NULL for an import by ordinal
+    uint32_t    nameLength;
+    uint16_t    hint;           // index into the DLL's export name table the linker saw, imports by name only
+    uint16_t    ordinal;        // imports by ordinal only
+    uint32_t    iatRva;         // RVA of the IAT slot the loader writes the address to
+} PE_IMPORT, *PPE_IMPORT;
+
+/**
+ * @brief position in a descriptor or thunk array
+ */
+typedef struct _PE_IMPORT_ITERATOR {
+    PCPE_VIEW   view;
+    uint32_t    rva;            // next descriptor or lookup thunk
+    uint32_t    iatRva;         // IAT slot of the next thunk
+    uint32_t    count;          // entries returned so far
+    bool        truncated;      // the walk stopped at an entry outside the file instead of at the terminator
+} PE_IMPORT_ITERATOR, *PPE_IMPORT_ITERATOR;
+
+
+/**
+ * @brief Starts a walk over the import descriptors of an image
+ * @remark An image without import directory yields no DLL
+ *
+ * @param[in] view Validated image
+ * @param[out] it Iterator to start
+ */
+void peImportDlls(PCPE_VIEW view, PPE_IMPORT_ITERATOR it);
+
+/**
+ * @brief Returns the next imported DLL
+ *
+ * @param[in,out] it Iterator started by peImportDlls()
+ * @param[out] dll Receives the DLL
+ * @return true if a DLL was returned | false at the terminating descriptor or at malformed data (it->truncated set)
+ */
+bool peNextImportDll(PPE_IMPORT_ITERATOR it, PPE_IMPORT_DLL dll);
+
+/**
+ * @brief Starts a walk over the functions imported from a DLL
+ *
+ * @param[in] view Validated image
+ * @param[in] dll DLL returned by peNextImportDll()
+ * @param[out] it Iterator to start
+ */
+void peImportFunctions(PCPE_VIEW view, const PE_IMPORT_DLL *dll, PPE_IMPORT_ITERATOR it);
+
+/**
+ * @brief Returns the next function imported from a DLL
+ * @remark Thunks are 4 or 8 bytes depending on the width of the image
+ *
+ * @param[in,out] it Iterator started by peImportFunctions()
+ * @param[out] import Receives the function
+ * @return true if a function was returned | false at the terminating thunk or at malformed data (it->truncated set)
+ */
+bool peNextImportFunction(PPE_IMPORT_ITERATOR it, PPE_IMPORT import);
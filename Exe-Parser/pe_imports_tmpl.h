@@ -0,0 +1,54 @@
+//-------------------------------------------------------------------------------------------------
+// pe_imports_tmpl.h
+//
+// Width dependent thunk decoding, included by pe_imports.c once per PE_BITS (see pe_traits.h).
+// No include guard on purpose.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef PE_BITS
+#error "define PE_BITS as 32 or 64 before including pe_imports_tmpl.h"
+#endif
+
+
+/**
+ * @brief Decodes the lookup thunk at the iterator and advances past it
+ *
+ * @return true if a function was returned | false at the terminating thunk or at malformed data
+ */
+static bool PE_FN(nextThunk)(PPE_IMPORT_ITERATOR it, PPE_IMPORT import) {
+
+    PE_THUNK value;
+    if (!peRvaCopy(it->view, it->rva, &value, sizeof(value))) {
+        it->truncated = true;
+        return false;
+    }
+    if (!value) {
+        return false;
+    }
+
+    import->name = NULL;
+    import->nameLength = 0;
+    import->hint = 0;
+    import->ordinal = 0;
+    import->iatRva = it->iatRva;
+    if (value & PE_ORDINAL_FLAG) {
+        import->ordinal = (uint16_t) (value & 0xffff);
+    }
+    else {
+        // bits 30-0 are the RVA of an IMAGE_IMPORT_BY_NAME, the others are reserved
+        uint32_t rva = (uint32_t) (value & 0x7fffffff);
+        // a name at an odd RVA still loads
+        const uint8_t *hint = peRvaPointer(it->view, rva, sizeof(uint16_t));
+        import->name = hint ? peRvaString(it->view, rva + sizeof(uint16_t), &import->nameLength) : NULL;
+        if (!import->name) {
+            it->truncated = true;
+            return false;
+        }
+        import->hint = peRead16(hint);
+    }
+
+    it->rva += sizeof(PE_THUNK);
+    it->iatRva += sizeof(PE_THUNK);
+    it->count++;
+    return true;
+}
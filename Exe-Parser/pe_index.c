@@ -0,0 +1,756 @@
+/**
+ * @file pe_index.c
+ * @brief Interned import index over many samples
+ * @date 2026-10-16
+ *
+ * Names are hashed once, when first interned; DLL and symbol keys are hashed from the ids and stored
+ * hashes of their strings, so neither an insertion nor a rehash reads a name twice. All tables are
+ * open addressed with linear probing and kept at most half full.
+ *
+ * A written index is the records and tables as they are in memory, so opening one only checks it:
+ * every id within its array, every list linked towards lower ids so that walking it ends, and every
+ * table with an empty slot so that probing it ends.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+
+#include "pe_index.h"
+#include "pe_imports.h"
+
+
+//*********************************************************************************
+// DECLARATIONS
+//*********************************************************************************
+
+#define FNV_OFFSET_BASIS    0x811C9DC5u
+#define FNV_PRIME           0x01000193u
+#define GOLDEN_RATIO        0x9E3779B1u
+
+// initial sizes, in records; the tables start at twice their record count
+#define INITIAL_POOL        (64u << 10)
+#define INITIAL_STRINGS     1024u
+#define INITIAL_DLLS        64u
+#define INITIAL_SYMBOLS     1024u
+#define INITIAL_REFS        4096u
+
+// arrays of a written index start at multiples of this
+#define INDEX_ALIGNMENT     8
+
+/**
+ * @brief the three hash tables of an index
+ */
+typedef enum _INDEX_TABLE {
+    TABLE_STRINGS,
+    TABLE_DLLS,
+    TABLE_SYMBOLS,
+} INDEX_TABLE;
+
+/**
+ * @brief FNV-1a hash of a name
+ */
+static inline uint32_t hashName(const char *name, uint32_t length);
+
+/**
+ * @brief Spreads the bits of a key built from ids (murmur3 finalizer)
+ */
+static inline uint32_t mixKey(uint32_t key);
+
+/**
+ * @brief Returns the hash of a symbol key
+ */
+static inline uint32_t symbolHash(PCPE_IMPORT_INDEX index, uint32_t dll, uint32_t name, uint16_t ordinal);
+
+/**
+ * @brief Returns the stored hash of a record, for rehashing
+ */
+static uint32_t recordHash(PCPE_IMPORT_INDEX index, INDEX_TABLE table, uint32_t id);
+
+/**
+ * @brief Grows an array of records to hold at least one more
+ *
+ * @return 0 = SUCCESS | -1 = ERROR
+ */
+static int reserveRecord(void **records, uint32_t count, uint32_t *capacity, size_t recordSize);
+
+/**
+ * @brief Doubles a hash table if one more record would make it more than half full
+ *
+ * @return 0 = SUCCESS | -1 = ERROR
+ */
+static int reserveSlot(PPE_IMPORT_INDEX index, INDEX_TABLE table, uint32_t count);
+
+/**
+ * @brief Returns the id of a string, interning it if it is new
+ *
+ * @return String id | PE_INDEX_NONE = ERROR
+ */
+static uint32_t internString(PPE_IMPORT_INDEX index, const char *string, uint32_t length, uint32_t hash);
+
+/**
+ * @brief Returns the id of a string | PE_INDEX_NONE if it was never interned
+ */
+static uint32_t findString(PCPE_IMPORT_INDEX index, const char *string, uint32_t length, uint32_t hash);
+
+/**
+ * @brief Returns the id of the DLL with an interned name, adding it if it is new
+ *
+ * @return DLL id | PE_INDEX_NONE = ERROR
+ */
+static uint32_t internDll(PPE_IMPORT_INDEX index, uint32_t name);
+
+/**
+ * @brief Returns the id of the DLL with an interned name | PE_INDEX_NONE if there is none
+ */
+static uint32_t findDll(PCPE_IMPORT_INDEX index, uint32_t name);
+
+/**
+ * @brief Returns the id of a symbol, adding it if it is new
+ *
+ * @param[in] name String id | PE_INDEX_NONE for an ordinal
+ * @return Symbol id | PE_INDEX_NONE = ERROR
+ */
+static uint32_t internSymbol(PPE_IMPORT_INDEX index, uint32_t dll, uint32_t name, uint16_t ordinal);
+
+/**
+ * @brief Returns the id of a symbol | PE_INDEX_NONE if there is none
+ */
+static uint32_t findSymbol(PCPE_IMPORT_INDEX index, uint32_t dll, uint32_t name, uint16_t ordinal);
+
+/**
+ * @brief Records that a sample imports a symbol, once per sample
+ *
+ * @return 0 = SUCCESS | -1 = ERROR
+ */
+static int addRef(PPE_IMPORT_INDEX index, uint32_t symbol, uint32_t sample);
+
+/**
+ * @brief Returns where each array of a written index starts, from the index's first byte, and its end
+ *
+ * @param[out] offsets Pool, strings, dlls, symbols, refs, stringSlots, dllSlots, symbolSlots and the end
+ */
+static void indexLayout(PCPE_INDEX_HEADER header, uint64_t offsets[9]);
+
+/**
+ * @brief Checks that a table of a written index has a power of two slots, an empty one, and only ids below count
+ */
+static bool validSlots(const uint32_t *slots, uint32_t mask, uint32_t count);
+
+/**
+ * @brief Writes bytes to a stream, and zeros up to the next multiple of INDEX_ALIGNMENT
+ *
+ * @return 0 = SUCCESS | -1 = ERROR
+ */
+static int writeAligned(FILE *stream, const void *data, uint64_t size);
+
+static inline uint64_t alignUp(uint64_t offset);
+
+/**
+ * @brief Copies a DLL name in lower case and returns its length | 0 if it is empty or too long
+ */
+static uint32_t lowerName(char *lower, const char *name, uint32_t length);
+
+
+//*********************************************************************************
+// DEFINITIONS
+//********************************************************************************
+
+int peIndexInit(PPE_IMPORT_INDEX index) {
+
+    memset(index, 0, sizeof(*index));
+    index->poolCapacity = INITIAL_POOL;
+    index->stringCapacity = INITIAL_STRINGS;
+    index->dllCapacity = INITIAL_DLLS;
+    index->symbolCapacity = INITIAL_SYMBOLS;
+    index->refCapacity = INITIAL_REFS;
+    index->stringMask = 2 * INITIAL_STRINGS - 1;
+    index->dllMask = 2 * INITIAL_DLLS - 1;
+    index->symbolMask = 2 * INITIAL_SYMBOLS - 1;
+
+    index->pool = malloc(index->poolCapacity);
+    index->strings = malloc(index->stringCapacity * sizeof(*index->strings));
+    index->dlls = malloc(index->dllCapacity * sizeof(*index->dlls));
+    index->symbols = malloc(index->symbolCapacity * sizeof(*index->symbols));
+    index->refs = malloc(index->refCapacity * sizeof(*index->refs));
+    index->stringSlots = calloc(index->stringMask + 1, sizeof(uint32_t));
+    index->dllSlots = calloc(index->dllMask + 1, sizeof(uint32_t));
+    index->symbolSlots = calloc(index->symbolMask + 1, sizeof(uint32_t));
+    if (!index->pool || !index->strings || !index->dlls || !index->symbols || !index->refs
+            || !index->stringSlots || !index->dllSlots || !index->symbolSlots) {
+        peIndexFree(index);
+        errno = ENOMEM;
+        return -1;
+    }
+    return 0;
+}
+
+
+void peIndexFree(PPE_IMPORT_INDEX index) {
+    if (index->mapped) {
+        memset(index, 0, sizeof(*index));
+        return;
+    }
+    free(index->pool);
+    free(index->strings);
+    free(index->dlls);
+    free(index->symbols);
+    free(index->refs);
+    free(index->stringSlots);
+    free(index->dllSlots);
+    free(index->symbolSlots);
+    memset(index, 0, sizeof(*index));
+}
+
+
+int peIndexAddImports(PPE_IMPORT_INDEX index, PCPE_VIEW view, uint32_t sample) {
+
+    int indexed = 0;
+    char lower[PE_MAX_NAME_LENGTH + 1];
+    PE_IMPORT_ITERATOR dlls, functions;
+    PE_IMPORT_DLL dll;
+    PE_IMPORT import;
+
+    if (index->mapped) {
+        errno = EROFS;
+        return -1;
+    }
+    peImportDlls(view, &dlls);
+    while (peNextImportDll(&dlls, &dll)) {
+
+        uint32_t length = lowerName(lower, dll.name, dll.nameLength);
+        if (!length) {
+            continue;
+        }
+        uint32_t name = internString(index, lower, length, hashName(lower, length));
+        uint32_t dllId = name == PE_INDEX_NONE ? PE_INDEX_NONE : internDll(index, name);
+        if (dllId == PE_INDEX_NONE) {
+            return -1;
+        }
+
+        peImportFunctions(view, &dll, &functions);
+        while (peNextImportFunction(&functions, &import)) {
+            uint32_t function = PE_INDEX_NONE;
+            if (import.name) {
+                function = internString(index, import.name, import.nameLength, hashName(import.name, import.nameLength));
+                if (function == PE_INDEX_NONE) {
+                    return -1;
+                }
+            }
+            uint32_t symbol = internSymbol(index, dllId, function, import.ordinal);
+            if (symbol == PE_INDEX_NONE || addRef(index, symbol, sample)) {
+                return -1;
+            }
+            indexed++;
+        }
+    }
+    return indexed;
+}
+
+
+int peIndexAppend(PPE_IMPORT_INDEX index, PCPE_IMPORT_INDEX other, uint32_t sampleBase) {
+
+    if (index->mapped) {
+        errno = EROFS;
+        return -1;
+    }
+
+    // names are interned again with their stored hashes, samples of other are new to index, so every
+    // ref is added as it is
+    for (uint32_t idx = 0; idx < other->symbolCount; idx++) {
+        const PE_INDEX_SYMBOL *from = &other->symbols[idx];
+        const PE_INDEX_STRING *dllName = &other->strings[other->dlls[from->dll].name];
+        uint32_t name = internString(index, other->pool + dllName->offset, dllName->length, dllName->hash);
+        uint32_t dll = name == PE_INDEX_NONE ? PE_INDEX_NONE : internDll(index, name);
+        if (dll == PE_INDEX_NONE) {
+            return -1;
+        }
+        uint32_t function = PE_INDEX_NONE;
+        if (from->name != PE_INDEX_NONE) {
+            const PE_INDEX_STRING *functionName = &other->strings[from->name];
+            function = internString(index, other->pool + functionName->offset, functionName->length, functionName->hash);
+            if (function == PE_INDEX_NONE) {
+                return -1;
+            }
+        }
+        uint32_t symbol = internSymbol(index, dll, function, from->ordinal);
+        if (symbol == PE_INDEX_NONE) {
+            return -1;
+        }
+        for (uint32_t ref = from->firstRef; ref != PE_INDEX_NONE; ref = other->refs[ref].next) {
+            if (addRef(index, symbol, other->refs[ref].sample + sampleBase) != 0) {
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+
+uint64_t peIndexSize(PCPE_IMPORT_INDEX index) {
+    PE_INDEX_HEADER header = {
+        .poolLength = index->poolLength,
+        .stringCount = index->stringCount, .dllCount = index->dllCount,
+        .symbolCount = index->symbolCount, .refCount = index->refCount,
+        .stringMask = index->stringMask, .dllMask = index->dllMask, .symbolMask = index->symbolMask,
+    };
+    uint64_t offsets[9];
+    indexLayout(&header, offsets);
+    return offsets[8];
+}
+
+
+int peIndexWrite(PCPE_IMPORT_INDEX index, FILE *stream) {
+
+    PE_INDEX_HEADER header = {
+        .poolLength = index->poolLength,
+        .stringCount = index->stringCount, .dllCount = index->dllCount,
+        .symbolCount = index->symbolCount, .refCount = index->refCount,
+        .stringMask = index->stringMask, .dllMask = index->dllMask, .symbolMask = index->symbolMask,
+    };
+    if (writeAligned(stream, &header, sizeof(header)) != 0
+            || writeAligned(stream, index->pool, index->poolLength) != 0
+            || writeAligned(stream, index->strings, (uint64_t) index->stringCount * sizeof(*index->strings)) != 0
+            || writeAligned(stream, index->dlls, (uint64_t) index->dllCount * sizeof(*index->dlls)) != 0
+            || writeAligned(stream, index->symbols, (uint64_t) index->symbolCount * sizeof(*index->symbols)) != 0
+            || writeAligned(stream, index->refs, (uint64_t) index->refCount * sizeof(*index->refs)) != 0
+            || writeAligned(stream, index->stringSlots, ((uint64_t) index->stringMask + 1) * sizeof(uint32_t)) != 0
+            || writeAligned(stream, index->dllSlots, ((uint64_t) index->dllMask + 1) * sizeof(uint32_t)) != 0
+            || writeAligned(stream, index->symbolSlots, ((uint64_t) index->symbolMask + 1) * sizeof(uint32_t)) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+
+bool peOpenIndex(const uint8_t *base, uint64_t size, uint32_t samples, PPE_IMPORT_INDEX index) {
+
+    memset(index, 0, sizeof(*index));
+    PCPE_INDEX_HEADER header = (PCPE_INDEX_HEADER) base;
+    if (size < sizeof(*header) || (uintptr_t) base % INDEX_ALIGNMENT || header->poolLength > UINT32_MAX) {
+        return false;
+    }
+    uint64_t offsets[9];
+    indexLayout(header, offsets);
+    if (offsets[8] > size) {
+        return false;
+    }
+
+    const char *pool = (const char *) base + offsets[0];
+    const PE_INDEX_STRING *strings = (const PE_INDEX_STRING *) (base + offsets[1]);
+    const PE_INDEX_DLL *dlls = (const PE_INDEX_DLL *) (base + offsets[2]);
+    const PE_INDEX_SYMBOL *symbols = (const PE_INDEX_SYMBOL *) (base + offsets[3]);
+    const PE_INDEX_REF *refs = (const PE_INDEX_REF *) (base + offsets[4]);
+    const uint32_t *stringSlots = (const uint32_t *) (base + offsets[5]);
+    const uint32_t *dllSlots = (const uint32_t *) (base + offsets[6]);
+    const uint32_t *symbolSlots = (const uint32_t *) (base + offsets[7]);
+
+    for (uint32_t idx = 0; idx < header->stringCount; idx++) {
+        if (strings[idx].offset >= header->poolLength || strings[idx].length >= header->poolLength - strings[idx].offset
+                || pool[strings[idx].offset + strings[idx].length]) {
+            return false;
+        }
+    }
+    for (uint32_t idx = 0; idx < header->dllCount; idx++) {
+        if (dlls[idx].name >= header->stringCount
+                || (dlls[idx].firstSymbol != PE_INDEX_NONE && dlls[idx].firstSymbol >= header->symbolCount)) {
+            return false;
+        }
+    }
+    for (uint32_t idx = 0; idx < header->symbolCount; idx++) {
+        const PE_INDEX_SYMBOL *symbol = &symbols[idx];
+        if (symbol->dll >= header->dllCount || (symbol->name != PE_INDEX_NONE && symbol->name >= header->stringCount)
+                || (symbol->nextInDll != PE_INDEX_NONE && symbol->nextInDll >= idx)
+                || (symbol->firstRef != PE_INDEX_NONE && symbol->firstRef >= header->refCount)) {
+            return false;
+        }
+    }
+    for (uint32_t idx = 0; idx < header->refCount; idx++) {
+        if (refs[idx].sample >= samples || (refs[idx].next != PE_INDEX_NONE && refs[idx].next >= idx)) {
+            return false;
+        }
+    }
+    if (!validSlots(stringSlots, header->stringMask, header->stringCount) || !validSlots(dllSlots, header->dllMask, header->dllCount)
+            || !validSlots(symbolSlots, header->symbolMask, header->symbolCount)) {
+        return false;
+    }
+
+    // the index is only read, its capacities stay 0
+    index->pool = (char *) pool;
+    index->poolLength = header->poolLength;
+    index->strings = (PE_INDEX_STRING *) strings;
+    index->stringCount = header->stringCount;
+    index->dlls = (PE_INDEX_DLL *) dlls;
+    index->dllCount = header->dllCount;
+    index->symbols = (PE_INDEX_SYMBOL *) symbols;
+    index->symbolCount = header->symbolCount;
+    index->refs = (PE_INDEX_REF *) refs;
+    index->refCount = header->refCount;
+    index->stringSlots = (uint32_t *) stringSlots;
+    index->dllSlots = (uint32_t *) dllSlots;
+    index->symbolSlots = (uint32_t *) symbolSlots;
+    index->stringMask = header->stringMask;
+    index->dllMask = header->dllMask;
+    index->symbolMask = header->symbolMask;
+    index->mapped = true;
+    return true;
+}
+
+
+uint32_t peIndexFindDll(PCPE_IMPORT_INDEX index, const char *dll) {
+
+    char lower[PE_MAX_NAME_LENGTH + 1];
+    size_t length = strlen(dll);
+    if (length > PE_MAX_NAME_LENGTH || !lowerName(lower, dll, (uint32_t) length)) {
+        return PE_INDEX_NONE;
+    }
+    uint32_t name = findString(index, lower, (uint32_t) length, hashName(lower, (uint32_t) length));
+    return name == PE_INDEX_NONE ? PE_INDEX_NONE : findDll(index, name);
+}
+
+
+uint32_t peIndexFindSymbol(PCPE_IMPORT_INDEX index, uint32_t dll, const char *function) {
+
+    size_t length = strlen(function);
+    if (dll >= index->dllCount || length > PE_MAX_NAME_LENGTH) {
+        return PE_INDEX_NONE;
+    }
+    uint32_t name = findString(index, function, (uint32_t) length, hashName(function, (uint32_t) length));
+    return name == PE_INDEX_NONE ? PE_INDEX_NONE : findSymbol(index, dll, name, 0);
+}
+
+
+uint32_t peIndexFindOrdinal(PCPE_IMPORT_INDEX index, uint32_t dll, uint16_t ordinal) {
+    if (dll >= index->dllCount) {
+        return PE_INDEX_NONE;
+    }
+    return findSymbol(index, dll, PE_INDEX_NONE, ordinal);
+}
+
+
+void peIndexMatch(PCPE_IMPORT_INDEX index, PCPE_IMPORT_QUERY query, uint8_t *hits, uint8_t matched) {
+
+    uint32_t dll = peIndexFindDll(index, query->dll);
+    if (dll == PE_INDEX_NONE) {
+        return;
+    }
+
+    // one symbol for a function, else every symbol of the DLL; a sample is raised once per query, as
+    // only the samples still at matched are
+    bool single = query->function || query->byOrdinal;
+    uint32_t symbol = query->function ? peIndexFindSymbol(index, dll, query->function)
+        : query->byOrdinal ? peIndexFindOrdinal(index, dll, query->ordinal) : index->dlls[dll].firstSymbol;
+    for (; symbol != PE_INDEX_NONE; symbol = single ? PE_INDEX_NONE : index->symbols[symbol].nextInDll) {
+        for (uint32_t ref = index->symbols[symbol].firstRef; ref != PE_INDEX_NONE; ref = index->refs[ref].next) {
+            uint32_t sample = index->refs[ref].sample;
+            if (hits[sample] == matched) {
+                hits[sample]++;
+            }
+        }
+    }
+}
+
+
+static inline uint32_t hashName(const char *name, uint32_t length) {
+    uint32_t hash = FNV_OFFSET_BASIS;
+    for (uint32_t idx = 0; idx < length; idx++) {
+        hash = (hash ^ (uint8_t) name[idx]) * FNV_PRIME;
+    }
+    return hash;
+}
+
+
+static inline uint32_t mixKey(uint32_t key) {
+    key ^= key >> 16;
+    key *= 0x85EBCA6Bu;
+    key ^= key >> 13;
+    key *= 0xC2B2AE35u;
+    key ^= key >> 16;
+    return key;
+}
+
+
+static inline uint32_t symbolHash(PCPE_IMPORT_INDEX index, uint32_t dll, uint32_t name, uint16_t ordinal) {
+    // ordinals are kept apart from name hashes by bit 16
+    uint32_t key = name != PE_INDEX_NONE ? index->strings[name].hash : (0x10000u | ordinal);
+    return mixKey(key ^ (dll * GOLDEN_RATIO));
+}
+
+
+static uint32_t recordHash(PCPE_IMPORT_INDEX index, INDEX_TABLE table, uint32_t id) {
+    switch (table) {
+        case TABLE_STRINGS:
+            return index->strings[id].hash;
+        case TABLE_DLLS:
+            return index->strings[index->dlls[id].name].hash;
+        default:
+            return index->symbols[id].hash;
+    }
+}
+
+
+static int reserveRecord(void **records, uint32_t count, uint32_t *capacity, size_t recordSize) {
+
+    if (count < *capacity) {
+        return 0;
+    }
+    if (*capacity > UINT32_MAX / 2) {
+        errno = ENOMEM;
+        return -1;
+    }
+    void *grown = realloc(*records, (size_t) *capacity * 2 * recordSize);
+    if (!grown) {
+        return -1;
+    }
+    *records = grown;
+    *capacity *= 2;
+    return 0;
+}
+
+
+static int reserveSlot(PPE_IMPORT_INDEX index, INDEX_TABLE table, uint32_t count) {
+
+    uint32_t **slots = table == TABLE_STRINGS ? &index->stringSlots : table == TABLE_DLLS ? &index->dllSlots : &index->symbolSlots;
+    uint32_t *mask = table == TABLE_STRINGS ? &index->stringMask : table == TABLE_DLLS ? &index->dllMask : &index->symbolMask;
+    if (count + 1 <= (*mask + 1) / 2) {
+        return 0;
+    }
+    if (*mask > UINT32_MAX / 4) {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    uint32_t newMask = *mask * 2 + 1;
+    uint32_t *grown = calloc((size_t) newMask + 1, sizeof(uint32_t));
+    if (!grown) {
+        return -1;
+    }
+    for (uint32_t id = 0; id < count; id++) {
+        uint32_t slot = recordHash(index, table, id) & newMask;
+        while (grown[slot]) {
+            slot = (slot + 1) & newMask;
+        }
+        grown[slot] = id + 1;
+    }
+    free(*slots);
+    *slots = grown;
+    *mask = newMask;
+    return 0;
+}
+
+
+static uint32_t internString(PPE_IMPORT_INDEX index, const char *string, uint32_t length, uint32_t hash) {
+
+    uint32_t id = findString(index, string, length, hash);
+    if (id != PE_INDEX_NONE) {
+        return id;
+    }
+    if (reserveRecord((void **) &index->strings, index->stringCount, &index->stringCapacity, sizeof(*index->strings))
+            || reserveSlot(index, TABLE_STRINGS, index->stringCount)) {
+        return PE_INDEX_NONE;
+    }
+    while (index->poolCapacity - index->poolLength < (size_t) length + 1) {
+        char *grown = realloc(index->pool, index->poolCapacity * 2);
+        if (!grown) {
+            return PE_INDEX_NONE;
+        }
+        index->pool = grown;
+        index->poolCapacity *= 2;
+    }
+    if (index->poolLength > UINT32_MAX - length - 1) {
+        errno = ENOMEM;
+        return PE_INDEX_NONE;
+    }
+
+    id = index->stringCount++;
+    index->strings[id] = (PE_INDEX_STRING) { .offset = (uint32_t) index->poolLength, .length = length, .hash = hash };
+    memcpy(index->pool + index->poolLength, string, length);
+    index->pool[index->poolLength + length] = '\0';
+    index->poolLength += length + 1;
+
+    uint32_t slot = hash & index->stringMask;
+    while (index->stringSlots[slot]) {
+        slot = (slot + 1) & index->stringMask;
+    }
+    index->stringSlots[slot] = id + 1;
+    return id;
+}
+
+
+static uint32_t findString(PCPE_IMPORT_INDEX index, const char *string, uint32_t length, uint32_t hash) {
+    for (uint32_t slot = hash & index->stringMask; index->stringSlots[slot]; slot = (slot + 1) & index->stringMask) {
+        const PE_INDEX_STRING *entry = &index->strings[index->stringSlots[slot] - 1];
+        if (entry->hash == hash && entry->length == length && !memcmp(index->pool + entry->offset, string, length)) {
+            return index->stringSlots[slot] - 1;
+        }
+    }
+    return PE_INDEX_NONE;
+}
+
+
+static uint32_t internDll(PPE_IMPORT_INDEX index, uint32_t name) {
+
+    uint32_t id = findDll(index, name);
+    if (id != PE_INDEX_NONE) {
+        return id;
+    }
+    if (reserveRecord((void **) &index->dlls, index->dllCount, &index->dllCapacity, sizeof(*index->dlls))
+            || reserveSlot(index, TABLE_DLLS, index->dllCount)) {
+        return PE_INDEX_NONE;
+    }
+
+    id = index->dllCount++;
+    index->dlls[id] = (PE_INDEX_DLL) { .name = name, .firstSymbol = PE_INDEX_NONE };
+    uint32_t slot = index->strings[name].hash & index->dllMask;
+    while (index->dllSlots[slot]) {
+        slot = (slot + 1) & index->dllMask;
+    }
+    index->dllSlots[slot] = id + 1;
+    return id;
+}
+
+
+static uint32_t findDll(PCPE_IMPORT_INDEX index, uint32_t name) {
+    uint32_t hash = index->strings[name].hash;
+    for (uint32_t slot = hash & index->dllMask; index->dllSlots[slot]; slot = (slot + 1) & index->dllMask) {
+        if (index->dlls[index->dllSlots[slot] - 1].name == name) {
+            return index->dllSlots[slot] - 1;
+        }
+    }
+    return PE_INDEX_NONE;
+}
+
+
+static uint32_t internSymbol(PPE_IMPORT_INDEX index, uint32_t dll, uint32_t name, uint16_t ordinal) {
+
+    uint32_t id = findSymbol(index, dll, name, ordinal);
+    if (id != PE_INDEX_NONE) {
+        return id;
+    }
+    if (reserveRecord((void **) &index->symbols, index->symbolCount, &index->symbolCapacity, sizeof(*index->symbols))
+            || reserveSlot(index, TABLE_SYMBOLS, index->symbolCount)) {
+        return PE_INDEX_NONE;
+    }
+
+    id = index->symbolCount++;
+    PE_INDEX_SYMBOL *symbol = &index->symbols[id];
+    *symbol = (PE_INDEX_SYMBOL) {
+        .dll = dll,
+        .name = name,
+        .hash = symbolHash(index, dll, name, ordinal),
+        .nextInDll = index->dlls[dll].firstSymbol,
+        .firstRef = PE_INDEX_NONE,
+        .lastSample = PE_INDEX_NONE,
+        .ordinal = name == PE_INDEX_NONE ? ordinal : 0,
+    };
+    index->dlls[dll].firstSymbol = id;
+    index->dlls[dll].symbolCount++;
+
+    uint32_t slot = symbol->hash & index->symbolMask;
+    while (index->symbolSlots[slot]) {
+        slot = (slot + 1) & index->symbolMask;
+    }
+    index->symbolSlots[slot] = id + 1;
+    return id;
+}
+
+
+static uint32_t findSymbol(PCPE_IMPORT_INDEX index, uint32_t dll, uint32_t name, uint16_t ordinal) {
+    uint32_t hash = symbolHash(index, dll, name, ordinal);
+    if (name != PE_INDEX_NONE) {
+        ordinal = 0;
+    }
+    for (uint32_t slot = hash & index->symbolMask; index->symbolSlots[slot]; slot = (slot + 1) & index->symbolMask) {
+        const PE_INDEX_SYMBOL *symbol = &index->symbols[index->symbolSlots[slot] - 1];
+        if (symbol->hash == hash && symbol->dll == dll && symbol->name == name && symbol->ordinal == ordinal) {
+            return index->symbolSlots[slot] - 1;
+        }
+    }
+    return PE_INDEX_NONE;
+}
+
+
+static int addRef(PPE_IMPORT_INDEX index, uint32_t symbol, uint32_t sample) {
+
+    PE_INDEX_SYMBOL *entry = &index->symbols[symbol];
+    if (entry->firstRef != PE_INDEX_NONE && entry->lastSample == sample) {
+        return 0;
+    }
+    if (reserveRecord((void **) &index->refs, index->refCount, &index->refCapacity, sizeof(*index->refs))) {
+        return -1;
+    }
+    uint32_t ref = index->refCount++;
+    index->refs[ref] = (PE_INDEX_REF) { .sample = sample, .next = entry->firstRef };
+    entry->firstRef = ref;
+    entry->lastSample = sample;
+    entry->refCount++;
+    return 0;
+}
+
+
+static void indexLayout(PCPE_INDEX_HEADER header, uint64_t offsets[9]) {
+    uint64_t sizes[8] = {
+        header->poolLength,
+        (uint64_t) header->stringCount * sizeof(PE_INDEX_STRING),
+        (uint64_t) header->dllCount * sizeof(PE_INDEX_DLL),
+        (uint64_t) header->symbolCount * sizeof(PE_INDEX_SYMBOL),
+        (uint64_t) header->refCount * sizeof(PE_INDEX_REF),
+        ((uint64_t) header->stringMask + 1) * sizeof(uint32_t),
+        ((uint64_t) header->dllMask + 1) * sizeof(uint32_t),
+        ((uint64_t) header->symbolMask + 1) * sizeof(uint32_t),
+    };
+    offsets[0] = alignUp(sizeof(*header));
+    for (unsigned idx = 0; idx < 8; idx++) {
+        offsets[idx + 1] = alignUp(offsets[idx] + sizes[idx]);
+    }
+}
+
+
+static bool validSlots(const uint32_t *slots, uint32_t mask, uint32_t count) {
+    if (mask & ((uint64_t) mask + 1)) {
+        return false;
+    }
+    bool empty = false;
+    for (uint64_t slot = 0; slot <= mask; slot++) {
+        if (slots[slot] > count) {
+            return false;
+        }
+        empty |= !slots[slot];
+    }
+    return empty;
+}
+
+
+static int writeAligned(FILE *stream, const void *data, uint64_t size) {
+
+    static const uint8_t ZEROS[INDEX_ALIGNMENT] = { 0 };
+    if (size && fwrite(data, (size_t) size, 1, stream) != 1) {
+        return -1;
+    }
+    size_t padding = (size_t) (alignUp(size) - size);
+    if (padding && fwrite(ZEROS, padding, 1, stream) != 1) {
+        return -1;
+    }
+    return 0;
+}
+
+
+static inline uint64_t alignUp(uint64_t offset) {
+    return (offset + INDEX_ALIGNMENT - 1) & ~(uint64_t) (INDEX_ALIGNMENT - 1);
+}
+
+
+static uint32_t lowerName(char *lower, const char *name, uint32_t length) {
+    if (!length || length > PE_MAX_NAME_LENGTH) {
+        return 0;
+    }
+    for (uint32_t idx = 0; idx < length; idx++) {
+        char c = name[idx];
+        lower[idx] = (c >= 'A' && c <= 'Z') ? (char) (c - 'A' + 'a') : c;
+    }
+    lower[length] = '\0';
+    return length;
+}
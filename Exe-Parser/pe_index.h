@@ -0,0 +1,229 @@
+//-------------------------------------------------------------------------------------------------
+// pe_index.h
+//
+// Interned import index over many samples: every DLL and function name is stored once in a string
+// pool with its hash computed once, every (DLL, function) pair once as a symbol, and each symbol
+// keeps the list of samples importing it. "Which samples import X" is two hash lookups and a list
+// walk instead of re-parsing the corpus.
+//
+// The records are plain arrays linked by index, to be walked directly:
+//
+//      DLL to functions    for (s = dlls[d].firstSymbol; s != PE_INDEX_NONE; s = symbols[s].nextInDll)
+//      symbol to samples   for (r = symbols[s].firstRef; r != PE_INDEX_NONE; r = refs[r].next) refs[r].sample
+//
+// An index is not thread safe; build one per thread, merge them with peIndexAppend() and query it
+// once built. A written index is opened in place, its records are queried where they were mapped:
+//
+//      PE_INDEX_HEADER
+//      pool, strings, dlls, symbols, refs      each 8-byte aligned
+//      stringSlots, dllSlots, symbolSlots      mask + 1 slots each, 8-byte aligned
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "pe_view.h"
+
+// no such record, also the end of a list
+#define PE_INDEX_NONE UINT32_MAX
+
+
+/**
+ * @brief an interned string, NUL terminated in the pool
+ */
+typedef struct _PE_INDEX_STRING {
+    uint32_t    offset;         // in the pool
+    uint32_t    length;
+    uint32_t    hash;
+} PE_INDEX_STRING;
+
+/**
+ * @brief an imported DLL, named in lower case since the loader ignores case
+ */
+typedef struct _PE_INDEX_DLL {
+    uint32_t    name;           // string id
+    uint32_t    firstSymbol;    // symbols imported from this DLL, linked by nextInDll
+    uint32_t    symbolCount;
+} PE_INDEX_DLL;
+
+/**
+ * @brief a function of a DLL, imported by name or by ordinal
+ */
+typedef struct _PE_INDEX_SYMBOL {
+    uint32_t    dll;            // DLL id
+    uint32_t    name;           // string id | PE_INDEX_NONE for an import by ordinal
+    uint32_t    hash;           // of (dll, name or ordinal), from the precomputed string hashes
+    uint32_t    nextInDll;
+    uint32_t    firstRef;       // samples importing this symbol, most recent first, linked by next
+    uint32_t    refCount;
+    uint32_t    lastSample;     // sample of firstRef, to skip a function a sample imports twice
+    uint16_t    ordinal;        // imports by ordinal only
+    uint16_t    reserved;       // 0, so a written symbol has no padding of undefined bytes
+} PE_INDEX_SYMBOL;
+
+/**
+ * @brief one sample importing one symbol
+ */
+typedef struct _PE_INDEX_REF {
+    uint32_t    sample;
+    uint32_t    next;
+} PE_INDEX_REF;
+
+/**
+ * @brief the index, initialize with peIndexInit() and release with peIndexFree()
+ * @remark An index opened with peOpenIndex() points into the memory it was opened from, it is read only
+ */
+typedef struct _PE_IMPORT_INDEX {
+    char            *pool;
+    size_t          poolLength, poolCapacity;
+    PE_INDEX_STRING *strings;
+    uint32_t        stringCount, stringCapacity;
+    PE_INDEX_DLL    *dlls;
+    uint32_t        dllCount, dllCapacity;
+    PE_INDEX_SYMBOL *symbols;
+    uint32_t        symbolCount, symbolCapacity;
+    PE_INDEX_REF    *refs;
+    uint32_t        refCount, refCapacity;
+
+    // open addressed hash tables holding record id + 1, 0 = empty slot
+    uint32_t        *stringSlots, *dllSlots, *symbolSlots;
+    uint32_t        stringMask, dllMask, symbolMask;
+    bool            mapped;         // opened by peOpenIndex(), nothing to add to or free
+} PE_IMPORT_INDEX, *PPE_IMPORT_INDEX;
+
+typedef const PE_IMPORT_INDEX* PCPE_IMPORT_INDEX;
+
+/**
+ * @brief first bytes of a written index, the record counts and table sizes
+ */
+typedef struct _PE_INDEX_HEADER {
+    uint64_t    poolLength;
+    uint32_t    stringCount;
+    uint32_t    dllCount;
+    uint32_t    symbolCount;
+    uint32_t    refCount;
+    uint32_t    stringMask;
+    uint32_t    dllMask;
+    uint32_t    symbolMask;
+    uint32_t    reserved;
+} PE_INDEX_HEADER, *PPE_INDEX_HEADER;
+
+typedef const PE_INDEX_HEADER* PCPE_INDEX_HEADER;
+
+/**
+ * @brief an import to look for: a function by name or ordinal, or any function of a DLL
+ */
+typedef struct _PE_IMPORT_QUERY {
+    const char  *dll;           // ignoring case
+    const char  *function;      // NULL for an ordinal or any function of the DLL
+    uint16_t    ordinal;
+    bool        byOrdinal;
+} PE_IMPORT_QUERY, *PPE_IMPORT_QUERY;
+
+typedef const PE_IMPORT_QUERY* PCPE_IMPORT_QUERY;
+
+
+/**
+ * @brief Initializes an empty index
+ *
+ * @return 0 = SUCCESS | -1 = ERROR (out of memory)
+ */
+int peIndexInit(PPE_IMPORT_INDEX index);
+
+/**
+ * @brief Releases everything an index holds
+ */
+void peIndexFree(PPE_IMPORT_INDEX index);
+
+/**
+ * @brief Adds the imports of one sample to an index
+ * @remark Samples are added one after the other, a sample id used again later is recorded again.
+ * A malformed import table is indexed up to where it stops being readable.
+ *
+ * @param[in,out] index Index to add to
+ * @param[in] view Validated image of the sample
+ * @param[in] sample Caller's id of the sample, e.g. its position in a file list
+ * @return Number of functions indexed | -1 = ERROR (out of memory, the index holds the functions added before)
+ */
+int peIndexAddImports(PPE_IMPORT_INDEX index, PCPE_VIEW view, uint32_t sample);
+
+/**
+ * @brief Adds every sample of another index, their ids raised by a base
+ * @remark The indexes of parts of a corpus merge into the index of the corpus, e.g. with the row of a
+ * sample in the merged columns as its id
+ *
+ * @param[in,out] index Index to add to
+ * @param[in] other Index to add, its samples are not in index yet
+ * @param[in] sampleBase Added to every sample id of other
+ * @return 0 = SUCCESS | -1 = ERROR (out of memory, the index holds the symbols added before)
+ */
+int peIndexAppend(PPE_IMPORT_INDEX index, PCPE_IMPORT_INDEX other, uint32_t sampleBase);
+
+/**
+ * @brief Returns the bytes peIndexWrite() writes
+ */
+uint64_t peIndexSize(PCPE_IMPORT_INDEX index);
+
+/**
+ * @brief Writes an index in the layout above, to be opened in place
+ *
+ * @param[in] stream Stream opened in binary mode, at a multiple of 8 bytes
+ * @return 0 = SUCCESS | -1 = ERROR (errno set)
+ */
+int peIndexWrite(PCPE_IMPORT_INDEX index, FILE *stream);
+
+/**
+ * @brief Validates a written index in memory and points an index into it
+ * @remark Every id, list and table is checked, so no lookup or walk of the opened index leaves it
+ * or loops. Nothing is copied, the index is valid while the memory is.
+ *
+ * @param[in] base First byte of the index, 8-byte aligned
+ * @param[in] size Number of bytes readable at base
+ * @param[in] samples Every sample id is below it, e.g. the files of the columns holding the index
+ * @param[out] index Receives the read only index
+ * @return true if base holds a whole, consistent index
+ */
+bool peOpenIndex(const uint8_t *base, uint64_t size, uint32_t samples, PPE_IMPORT_INDEX index);
+
+/**
+ * @brief Looks up a DLL by name, ignoring case
+ *
+ * @return DLL id | PE_INDEX_NONE if no sample imports it
+ */
+uint32_t peIndexFindDll(PCPE_IMPORT_INDEX index, const char *dll);
+
+/**
+ * @brief Looks up a function imported by name from a DLL
+ *
+ * @param[in] dll DLL id from peIndexFindDll()
+ * @return Symbol id | PE_INDEX_NONE if no sample imports it
+ */
+uint32_t peIndexFindSymbol(PCPE_IMPORT_INDEX index, uint32_t dll, const char *function);
+
+/**
+ * @brief Looks up a function imported by ordinal from a DLL
+ *
+ * @param[in] dll DLL id from peIndexFindDll()
+ * @return Symbol id | PE_INDEX_NONE if no sample imports it
+ */
+uint32_t peIndexFindOrdinal(PCPE_IMPORT_INDEX index, uint32_t dll, uint16_t ordinal);
+
+/**
+ * @brief Counts a query for the samples that matched all queries before it
+ * @remark Run the queries in order with matched 0, 1, ...; the samples importing all of them end at the query count
+ *
+ * @param[in,out] hits Queries matched per sample, raised from matched to matched + 1 for the samples importing the query
+ */
+void peIndexMatch(PCPE_IMPORT_INDEX index, PCPE_IMPORT_QUERY query, uint8_t *hits, uint8_t matched);
+
+/**
+ * @brief Returns an interned string
+ *
+ * @param[in] string String id
+ */
+static inline const char *peIndexString(PCPE_IMPORT_INDEX index, uint32_t string) {
+    return index->pool + index->strings[string].offset;
+}
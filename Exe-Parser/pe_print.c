@@ -0,0 +1,475 @@
+/**
+ * @file pe_print.c
+ * @brief Prints the headers of a validated PE view as a Python readable list of tuples
+ * @date 2026-10-16
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "pe_print.h"
+#include "pe_traits.h"
+#include "pe_imports.h"
+#include "pe_exports.h"
+#include "pe_relocs.h"
+#include "pe_config.h"
+#include "pe_resources.h"
+#include "pe_version.h"
+
+
+//*********************************************************************************
+// DECLARATIONS
+//*********************************************************************************
+
+// ordinals are 16 bits, a longer export function array is not printed past them
+#define MAX_EXPORTED_FUNCTIONS 0x10000
+
+// UTF-8 bytes printed of a resource name or version string
+#define MAX_PRINTED_STRING 1024
+
+// names of the predefined resource types, indexed by RT_* id
+static const char *const RESOURCE_TYPES[] = {
+    [RT_CURSOR] = "RT_CURSOR", [RT_BITMAP] = "RT_BITMAP", [RT_ICON] = "RT_ICON", [RT_MENU] = "RT_MENU",
+    [RT_DIALOG] = "RT_DIALOG", [RT_STRING] = "RT_STRING", [RT_FONTDIR] = "RT_FONTDIR", [RT_FONT] = "RT_FONT",
+    [RT_ACCELERATOR] = "RT_ACCELERATOR", [RT_RCDATA] = "RT_RCDATA", [RT_MESSAGETABLE] = "RT_MESSAGETABLE",
+    [RT_GROUP_CURSOR] = "RT_GROUP_CURSOR", [RT_GROUP_ICON] = "RT_GROUP_ICON", [RT_VERSION] = "RT_VERSION",
+    [RT_DLGINCLUDE] = "RT_DLGINCLUDE", [RT_PLUGPLAY] = "RT_PLUGPLAY", [RT_VXD] = "RT_VXD",
+    [RT_ANICURSOR] = "RT_ANICURSOR", [RT_ANIICON] = "RT_ANIICON", [RT_HTML] = "RT_HTML", [RT_MANIFEST] = "RT_MANIFEST",
+};
+
+/**
+ * @brief Print the DOS header and its relevant fields as python tuples
+ * 
+ * @param stream
+ * @param view
+ */
+static void printDOSHeader(FILE *stream, PCPE_VIEW view);
+
+/**
+ * @brief Print the File header and its relevant fields as python tuples
+ * 
+ * @param stream
+ * @param view
+ */
+static void printFileHeader(FILE *stream, PCPE_VIEW view);
+
+/**
+ * @brief Print the Section headers and their relevant fields as python tuples
+ * 
+ * @param stream
+ * @param view
+ */
+static void printSectionHeaders(FILE *stream, PCPE_VIEW view);
+
+/**
+ * @brief Print the imported DLLs and their functions as python tuples, (name, hint, IAT RVA) or (None, ordinal, IAT RVA)
+ * 
+ * @param stream
+ * @param view
+ */
+static void printImports(FILE *stream, PCPE_VIEW view);
+
+/**
+ * @brief Print the exported functions as python tuples (ordinal, RVA, name, forwarder), named ones in name order first
+ * 
+ * @param stream
+ * @param view
+ */
+static void printExports(FILE *stream, PCPE_VIEW view);
+
+/**
+ * @brief Print the base relocation blocks as python tuples (page RVA, relocations), padding entries not counted
+ * 
+ * @param stream
+ * @param view
+ */
+static void printRelocs(FILE *stream, PCPE_VIEW view);
+
+/**
+ * @brief Print the TLS directory and its callback VAs as python tuples
+ * 
+ * @param stream
+ * @param view
+ */
+static void printTls(FILE *stream, PCPE_VIEW view);
+
+/**
+ * @brief Print the security cookie and Control Flow Guard fields of the load config directory as python tuples
+ * 
+ * @param stream
+ * @param view
+ */
+static void printLoadConfig(FILE *stream, PCPE_VIEW view);
+
+/**
+ * @brief Print the resource types as python tuples (type, entries), reading only the first two levels of the tree
+ * 
+ * @param stream
+ * @param view
+ */
+static void printResources(FILE *stream, PCPE_VIEW view);
+
+/**
+ * @brief Print the fixed file info and the string table of the version resource as python tuples
+ * 
+ * @param stream
+ * @param view
+ */
+static void printVersionInfo(FILE *stream, PCPE_VIEW view);
+
+/**
+ * @brief Print UTF-16 text of the image as a quoted python string
+ */
+static void printUtf16(FILE *stream, const uint16_t *text, uint32_t length);
+
+/**
+ * @brief Print a NUL terminated name of the image as a quoted python string, or None for NULL
+ *
+ * @param quoted false to print it as the text of a comment, with only the control characters escaped
+ */
+static void printString(FILE *stream, const char *text, bool quoted);
+
+// printNTHeaders32/64(), printOptionalHeader32/64() and printDataDirectories32/64()
+#define PE_BITS 32
+#include "pe_print_tmpl.h"
+#undef PE_BITS
+
+#define PE_BITS 64
+#include "pe_print_tmpl.h"
+#undef PE_BITS
+
+
+//*********************************************************************************
+// DEFINITIONS
+//********************************************************************************
+
+void printPrologue(FILE *stream, const char *fileName, uint64_t fileSize) {
+    fprintf(stream, "# \'%s\' info\n", fileName);
+    fprintf(stream, "# File Size: %llu bytes.\n", (unsigned long long) fileSize);
+    fprintf(stream, "#\n");
+    fprintf(stream, "#                                   offset      size        value\n");
+    fprintf(stream, "[\n");
+}
+
+
+void printHeaders(FILE *stream, PCPE_VIEW view) {
+
+    printDOSHeader(stream, view);
+
+    if (view->bits == 32) {
+        printNTHeaders32(stream, view);
+        printFileHeader(stream, view);
+        printOptionalHeader32(stream, view);
+        printDataDirectories32(stream, view);
+    }
+    else {
+        printNTHeaders64(stream, view);
+        printFileHeader(stream, view);
+        printOptionalHeader64(stream, view);
+        printDataDirectories64(stream, view);
+    }
+
+    printSectionHeaders(stream, view);
+
+    printImports(stream, view);
+
+    printExports(stream, view);
+
+    printRelocs(stream, view);
+
+    printTls(stream, view);
+
+    printLoadConfig(stream, view);
+
+    printResources(stream, view);
+
+    printVersionInfo(stream, view);
+}
+
+
+void printEpilogue(FILE *stream) {
+    fprintf(stream, "]\n");
+}
+
+
+static void printDOSHeader(FILE *stream, PCPE_VIEW view) {
+    PCIMAGE_DOS_HEADER DOSHeader = &view->dosHeader;
+    fprintf(stream, "('IMAGE_DOS_HEADER',                0x%05X,    %u),\n", 0, DOSHeader->e_lfanew);
+    fprintf(stream, "    ('e_magic',                     0x%05X,    %zu,          0x%04X),\n", FIELD_OFFSET(IMAGE_DOS_HEADER, e_magic), sizeof(DOSHeader->e_magic), DOSHeader->e_magic);
+    fprintf(stream, "    ('e_lfanew',                    0x%05X,    %zu,          0x%08X),\n", FIELD_OFFSET(IMAGE_DOS_HEADER, e_lfanew), sizeof(DOSHeader->e_lfanew), DOSHeader->e_lfanew);
+    fprintf(stream, "\n");
+}
+
+
+static void printFileHeader(FILE *stream, PCPE_VIEW view) {
+    PCIMAGE_FILE_HEADER fileHeader = &view->fileHeader;
+    unsigned long long offset = view->ntOffset + FIELD_OFFSET(IMAGE_NT_HEADERS64, FileHeader);
+    fprintf(stream, "('IMAGE_FILE_HEADER',               0x%05llX,    %zu),\n", offset, sizeof(IMAGE_FILE_HEADER));
+    fprintf(stream, "    ('Machine',                     0x%05llX,    %zu,          0x%04X),\n", offset + FIELD_OFFSET(IMAGE_FILE_HEADER, Machine), sizeof(fileHeader->Machine), fileHeader->Machine);
+    fprintf(stream, "    ('NumberOfSections',            0x%05llX,    %zu,          %d),\n", offset + FIELD_OFFSET(IMAGE_FILE_HEADER, NumberOfSections), sizeof(fileHeader->NumberOfSections), fileHeader->NumberOfSections);
+    fprintf(stream, "    ('SizeOfOptionalHeader',        0x%05llX,    %zu,          %d),\n", offset + FIELD_OFFSET(IMAGE_FILE_HEADER, SizeOfOptionalHeader), sizeof(fileHeader->SizeOfOptionalHeader), fileHeader->SizeOfOptionalHeader);
+    fprintf(stream, "\n"); 
+}
+
+
+static void printSectionHeaders(FILE *stream, PCPE_VIEW view) {
+    IMAGE_SECTION_HEADER section;
+    unsigned long long offset = view->sectionOffset;
+    uint16_t numSections = view->numberOfSections;
+    fprintf(stream, "    ('Section Headers',            0x%05llX,    %zu,         [\n", offset, sizeof(section) * numSections);
+    fprintf(stream, "        # Name        VirtualSize  VirtualAddress  SizeOfRawData  PointerToRawData\n");
+    // print each section header's data up to amount specified in the file header, names are not NUL terminated at 8 characters
+    for (uint16_t idx = 0; idx < numSections; idx++) {
+        peSection(view, idx, &section);
+        fprintf(stream, "        ('%-8.8s',   0x%06X,      0x%06X,       0x%06X,      0x%06X),\n", section.Name, section.Misc.VirtualSize, section.VirtualAddress, section.SizeOfRawData, section.PointerToRawData);
+    }
+    fprintf(stream, "    ]),\n");
+}
+
+
+static void printImports(FILE *stream, PCPE_VIEW view) {
+    PCIMAGE_DATA_DIRECTORY directory = peDataDirectory(view, IMAGE_DIRECTORY_ENTRY_IMPORT);
+    uint64_t offset = 0;
+    if (!directory || !directory->Size || !peRvaToOffset(view, directory->VirtualAddress, 1, &offset)) {
+        return;
+    }
+    fprintf(stream, "    ('Imports',                    0x%05llX,    %u,         [\n", (unsigned long long) offset, directory->Size);
+    fprintf(stream, "        # DLL / Name                    Hint|Ordinal  IAT\n");
+    PE_IMPORT_ITERATOR dlls, functions;
+    PE_IMPORT_DLL dll;
+    PE_IMPORT import;
+    // print each DLL up to the null descriptor, and each of its functions up to the null thunk
+    peImportDlls(view, &dlls);
+    while (peNextImportDll(&dlls, &dll)) {
+        fprintf(stream, "        (");
+        printString(stream, dll.name, true);
+        fprintf(stream, ", [\n");
+        peImportFunctions(view, &dll, &functions);
+        while (peNextImportFunction(&functions, &import)) {
+            if (import.name) {
+                fprintf(stream, "            (");
+                printString(stream, import.name, true);
+                fprintf(stream, ", 0x%04X, 0x%06X),\n", import.hint, import.iatRva);
+            }
+            else {
+                fprintf(stream, "            (None, %u, 0x%06X),\n", import.ordinal, import.iatRva);
+            }
+        }
+        fprintf(stream, "        ]),\n");
+    }
+    fprintf(stream, "    ]),\n");
+}
+
+
+static void printExports(FILE *stream, PCPE_VIEW view) {
+    PE_EXPORTS exports;
+    uint64_t offset = 0;
+    if (!peOpenExports(view, &exports) || !peRvaToOffset(view, exports.directoryRva, 1, &offset)) {
+        return;
+    }
+    fprintf(stream, "    ('Exports',                    0x%05llX,    %u,         [\n", (unsigned long long) offset, exports.directorySize);
+    fprintf(stream, "        # ");
+    printString(stream, exports.dllName ? exports.dllName : "?", false);
+    fprintf(stream, "\n");
+    fprintf(stream, "        # Ordinal  RVA         Name, Forwarder\n");
+
+    uint8_t named[MAX_EXPORTED_FUNCTIONS / 8] = { 0 };
+    PE_EXPORT export;
+    for (uint32_t idx = 0; idx < exports.numberOfNames; idx++) {
+        if (!peExportByNameIndex(&exports, idx, &export)) {
+            continue;
+        }
+        uint32_t function = export.ordinal - exports.base;
+        if (function < MAX_EXPORTED_FUNCTIONS) {
+            named[function / 8] |= (uint8_t) (1u << (function % 8));
+        }
+        fprintf(stream, "        (%6u,   0x%06X,   ", export.ordinal, export.rva);
+        printString(stream, export.name, true);
+        fprintf(stream, ", ");
+        printString(stream, export.forwarder, true);
+        fprintf(stream, "),\n");
+    }
+    // then the functions exported by ordinal only
+    for (uint32_t function = 0; function < exports.numberOfFunctions && function < MAX_EXPORTED_FUNCTIONS; function++) {
+        if (named[function / 8] & (1u << (function % 8))
+                || !peExportByOrdinal(&exports, exports.base + function, &export) || !export.rva) {
+            continue;
+        }
+        fprintf(stream, "        (%6u,   0x%06X,   None, ", export.ordinal, export.rva);
+        printString(stream, export.forwarder, true);
+        fprintf(stream, "),\n");
+    }
+    fprintf(stream, "    ]),\n");
+}
+
+
+static void printRelocs(FILE *stream, PCPE_VIEW view) {
+    PCIMAGE_DATA_DIRECTORY directory = peDataDirectory(view, IMAGE_DIRECTORY_ENTRY_BASERELOC);
+    uint64_t offset = 0;
+    if (!directory || !directory->Size || !peRvaToOffset(view, directory->VirtualAddress, 1, &offset)) {
+        return;
+    }
+    fprintf(stream, "    ('Base Relocations',           0x%05llX,    %u,         [\n", (unsigned long long) offset, directory->Size);
+    fprintf(stream, "        # PageRVA   Relocations\n");
+    PE_RELOC_ITERATOR it;
+    PE_RELOC_BLOCK block;
+    PE_RELOC reloc;
+    peRelocBlocks(view, &it);
+    while (peNextRelocBlock(&it, &block)) {
+        uint32_t count = 0;
+        for (uint32_t idx = 0; idx < block.count; idx++) {
+            count += peRelocEntry(&block, idx, &reloc);
+        }
+        fprintf(stream, "        (0x%06X,  %u),\n", block.pageRva, count);
+    }
+    fprintf(stream, "    ]),\n");
+}
+
+
+static void printTls(FILE *stream, PCPE_VIEW view) {
+    PE_TLS tls;
+    uint64_t offset = 0;
+    if (!peOpenTls(view, &tls) || !peRvaToOffset(view, peDataDirectory(view, IMAGE_DIRECTORY_ENTRY_TLS)->VirtualAddress, 1, &offset)) {
+        return;
+    }
+    int digits = view->bits / 4;
+    fprintf(stream, "    ('TLS',                        0x%05llX,    %u,         [\n", (unsigned long long) offset, peDataDirectory(view, IMAGE_DIRECTORY_ENTRY_TLS)->Size);
+    fprintf(stream, "        ('StartAddressOfRawData',  0x%0*llX),\n", digits, (unsigned long long) tls.startAddressOfRawData);
+    fprintf(stream, "        ('EndAddressOfRawData',    0x%0*llX),\n", digits, (unsigned long long) tls.endAddressOfRawData);
+    fprintf(stream, "        ('AddressOfIndex',         0x%0*llX),\n", digits, (unsigned long long) tls.addressOfIndex);
+    fprintf(stream, "        ('SizeOfZeroFill',         %u),\n", tls.sizeOfZeroFill);
+    fprintf(stream, "        ('AddressOfCallBacks',     0x%0*llX, [\n", digits, (unsigned long long) tls.addressOfCallBacks);
+    PE_VA_ITERATOR it;
+    uint64_t va;
+    peTlsCallbacks(&tls, &it);
+    while (peNextTlsCallback(&it, &va)) {
+        fprintf(stream, "            0x%0*llX,\n", digits, (unsigned long long) va);
+    }
+    fprintf(stream, "        ]),\n");
+    fprintf(stream, "    ]),\n");
+}
+
+
+static void printLoadConfig(FILE *stream, PCPE_VIEW view) {
+    PE_LOAD_CONFIG config;
+    uint64_t offset = 0;
+    if (!peOpenLoadConfig(view, &config) || !peRvaToOffset(view, peDataDirectory(view, IMAGE_DIRECTORY_ENTRY_LOAD_CONFIG)->VirtualAddress, 1, &offset)) {
+        return;
+    }
+    int digits = view->bits / 4;
+    fprintf(stream, "    ('Load Config',                0x%05llX,    %u,         [\n", (unsigned long long) offset, config.size);
+    fprintf(stream, "        ('SecurityCookie',                 0x%0*llX),\n", digits, (unsigned long long) config.securityCookie);
+    if (view->bits == 32) {
+        fprintf(stream, "        ('SEHandlerTable',                 0x%0*llX),\n", digits, (unsigned long long) config.seHandlerTable);
+        fprintf(stream, "        ('SEHandlerCount',                 %llu),\n", (unsigned long long) config.seHandlerCount);
+    }
+    fprintf(stream, "        ('GuardCFCheckFunctionPointer',    0x%0*llX),\n", digits, (unsigned long long) config.guardCFCheckFunctionPointer);
+    fprintf(stream, "        ('GuardCFDispatchFunctionPointer', 0x%0*llX),\n", digits, (unsigned long long) config.guardCFDispatchFunctionPointer);
+    fprintf(stream, "        ('GuardCFFunctionTable',           0x%0*llX),\n", digits, (unsigned long long) config.guardCFFunctionTable);
+    fprintf(stream, "        ('GuardCFFunctionCount',           %llu),\n", (unsigned long long) config.guardCFFunctionCount);
+    fprintf(stream, "        ('GuardFlags',                     0x%08X),\n", config.guardFlags);
+    fprintf(stream, "        ('GuardLongJumpTargetTable',       0x%0*llX),\n", digits, (unsigned long long) config.guardLongJumpTargetTable);
+    fprintf(stream, "        ('GuardLongJumpTargetCount',       %llu),\n", (unsigned long long) config.guardLongJumpTargetCount);
+    fprintf(stream, "    ]),\n");
+}
+
+
+static void printResources(FILE *stream, PCPE_VIEW view) {
+    PE_RESOURCES resources;
+    PE_RESOURCE_DIRECTORY root, names;
+    uint64_t offset = 0;
+    if (!peOpenResources(view, &resources) || !peRvaToOffset(view, resources.rva, 1, &offset) || !peResourceDirectory(&resources, 0, &root)) {
+        return;
+    }
+    fprintf(stream, "    ('Resources',                  0x%05llX,    %u,         [\n", (unsigned long long) offset, resources.size);
+    fprintf(stream, "        # Type                     Entries\n");
+    PE_RESOURCE_ENTRY type;
+    for (uint32_t idx = 0; idx < root.numberOfNamed + root.numberOfIds; idx++) {
+        if (!peResourceEntry(&root, idx, &type)) {
+            continue;
+        }
+        uint32_t count = type.isDirectory && peResourceDirectory(&resources, type.offset, &names) ? names.numberOfNamed + names.numberOfIds : 0;
+        fprintf(stream, "        (");
+        if (type.name) {
+            printUtf16(stream, type.name, type.nameLength);
+        }
+        else if (type.id < sizeof(RESOURCE_TYPES) / sizeof(RESOURCE_TYPES[0]) && RESOURCE_TYPES[type.id]) {
+            fprintf(stream, "'%s'", RESOURCE_TYPES[type.id]);
+        }
+        else {
+            fprintf(stream, "%u", type.id);
+        }
+        fprintf(stream, ", %u),\n", count);
+    }
+    fprintf(stream, "    ]),\n");
+}
+
+
+static void printVersionInfo(FILE *stream, PCPE_VIEW view) {
+    PE_RESOURCES resources;
+    PE_VERSION_INFO info;
+    uint64_t offset = 0;
+    if (!peOpenResources(view, &resources) || !peOpenVersionInfo(&resources, &info) || !peRvaToOffset(view, info.rva, 1, &offset)) {
+        return;
+    }
+    fprintf(stream, "    ('Version Info',               0x%05llX,    %u,         [\n", (unsigned long long) offset, info.size);
+    if (info.hasFixed) {
+        PCVS_FIXEDFILEINFO fixed = &info.fixed;
+        fprintf(stream, "        ('FileVersion',        '%u.%u.%u.%u'),\n", fixed->dwFileVersionMS >> 16, fixed->dwFileVersionMS & 0xffff, fixed->dwFileVersionLS >> 16, fixed->dwFileVersionLS & 0xffff);
+        fprintf(stream, "        ('ProductVersion',     '%u.%u.%u.%u'),\n", fixed->dwProductVersionMS >> 16, fixed->dwProductVersionMS & 0xffff, fixed->dwProductVersionLS >> 16, fixed->dwProductVersionLS & 0xffff);
+        fprintf(stream, "        ('FileFlags',          0x%08X),\n", fixed->dwFileFlags & fixed->dwFileFlagsMask);
+        fprintf(stream, "        ('FileOS',             0x%08X),\n", fixed->dwFileOS);
+        fprintf(stream, "        ('FileType',           %u),\n", fixed->dwFileType);
+    }
+    PE_VERSION_ITERATOR it;
+    PE_VERSION_STRING string;
+    if (info.strings) {
+        fprintf(stream, "        # StringTable ");
+        printString(stream, info.language, false);
+        fprintf(stream, "\n");
+    }
+    peVersionStrings(&info, &it);
+    while (peNextVersionString(&it, &string)) {
+        fprintf(stream, "        (");
+        printUtf16(stream, string.key, string.keyLength);
+        fprintf(stream, ", ");
+        printUtf16(stream, string.value, string.valueLength);
+        fprintf(stream, "),\n");
+    }
+    fprintf(stream, "    ]),\n");
+}
+
+
+static void printUtf16(FILE *stream, const uint16_t *text, uint32_t length) {
+    char buffer[MAX_PRINTED_STRING];
+    peUtf16ToUtf8(text, length, buffer, sizeof(buffer));
+    printString(stream, buffer, true);
+}
+
+
+static void printString(FILE *stream, const char *text, bool quoted) {
+    if (!text) {
+        fprintf(stream, "None");
+        return;
+    }
+    // escape what would end or break a python string literal or the comment line, other bytes as they are: UTF-8 stays readable
+    if (quoted) {
+        fputc('\'', stream);
+    }
+    for (const char *next = text; *next; next++) {
+        if (quoted && (*next == '\'' || *next == '\\')) {
+            fprintf(stream, "\\%c", *next);
+        }
+        else if ((unsigned char) *next < 0x20) {
+            fprintf(stream, "\\x%02x", (unsigned char) *next);
+        }
+        else {
+            fputc(*next, stream);
+        }
+    }
+    if (quoted) {
+        fputc('\'', stream);
+    }
+}
+
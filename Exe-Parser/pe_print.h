@@ -0,0 +1,38 @@
+//-------------------------------------------------------------------------------------------------
+// pe_print.h
+//
+// Prints the headers of a validated PE view as a Python readable list of tuples
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "pe_view.h"
+
+
+/**
+ * @brief Prints the file name, file size, and column headers into python comments, then starts a python list
+ *
+ * @param[in] stream Output stream
+ * @param[in] fileName Name printed in the first comment
+ * @param[in] fileSize Size of the file in bytes
+ */
+void printPrologue(FILE *stream, const char *fileName, uint64_t fileSize);
+
+/**
+ * @brief Prints the DOS, NT, file and optional headers, the data directories, the section headers, the imports, exports,
+ * base relocations, TLS, load config and resource directories and the version information as python tuples
+ * @remark Only reads what peOpen() validated, so it is safe on any view peOpen() accepted
+ *
+ * @param[in] stream Output stream
+ * @param[in] view Validated image
+ */
+void printHeaders(FILE *stream, PCPE_VIEW view);
+
+/**
+ * @brief Closes the python list started by printPrologue()
+ *
+ * @param[in] stream Output stream
+ */
+void printEpilogue(FILE *stream);
@@ -0,0 +1,90 @@
+//-------------------------------------------------------------------------------------------------
+// pe_print_tmpl.h
+//
+// Width dependent printers, included by pe_print.c once per PE_BITS (see pe_traits.h).
+// No include guard on purpose.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef PE_BITS
+#error "define PE_BITS as 32 or 64 before including pe_print_tmpl.h"
+#endif
+
+
+/**
+ * @brief Print the NT headers and NT signature as python tuples
+ * 
+ * @param stream
+ * @param view
+ */
+static void PE_FN(printNTHeaders)(FILE *stream, PCPE_VIEW view) {
+    const PE_NT_HEADERS *NTHeaders = &view->PE_VIEW_NT_HEADERS;
+    unsigned long long offset = view->ntOffset;
+    fprintf(stream, "('IMAGE_NT_HEADERS',                0x%05llX,    %zu),\n", offset, sizeof(PE_NT_HEADERS));
+    fprintf(stream, "    ('Signature',                   0x%05llX,    %zu,          0x%08X),\n", offset + FIELD_OFFSET(PE_NT_HEADERS, Signature), sizeof(NTHeaders->Signature), NTHeaders->Signature);
+    fprintf(stream, "    ('FileHeader',                  0x%05llX,    %zu),\n", offset + FIELD_OFFSET(PE_NT_HEADERS, FileHeader), sizeof(NTHeaders->FileHeader));
+    fprintf(stream, "    ('OptionalHeader',              0x%05llX,    %zu),\n", offset + FIELD_OFFSET(PE_NT_HEADERS, OptionalHeader), sizeof(NTHeaders->OptionalHeader));
+    fprintf(stream, "\n");
+}
+
+
+/**
+ * @brief Print the Optional header and its relevant fields as python tuples
+ * 
+ * @param stream
+ * @param view
+ */
+static void PE_FN(printOptionalHeader)(FILE *stream, PCPE_VIEW view) {
+    const PE_OPTIONAL_HEADER *optionalHeader = &view->PE_VIEW_NT_HEADERS.OptionalHeader;
+    unsigned long long offset = view->ntOffset + FIELD_OFFSET(PE_NT_HEADERS, OptionalHeader);
+    fprintf(stream, "('IMAGE_OPTIONAL_HEADER',           0x%05llX,    %zu),\n", offset, sizeof(PE_OPTIONAL_HEADER));
+    fprintf(stream, "    ('Magic',                       0x%05llX,    %zu,          0x%04X),\n", offset + FIELD_OFFSET(PE_OPTIONAL_HEADER, Magic), sizeof(optionalHeader->Magic), optionalHeader->Magic);
+    //fprintf(stream, "    ('MajorLinkerVersion',          0x%05llX,    %zu,      0x%04X),\n", offset + FIELD_OFFSET(PE_OPTIONAL_HEADER, MajorLinkerVersion), sizeof(optionalHeader->MajorLinkerVersion), optionalHeader->MajorLinkerVersion);
+    //fprintf(stream, "    ('MinorLinkerVersion',          0x%05llX,    %zu,      0x%04X),\n", offset + FIELD_OFFSET(PE_OPTIONAL_HEADER, MinorLinkerVersion), sizeof(optionalHeader->MinorLinkerVersion), optionalHeader->MinorLinkerVersion);
+    fprintf(stream, "    ('SizeOfCode',                  0x%05llX,    %zu,          %u),\n", offset + FIELD_OFFSET(PE_OPTIONAL_HEADER, SizeOfCode), sizeof(optionalHeader->SizeOfCode), optionalHeader->SizeOfCode);
+    fprintf(stream, "    ('SizeOfInitializedData',       0x%05llX,    %zu,          %u),\n", offset + FIELD_OFFSET(PE_OPTIONAL_HEADER, SizeOfInitializedData), sizeof(optionalHeader->SizeOfInitializedData), optionalHeader->SizeOfInitializedData);
+    fprintf(stream, "    ('SizeOfUninitializedData',     0x%05llX,    %zu,          %u),\n", offset + FIELD_OFFSET(PE_OPTIONAL_HEADER, SizeOfUninitializedData), sizeof(optionalHeader->SizeOfUninitializedData), optionalHeader->SizeOfUninitializedData);
+    fprintf(stream, "    ('AddressOfEntryPoint',         0x%05llX,    %zu,          0x%08X),\n", offset + FIELD_OFFSET(PE_OPTIONAL_HEADER, AddressOfEntryPoint), sizeof(optionalHeader->AddressOfEntryPoint), optionalHeader->AddressOfEntryPoint);
+#if PE_BITS == 32
+    fprintf(stream, "    ('BaseOfData',                  0x%05llX,    %zu,          0x%08X),\n", offset + FIELD_OFFSET(PE_OPTIONAL_HEADER, BaseOfData), sizeof(optionalHeader->BaseOfData), optionalHeader->BaseOfData);
+#endif
+    fprintf(stream, "    ('ImageBase',                   0x%05llX,    %zu,          0x%0*llX),\n", offset + FIELD_OFFSET(PE_OPTIONAL_HEADER, ImageBase), sizeof(optionalHeader->ImageBase), PE_VA_DIGITS, (unsigned long long) optionalHeader->ImageBase);
+    fprintf(stream, "    ('SectionAlignment',            0x%05llX,    %zu,          %u),\n", offset + FIELD_OFFSET(PE_OPTIONAL_HEADER, SectionAlignment), sizeof(optionalHeader->SectionAlignment), optionalHeader->SectionAlignment);
+    fprintf(stream, "    ('FileAlignment',               0x%05llX,    %zu,          %u),\n", offset + FIELD_OFFSET(PE_OPTIONAL_HEADER, FileAlignment), sizeof(optionalHeader->FileAlignment), optionalHeader->FileAlignment);
+    fprintf(stream, "    ('MinorOperatingSystemVersion', 0x%05llX,    %zu,          %u),\n", offset + FIELD_OFFSET(PE_OPTIONAL_HEADER, MinorOperatingSystemVersion), sizeof(optionalHeader->MinorOperatingSystemVersion), optionalHeader->MinorOperatingSystemVersion);
+    fprintf(stream, "    ('MajorOperatingSystemVersion', 0x%05llX,    %zu,          %u),\n", offset + FIELD_OFFSET(PE_OPTIONAL_HEADER, MajorOperatingSystemVersion), sizeof(optionalHeader->MajorOperatingSystemVersion), optionalHeader->MajorOperatingSystemVersion);
+    fprintf(stream, "    ('MajorImageVersion',           0x%05llX,    %zu,          %u),\n", offset + FIELD_OFFSET(PE_OPTIONAL_HEADER, MajorImageVersion), sizeof(optionalHeader->MajorImageVersion), optionalHeader->MajorImageVersion);
+    fprintf(stream, "    ('MinorImageVersion',           0x%05llX,    %zu,          %u),\n", offset + FIELD_OFFSET(PE_OPTIONAL_HEADER, MinorImageVersion), sizeof(optionalHeader->MinorImageVersion), optionalHeader->MinorImageVersion);
+    fprintf(stream, "    ('MajorSubsystemVersion',       0x%05llX,    %zu,          %u),\n", offset + FIELD_OFFSET(PE_OPTIONAL_HEADER, MajorSubsystemVersion), sizeof(optionalHeader->MajorSubsystemVersion), optionalHeader->MajorSubsystemVersion);
+    fprintf(stream, "    ('MinorSubsystemVersion',       0x%05llX,    %zu,          %u),\n", offset + FIELD_OFFSET(PE_OPTIONAL_HEADER, MinorSubsystemVersion), sizeof(optionalHeader->MinorSubsystemVersion), optionalHeader->MinorSubsystemVersion);
+    fprintf(stream, "    ('Win32VersionValue',           0x%05llX,    %zu,          %u),\n", offset + FIELD_OFFSET(PE_OPTIONAL_HEADER, Win32VersionValue), sizeof(optionalHeader->Win32VersionValue), optionalHeader->Win32VersionValue);
+    fprintf(stream, "    ('SizeOfImage',                 0x%05llX,    %zu,          0x%08X),\n", offset + FIELD_OFFSET(PE_OPTIONAL_HEADER, SizeOfImage), sizeof(optionalHeader->SizeOfImage), optionalHeader->SizeOfImage);
+    fprintf(stream, "    ('SizeOfHeaders',               0x%05llX,    %zu,          0x%08X),\n", offset + FIELD_OFFSET(PE_OPTIONAL_HEADER, SizeOfHeaders), sizeof(optionalHeader->SizeOfHeaders), optionalHeader->SizeOfHeaders);
+    fprintf(stream, "    ('CheckSum',                    0x%05llX,    %zu,          0x%08X),\n", offset + FIELD_OFFSET(PE_OPTIONAL_HEADER, CheckSum), sizeof(optionalHeader->CheckSum), optionalHeader->CheckSum);
+    fprintf(stream, "    ('Subsystem',                   0x%05llX,    %zu,          %u),\n", offset + FIELD_OFFSET(PE_OPTIONAL_HEADER, Subsystem), sizeof(optionalHeader->Subsystem), optionalHeader->Subsystem);
+    fprintf(stream, "    ('SizeOfStackReserve',          0x%05llX,    %zu,          0x%08llX),\n", offset + FIELD_OFFSET(PE_OPTIONAL_HEADER, SizeOfStackReserve), sizeof(optionalHeader->SizeOfStackReserve), (unsigned long long) optionalHeader->SizeOfStackReserve);
+    fprintf(stream, "    ('SizeOfStackCommit',           0x%05llX,    %zu,          0x%08llX),\n", offset + FIELD_OFFSET(PE_OPTIONAL_HEADER, SizeOfStackCommit), sizeof(optionalHeader->SizeOfStackCommit), (unsigned long long) optionalHeader->SizeOfStackCommit);
+    fprintf(stream, "    ('SizeOfHeapReserve',           0x%05llX,    %zu,          0x%08llX),\n", offset + FIELD_OFFSET(PE_OPTIONAL_HEADER, SizeOfHeapReserve), sizeof(optionalHeader->SizeOfHeapReserve), (unsigned long long) optionalHeader->SizeOfHeapReserve);
+    fprintf(stream, "    ('SizeOfHeapCommit',            0x%05llX,    %zu,          0x%08llX),\n", offset + FIELD_OFFSET(PE_OPTIONAL_HEADER, SizeOfHeapCommit), sizeof(optionalHeader->SizeOfHeapCommit), (unsigned long long) optionalHeader->SizeOfHeapCommit);
+    fprintf(stream, "    ('NumberOfRvaAndSizes',         0x%05llX,    %zu,          %u),\n", offset + FIELD_OFFSET(PE_OPTIONAL_HEADER, NumberOfRvaAndSizes), sizeof(optionalHeader->NumberOfRvaAndSizes), optionalHeader->NumberOfRvaAndSizes);
+}
+
+
+/**
+ * @brief Print the Data directories and their relevant fields as python tuples
+ * 
+ * @param stream
+ * @param view
+ */
+static void PE_FN(printDataDirectories)(FILE *stream, PCPE_VIEW view) {
+    const PE_OPTIONAL_HEADER *optionalHeader = &view->PE_VIEW_NT_HEADERS.OptionalHeader;
+    unsigned long long offset = view->ntOffset + FIELD_OFFSET(PE_NT_HEADERS, OptionalHeader);
+    fprintf(stream, "    ('DataDirectory',               0x%05llX,    %zu,        [\n", offset + FIELD_OFFSET(PE_OPTIONAL_HEADER, DataDirectory), sizeof(optionalHeader->DataDirectory));
+    fprintf(stream, "        # offset  type   VirtualAddress    Size\n");
+    PCIMAGE_DATA_DIRECTORY dataDir;
+    // print each data directory's data up to amount specified in the optional header, as far as the header holds them
+    for (uint32_t idx = 0; idx < view->numberOfDirectories; idx++) {
+        dataDir = &(optionalHeader->DataDirectory[idx]);
+        fprintf(stream, "        (0x%05llX, '%2u',     0x%06X,      0x%04X),\n", offset + FIELD_OFFSET(PE_OPTIONAL_HEADER, DataDirectory) + idx * sizeof(*dataDir), idx, dataDir->VirtualAddress, dataDir->Size);
+    }
+    fprintf(stream, "    ]),\n");
+}
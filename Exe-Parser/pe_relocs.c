@@ -0,0 +1,57 @@
+/**
+ * @file pe_relocs.c
+ * @brief Streaming walker over the base relocation directory of a PE view
+ * @date 2026-10-16
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "pe_relocs.h"
+
+
+//*********************************************************************************
+// DEFINITIONS
+//********************************************************************************
+
+void peRelocBlocks(PCPE_VIEW view, PPE_RELOC_ITERATOR it) {
+
+    PCIMAGE_DATA_DIRECTORY directory = peDataDirectory(view, IMAGE_DIRECTORY_ENTRY_BASERELOC);
+    it->view = view;
+    it->rva = directory ? directory->VirtualAddress : 0;
+    it->remaining = directory && directory->VirtualAddress ? directory->Size : 0;
+    it->count = 0;
+    it->truncated = false;
+}
+
+
+bool peNextRelocBlock(PPE_RELOC_ITERATOR it, PPE_RELOC_BLOCK block) {
+
+    if (it->remaining < sizeof(IMAGE_BASE_RELOCATION)) {
+        return false;
+    }
+    IMAGE_BASE_RELOCATION copy;
+    PCIMAGE_BASE_RELOCATION header = &copy;
+    bool copied = peRvaCopy(it->view, it->rva, &copy, sizeof(copy));
+
+    // a block holds at least its header and cannot run past the directory
+    if (!copied || header->SizeOfBlock < sizeof(*header) || header->SizeOfBlock > it->remaining) {
+        it->truncated = true;
+        it->remaining = 0;
+        return false;
+    }
+    block->pageRva = header->VirtualAddress;
+    block->count = (header->SizeOfBlock - sizeof(*header)) / sizeof(uint16_t);
+    block->entries = block->count ? peRvaPointer(it->view, it->rva + sizeof(*header), block->count * sizeof(uint16_t)) : NULL;
+    if (block->count && !block->entries) {
+        it->truncated = true;
+        it->remaining = 0;
+        return false;
+    }
+
+    it->rva += header->SizeOfBlock;
+    it->remaining -= header->SizeOfBlock;
+    it->count++;
+    return true;
+}
@@ -0,0 +1,85 @@
+//-------------------------------------------------------------------------------------------------
+// pe_relocs.h
+//
+// Streaming walker over the base relocation directory of a PE view. Blocks are returned one at a
+// time with their entries in place, read by peRelocEntry(); nothing is allocated.
+//
+//      PE_RELOC_ITERATOR it;
+//      PE_RELOC_BLOCK block;
+//      PE_RELOC reloc;
+//      peRelocBlocks(&view, &it);
+//      while (peNextRelocBlock(&it, &block)) {
+//          for (uint32_t idx = 0; idx < block.count; idx++) {
+//              if (peRelocEntry(&block, idx, &reloc)) { ... }
+//          }
+//      }
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "pe_view.h"
+
+
+/**
+ * @brief one relocation block, the relocations of one 4 KiB page
+ */
+typedef struct _PE_RELOC_BLOCK {
+    uint32_t        pageRva;        // RVA the entry offsets are relative to
+    uint32_t        count;          // entries in the block, padding included
+    const uint8_t   *entries;       // uint16_t each, type in the top 4 bits, offset in the page in the low 12
+} PE_RELOC_BLOCK, *PPE_RELOC_BLOCK;
+
+/**
+ * @brief one decoded relocation entry
+ */
+typedef struct _PE_RELOC {
+    uint32_t    rva;            // address patched
+    uint8_t     type;           // IMAGE_REL_BASED_*
+} PE_RELOC, *PPE_RELOC;
+
+/**
+ * @brief position in the relocation directory
+ */
+typedef struct _PE_RELOC_ITERATOR {
+    PCPE_VIEW   view;
+    uint32_t    rva;            // next block
+    uint32_t    remaining;      // bytes of the directory after rva
+    uint32_t    count;          // blocks returned so far
+    bool        truncated;      // the walk stopped at a block outside the file or of an impossible size
+} PE_RELOC_ITERATOR, *PPE_RELOC_ITERATOR;
+
+
+/**
+ * @brief Starts a walk over the relocation blocks of an image
+ * @remark An image without relocation directory yields no block
+ *
+ * @param[in] view Validated image
+ * @param[out] it Iterator to start
+ */
+void peRelocBlocks(PCPE_VIEW view, PPE_RELOC_ITERATOR it);
+
+/**
+ * @brief Returns the next relocation block
+ *
+ * @param[in,out] it Iterator started by peRelocBlocks()
+ * @param[out] block Receives the block
+ * @return true if a block was returned | false at the end of the directory or at malformed data (it->truncated set)
+ */
+bool peNextRelocBlock(PPE_RELOC_ITERATOR it, PPE_RELOC_BLOCK block);
+
+/**
+ * @brief Decodes an entry of a block
+ *
+ * @param[in] block Block returned by peNextRelocBlock()
+ * @param[in] index 0 to block->count - 1
+ * @param[out] reloc Receives the relocation
+ * @return true for a relocation | false for IMAGE_REL_BASED_ABSOLUTE, the padding that aligns blocks
+ */
+static inline bool peRelocEntry(const PE_RELOC_BLOCK *block, uint32_t index, PPE_RELOC reloc) {
+    uint16_t entry = peRead16(block->entries + (uint64_t) index * sizeof(uint16_t));
+    reloc->rva = block->pageRva + (entry & 0x0fff);
+    reloc->type = (uint8_t) (entry >> 12);
+    return reloc->type != IMAGE_REL_BASED_ABSOLUTE;
+}
@@ -0,0 +1,183 @@
+/**
+ * @file pe_resources.c
+ * @brief Lazy walker over the resource directory of a PE view
+ * @date 2026-10-16
+ *
+ * Nothing is decoded ahead: a directory is its 16-byte header and an entry array checked against the
+ * file when opened, an entry is decoded when asked for. An installer with tens of thousands of
+ * resources costs a lookup no more than three directories and the entries its binary searches probe.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "pe_resources.h"
+
+
+//*********************************************************************************
+// DECLARATIONS
+//*********************************************************************************
+
+/**
+ * @brief Returns a pointer to length bytes at an offset from the root directory | NULL if outside the file
+ */
+static const void *treePointer(PCPE_RESOURCES resources, uint32_t offset, uint32_t length);
+
+/**
+ * @brief Copies length bytes at an offset from the root directory
+ *
+ * @return true | false if they are outside the file
+ */
+static bool treeCopy(PCPE_RESOURCES resources, uint32_t offset, void *copy, uint32_t length);
+
+
+//*********************************************************************************
+// DEFINITIONS
+//********************************************************************************
+
+bool peOpenResources(PCPE_VIEW view, PPE_RESOURCES resources) {
+
+    memset(resources, 0, sizeof(*resources));
+    resources->view = view;
+    PCIMAGE_DATA_DIRECTORY directory = peDataDirectory(view, IMAGE_DIRECTORY_ENTRY_RESOURCE);
+    if (!directory || !directory->VirtualAddress || directory->Size < sizeof(IMAGE_RESOURCE_DIRECTORY)) {
+        return false;
+    }
+    resources->rva = directory->VirtualAddress;
+    resources->size = directory->Size;
+    return true;
+}
+
+
+bool peResourceDirectory(PCPE_RESOURCES resources, uint32_t offset, PPE_RESOURCE_DIRECTORY directory) {
+
+    IMAGE_RESOURCE_DIRECTORY header;
+    if (!treeCopy(resources, offset, &header, sizeof(header))) {
+        return false;
+    }
+    directory->resources = resources;
+    directory->numberOfNamed = header.NumberOfNamedEntries;
+    directory->numberOfIds = header.NumberOfIdEntries;
+    directory->entries = NULL;
+
+    // at most 2 * 0xffff entries of 8 bytes, the length cannot overflow
+    uint32_t count = directory->numberOfNamed + directory->numberOfIds;
+    if (count) {
+        directory->entries = treePointer(resources, offset + sizeof(header), count * sizeof(IMAGE_RESOURCE_DIRECTORY_ENTRY));
+        return directory->entries != NULL;
+    }
+    return true;
+}
+
+
+bool peResourceEntry(const PE_RESOURCE_DIRECTORY *directory, uint32_t index, PPE_RESOURCE_ENTRY entry) {
+
+    if (index >= directory->numberOfNamed + directory->numberOfIds) {
+        return false;
+    }
+    IMAGE_RESOURCE_DIRECTORY_ENTRY raw;
+    memcpy(&raw, directory->entries + (uint64_t) index * sizeof(raw), sizeof(raw));
+    entry->isDirectory = (raw.OffsetToData & IMAGE_RESOURCE_DATA_IS_DIRECTORY) != 0;
+    entry->offset = raw.OffsetToData & ~IMAGE_RESOURCE_DATA_IS_DIRECTORY;
+    entry->id = PE_RESOURCE_ANY;
+    entry->name = NULL;
+    entry->nameLength = 0;
+    if (!(raw.Name & IMAGE_RESOURCE_NAME_IS_STRING)) {
+        entry->id = raw.Name & 0xffff;
+        return true;
+    }
+
+    // a counted UTF-16 string, not terminated
+    uint32_t nameOffset = raw.Name & ~IMAGE_RESOURCE_NAME_IS_STRING;
+    const uint8_t *name = treePointer(directory->resources, nameOffset, sizeof(uint16_t));
+    uint16_t length = name ? peRead16(name) : 0;
+    if (!name || (length && !treePointer(directory->resources, nameOffset + sizeof(uint16_t), length * sizeof(uint16_t)))) {
+        return false;
+    }
+    entry->name = (const uint16_t *) (name + FIELD_OFFSET(IMAGE_RESOURCE_DIR_STRING_U, NameString));
+    entry->nameLength = length;
+    return true;
+}
+
+
+bool peFindResourceEntry(const PE_RESOURCE_DIRECTORY *directory, uint32_t id, PPE_RESOURCE_ENTRY entry) {
+
+    if (id == PE_RESOURCE_ANY) {
+        return peResourceEntry(directory, 0, entry);
+    }
+
+    // the id entries follow the named ones, sorted ascending
+    uint32_t low = directory->numberOfNamed, high = directory->numberOfNamed + directory->numberOfIds;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        uint32_t probe = peRead32(directory->entries + (uint64_t) mid * sizeof(IMAGE_RESOURCE_DIRECTORY_ENTRY)
+                + FIELD_OFFSET(IMAGE_RESOURCE_DIRECTORY_ENTRY, Name)) & 0xffff;
+        if (probe == id) {
+            return peResourceEntry(directory, mid, entry);
+        }
+        if (probe < id) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+    return false;
+}
+
+
+bool peResourceData(PCPE_RESOURCES resources, const PE_RESOURCE_ENTRY *entry, PPE_RESOURCE_DATA data) {
+
+    if (entry->isDirectory) {
+        return false;
+    }
+    IMAGE_RESOURCE_DATA_ENTRY raw;
+    if (!treeCopy(resources, entry->offset, &raw, sizeof(raw))) {
+        return false;
+    }
+    data->rva = raw.OffsetToData;
+    data->size = raw.Size;
+    data->codePage = raw.CodePage;
+    data->data = raw.Size ? peRvaPointer(resources->view, raw.OffsetToData, raw.Size) : NULL;
+    return !raw.Size || data->data;
+}
+
+
+bool peFindResource(PCPE_RESOURCES resources, uint32_t type, uint32_t name, uint32_t language, PPE_RESOURCE_DATA data) {
+
+    const uint32_t ids[PE_RESOURCE_LEVELS] = { type, name, language };
+    PE_RESOURCE_DIRECTORY directory;
+    PE_RESOURCE_ENTRY entry = { .isDirectory = true, .offset = 0 };
+
+    // a fixed number of levels, so a tree pointing back at itself ends the walk
+    for (int level = 0; level < PE_RESOURCE_LEVELS; level++) {
+        if (!entry.isDirectory || !peResourceDirectory(resources, entry.offset, &directory)
+                || !peFindResourceEntry(&directory, ids[level], &entry)) {
+            return false;
+        }
+    }
+    return peResourceData(resources, &entry, data);
+}
+
+
+static const void *treePointer(PCPE_RESOURCES resources, uint32_t offset, uint32_t length) {
+
+    // an RVA past 32 bits would wrap to the start of the image
+    uint64_t rva = (uint64_t) resources->rva + offset;
+    if (rva > UINT32_MAX) {
+        return NULL;
+    }
+    return peRvaPointer(resources->view, (uint32_t) rva, length);
+}
+
+
+static bool treeCopy(PCPE_RESOURCES resources, uint32_t offset, void *copy, uint32_t length) {
+    const void *data = treePointer(resources, offset, length);
+    if (!data) {
+        return false;
+    }
+    memcpy(copy, data, length);
+    return true;
+}
@@ -0,0 +1,131 @@
+//-------------------------------------------------------------------------------------------------
+// pe_resources.h
+//
+// Lazy walker over the resource directory of a PE view. The tree has three levels, type, name and
+// language, and each directory is decoded only when it is opened: looking up one resource reads the
+// three directories on its path, a binary search over each, and never the rest of the tree.
+//
+//      PE_RESOURCES resources;
+//      PE_RESOURCE_DATA data;
+//      if (peOpenResources(&view, &resources)
+//              && peFindResource(&resources, RT_VERSION, PE_RESOURCE_ANY, PE_RESOURCE_ANY, &data)) { ... }
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "pe_view.h"
+
+// id matching the first entry of a level, e.g. any name or any language
+#define PE_RESOURCE_ANY UINT32_MAX
+
+// levels of the tree the loader uses: type, name and language
+#define PE_RESOURCE_LEVELS 3
+
+
+/**
+ * @brief the resource directory of an image, filled by peOpenResources()
+ */
+typedef struct _PE_RESOURCES {
+    PCPE_VIEW   view;
+    uint32_t    rva;            // root directory, the offsets in the tree are relative to it
+    uint32_t    size;
+} PE_RESOURCES, *PPE_RESOURCES;
+
+typedef const PE_RESOURCES* PCPE_RESOURCES;
+
+/**
+ * @brief one directory of the tree, its entries in place
+ */
+typedef struct _PE_RESOURCE_DIRECTORY {
+    PCPE_RESOURCES                      resources;
+    const uint8_t                       *entries;       // IMAGE_RESOURCE_DIRECTORY_ENTRY each, named first, then ids in ascending order
+    uint32_t                            numberOfNamed;
+    uint32_t                            numberOfIds;
+} PE_RESOURCE_DIRECTORY, *PPE_RESOURCE_DIRECTORY;
+
+/**
+ * @brief one decoded directory entry
+ */
+typedef struct _PE_RESOURCE_ENTRY {
+    uint32_t        id;             // type, name or language id | PE_RESOURCE_ANY for a named entry
+    const uint16_t  *name;          // UTF-16 name, not NUL terminated, at any alignment | NULL for an id
+    uint32_t        nameLength;     // UTF-16 units
+    bool            isDirectory;    // offset is a subdirectory, else a data entry
+    uint32_t        offset;         // from the root directory
+} PE_RESOURCE_ENTRY, *PPE_RESOURCE_ENTRY;
+
+/**
+ * @brief the data of one resource
+ */
+typedef struct _PE_RESOURCE_DATA {
+    uint32_t        rva;
+    uint32_t        size;
+    uint32_t        codePage;
+    const uint8_t   *data;          // size bytes in the image
+} PE_RESOURCE_DATA, *PPE_RESOURCE_DATA;
+
+
+/**
+ * @brief Locates the resource directory of an image
+ * @remark Reads nothing of the tree
+ *
+ * @param[in] view Validated image
+ * @param[out] resources Receives the directory
+ * @return true if the image has a resource directory
+ */
+bool peOpenResources(PCPE_VIEW view, PPE_RESOURCES resources);
+
+/**
+ * @brief Opens a directory of the tree, checking its entry array lies within the file
+ *
+ * @param[in] resources Resource directory
+ * @param[in] offset 0 for the root, else the offset of a subdirectory entry
+ * @param[out] directory Receives the directory
+ * @return true if the directory and its entries are within the file
+ */
+bool peResourceDirectory(PCPE_RESOURCES resources, uint32_t offset, PPE_RESOURCE_DIRECTORY directory);
+
+/**
+ * @brief Decodes the n-th entry of a directory
+ *
+ * @param[in] directory Directory opened by peResourceDirectory()
+ * @param[in] index 0 to numberOfNamed + numberOfIds - 1
+ * @param[out] entry Receives the entry
+ * @return true if the entry and its name, if any, are within the file
+ */
+bool peResourceEntry(const PE_RESOURCE_DIRECTORY *directory, uint32_t index, PPE_RESOURCE_ENTRY entry);
+
+/**
+ * @brief Looks up an entry by id, binary searching the id entries: O(log n)
+ *
+ * @param[in] directory Directory opened by peResourceDirectory()
+ * @param[in] id Id to look up | PE_RESOURCE_ANY for the first entry, named or not
+ * @param[out] entry Receives the entry
+ * @return true if the id is in the directory
+ */
+bool peFindResourceEntry(const PE_RESOURCE_DIRECTORY *directory, uint32_t id, PPE_RESOURCE_ENTRY entry);
+
+/**
+ * @brief Reads the data entry a leaf points at
+ *
+ * @param[in] resources Resource directory
+ * @param[in] entry Entry that is not a directory
+ * @param[out] data Receives the data
+ * @return true if the data entry and all of the data are within the file
+ */
+bool peResourceData(PCPE_RESOURCES resources, const PE_RESOURCE_ENTRY *entry, PPE_RESOURCE_DATA data);
+
+/**
+ * @brief Looks up a resource by type, name and language ids, as FindResourceEx does for ids
+ * @remark Only the three directories on the path are read
+ *
+ * @param[in] resources Resource directory
+ * @param[in] type RT_* or other type id
+ * @param[in] name Name id | PE_RESOURCE_ANY
+ * @param[in] language Language id | PE_RESOURCE_ANY
+ * @param[out] data Receives the data
+ * @return true if the resource exists and is within the file
+ */
+bool peFindResource(PCPE_RESOURCES resources, uint32_t type, uint32_t name, uint32_t language, PPE_RESOURCE_DATA data);
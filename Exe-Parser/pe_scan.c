@@ -0,0 +1,709 @@
+/**
+ * @file pe_scan.c
+ * @brief Corpus scanner over a work-stealing pool of parser threads
+ * @date 2026-10-16
+ *
+ * Every thread owns a deque of tasks, a directory to list or a file to parse. Listing a directory
+ * pushes its entries onto the lister's own deque; a thread takes its newest task first and, when
+ * its deque is empty, steals the oldest task of another thread, which is the one most likely to be
+ * a directory holding more work. A count of pending tasks ends the scan when it drops to 0.
+ *
+ * Records are formatted into a per-thread buffer that goes to the output stream in one write when
+ * full, so threads only meet on the stream lock once per buffer. A file that cannot be mapped or
+ * parsed gets a record with the error; the parsers are bounds checked, so no input stops the scan.
+ * A write to the stream that fails does, once every thread is done, failing the scan.
+ *
+ * A thread that finds no task while others still have some yields for a while, then sleeps a
+ * millisecond between looks, so the tail of a scan does not keep idle processors busy.
+ *
+ * For columnar output every thread adds its rows to its own builder instead, next to a per-thread
+ * index of the imports, and the builders and indexes are merged and written once all threads are
+ * done, so the whole corpus is held in memory until then. Import queries keep the rows and indexes
+ * the same way; once all threads are done each index is queried and only the rows of the files
+ * matching go out.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+
+#include "pe_scan.h"
+#include "pe_clock.h"
+#include "pe_imports.h"
+#include "pe_exports.h"
+#include "pe_columns.h"
+#include "pe_index.h"
+#include "mapfile.h"
+#include "platform.h"
+
+
+//*********************************************************************************
+// DECLARATIONS
+//*********************************************************************************
+
+// bytes of records a thread collects before writing them out
+#define SCAN_BUFFER_SIZE (1u << 20)
+
+// tasks a deque holds before it first grows
+#define SCAN_DEQUE_SIZE 256
+
+// times an idle thread yields before it sleeps between looks for work, and how long it sleeps
+#define SCAN_IDLE_YIELDS 64
+#define SCAN_IDLE_SLEEP_MS 1
+
+/**
+ * @brief a directory to list or a file to parse
+ */
+typedef struct _SCAN_TASK {
+    char    *path;
+    bool    directory;
+} SCAN_TASK, *PSCAN_TASK;
+
+/**
+ * @brief tasks of one thread, a ring: the owner pushes and pops at the tail, thieves take the head
+ */
+typedef struct _SCAN_DEQUE {
+    PLOCK       lock;
+    SCAN_TASK   *tasks;
+    size_t      capacity;
+    size_t      head;
+    size_t      count;
+} SCAN_DEQUE, *PSCAN_DEQUE;
+
+typedef struct _SCAN SCAN, *PSCAN;
+
+/**
+ * @brief state of one parser thread
+ */
+typedef struct _SCAN_WORKER {
+    PSCAN               scan;
+    SCAN_DEQUE          deque;
+    char                *buffer;        // records not written yet
+    size_t              used;
+    PE_COLUMNS_BUILDER  builder;        // rows of columnar output, or of the files indexed
+    PE_IMPORT_INDEX     index;          // imports of the rows, with columns or import queries, samples are row numbers
+    bool                failed;         // a row did not fit in memory
+    int                 writeError;     // errno of the first write to the stream that failed, else 0
+    PE_DIRECTORY_TIMES  times;
+    uint64_t            files;
+    uint64_t            errors;
+    uint64_t            bytes;
+} SCAN_WORKER, *PSCAN_WORKER;
+
+/**
+ * @brief state shared by the threads of a scan
+ */
+struct _SCAN {
+    PSCAN_WORKER        workers;
+    unsigned            count;
+    volatile int64_t    pending;        // tasks pushed and not finished
+    FILE                *stream;
+    PLOCK               streamLock;
+    PE_SCAN_FORMAT      format;
+    PCPE_IMPORT_QUERY   queries;
+    unsigned            queryCount;
+    bool                timed;
+};
+
+/**
+ * @brief where the entries of a directory being listed go
+ */
+typedef struct _LIST_CONTEXT {
+    PSCAN_WORKER    worker;
+    const char      *parent;
+    size_t          parentLength;
+} LIST_CONTEXT, *PLIST_CONTEXT;
+
+/**
+ * @brief Takes tasks until there are none left anywhere, then writes out the buffer
+ */
+static void scanWorker(void *context, unsigned index);
+
+/**
+ * @brief Lists a directory onto the worker's deque or parses a file into a record
+ */
+static void runTask(PSCAN_WORKER worker, const SCAN_TASK *task);
+
+/**
+ * @brief Pushes a task for an entry of the directory being listed
+ */
+static void listEntry(void *context, const char *name, ENTRY_KIND kind);
+
+/**
+ * @brief Maps and parses one file, and appends its record
+ */
+static void scanFile(PSCAN_WORKER worker, const char *path);
+
+/**
+ * @brief Adds the sections of an image to the worker's builder, columnar output only
+ */
+static void addSections(PSCAN_WORKER worker, PCPE_VIEW view);
+
+/**
+ * @brief Appends the record of a file that could not be parsed, or of a directory that could not be listed
+ */
+static void appendError(PSCAN_WORKER worker, const char *path, uint64_t size, const char *format, ...);
+
+/**
+ * @brief Adds the row to the worker's builder with columnar output or import queries, else appends its record
+ */
+static void appendRow(PSCAN_WORKER worker, PCPE_FILE_ROW row);
+
+/**
+ * @brief Appends a record to the worker's buffer, writing the buffer out first if it is full
+ */
+static void appendRecord(PSCAN_WORKER worker, PCPE_FILE_ROW row);
+
+/**
+ * @brief Merges the builders and indexes of all workers into the first and writes them to the stream
+ *
+ * @return 0 = SUCCESS | -1 = ERROR (errno set)
+ */
+static int writeColumns(PSCAN scan);
+
+/**
+ * @brief Queries the index of every worker and writes the records of the files importing all queries
+ *
+ * @return 0 = SUCCESS | -1 = ERROR (errno set)
+ */
+static int writeMatches(PSCAN scan);
+
+/**
+ * @brief Writes the worker's buffer to the stream
+ */
+static void flushWorker(PSCAN_WORKER worker);
+
+/**
+ * @brief Writes records to the stream under its lock, keeping the first error in the worker
+ */
+static void writeRecords(PSCAN_WORKER worker, const char *records, size_t length);
+
+/**
+ * @brief Returns the errno of the first write that failed in any worker or on the stream | 0 if none did
+ */
+static int writeError(PSCAN scan);
+
+/**
+ * @brief Pushes a task at the tail of a deque, growing it if full
+ *
+ * @return true | false if out of memory
+ */
+static bool pushTask(PSCAN_DEQUE deque, SCAN_TASK task);
+
+/**
+ * @brief Pops the newest task of the owner's deque
+ */
+static bool popTask(PSCAN_DEQUE deque, PSCAN_TASK task);
+
+/**
+ * @brief Takes the oldest task of another thread's deque, trying each in turn
+ */
+static bool stealTask(PSCAN scan, unsigned thief, PSCAN_TASK task);
+
+/**
+ * @brief Returns a new string of parent, the path separator and name | NULL if out of memory
+ */
+static char *joinPath(const char *parent, size_t parentLength, const char *name);
+
+
+//*********************************************************************************
+// DEFINITIONS
+//********************************************************************************
+
+int peScanDirectory(const char *root, unsigned threads, PE_SCAN_FORMAT format, PCPE_IMPORT_QUERY queries, unsigned queryCount,
+        FILE *stream, PPE_DIRECTORY_TIMES times, PPE_SCAN_STATS stats) {
+
+    memset(stats, 0, sizeof(*stats));
+    uint64_t start = peClock();
+    int result = -1;
+    if (queryCount > PE_SCAN_MAX_QUERIES || (queryCount && (!queries || format == PE_SCAN_COLUMNS))) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    SCAN scan = { 0 };
+    scan.count = threads ? threads : processorCount();
+    scan.stream = stream;
+    scan.format = format;
+    scan.queries = queries;
+    scan.queryCount = queryCount;
+    scan.timed = times != NULL;
+    scan.streamLock = createLock();
+    scan.workers = calloc(scan.count, sizeof(*scan.workers));
+    if (!scan.streamLock || !scan.workers) {
+        errno = ENOMEM;
+        goto cleanup;
+    }
+    for (unsigned idx = 0; idx < scan.count; idx++) {
+        PSCAN_WORKER worker = &scan.workers[idx];
+        worker->scan = &scan;
+        worker->deque.lock = createLock();
+        worker->buffer = malloc(SCAN_BUFFER_SIZE);
+        bool rows = format == PE_SCAN_COLUMNS || queryCount;
+        if (!worker->deque.lock || !worker->buffer || (rows && (peColumnsInit(&worker->builder) != 0 || peIndexInit(&worker->index) != 0))) {
+            errno = ENOMEM;
+            goto cleanup;
+        }
+    }
+
+    // the root is listed before the threads start, so a root that cannot be scanned fails the whole scan
+    LIST_CONTEXT list = { &scan.workers[0], root, strlen(root) };
+    if (listDirectory(root, listEntry, &list) != 0) {
+        goto cleanup;
+    }
+
+    if (format == PE_SCAN_PYTHON) {
+        fprintf(stream, "# Scan of '%s'\n", root);
+        fprintf(stream, "# " PE_ROW_FIELDS "\n");
+        fprintf(stream, "[\n");
+    }
+    stats->threads = runThreads(scan.count, scanWorker, &scan);
+    result = format == PE_SCAN_COLUMNS ? writeColumns(&scan) : queryCount ? writeMatches(&scan) : 0;
+    if (format == PE_SCAN_PYTHON) {
+        fprintf(stream, "]\n");
+    }
+    int failedWrite = result == 0 ? writeError(&scan) : 0;
+    if (failedWrite) {
+        errno = failedWrite;
+        result = -1;
+    }
+
+    cleanup:
+    for (unsigned idx = 0; scan.workers && idx < scan.count; idx++) {
+        PSCAN_WORKER worker = &scan.workers[idx];
+        stats->files += worker->files;
+        stats->errors += worker->errors;
+        stats->bytes += worker->bytes;
+        for (unsigned entry = 0; times && entry < IMAGE_NUMBEROF_DIRECTORY_ENTRIES; entry++) {
+            times->nanoseconds[entry] += worker->times.nanoseconds[entry];
+            times->items[entry] += worker->times.items[entry];
+        }
+        if (times) {
+            times->images += worker->times.images;
+            times->checksum += worker->times.checksum;
+        }
+
+        // tasks are left over only when the root failed to list part way, or setup failed
+        SCAN_TASK task;
+        while (worker->deque.lock && popTask(&worker->deque, &task)) {
+            free(task.path);
+        }
+        free(worker->deque.tasks);
+        destroyLock(worker->deque.lock);
+        free(worker->buffer);
+        peColumnsFree(&worker->builder);
+        peIndexFree(&worker->index);
+    }
+    int error = errno;
+    free(scan.workers);
+    destroyLock(scan.streamLock);
+    stats->nanoseconds = peClock() - start;
+    errno = error;
+    return result;
+}
+
+
+bool peParseImportQuery(char *text, PPE_IMPORT_QUERY query) {
+
+    // the text is cut only once the whole query parsed, so a bad one can still be reported
+    memset(query, 0, sizeof(*query));
+    char *separator = strpbrk(text, "!#");
+    if (!*text || separator == text) {
+        return false;
+    }
+    if (separator && *separator == '!') {
+        if (!separator[1]) {
+            return false;
+        }
+        query->function = separator + 1;
+    }
+    else if (separator) {
+        char *end = NULL;
+        unsigned long ordinal = strtoul(separator + 1, &end, 0);
+        if (separator[1] < '0' || separator[1] > '9' || *end || ordinal > UINT16_MAX) {
+            return false;
+        }
+        query->ordinal = (uint16_t) ordinal;
+        query->byOrdinal = true;
+    }
+    if (separator) {
+        *separator = '\0';
+    }
+    query->dll = text;
+    return true;
+}
+
+
+static void scanWorker(void *context, unsigned index) {
+
+    PSCAN scan = context;
+    PSCAN_WORKER worker = &scan->workers[index];
+    SCAN_TASK task;
+    unsigned idle = 0;
+    for (;;) {
+        if (popTask(&worker->deque, &task) || stealTask(scan, index, &task)) {
+            runTask(worker, &task);
+            free(task.path);
+            atomicAdd(&scan->pending, -1);
+            idle = 0;
+            continue;
+        }
+
+        // nothing to take: done once no task is pending, else another thread is still listing or
+        // parsing and may push more; a last large file can take a while, so stop spinning on it
+        if (atomicAdd(&scan->pending, 0) == 0) {
+            break;
+        }
+        if (idle < SCAN_IDLE_YIELDS) {
+            idle++;
+            yieldThread();
+        }
+        else {
+            sleepThread(SCAN_IDLE_SLEEP_MS);
+        }
+    }
+    flushWorker(worker);
+}
+
+
+static void runTask(PSCAN_WORKER worker, const SCAN_TASK *task) {
+
+    if (!task->directory) {
+        scanFile(worker, task->path);
+        return;
+    }
+    LIST_CONTEXT list = { worker, task->path, strlen(task->path) };
+    if (listDirectory(task->path, listEntry, &list) != 0) {
+        appendError(worker, task->path, 0, "cannot list directory, errno %d", errno);
+    }
+}
+
+
+static void listEntry(void *context, const char *name, ENTRY_KIND kind) {
+
+    PLIST_CONTEXT list = context;
+    SCAN_TASK task = { joinPath(list->parent, list->parentLength, name), kind == ENTRY_DIRECTORY };
+
+    // counted before it can be taken, so pending cannot reach 0 while it waits
+    atomicAdd(&list->worker->scan->pending, 1);
+    if (!task.path || !pushTask(&list->worker->deque, task)) {
+        atomicAdd(&list->worker->scan->pending, -1);
+        appendError(list->worker, list->parent, 0, "out of memory listing '%s'", name);
+        free(task.path);
+    }
+}
+
+
+static void scanFile(PSCAN_WORKER worker, const char *path) {
+
+    MAPPED_FILE file;
+    if (mapFile(path, &file) != 0) {
+        appendError(worker, path, 0, "cannot map file, errno %d", errno);
+        return;
+    }
+
+    PE_VIEW view;
+    PE_STATUS status;
+    if (file.size < sizeof(IMAGE_DOS_HEADER)) {
+        appendError(worker, path, file.size, "file is too small for a DOS header");
+    }
+    else if ((status = peOpen(&view, file.base, file.size)) != PE_OK) {
+        appendError(worker, path, file.size, "%s", peStatusString(status));
+    }
+    else if (!peMachineName(view.fileHeader.Machine)) {
+        appendError(worker, path, file.size, "unsupported Image Header Machine: %04X", view.fileHeader.Machine);
+    }
+    else {
+        // before the parse below reads the same directories, so the walks take the page faults
+        if (worker->scan->timed) {
+            peTimeDirectories(&view, &worker->times);
+        }
+
+        PE_FILE_ROW row = { .path = path, .fileSize = file.size };
+        peFileRowHeaders(&view, &row);
+        bool columns = worker->scan->format == PE_SCAN_COLUMNS;
+        if (columns) {
+            addSections(worker, &view);
+        }
+
+        PE_IMPORT_ITERATOR dllIt, functionIt;
+        PE_IMPORT_DLL dll;
+        PE_IMPORT import;
+        peImportDlls(&view, &dllIt);
+        while (peNextImportDll(&dllIt, &dll)) {
+            PE_DLL_ROW dllRow = { dll.name, 0 };
+            peImportFunctions(&view, &dll, &functionIt);
+            while (peNextImportFunction(&functionIt, &import)) {
+                dllRow.functions++;
+            }
+            row.importDlls++;
+            row.importFunctions += dllRow.functions;
+            if (columns && peColumnsAddDll(&worker->builder, &dllRow) != 0) {
+                worker->failed = true;
+            }
+        }
+        PE_EXPORTS exports;
+        row.exports = peOpenExports(&view, &exports) ? exports.numberOfNames : 0;
+
+        // the sample id of a file is the row it is about to get
+        uint32_t sample = (uint32_t) worker->builder.columns.rows[PE_TABLE_FILES];
+        if ((columns || worker->scan->queryCount) && peIndexAddImports(&worker->index, &view, sample) < 0) {
+            worker->failed = true;
+        }
+        appendRow(worker, &row);
+        worker->files++;
+        worker->bytes += file.size;
+    }
+    unmapFile(&file);
+}
+
+
+static void addSections(PSCAN_WORKER worker, PCPE_VIEW view) {
+
+    // names are not NUL terminated at 8 characters
+    char name[IMAGE_SIZEOF_SHORT_NAME + 1];
+    IMAGE_SECTION_HEADER section;
+    for (uint16_t idx = 0; idx < view->numberOfSections; idx++) {
+        peSection(view, idx, &section);
+        memcpy(name, section.Name, IMAGE_SIZEOF_SHORT_NAME);
+        name[IMAGE_SIZEOF_SHORT_NAME] = '\0';
+        PE_SECTION_ROW row = { name, section.Misc.VirtualSize, section.VirtualAddress, section.SizeOfRawData,
+            section.PointerToRawData, section.Characteristics };
+        if (peColumnsAddSection(&worker->builder, &row) != 0) {
+            worker->failed = true;
+        }
+    }
+}
+
+
+static void appendError(PSCAN_WORKER worker, const char *path, uint64_t size, const char *format, ...) {
+
+    char message[512];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+
+    PE_FILE_ROW row = { .path = path, .error = message, .fileSize = size };
+    appendRow(worker, &row);
+    worker->files++;
+    worker->errors++;
+}
+
+
+static void appendRow(PSCAN_WORKER worker, PCPE_FILE_ROW row) {
+
+    if (worker->scan->format == PE_SCAN_COLUMNS || worker->scan->queryCount) {
+        if (peColumnsAddFile(&worker->builder, row) != 0) {
+            worker->failed = true;
+        }
+        return;
+    }
+    appendRecord(worker, row);
+}
+
+
+static void appendRecord(PSCAN_WORKER worker, PCPE_FILE_ROW row) {
+
+    PSCAN scan = worker->scan;
+    PE_ROW_FORMAT format = scan->format == PE_SCAN_JSON ? PE_ROW_JSON : PE_ROW_PYTHON;
+    size_t length = peFormatFileRow(worker->buffer + worker->used, SCAN_BUFFER_SIZE - worker->used, row, format);
+    if (length < SCAN_BUFFER_SIZE - worker->used) {
+        worker->used += length;
+        return;
+    }
+
+    // did not fit: write out what is there and format again into the empty buffer, a record is
+    // at most a few times the length of its path
+    flushWorker(worker);
+    length = peFormatFileRow(worker->buffer, SCAN_BUFFER_SIZE, row, format);
+    if (length < SCAN_BUFFER_SIZE) {
+        worker->used = length;
+        return;
+    }
+
+    // longer than the whole buffer, such as a long error message: formatted on its own and written
+    // directly, or counted as an error if there is no memory for it
+    char *record = malloc(length + 1);
+    if (!record) {
+        worker->errors++;
+        return;
+    }
+    peFormatFileRow(record, length + 1, row, format);
+    writeRecords(worker, record, length);
+    free(record);
+}
+
+
+static void flushWorker(PSCAN_WORKER worker) {
+    writeRecords(worker, worker->buffer, worker->used);
+    worker->used = 0;
+}
+
+
+static void writeRecords(PSCAN_WORKER worker, const char *records, size_t length) {
+    if (!length) {
+        return;
+    }
+    acquireLock(worker->scan->streamLock);
+    errno = 0;
+    if (fwrite(records, 1, length, worker->scan->stream) != length && !worker->writeError) {
+        worker->writeError = errno ? errno : EIO;
+    }
+    releaseLock(worker->scan->streamLock);
+}
+
+
+static int writeError(PSCAN scan) {
+    for (unsigned idx = 0; idx < scan->count; idx++) {
+        if (scan->workers[idx].writeError) {
+            return scan->workers[idx].writeError;
+        }
+    }
+    // the prologue and epilogue, and whatever is still buffered, are checked on the stream
+    errno = 0;
+    if (fflush(scan->stream) != 0 || ferror(scan->stream)) {
+        return errno ? errno : EIO;
+    }
+    return 0;
+}
+
+
+static bool pushTask(PSCAN_DEQUE deque, SCAN_TASK task) {
+
+    acquireLock(deque->lock);
+    if (deque->count == deque->capacity) {
+        // unwrap the ring into a larger one
+        size_t capacity = deque->capacity ? 2 * deque->capacity : SCAN_DEQUE_SIZE;
+        SCAN_TASK *tasks = malloc(capacity * sizeof(*tasks));
+        if (!tasks) {
+            releaseLock(deque->lock);
+            return false;
+        }
+        for (size_t idx = 0; idx < deque->count; idx++) {
+            tasks[idx] = deque->tasks[(deque->head + idx) % deque->capacity];
+        }
+        free(deque->tasks);
+        deque->tasks = tasks;
+        deque->capacity = capacity;
+        deque->head = 0;
+    }
+    deque->tasks[(deque->head + deque->count) % deque->capacity] = task;
+    deque->count++;
+    releaseLock(deque->lock);
+    return true;
+}
+
+
+static bool popTask(PSCAN_DEQUE deque, PSCAN_TASK task) {
+
+    bool found = false;
+    acquireLock(deque->lock);
+    if (deque->count) {
+        deque->count--;
+        *task = deque->tasks[(deque->head + deque->count) % deque->capacity];
+        found = true;
+    }
+    releaseLock(deque->lock);
+    return found;
+}
+
+
+static bool stealTask(PSCAN scan, unsigned thief, PSCAN_TASK task) {
+
+    for (unsigned offset = 1; offset < scan->count; offset++) {
+        PSCAN_DEQUE deque = &scan->workers[(thief + offset) % scan->count].deque;
+        bool found = false;
+        acquireLock(deque->lock);
+        if (deque->count) {
+            *task = deque->tasks[deque->head];
+            deque->head = (deque->head + 1) % deque->capacity;
+            deque->count--;
+            found = true;
+        }
+        releaseLock(deque->lock);
+        if (found) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+static int writeColumns(PSCAN scan) {
+
+    // each worker's rows are freed once merged, so the corpus is not held twice; its samples follow
+    // the rows merged before them
+    PPE_COLUMNS_BUILDER merged = &scan->workers[0].builder;
+    PPE_IMPORT_INDEX index = &scan->workers[0].index;
+    bool failed = scan->workers[0].failed;
+    for (unsigned idx = 1; idx < scan->count; idx++) {
+        PSCAN_WORKER worker = &scan->workers[idx];
+        uint32_t sampleBase = (uint32_t) merged->columns.rows[PE_TABLE_FILES];
+        failed = failed || worker->failed || peColumnsAppend(merged, &worker->builder.columns) != 0
+            || peIndexAppend(index, &worker->index, sampleBase) != 0;
+        peColumnsFree(&worker->builder);
+        peIndexFree(&worker->index);
+    }
+    if (failed) {
+        errno = ENOMEM;
+        return -1;
+    }
+    return peColumnsWrite(merged, index, scan->stream);
+}
+
+
+static int writeMatches(PSCAN scan) {
+
+    for (unsigned idx = 0; idx < scan->count; idx++) {
+        if (scan->workers[idx].failed) {
+            errno = ENOMEM;
+            return -1;
+        }
+    }
+
+    // each index is queried on its own, its samples are the rows of the same worker
+    for (unsigned idx = 0; idx < scan->count; idx++) {
+        PSCAN_WORKER worker = &scan->workers[idx];
+        PCPE_COLUMNS columns = &worker->builder.columns;
+        uint64_t files = columns->rows[PE_TABLE_FILES];
+        uint8_t *hits = calloc(files ? files : 1, sizeof(*hits));
+        if (!hits) {
+            errno = ENOMEM;
+            return -1;
+        }
+        for (unsigned query = 0; query < scan->queryCount; query++) {
+            peIndexMatch(&worker->index, &scan->queries[query], hits, (uint8_t) query);
+        }
+        PE_FILE_ROW row;
+        for (uint64_t file = 0; file < files; file++) {
+            if (hits[file] == scan->queryCount) {
+                peColumnsFile(columns, file, &row);
+                appendRecord(worker, &row);
+            }
+        }
+        flushWorker(worker);
+        free(hits);
+    }
+    return 0;
+}
+
+
+static char *joinPath(const char *parent, size_t parentLength, const char *name) {
+
+    // a root given with a trailing separator, such as "/", already ends in one
+    size_t nameLength = strlen(name);
+    size_t separator = parentLength && parent[parentLength - 1] == PATH_SEPARATOR ? 0 : 1;
+    char *path = malloc(parentLength + separator + nameLength + 1);
+    if (path) {
+        memcpy(path, parent, parentLength);
+        path[parentLength] = PATH_SEPARATOR;
+        memcpy(path + parentLength + separator, name, nameLength + 1);
+    }
+    return path;
+}
@@ -0,0 +1,76 @@
+//-------------------------------------------------------------------------------------------------
+// pe_scan.h
+//
+// Corpus scanner: walks a directory tree on a pool of threads and writes one record per file, the
+// file's headers summarized as a python tuple, a JSON object or a row of columns. Files that fail to
+// map or parse get a record with the error instead of stopping the scan.
+//
+// Given import queries, a scan indexes the imports of every file instead (pe_index.h) and writes only
+// the records of the files importing all of them, once the whole tree is indexed:
+//
+//      kernel32.dll!VirtualAlloc   a function imported by name, the DLL in any case
+//      ws2_32.dll#23               a function imported by ordinal
+//      wininet.dll                 any function of the DLL
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "pe_timing.h"
+#include "pe_index.h"
+
+// most import queries of one scan
+#define PE_SCAN_MAX_QUERIES 16
+
+
+/**
+ * @brief output of a scan
+ */
+typedef enum _PE_SCAN_FORMAT {
+    PE_SCAN_PYTHON,     // a python list of tuples, with comments naming the fields
+    PE_SCAN_JSON,       // JSON Lines, an object per file
+    PE_SCAN_COLUMNS,    // a columns file of pe_columns.h, with sections, imported DLLs and the import index
+} PE_SCAN_FORMAT;
+
+/**
+ * @brief totals of a scan
+ */
+typedef struct _PE_SCAN_STATS {
+    uint64_t    files;          // files scanned, each with a record unless filtered by import queries
+    uint64_t    errors;         // records of files that could not be parsed, and directories that could not be listed
+    uint64_t    bytes;          // sizes of the files parsed
+    uint64_t    nanoseconds;    // wall time of the scan
+    unsigned    threads;        // threads the scan ran on
+} PE_SCAN_STATS, *PPE_SCAN_STATS;
+
+
+/**
+ * @brief Scans every regular file below a directory and writes a record per file, or per file importing all queries
+ * @remark Records come in no particular order. Links are not followed. Columns, and the records of
+ * import queries, are written once the scan is done, and held in memory until then.
+ *
+ * @param[in] root Directory to scan
+ * @param[in] threads Parser threads, 0 for one per logical processor
+ * @param[in] format Output format, python or JSON with import queries
+ * @param[in] queries Optional, imports a file needs all of to get a record
+ * @param[in] queryCount Number of queries, at most PE_SCAN_MAX_QUERIES, 0 for a record per file
+ * @param[in] stream Output stream for the records, in binary mode for columns
+ * @param[in,out] times Optional, per-directory decode times of all files are added to it
+ * @param[out] stats Receives the totals
+ * @return 0 = SUCCESS | -1 = ERROR, the root could not be scanned at all, the columns or the index did not fit in memory,
+ * or a write to the stream failed (the stream is flushed before returning)
+ */
+int peScanDirectory(const char *root, unsigned threads, PE_SCAN_FORMAT format, PCPE_IMPORT_QUERY queries, unsigned queryCount,
+    FILE *stream, PPE_DIRECTORY_TIMES times, PPE_SCAN_STATS stats);
+
+/**
+ * @brief Parses an import query: DLL!function, DLL#ordinal or DLL
+ * @remark The query points into text, which is cut at the separator once the query parsed
+ *
+ * @param[in,out] text Query from the command line
+ * @param[out] query Receives the query
+ * @return true | false if the DLL is empty, the function is empty or the ordinal is not a number up to 65535
+ */
+bool peParseImportQuery(char *text, PPE_IMPORT_QUERY query);
@@ -0,0 +1,46 @@
+//-------------------------------------------------------------------------------------------------
+// pe_timing.h
+//
+// Per-directory timing of the decoders: each directory of an image is walked completely and the
+// time and the number of items decoded are added to counters indexed by IMAGE_DIRECTORY_ENTRY_*,
+// so the counters of a whole corpus can be summed in one structure.
+//
+// The times include the page faults of a mapped image only where the walks are the first to read
+// its directories: pehdr and the scan time an image right after peOpen(), before they parse it.
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "pe_view.h"
+
+
+/**
+ * @brief time spent and items decoded per data directory, zero it before the first use
+ */
+typedef struct _PE_DIRECTORY_TIMES {
+    uint64_t    nanoseconds[IMAGE_NUMBEROF_DIRECTORY_ENTRIES];
+    uint64_t    items[IMAGE_NUMBEROF_DIRECTORY_ENTRIES];    // exports, imported functions, relocations, callbacks, guard entries, resources
+    uint64_t    images;                                     // images timed
+    uint64_t    checksum;                                   // folded from every item, so the walks are not optimized away
+} PE_DIRECTORY_TIMES, *PPE_DIRECTORY_TIMES;
+
+
+/**
+ * @brief Walks the export, import, base relocation, TLS, load config and resource directories of an image
+ * and adds the time and the items of each to the counters
+ * @remark Call it before anything else reads the directories, or it times pages already faulted in
+ *
+ * @param[in] view Validated image
+ * @param[in,out] times Counters to add to
+ */
+void peTimeDirectories(PCPE_VIEW view, PPE_DIRECTORY_TIMES times);
+
+/**
+ * @brief Prints the counters of the directories that were walked as python comments
+ *
+ * @param[in] stream Output stream
+ * @param[in] times Counters
+ */
+void printDirectoryTimes(FILE *stream, const PE_DIRECTORY_TIMES *times);
@@ -0,0 +1,55 @@
+//-------------------------------------------------------------------------------------------------
+// pe_traits.h
+//
+// Header traits for the two image widths, PE32 and PE32+. Code that depends on the width is
+// written once in a template file that uses the names below, and included once per width with
+// PE_BITS defined as 32 or 64:
+//
+//      #define PE_BITS 32
+//      #include "pe_view_tmpl.h"
+//      #undef PE_BITS
+//
+// The names only expand where they are used, so the template sees the PE_BITS of its inclusion.
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+#include <stdint.h>
+
+#include "pehdr.h"
+
+
+#define PE_CONCAT_(a, b)                a##b
+#define PE_CONCAT(a, b)                 PE_CONCAT_(a, b)
+
+// width suffixed function name, e.g. PE_FN(printOptionalHeader) is printOptionalHeader32
+#define PE_FN(name)                     PE_CONCAT(name, PE_BITS)
+
+// IMAGE_NT_HEADERS32 / IMAGE_NT_HEADERS64
+#define PE_NT_HEADERS                   PE_CONCAT(IMAGE_NT_HEADERS, PE_BITS)
+
+// ntHeaders32 / ntHeaders64, the copy of the NT headers in a PE_VIEW
+#define PE_VIEW_NT_HEADERS              PE_CONCAT(ntHeaders, PE_BITS)
+
+// IMAGE_OPTIONAL_HEADER32 / IMAGE_OPTIONAL_HEADER64
+#define PE_OPTIONAL_HEADER              PE_CONCAT(IMAGE_OPTIONAL_HEADER, PE_BITS)
+
+// IMAGE_NT_OPTIONAL_HDR32_MAGIC / IMAGE_NT_OPTIONAL_HDR64_MAGIC
+#define PE_OPTIONAL_HEADER_MAGIC        PE_CONCAT(PE_CONCAT(IMAGE_NT_OPTIONAL_HDR, PE_BITS), _MAGIC)
+
+// bytes of the optional header before its data directories
+#define PE_OPTIONAL_HEADER_FIXED_SIZE   FIELD_OFFSET(PE_OPTIONAL_HEADER, DataDirectory)
+
+// hex digits of a virtual address (ImageBase, pointers in the image)
+#define PE_VA_DIGITS                    (PE_BITS / 4)
+
+// uint32_t / uint64_t, an import thunk or a pointer stored in the image
+#define PE_THUNK                        PE_CONCAT(PE_CONCAT(uint, PE_BITS), _t)
+
+// IMAGE_ORDINAL_FLAG32 / IMAGE_ORDINAL_FLAG64, set in a thunk that imports by ordinal
+#define PE_ORDINAL_FLAG                 PE_CONCAT(IMAGE_ORDINAL_FLAG, PE_BITS)
+
+// IMAGE_TLS_DIRECTORY32 / IMAGE_TLS_DIRECTORY64
+#define PE_TLS_DIRECTORY                PE_CONCAT(IMAGE_TLS_DIRECTORY, PE_BITS)
+
+// IMAGE_LOAD_CONFIG_DIRECTORY32 / IMAGE_LOAD_CONFIG_DIRECTORY64
+#define PE_LOAD_CONFIG_DIRECTORY        PE_CONCAT(IMAGE_LOAD_CONFIG_DIRECTORY, PE_BITS)
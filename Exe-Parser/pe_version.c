@@ -0,0 +1,253 @@
+/**
+ * @file pe_version.c
+ * @brief Version information of a PE view
+ * @date 2026-10-16
+ *
+ * VS_VERSIONINFO is a tree of blocks, each a length, a value length, a type, a UTF-16 key and the
+ * value, with children filling the rest of the length. Blocks start 4-byte aligned from the start
+ * of the resource. Every block is checked to lie within its parent, the resource within the file.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "pe_version.h"
+
+
+//*********************************************************************************
+// DECLARATIONS
+//*********************************************************************************
+
+/**
+ * @brief a decoded version block
+ */
+typedef struct _VERSION_BLOCK {
+    const uint16_t  *key;
+    uint32_t        keyLength;      // UTF-16 units
+    const uint8_t   *value;
+    uint32_t        valueSize;      // bytes
+    const uint8_t   *children;
+    uint32_t        childrenSize;
+    uint32_t        size;           // bytes to the next sibling, padding included
+} VERSION_BLOCK, *PVERSION_BLOCK;
+
+// wType of a block whose value is text, its wValueLength then counts UTF-16 units
+#define VERSION_TEXT 1
+
+/**
+ * @brief Decodes the block at data
+ *
+ * @param[in] available Bytes of the parent after data
+ * @return true if the block and its key are within available
+ */
+static bool readBlock(const uint8_t *data, uint32_t available, PVERSION_BLOCK block);
+
+/**
+ * @brief Returns true if a UTF-16 key equals an ASCII key
+ */
+static bool keyIs(const uint16_t *key, uint32_t keyLength, const char *ascii);
+
+/**
+ * @brief Returns the 16-bit little endian value at data, which need not be aligned
+ */
+static inline uint32_t read16(const uint8_t *data);
+
+/**
+ * @brief Rounds an offset up to the next multiple of 4
+ */
+static inline uint32_t align4(uint32_t offset);
+
+
+//*********************************************************************************
+// DEFINITIONS
+//********************************************************************************
+
+bool peOpenVersionInfo(PCPE_RESOURCES resources, PPE_VERSION_INFO info) {
+
+    memset(info, 0, sizeof(*info));
+    PE_RESOURCE_DATA data;
+    VERSION_BLOCK root;
+    if (!peFindResource(resources, RT_VERSION, PE_RESOURCE_ANY, PE_RESOURCE_ANY, &data)
+            || !readBlock(data.data, data.size, &root) || !keyIs(root.key, root.keyLength, "VS_VERSION_INFO")) {
+        return false;
+    }
+    info->rva = data.rva;
+    info->size = data.size;
+    if (root.valueSize >= sizeof(VS_FIXEDFILEINFO) && peRead32(root.value) == VS_FFI_SIGNATURE) {
+        memcpy(&info->fixed, root.value, sizeof(info->fixed));
+        info->hasFixed = true;
+    }
+
+    // StringFileInfo and VarFileInfo may come in either order, the strings are in the first table
+    VERSION_BLOCK child, table;
+    for (uint32_t offset = 0; offset < root.childrenSize && readBlock(root.children + offset, root.childrenSize - offset, &child); offset += child.size) {
+        if (keyIs(child.key, child.keyLength, "StringFileInfo") && readBlock(child.children, child.childrenSize, &table)) {
+            info->strings = table.children;
+            info->stringsSize = table.childrenSize;
+            peUtf16ToUtf8(table.key, table.keyLength, info->language, sizeof(info->language));
+            break;
+        }
+    }
+    return true;
+}
+
+
+void peVersionStrings(const PE_VERSION_INFO *info, PPE_VERSION_ITERATOR it) {
+    it->next = info->strings;
+    it->remaining = info->strings ? info->stringsSize : 0;
+}
+
+
+bool peNextVersionString(PPE_VERSION_ITERATOR it, PPE_VERSION_STRING string) {
+
+    VERSION_BLOCK block;
+    if (!it->remaining || !readBlock(it->next, it->remaining, &block)) {
+        it->remaining = 0;
+        return false;
+    }
+    string->key = block.key;
+    string->keyLength = block.keyLength;
+    string->value = (const uint16_t *) block.value;
+    string->valueLength = block.valueSize / sizeof(uint16_t);
+
+    // the value length usually counts the terminator, sometimes padding too
+    while (string->valueLength && !read16(block.value + (string->valueLength - 1) * sizeof(uint16_t))) {
+        string->valueLength--;
+    }
+
+    it->next += block.size;
+    it->remaining -= block.size;
+    return true;
+}
+
+
+bool peVersionString(const PE_VERSION_INFO *info, const char *key, PPE_VERSION_STRING string) {
+    PE_VERSION_ITERATOR it;
+    peVersionStrings(info, &it);
+    while (peNextVersionString(&it, string)) {
+        if (keyIs(string->key, string->keyLength, key)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+size_t peUtf16ToUtf8(const uint16_t *text, uint32_t length, char *buffer, size_t size) {
+
+    size_t used = 0;
+    for (uint32_t idx = 0; idx < length; idx++) {
+        uint32_t code = read16((const uint8_t *) &text[idx]);
+        if (code >= 0xd800 && code < 0xdc00 && idx + 1 < length) {
+            uint32_t low = read16((const uint8_t *) &text[idx + 1]);
+            if (low >= 0xdc00 && low < 0xe000) {
+                code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+                idx++;
+            }
+        }
+        if (code >= 0xd800 && code < 0xe000) {
+            code = 0xfffd;
+        }
+
+        char bytes[4];
+        size_t count;
+        if (code < 0x80) {
+            bytes[0] = (char) code;
+            count = 1;
+        }
+        else if (code < 0x800) {
+            bytes[0] = (char) (0xc0 | code >> 6);
+            bytes[1] = (char) (0x80 | (code & 0x3f));
+            count = 2;
+        }
+        else if (code < 0x10000) {
+            bytes[0] = (char) (0xe0 | code >> 12);
+            bytes[1] = (char) (0x80 | (code >> 6 & 0x3f));
+            bytes[2] = (char) (0x80 | (code & 0x3f));
+            count = 3;
+        }
+        else {
+            bytes[0] = (char) (0xf0 | code >> 18);
+            bytes[1] = (char) (0x80 | (code >> 12 & 0x3f));
+            bytes[2] = (char) (0x80 | (code >> 6 & 0x3f));
+            bytes[3] = (char) (0x80 | (code & 0x3f));
+            count = 4;
+        }
+        if (used + count >= size) {
+            break;
+        }
+        memcpy(buffer + used, bytes, count);
+        used += count;
+    }
+    buffer[used] = '\0';
+    return used;
+}
+
+
+static bool readBlock(const uint8_t *data, uint32_t available, PVERSION_BLOCK block) {
+
+    // wLength, wValueLength, wType, then the key
+    const uint32_t HEADER_SIZE = 3 * sizeof(uint16_t);
+    if (available < HEADER_SIZE) {
+        return false;
+    }
+    uint32_t length = read16(data);
+    uint32_t valueLength = read16(data + 2);
+    uint32_t type = read16(data + 4);
+    if (length < HEADER_SIZE || length > available) {
+        return false;
+    }
+
+    // the key is NUL terminated within the block
+    block->key = (const uint16_t *) (data + HEADER_SIZE);
+    uint32_t keyEnd = HEADER_SIZE;
+    while (keyEnd + sizeof(uint16_t) <= length && read16(data + keyEnd)) {
+        keyEnd += sizeof(uint16_t);
+    }
+    if (keyEnd + sizeof(uint16_t) > length) {
+        return false;
+    }
+    block->keyLength = (keyEnd - HEADER_SIZE) / sizeof(uint16_t);
+
+    // a value running past the block is cut to it
+    uint32_t valueOffset = align4(keyEnd + sizeof(uint16_t));
+    uint32_t valueSize = type == VERSION_TEXT ? valueLength * sizeof(uint16_t) : valueLength;
+    if (valueOffset > length) {
+        valueOffset = length;
+    }
+    if (valueSize > length - valueOffset) {
+        valueSize = length - valueOffset;
+    }
+    block->value = data + valueOffset;
+    block->valueSize = valueSize;
+
+    uint32_t childrenOffset = align4(valueOffset + valueSize);
+    block->children = data + childrenOffset;
+    block->childrenSize = childrenOffset < length ? length - childrenOffset : 0;
+
+    // the padding after the last block of a parent may be missing
+    block->size = align4(length) < available ? align4(length) : available;
+    return true;
+}
+
+
+static bool keyIs(const uint16_t *key, uint32_t keyLength, const char *ascii) {
+    for (uint32_t idx = 0; idx < keyLength; idx++, ascii++) {
+        if (!*ascii || read16((const uint8_t *) &key[idx]) != (uint8_t) *ascii) {
+            return false;
+        }
+    }
+    return !*ascii;
+}
+
+
+static inline uint32_t read16(const uint8_t *data) {
+    return (uint32_t) data[0] | (uint32_t) data[1] << 8;
+}
+
+
+static inline uint32_t align4(uint32_t offset) {
+    return (offset + 3) & ~3u;
+}
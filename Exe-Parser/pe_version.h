@@ -0,0 +1,95 @@
+//-------------------------------------------------------------------------------------------------
+// pe_version.h
+//
+// Version information of a PE view: the VS_VERSIONINFO resource, its VS_FIXEDFILEINFO and the
+// strings of its first string table, such as FileVersion or ProductName. Found through the lazy
+// resource walker, so only the version resource and the directories leading to it are read.
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "pe_resources.h"
+
+
+/**
+ * @brief the version information of an image, filled by peOpenVersionInfo()
+ */
+typedef struct _PE_VERSION_INFO {
+    uint32_t            rva;            // VS_VERSIONINFO resource
+    uint32_t            size;
+    VS_FIXEDFILEINFO    fixed;          // copied out of the resource, which need not be aligned for it
+    bool                hasFixed;       // false if absent or without VS_FFI_SIGNATURE, fixed is then all 0
+    const uint8_t       *strings;       // String blocks of the first StringTable, in the image
+    uint32_t            stringsSize;
+    char                language[9];    // key of that table, language and code page in hex, e.g. "040904B0"
+} PE_VERSION_INFO, *PPE_VERSION_INFO;
+
+/**
+ * @brief one string of the string table
+ */
+typedef struct _PE_VERSION_STRING {
+    const uint16_t  *key;           // UTF-16, not NUL terminated
+    uint32_t        keyLength;      // UTF-16 units
+    const uint16_t  *value;         // UTF-16, not NUL terminated
+    uint32_t        valueLength;    // UTF-16 units
+} PE_VERSION_STRING, *PPE_VERSION_STRING;
+
+/**
+ * @brief position in the string table
+ */
+typedef struct _PE_VERSION_ITERATOR {
+    const uint8_t   *next;
+    uint32_t        remaining;      // bytes after next
+} PE_VERSION_ITERATOR, *PPE_VERSION_ITERATOR;
+
+
+/**
+ * @brief Reads the first RT_VERSION resource of an image
+ *
+ * @param[in] resources Resource directory
+ * @param[out] info Receives the version information
+ * @return true if the image has a VS_VERSIONINFO resource within the file
+ */
+bool peOpenVersionInfo(PCPE_RESOURCES resources, PPE_VERSION_INFO info);
+
+/**
+ * @brief Starts a walk over the strings of the string table
+ *
+ * @param[in] info Version information read by peOpenVersionInfo()
+ * @param[out] it Iterator to start
+ */
+void peVersionStrings(const PE_VERSION_INFO *info, PPE_VERSION_ITERATOR it);
+
+/**
+ * @brief Returns the next string of the string table
+ *
+ * @param[in,out] it Iterator started by peVersionStrings()
+ * @param[out] string Receives the key and the value
+ * @return true if a string was returned | false at the end of the table or at a malformed block
+ */
+bool peNextVersionString(PPE_VERSION_ITERATOR it, PPE_VERSION_STRING string);
+
+/**
+ * @brief Looks up a string by key, e.g. "FileVersion"
+ *
+ * @param[in] info Version information read by peOpenVersionInfo()
+ * @param[in] key ASCII key, compared exactly
+ * @param[out] string Receives the key and the value
+ * @return true if the key is in the string table
+ */
+bool peVersionString(const PE_VERSION_INFO *info, const char *key, PPE_VERSION_STRING string);
+
+/**
+ * @brief Converts UTF-16 text of the image to NUL terminated UTF-8
+ * @remark Unpaired surrogates become U+FFFD, the text is cut at a character boundary to fit
+ *
+ * @param[in] text UTF-16 text
+ * @param[in] length UTF-16 units
+ * @param[out] buffer Receives the UTF-8 text
+ * @param[in] size Size of buffer in bytes, at least 1
+ * @return Bytes written without the terminator
+ */
+size_t peUtf16ToUtf8(const uint16_t *text, uint32_t length, char *buffer, size_t size);
@@ -0,0 +1,320 @@
+/**
+ * @file pe_view.c
+ * @brief Bounds-checked, read-only view over a PE image in memory
+ * @date 2026-10-16
+ *
+ * peOpen() checks every header against the size of the image once, so the accessors only have to
+ * check the ranges they are asked for. All arithmetic is done in 64 bits, so offsets and sizes taken
+ * from the file cannot wrap around. The headers are copied into the view, and section headers are
+ * read a field at a time, so no offset the file gives has to be aligned.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "pe_view.h"
+#include "pe_traits.h"
+
+
+//*********************************************************************************
+// DECLARATIONS
+//*********************************************************************************
+
+// offset of the optional header in the NT headers, the same for both widths
+#define OPTIONAL_HEADER_OFFSET FIELD_OFFSET(IMAGE_NT_HEADERS64, OptionalHeader)
+
+/**
+ * @brief Returns true if length bytes at offset lie within the image
+ */
+static inline bool inImage(PCPE_VIEW view, uint64_t offset, uint64_t length);
+
+/**
+ * @brief Returns the index of the section whose virtual range holds an RVA | -1 if there is none
+ */
+static int findSection(PCPE_VIEW view, uint32_t rva);
+
+// openOptionalHeader32() and openOptionalHeader64()
+#define PE_BITS 32
+#include "pe_view_tmpl.h"
+#undef PE_BITS
+
+#define PE_BITS 64
+#include "pe_view_tmpl.h"
+#undef PE_BITS
+
+
+//*********************************************************************************
+// DEFINITIONS
+//********************************************************************************
+
+static const char *STATUS_STRINGS[PE_STATUS_COUNT] = {
+    [PE_OK]                     = "valid image",
+    [PE_ERROR_DOS_HEADER]       = "file is too small for a DOS header",
+    [PE_ERROR_DOS_SIGNATURE]    = "DOS signature (MZ) missing",
+    [PE_ERROR_NT_OFFSET]        = "e_lfanew points outside the file",
+    [PE_ERROR_NT_SIGNATURE]     = "NT signature (PE00) missing",
+    [PE_ERROR_OPTIONAL_HEADER]  = "optional header truncated or of unknown magic",
+    [PE_ERROR_SECTIONS]         = "section table runs past the end of the file",
+};
+
+static const struct {
+    uint16_t machine;
+    const char *name;
+} MACHINES[] = {
+    { IMAGE_FILE_MACHINE_I386,      "I386" },
+    { IMAGE_FILE_MACHINE_AMD64,     "AMD64" },
+    { IMAGE_FILE_MACHINE_ARMNT,     "ARMNT" },
+    { IMAGE_FILE_MACHINE_ARM64,     "ARM64" },
+    { IMAGE_FILE_MACHINE_ARM64EC,   "ARM64EC" },
+    { IMAGE_FILE_MACHINE_ARM64X,    "ARM64X" },
+};
+
+
+PE_STATUS peOpen(PPE_VIEW view, const uint8_t *base, uint64_t size) {
+
+    memset(view, 0, sizeof(*view));
+    view->base = base;
+    view->size = size;
+
+    // DOS header and signature
+    if (!base || size < sizeof(IMAGE_DOS_HEADER)) {
+        return PE_ERROR_DOS_HEADER;
+    }
+    memcpy(&view->dosHeader, base, sizeof(view->dosHeader));
+    if (view->dosHeader.e_magic != IMAGE_DOS_SIGNATURE) {
+        return PE_ERROR_DOS_SIGNATURE;
+    }
+
+    // e_lfanew is signed, the signature and file header have to follow it within the file, at any alignment
+    uint64_t ntOffset = (uint64_t) (uint32_t) view->dosHeader.e_lfanew;
+    if (view->dosHeader.e_lfanew < 0 || !inImage(view, ntOffset, OPTIONAL_HEADER_OFFSET)) {
+        return PE_ERROR_NT_OFFSET;
+    }
+    const uint8_t *ntHeaders = base + ntOffset;
+    if (peRead32(ntHeaders) != IMAGE_NT_SIGNATURE) {
+        return PE_ERROR_NT_SIGNATURE;
+    }
+    view->ntOffset = ntOffset;
+    memcpy(&view->fileHeader, ntHeaders + FIELD_OFFSET(IMAGE_NT_HEADERS64, FileHeader), sizeof(view->fileHeader));
+
+    // the whole optional header has to be in the file, its magic selects the width
+    uint64_t optionalOffset = ntOffset + OPTIONAL_HEADER_OFFSET;
+    uint16_t optionalSize = view->fileHeader.SizeOfOptionalHeader;
+    if (optionalSize < sizeof(uint16_t) || !inImage(view, optionalOffset, optionalSize)) {
+        return PE_ERROR_OPTIONAL_HEADER;
+    }
+    PE_STATUS status;
+    switch (peRead16(base + optionalOffset)) {
+        case IMAGE_NT_OPTIONAL_HDR32_MAGIC:
+            status = openOptionalHeader32(view, ntHeaders);
+            break;
+        case IMAGE_NT_OPTIONAL_HDR64_MAGIC:
+            status = openOptionalHeader64(view, ntHeaders);
+            break;
+        default:
+            status = PE_ERROR_OPTIONAL_HEADER;
+            break;
+    }
+    if (status != PE_OK) {
+        return status;
+    }
+
+    // the section table follows the optional header, as long as SizeOfOptionalHeader says
+    uint64_t sectionOffset = optionalOffset + optionalSize;
+    uint16_t numberOfSections = view->fileHeader.NumberOfSections;
+    if (!inImage(view, sectionOffset, (uint64_t) numberOfSections * sizeof(IMAGE_SECTION_HEADER))) {
+        return PE_ERROR_SECTIONS;
+    }
+    view->sectionOffset = sectionOffset;
+    view->numberOfSections = numberOfSections;
+    return PE_OK;
+}
+
+
+const char *peStatusString(PE_STATUS status) {
+    return (unsigned) status < PE_STATUS_COUNT ? STATUS_STRINGS[status] : "unknown status";
+}
+
+
+const char *peMachineName(uint16_t machine) {
+    for (size_t idx = 0; idx < sizeof(MACHINES) / sizeof(MACHINES[0]); idx++) {
+        if (MACHINES[idx].machine == machine) {
+            return MACHINES[idx].name;
+        }
+    }
+    return NULL;
+}
+
+
+const void *peFilePointer(PCPE_VIEW view, uint64_t offset, uint64_t length) {
+    return inImage(view, offset, length) ? view->base + offset : NULL;
+}
+
+
+void peSection(PCPE_VIEW view, uint16_t index, PIMAGE_SECTION_HEADER section) {
+    memcpy(section, view->base + view->sectionOffset + (uint64_t) index * sizeof(*section), sizeof(*section));
+}
+
+
+bool peSectionByName(PCPE_VIEW view, const char *name, PIMAGE_SECTION_HEADER section) {
+    for (uint16_t idx = 0; idx < view->numberOfSections; idx++) {
+        const uint8_t *header = view->base + view->sectionOffset + (uint64_t) idx * sizeof(IMAGE_SECTION_HEADER);
+        if (!strncmp((const char *) header + FIELD_OFFSET(IMAGE_SECTION_HEADER, Name), name, IMAGE_SIZEOF_SHORT_NAME)) {
+            peSection(view, idx, section);
+            return true;
+        }
+    }
+    return false;
+}
+
+
+bool peSectionByRva(PCPE_VIEW view, uint32_t rva, PIMAGE_SECTION_HEADER section) {
+    int index = findSection(view, rva);
+    if (index < 0) {
+        return false;
+    }
+    peSection(view, (uint16_t) index, section);
+    return true;
+}
+
+
+bool peRvaToOffset(PCPE_VIEW view, uint32_t rva, uint32_t length, uint64_t *offset) {
+
+    // the headers are mapped at RVA 0 as they are in the file
+    if ((uint64_t) rva + length <= view->sizeOfHeaders) {
+        *offset = rva;
+        return inImage(view, rva, length);
+    }
+
+    IMAGE_SECTION_HEADER section;
+    if (!peSectionByRva(view, rva, &section)) {
+        return false;
+    }
+    uint64_t delta = rva - section.VirtualAddress;
+    if (delta + length > section.SizeOfRawData) {
+        return false;       // the tail of the section is zero fill, not in the file
+    }
+    *offset = section.PointerToRawData + delta;
+    return inImage(view, *offset, length);
+}
+
+
+bool peVaToRva(PCPE_VIEW view, uint64_t va, uint32_t *rva) {
+    if (va < view->imageBase || va - view->imageBase > UINT32_MAX) {
+        return false;
+    }
+    *rva = (uint32_t) (va - view->imageBase);
+    return true;
+}
+
+
+const void *peRvaPointer(PCPE_VIEW view, uint32_t rva, uint32_t length) {
+    uint64_t offset;
+    return peRvaToOffset(view, rva, length, &offset) ? view->base + offset : NULL;
+}
+
+
+bool peRvaCopy(PCPE_VIEW view, uint32_t rva, void *copy, uint32_t length) {
+    const void *data = peRvaPointer(view, rva, length);
+    if (!data) {
+        return false;
+    }
+    memcpy(copy, data, length);
+    return true;
+}
+
+
+const char *peRvaString(PCPE_VIEW view, uint32_t rva, uint32_t *length) {
+
+    uint64_t offset;
+    if (!peRvaToOffset(view, rva, 1, &offset)) {
+        return NULL;
+    }
+
+    // the string may run up to the end of the headers or of the section's raw data, whichever holds it
+    uint64_t end = view->size;
+    if ((uint64_t) rva + 1 <= view->sizeOfHeaders) {
+        end = view->sizeOfHeaders < end ? view->sizeOfHeaders : end;
+    }
+    else {
+        IMAGE_SECTION_HEADER section;
+        peSectionByRva(view, rva, &section);
+        uint64_t rawEnd = (uint64_t) section.PointerToRawData + section.SizeOfRawData;
+        end = rawEnd < end ? rawEnd : end;
+    }
+    uint64_t available = end - offset;
+    if (available > PE_MAX_NAME_LENGTH + 1) {
+        available = PE_MAX_NAME_LENGTH + 1;
+    }
+
+    const char *string = (const char *) view->base + offset;
+    const char *terminator = memchr(string, '\0', (size_t) available);
+    if (!terminator) {
+        return NULL;
+    }
+    if (length) {
+        *length = (uint32_t) (terminator - string);
+    }
+    return string;
+}
+
+
+PCIMAGE_DATA_DIRECTORY peDataDirectory(PCPE_VIEW view, unsigned index) {
+    if (index >= view->numberOfDirectories) {
+        return NULL;
+    }
+    return view->bits == 32 ? &view->ntHeaders32.OptionalHeader.DataDirectory[index] : &view->ntHeaders64.OptionalHeader.DataDirectory[index];
+}
+
+
+const void *peDirectoryData(PCPE_VIEW view, unsigned index, uint32_t minSize, uint32_t *size) {
+
+    PCIMAGE_DATA_DIRECTORY directory = peDataDirectory(view, index);
+    if (size) {
+        *size = directory ? directory->Size : 0;
+    }
+    if (!directory || !directory->VirtualAddress || directory->Size < minSize) {
+        return NULL;
+    }
+
+    // the certificate table is the one directory addressed by file offset instead of RVA
+    if (index == IMAGE_DIRECTORY_ENTRY_SECURITY) {
+        return peFilePointer(view, directory->VirtualAddress, minSize);
+    }
+    return peRvaPointer(view, directory->VirtualAddress, minSize);
+}
+
+
+bool peDirectoryCopy(PCPE_VIEW view, unsigned index, void *copy, uint32_t length) {
+    const void *data = peDirectoryData(view, index, length, NULL);
+    if (!data) {
+        return false;
+    }
+    memcpy(copy, data, length);
+    return true;
+}
+
+
+static inline bool inImage(PCPE_VIEW view, uint64_t offset, uint64_t length) {
+    return offset <= view->size && length <= view->size - offset;
+}
+
+
+static int findSection(PCPE_VIEW view, uint32_t rva) {
+
+    // only the fields compared are read, this runs for every RVA translated
+    const uint8_t *header = view->base + view->sectionOffset;
+    for (uint16_t idx = 0; idx < view->numberOfSections; idx++, header += sizeof(IMAGE_SECTION_HEADER)) {
+        uint32_t virtualAddress = peRead32(header + FIELD_OFFSET(IMAGE_SECTION_HEADER, VirtualAddress));
+        uint32_t virtualSize = peRead32(header + FIELD_OFFSET(IMAGE_SECTION_HEADER, Misc.VirtualSize));
+        // a VirtualSize of 0 means the section is as large as its raw data
+        if (!virtualSize) {
+            virtualSize = peRead32(header + FIELD_OFFSET(IMAGE_SECTION_HEADER, SizeOfRawData));
+        }
+        if (rva >= virtualAddress && (uint64_t) rva < (uint64_t) virtualAddress + virtualSize) {
+            return idx;
+        }
+    }
+    return -1;
+}
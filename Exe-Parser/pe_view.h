@@ -0,0 +1,221 @@
+//-------------------------------------------------------------------------------------------------
+// pe_view.h
+//
+// Bounds-checked, read-only view over a PE image in memory: headers, sections, RVAs and data
+// directories. Every pointer handed out points into the image and is checked to lie within it.
+//
+// Offsets in an image need not be aligned for what is stored there, the loader does not ask it of
+// them. Data in the image is therefore read with peRead16(), peRead32(), peRead64() or memcpy(),
+// never through a cast pointer; the headers and section headers are copied out the same way.
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "pehdr.h"
+
+
+// longest name peRvaString() looks for a terminator in, linkers cap decorated names well below this
+#define PE_MAX_NAME_LENGTH 4096
+
+/**
+ * @brief result of validating an image
+ */
+typedef enum _PE_STATUS {
+    PE_OK = 0,
+    PE_ERROR_DOS_HEADER,        // file smaller than a DOS header
+    PE_ERROR_DOS_SIGNATURE,     // e_magic is not MZ
+    PE_ERROR_NT_OFFSET,         // e_lfanew points outside the file
+    PE_ERROR_NT_SIGNATURE,      // no PE00 at e_lfanew
+    PE_ERROR_OPTIONAL_HEADER,   // optional header truncated, too small or of an unknown magic
+    PE_ERROR_SECTIONS,          // section table runs past the end of the file
+    PE_STATUS_COUNT
+} PE_STATUS;
+
+/**
+ * @brief a validated image, filled by peOpen()
+ * @remark The headers are copies, they hold what the image does wherever it placed them: the DOS
+ * header, the NT headers of the width given by bits with the optional header as far as
+ * SizeOfOptionalHeader reaches and zeros after it, and numberOfDirectories data directories in it.
+ * The fields common to both widths are copied out so most callers need neither. The numberOfSections
+ * section headers are guaranteed to lie within the image at sectionOffset, see peSection().
+ */
+typedef struct _PE_VIEW {
+    const uint8_t           *base;                  // first byte of the image
+    uint64_t                size;                   // bytes readable at base
+    IMAGE_DOS_HEADER        dosHeader;
+    union {
+        IMAGE_NT_HEADERS32  ntHeaders32;            // bits == 32
+        IMAGE_NT_HEADERS64  ntHeaders64;            // bits == 64
+    };
+    IMAGE_FILE_HEADER       fileHeader;
+    uint64_t                ntOffset;               // file offset of the NT headers, e_lfanew
+    uint64_t                sectionOffset;          // file offset of the first section header
+    uint64_t                imageBase;              // preferred load address, from the optional header
+    uint32_t                sizeOfHeaders;          // headers are mapped as they are in the file up to here
+    uint32_t                numberOfDirectories;    // data directories present in the optional header, at most 16
+    uint16_t                numberOfSections;
+    uint8_t                 bits;                   // 32 = PE32, 64 = PE32+
+} PE_VIEW, *PPE_VIEW;
+
+typedef const PE_VIEW* PCPE_VIEW;
+
+
+/**
+ * @brief Validates the headers of an image in memory and fills a view of it
+ * @remark Costs a few comparisons and a copy of the headers, the image is not scanned. The view stays
+ * valid as long as the image memory.
+ *
+ * @param[out] view View to fill
+ * @param[in] base First byte of the image, typically a mapped file
+ * @param[in] size Number of bytes readable at base
+ * @return PE_OK, or the first check that failed
+ */
+PE_STATUS peOpen(PPE_VIEW view, const uint8_t *base, uint64_t size);
+
+/**
+ * @brief Returns a short description of a status, for error messages
+ */
+const char *peStatusString(PE_STATUS status);
+
+/**
+ * @brief Returns the name of a machine type, e.g. "AMD64"
+ *
+ * @return Name | NULL if the machine type is not one of the supported ones
+ */
+const char *peMachineName(uint16_t machine);
+
+/**
+ * @brief Returns a pointer to length bytes at a file offset
+ *
+ * @return Pointer into the image | NULL if any of the bytes lies outside it
+ */
+const void *peFilePointer(PCPE_VIEW view, uint64_t offset, uint64_t length);
+
+/**
+ * @brief Copies a section header out of the section table
+ *
+ * @param[in] index Section, below numberOfSections
+ * @param[out] section Receives the section header
+ */
+void peSection(PCPE_VIEW view, uint16_t index, PIMAGE_SECTION_HEADER section);
+
+/**
+ * @brief Copies the section header with the given name (up to 8 characters, compared like strncmp)
+ *
+ * @param[out] section Receives the section header
+ * @return true | false if there is none
+ */
+bool peSectionByName(PCPE_VIEW view, const char *name, PIMAGE_SECTION_HEADER section);
+
+/**
+ * @brief Copies the section header whose virtual range holds an RVA
+ *
+ * @param[out] section Receives the section header
+ * @return true | false if the RVA is in no section
+ */
+bool peSectionByRva(PCPE_VIEW view, uint32_t rva, PIMAGE_SECTION_HEADER section);
+
+/**
+ * @brief Translates an RVA range to a file offset
+ * @remark RVAs below SizeOfHeaders map to the same file offset. The whole range has to be backed by
+ * raw data of one section (or the headers) and lie within the file.
+ *
+ * @param[in] rva Relative virtual address of the first byte
+ * @param[in] length Number of bytes that have to be readable
+ * @param[out] offset Receives the file offset of the first byte
+ * @return true if the range is backed by the file
+ */
+bool peRvaToOffset(PCPE_VIEW view, uint32_t rva, uint32_t length, uint64_t *offset);
+
+/**
+ * @brief Translates a VA, an address as stored in the image for its preferred base, to an RVA
+ *
+ * @return true if the VA is within 4 GiB above the image base
+ */
+bool peVaToRva(PCPE_VIEW view, uint64_t va, uint32_t *rva);
+
+/**
+ * @brief Returns a pointer to length bytes at an RVA
+ * @remark The bytes may be at any alignment, read them with peRead16(), peRead32(), peRead64() or memcpy()
+ *
+ * @return Pointer into the image | NULL if the range is not backed by the file
+ */
+const void *peRvaPointer(PCPE_VIEW view, uint32_t rva, uint32_t length);
+
+/**
+ * @brief Copies length bytes at an RVA, typically a structure of the image
+ *
+ * @param[out] copy Receives the bytes
+ * @return true | false if the range is not backed by the file, copy is left as it was
+ */
+bool peRvaCopy(PCPE_VIEW view, uint32_t rva, void *copy, uint32_t length);
+
+/**
+ * @brief Returns a NUL terminated string at an RVA, such as a DLL or function name
+ * @remark The terminator has to be within PE_MAX_NAME_LENGTH bytes and in the same section (or the headers)
+ *
+ * @param[out] length Optional, receives the length of the string without the terminator
+ * @return Pointer into the image | NULL if the string is not terminated within the file
+ */
+const char *peRvaString(PCPE_VIEW view, uint32_t rva, uint32_t *length);
+
+/**
+ * @brief Returns a data directory entry of the optional header
+ *
+ * @param[in] index IMAGE_DIRECTORY_ENTRY_* index
+ * @return Directory entry, in the view's copy of the headers | NULL if the optional header has fewer entries
+ */
+PCIMAGE_DATA_DIRECTORY peDataDirectory(PCPE_VIEW view, unsigned index);
+
+/**
+ * @brief Returns the contents of a data directory if it holds at least minSize bytes
+ * @remark The bytes may be at any alignment, like those of peRvaPointer()
+ *
+ * @param[in] index IMAGE_DIRECTORY_ENTRY_* index
+ * @param[in] minSize Bytes that have to be readable, typically the size of the directory's structure
+ * @param[out] size Optional, receives the size recorded in the directory entry
+ * @return Pointer into the image | NULL if the directory is absent, smaller than minSize or not backed by the file
+ */
+const void *peDirectoryData(PCPE_VIEW view, unsigned index, uint32_t minSize, uint32_t *size);
+
+// copy of the structure of a data directory, e.g. PE_DIRECTORY(view, IMAGE_DIRECTORY_ENTRY_EXPORT, &directory)
+#define PE_DIRECTORY(view, index, copy) \
+    peDirectoryCopy((view), (index), (copy), (uint32_t) sizeof(*(copy)))
+
+/**
+ * @brief Copies the structure of a data directory, see PE_DIRECTORY()
+ *
+ * @param[out] copy Receives length bytes
+ * @return true | false as peDirectoryData() with minSize length returns NULL, copy is left as it was
+ */
+bool peDirectoryCopy(PCPE_VIEW view, unsigned index, void *copy, uint32_t length);
+
+/**
+ * @brief Reads a 16-bit field of the image at any alignment
+ */
+static inline uint16_t peRead16(const void *data) {
+    uint16_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+/**
+ * @brief Reads a 32-bit field of the image at any alignment
+ */
+static inline uint32_t peRead32(const void *data) {
+    uint32_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+/**
+ * @brief Reads a 64-bit field of the image at any alignment
+ */
+static inline uint64_t peRead64(const void *data) {
+    uint64_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
@@ -0,0 +1,49 @@
+//-------------------------------------------------------------------------------------------------
+// pe_view_tmpl.h
+//
+// Width dependent part of peOpen(), included by pe_view.c once per PE_BITS (see pe_traits.h).
+// No include guard on purpose.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef PE_BITS
+#error "define PE_BITS as 32 or 64 before including pe_view_tmpl.h"
+#endif
+
+
+/**
+ * @brief Validates an optional header of this width and fills the width dependent fields of the view
+ * @remark The caller checked that optionalSize bytes at ntHeaders' optional header lie within the image
+ * and copied the file header
+ *
+ * @param[in,out] view View being opened
+ * @param[in] ntHeaders NT headers in the image, at any alignment, with a signature already checked
+ * @return PE_OK | PE_ERROR_OPTIONAL_HEADER
+ */
+static PE_STATUS PE_FN(openOptionalHeader)(PPE_VIEW view, const uint8_t *ntHeaders) {
+
+    uint16_t optionalSize = view->fileHeader.SizeOfOptionalHeader;
+    if (optionalSize < PE_OPTIONAL_HEADER_FIXED_SIZE) {
+        return PE_ERROR_OPTIONAL_HEADER;
+    }
+
+    // copied as far as the file has it, an optional header with fewer directories leaves zeros after them
+    PE_NT_HEADERS *headers = &view->PE_VIEW_NT_HEADERS;
+    size_t copied = OPTIONAL_HEADER_OFFSET + (size_t) optionalSize;
+    memcpy(headers, ntHeaders, copied < sizeof(*headers) ? copied : sizeof(*headers));
+
+    // the directories claimed have to fit in the optional header
+    uint32_t directories = headers->OptionalHeader.NumberOfRvaAndSizes;
+    uint32_t directoriesFit = (optionalSize - PE_OPTIONAL_HEADER_FIXED_SIZE) / sizeof(IMAGE_DATA_DIRECTORY);
+    if (directories > directoriesFit) {
+        directories = directoriesFit;
+    }
+    if (directories > IMAGE_NUMBEROF_DIRECTORY_ENTRIES) {
+        directories = IMAGE_NUMBEROF_DIRECTORY_ENTRIES;
+    }
+
+    view->numberOfDirectories = directories;
+    view->imageBase = headers->OptionalHeader.ImageBase;
+    view->sizeOfHeaders = headers->OptionalHeader.SizeOfHeaders;
+    view->bits = PE_BITS;
+    return PE_OK;
+}
@@ -1,15 +1,24 @@
 /**
  * @file pehdr.c
  * @author Brian Guerrero
- * @brief Parses fields from a 64-bit PE header and prints them into a Python readable list format
+ * @brief Parses fields from a 32-bit or 64-bit PE header and prints them into a Python readable list format
  * @date 2024-05-09
  */
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
 
 #include "pehdr.h"
+#include "mapfile.h"
+#include "pe_view.h"
+#include "pe_print.h"
+#include "pe_timing.h"
+#include "pe_scan.h"
+#include "pe_columns.h"
 
 
 //*********************************************************************************
@@ -17,324 +26,298 @@
 //*********************************************************************************
 
 /**
- * @brief Parses the second command line argument as a filepath and opens the file to buffer in process memory
- * @remark Use free() to release buffer when no longer needed
- * 
- * @param[out] fileName Name and path of file read
- * @param[out] fileSize Size of the file read
- * @return Returns allocated buffer containing file (free() when no longer needed) | 0 = ERROR
+ * @brief command line options
  */
-static uint8_t *loadArgFile(char **fileName, size_t *fileSize, int argc, char *argv[]);
+typedef struct _OPTIONS {
+    char    *path;      // file to print, directory to scan or columns file to read
+    char    *columns;   // --columns, file the scan writes columns to
+    PE_IMPORT_QUERY queries[PE_SCAN_MAX_QUERIES];   // --imports, a scan or a read prints only the files importing all of them
+    unsigned queryCount;
+    bool    timed;      // -t, print the per-directory decode times
+    bool    scan;       // --scan, path is a directory to scan
+    bool    read;       // --read, path is a columns file to print
+    bool    json;       // --json, records as JSON Lines instead of a python list
+    bool    tables;     // --tables, a read prints the sections and DLLs of each file instead of its record
+} OPTIONS, *POPTIONS;
 
 /**
- * @brief Get length of an open file
- * @remark Limited to 2GiB
+ * @brief Parses the command line: pehdr [-t] <filename|filepath>, pehdr [-t] [--json | --columns <output>] [--imports <query>]... --scan <directory>
+ * or pehdr [--json] [--tables] [--imports <query>]... --read <columns file>
  *
- * @param[in] fp Open file pointer
- * @return Returns the length of the file, on error returns 0
- */
-static uint32_t FileSize(FILE* fp);
-
-/**
- * @brief Prints the file name, file size, and column headers into python comments, then starts a python list
- * 
- * @param fileName 
- * @param fileSize 
- */
-static void printPrologue(char * fileName, size_t fileSize);
-
-/**
- * @brief Print the DOS header and its relevant fields as python tuples
- * 
- * @param DOSHeader 
- */
-static void printDOSHeader(PCIMAGE_DOS_HEADER DOSHeader);
-
-/**
- * @brief Print the NT headers and NT signature as python tuples
- * 
- * @param NTHeaders 
- */
-static void printNTHeaders(PCIMAGE_NT_HEADERS64 NTHeaders);
-
-/**
- * @brief Print the File header and its relevant fields as python tuples
- * 
- * @param NTHeaders 
+ * @param[out] options Receives the options
+ * @return 0 = SUCCESS | 1 = ERROR
  */
-static void printFileHeader(PCIMAGE_NT_HEADERS64 NTHeaders);
+static int parseArgs(POPTIONS options, int argc, char *argv[]);
 
 /**
- * @brief Print the Optional header and its relevant fields as python tuples
+ * @brief Maps the file named on the command line read-only into process memory
+ * @remark Only the pages that are parsed are read from disk. Use unmapFile() to release the view when no longer needed
  * 
- * @param NTHeaders 
+ * @param[in] fileName Name and path of file to map
+ * @param[out] file Receives the view of the file and its size
+ * @return 0 = SUCCESS | 1 = ERROR
  */
-static void printOptionalHeader(PCIMAGE_NT_HEADERS64 NTHeaders);
+static int mapArgFile(const char *fileName, PMAPPED_FILE file);
 
 /**
- * @brief Print the Data directories and their relevant fields as python tuples
- * 
- * @param NTHeaders
+ * @brief Scans the directory named on the command line, a record per file on stdout or in the columns file, and the totals on stderr
+ *
+ * @return 0 = SUCCESS | 1 = ERROR
  */
-static void printDataDirectories(PCIMAGE_NT_HEADERS64 NTHeaders);
+static int scanArgDirectory(const OPTIONS *options);
 
 /**
- * @brief Print the Section headers and their relevant fields as python tuples
- * 
- * @param NTHeaders
+ * @brief Prints the files of the columns file named on the command line, a record per file as a scan would,
+ * or with --tables the section headers and imported DLLs of each file; with --imports only the files the
+ * file's import index lists for all queries
+ *
+ * @return 0 = SUCCESS | 1 = ERROR
  */
-static void printSectionHeaders(PCIMAGE_NT_HEADERS64 NTHeaders);
+static int readArgColumns(const OPTIONS *options);
 
 
 //*********************************************************************************
 // DEFINITIONS
 //********************************************************************************
 
-// global 
-static uint8_t *imageBase = 0;
-
 int main (int argc, char * argv[]){
     
-    // open file from command line argument 
-    char *fileName;
-    size_t fileSize = 0;
-    uint8_t *buffer = loadArgFile(&fileName, &fileSize, argc, argv);
-    if (!buffer){
+    // map file from command line argument, headers are parsed in place
+    OPTIONS options;
+    MAPPED_FILE file = { 0 };
+    if (parseArgs(&options, argc, argv)){
+        return 1;
+    }
+    if (options.scan){
+        return scanArgDirectory(&options);
+    }
+    if (options.read){
+        return readArgColumns(&options);
+    }
+    char *fileName = options.path;
+    if (mapArgFile(fileName, &file)){
         goto cleanup;
     }
-
-    // verify DOS signature at start of file
-    PCIMAGE_DOS_HEADER DOSHeader = (PCIMAGE_DOS_HEADER) buffer;
-    if(DOSHeader->e_magic != IMAGE_DOS_SIGNATURE){
-        fprintf(stderr, "Aborting, expected DOS Signature: %04X. Actual: %04X.\n", IMAGE_DOS_SIGNATURE, DOSHeader->e_magic);
+    if (file.size < sizeof(IMAGE_DOS_HEADER)){
+        fprintf(stderr, "Aborting, file is too small for a DOS header: %llu bytes.\n", (unsigned long long) file.size);
         goto cleanup;
     }
-    // set imageBase based on the the start of the DOS Header
-    imageBase = (uint8_t *) DOSHeader;
-    
 
-    // verify NT signature at start of NT/COFF header
-    PCIMAGE_NT_HEADERS64 NTHeaders = (PCIMAGE_NT_HEADERS64) ((uint8_t *) DOSHeader + DOSHeader->e_lfanew);
-    if(NTHeaders->Signature != IMAGE_NT_SIGNATURE){
-        fprintf(stderr, "Aborting, expected NT Signature: %08X. Actual: %08X.\n", IMAGE_NT_SIGNATURE, NTHeaders->Signature);
+    // validate the DOS, NT and section headers against the file size before reading any of them
+    PE_VIEW view;
+    PE_STATUS status = peOpen(&view, file.base, file.size);
+    if (status != PE_OK){
+        fprintf(stderr, "Aborting, %s.\n", peStatusString(status));
         goto cleanup;
     }
 
-    // verify machine type is x86-64-bit
-    if(NTHeaders->FileHeader.Machine != IMAGE_FILE_MACHINE_AMD64){
-        fprintf(stderr, "Aborting, expected Image Header Machine: %04X. Actual: %04X.\n", IMAGE_FILE_MACHINE_AMD64, NTHeaders->FileHeader.Machine);
+    // verify machine type is one of x86, x64, ARM or ARM64, the optional header magic picked the width
+    uint16_t machine = view.fileHeader.Machine;
+    if(!peMachineName(machine)){
+        fprintf(stderr, "Aborting, unsupported Image Header Machine: %04X.\n", machine);
         goto cleanup;
     }
 
-    printPrologue(fileName, fileSize);
-
-    printDOSHeader(DOSHeader);
-
-    printNTHeaders(NTHeaders);
-
-    printFileHeader(NTHeaders);
+    // time the directory decoders apart from printing and before it, so they are the first to touch
+    // the pages of the mapping; on stderr so the list stays python readable
+    PE_DIRECTORY_TIMES times = { 0 };
+    if (options.timed) {
+        peTimeDirectories(&view, &times);
+    }
 
-    printOptionalHeader(NTHeaders);
+    printPrologue(stdout, fileName, file.size);
 
-    printDataDirectories(NTHeaders);
+    printHeaders(stdout, &view);
 
-    printSectionHeaders(NTHeaders);
+    printEpilogue(stdout);
 
-    printf("]\n");
+    if (options.timed) {
+        printDirectoryTimes(stderr, &times);
+    }
 
+    unmapFile(&file);
     return 0;
 
     cleanup:
-    if(buffer){
-        free(buffer);
-    }
+    unmapFile(&file);
     return 1;
 }
 
 
-static void printPrologue(char *fileName, size_t fileSize) {
-    printf("# \'%s\' info\n", fileName);
-    printf("# File Size: %llu bytes.\n", fileSize);
-    printf("#\n");
-    printf("#                                   offset      size        value\n");
-    printf("[\n");
-}
+static int parseArgs(POPTIONS options, int argc, char *argv[]) {
 
+    // options in any order, then exactly one path
+    memset(options, 0, sizeof(*options));
+    int arg = 1;
+    for (; arg < argc && argv[arg][0] == '-'; arg++) {
+        if (!strcmp(argv[arg], "-t")) {
+            options->timed = true;
+        }
+        else if (!strcmp(argv[arg], "--scan")) {
+            options->scan = true;
+        }
+        else if (!strcmp(argv[arg], "--read")) {
+            options->read = true;
+        }
+        else if (!strcmp(argv[arg], "--json")) {
+            options->json = true;
+        }
+        else if (!strcmp(argv[arg], "--tables")) {
+            options->tables = true;
+        }
+        else if (!strcmp(argv[arg], "--columns") && arg + 1 < argc) {
+            options->columns = argv[++arg];
+        }
+        else if (!strcmp(argv[arg], "--imports") && arg + 1 < argc) {
+            if (options->queryCount == PE_SCAN_MAX_QUERIES || !peParseImportQuery(argv[++arg], &options->queries[options->queryCount])) {
+                fprintf(stderr, "Invalid import query '%s', expected at most %u of DLL!function, DLL#ordinal or DLL.\n", argv[arg], PE_SCAN_MAX_QUERIES);
+                return 1;
+            }
+            options->queryCount++;
+        }
+        else {
+            break;
+        }
+    }
 
-static void printDOSHeader(PCIMAGE_DOS_HEADER DOSHeader) {
-    printf("('IMAGE_DOS_HEADER',                0x%05X,    %u),\n", 0, DOSHeader->e_lfanew);
-    printf("    ('e_magic',                     0x%05X,    %zu,          0x%04X),\n", FIELD_OFFSET(IMAGE_DOS_HEADER, e_magic), sizeof(DOSHeader->e_magic), DOSHeader->e_magic);
-    printf("    ('e_lfanew',                    0x%05X,    %zu,          0x%08X),\n", FIELD_OFFSET(IMAGE_DOS_HEADER, e_lfanew), sizeof(DOSHeader->e_lfanew), DOSHeader->e_lfanew);
-    printf("\n");
+    // --json and --columns pick the output of a scan or a read, a read has no decode times, columns hold every file
+    bool formatted = options->json || options->columns;
+    if (argc != arg + 1 || (options->scan && options->read) || (options->json && options->columns)
+            || (formatted && !options->scan && !options->read) || (options->read && (options->timed || options->columns))
+            || (options->queryCount && !options->read && (!options->scan || options->columns)) || (options->tables && !options->read)) {
+        fprintf(stderr, "Invalid arguments given.\nUsage: pehdr [-t] <filename|filepath>\n"
+            "       pehdr [-t] [--json | --columns <output>] [--imports <DLL[!function|#ordinal]>]... --scan <directory>\n"
+            "       pehdr [--json] [--tables] [--imports <DLL[!function|#ordinal]>]... --read <columns file>\n");
+        return 1;
+    }
+    options->path = argv[arg];
+    return 0;
 }
 
 
-static void printNTHeaders(PCIMAGE_NT_HEADERS64 NTHeaders) {
-    size_t offset = (uint8_t *) NTHeaders - imageBase; 
-    printf("('IMAGE_NT_HEADERS',                0x%05llX,    %llu),\n", offset, sizeof(IMAGE_NT_HEADERS64));
-    printf("    ('Signature',                   0x%05llX,    %llu,          0x%08X),\n", offset + FIELD_OFFSET(IMAGE_NT_HEADERS64, Signature), sizeof(NTHeaders->Signature), NTHeaders->Signature);
-    printf("    ('FileHeader',                  0x%05llX,    %llu),\n", offset + FIELD_OFFSET(IMAGE_NT_HEADERS64, FileHeader), sizeof(NTHeaders->FileHeader));
-    printf("    ('OptionalHeader',              0x%05llX,    %llu),\n", offset + FIELD_OFFSET(IMAGE_NT_HEADERS64, OptionalHeader), sizeof(NTHeaders->OptionalHeader));
-    printf("\n");
-}
-
+static int mapArgFile(const char *fileName, PMAPPED_FILE file) {
 
-static void printFileHeader(PCIMAGE_NT_HEADERS64 NTHeaders) {
-    PCIMAGE_FILE_HEADER fileHeader = &(NTHeaders->FileHeader);
-    size_t offset = (uint8_t *) fileHeader - imageBase; 
-    printf("('IMAGE_FILE_HEADER',               0x%05llX,    %llu),\n", offset, sizeof(IMAGE_FILE_HEADER));
-    printf("    ('Machine',                     0x%05llX,    %llu,          0x%04X),\n", offset + FIELD_OFFSET(IMAGE_FILE_HEADER, Machine), sizeof(fileHeader->Machine), fileHeader->Machine);
-    printf("    ('NumberOfSections',            0x%05llX,    %llu,          %d),\n", offset + FIELD_OFFSET(IMAGE_FILE_HEADER, NumberOfSections), sizeof(fileHeader->NumberOfSections), fileHeader->NumberOfSections);
-    printf("    ('SizeOfOptionalHeader',        0x%05llX,    %llu,          %d),\n", offset + FIELD_OFFSET(IMAGE_FILE_HEADER, SizeOfOptionalHeader), sizeof(fileHeader->SizeOfOptionalHeader), fileHeader->SizeOfOptionalHeader);
-    printf("\n"); 
+    // map the file instead of reading it, a multi-GB installer costs no more than its headers
+    if (mapFile(fileName, file) != 0) {
+        fprintf(stderr, "ERROR: Map input file for read failed. File: '%s',  Error: %d\n", fileName, errno);
+        return 1;
+    }
+    return 0;
 }
 
 
-static void printOptionalHeader(PCIMAGE_NT_HEADERS64 NTHeaders) {
-    PCIMAGE_OPTIONAL_HEADER64 optionalHeader = &(NTHeaders->OptionalHeader);
-    size_t offset = (uint8_t *) optionalHeader - imageBase;
-    printf("('IMAGE_OPTIONAL_HEADER',           0x%05llX,    %llu),\n", offset, sizeof(IMAGE_OPTIONAL_HEADER64));
-    printf("    ('Magic',                       0x%05llX,    %llu,          0x%04X),\n", offset + FIELD_OFFSET(IMAGE_OPTIONAL_HEADER64, Magic), sizeof(optionalHeader->Magic), optionalHeader->Magic);
-    //printf("    ('MajorLinkerVersion',          0x%05llX,    %llu,      0x%04X),\n", offset + FIELD_OFFSET(IMAGE_OPTIONAL_HEADER64, MajorLinkerVersion), sizeof(optionalHeader->MajorLinkerVersion), optionalHeader->MajorLinkerVersion);
-    //printf("    ('MinorLinkerVersion',          0x%05llX,    %llu,      0x%04X),\n", offset + FIELD_OFFSET(IMAGE_OPTIONAL_HEADER64, MinorLinkerVersion), sizeof(optionalHeader->MinorLinkerVersion), optionalHeader->MinorLinkerVersion);
-    printf("    ('SizeOfCode',                  0x%05llX,    %llu,          %u),\n", offset + FIELD_OFFSET(IMAGE_OPTIONAL_HEADER64, SizeOfCode), sizeof(optionalHeader->SizeOfCode), optionalHeader->SizeOfCode);
-    printf("    ('SizeOfInitializedData',       0x%05llX,    %llu,          %u),\n", offset + FIELD_OFFSET(IMAGE_OPTIONAL_HEADER64, SizeOfInitializedData), sizeof(optionalHeader->SizeOfInitializedData), optionalHeader->SizeOfInitializedData);
-    printf("    ('SizeOfUninitializedData',     0x%05llX,    %llu,          %u),\n", offset + FIELD_OFFSET(IMAGE_OPTIONAL_HEADER64, SizeOfUninitializedData), sizeof(optionalHeader->SizeOfUninitializedData), optionalHeader->SizeOfUninitializedData);
-    printf("    ('AddressOfEntryPoint',         0x%05llX,    %llu,          0x%08X),\n", offset + FIELD_OFFSET(IMAGE_OPTIONAL_HEADER64, AddressOfEntryPoint), sizeof(optionalHeader->AddressOfEntryPoint), optionalHeader->AddressOfEntryPoint);
-    printf("    ('ImageBase',                   0x%05llX,    %llu,          0x%016llX),\n", offset + FIELD_OFFSET(IMAGE_OPTIONAL_HEADER64, ImageBase), sizeof(optionalHeader->ImageBase), optionalHeader->ImageBase);
-    printf("    ('SectionAlignment',            0x%05llX,    %llu,          %u),\n", offset + FIELD_OFFSET(IMAGE_OPTIONAL_HEADER64, SectionAlignment), sizeof(optionalHeader->SectionAlignment), optionalHeader->SectionAlignment);
-    printf("    ('FileAlignment',               0x%05llX,    %llu,          %u),\n", offset + FIELD_OFFSET(IMAGE_OPTIONAL_HEADER64, FileAlignment), sizeof(optionalHeader->FileAlignment), optionalHeader->FileAlignment);
-    printf("    ('MinorOperatingSystemVersion', 0x%05llX,    %llu,          %u),\n", offset + FIELD_OFFSET(IMAGE_OPTIONAL_HEADER64, MinorOperatingSystemVersion), sizeof(optionalHeader->MinorOperatingSystemVersion), optionalHeader->MinorOperatingSystemVersion);
-    printf("    ('MajorOperatingSystemVersion', 0x%05llX,    %llu,          %u),\n", offset + FIELD_OFFSET(IMAGE_OPTIONAL_HEADER64, MajorOperatingSystemVersion), sizeof(optionalHeader->MajorOperatingSystemVersion), optionalHeader->MajorOperatingSystemVersion);
-    printf("    ('MajorImageVersion',           0x%05llX,    %llu,          %u),\n", offset + FIELD_OFFSET(IMAGE_OPTIONAL_HEADER64, MajorImageVersion), sizeof(optionalHeader->MajorImageVersion), optionalHeader->MajorImageVersion);
-    printf("    ('MinorImageVersion',           0x%05llX,    %llu,          %u),\n", offset + FIELD_OFFSET(IMAGE_OPTIONAL_HEADER64, MinorImageVersion), sizeof(optionalHeader->MinorImageVersion), optionalHeader->MinorImageVersion);
-    printf("    ('MajorSubsystemVersion',       0x%05llX,    %llu,          %u),\n", offset + FIELD_OFFSET(IMAGE_OPTIONAL_HEADER64, MajorSubsystemVersion), sizeof(optionalHeader->MajorSubsystemVersion), optionalHeader->MajorSubsystemVersion);
-    printf("    ('MinorSubsystemVersion',       0x%05llX,    %llu,          %u),\n", offset + FIELD_OFFSET(IMAGE_OPTIONAL_HEADER64, MinorSubsystemVersion), sizeof(optionalHeader->MinorSubsystemVersion), optionalHeader->MinorSubsystemVersion);
-    printf("    ('Win32VersionValue',           0x%05llX,    %llu,          %u),\n", offset + FIELD_OFFSET(IMAGE_OPTIONAL_HEADER64, Win32VersionValue), sizeof(optionalHeader->Win32VersionValue), optionalHeader->Win32VersionValue);
-    printf("    ('SizeOfImage',                 0x%05llX,    %llu,          0x%08X),\n", offset + FIELD_OFFSET(IMAGE_OPTIONAL_HEADER64, SizeOfImage), sizeof(optionalHeader->SizeOfImage), optionalHeader->SizeOfImage);
-    printf("    ('SizeOfHeaders',               0x%05llX,    %llu,          0x%08X),\n", offset + FIELD_OFFSET(IMAGE_OPTIONAL_HEADER64, SizeOfHeaders), sizeof(optionalHeader->SizeOfHeaders), optionalHeader->SizeOfHeaders);
-    printf("    ('CheckSum',                    0x%05llX,    %llu,          0x%08X),\n", offset + FIELD_OFFSET(IMAGE_OPTIONAL_HEADER64, CheckSum), sizeof(optionalHeader->CheckSum), optionalHeader->CheckSum);
-    printf("    ('Subsystem',                   0x%05llX,    %llu,          %u),\n", offset + FIELD_OFFSET(IMAGE_OPTIONAL_HEADER64, Subsystem), sizeof(optionalHeader->Subsystem), optionalHeader->Subsystem);
-    printf("    ('SizeOfStackReserve',          0x%05llX,    %llu,          0x%08llX),\n", offset + FIELD_OFFSET(IMAGE_OPTIONAL_HEADER64, SizeOfStackReserve), sizeof(optionalHeader->SizeOfStackReserve), optionalHeader->SizeOfStackReserve);
-    printf("    ('SizeOfStackCommit',           0x%05llX,    %llu,          0x%08llX),\n", offset + FIELD_OFFSET(IMAGE_OPTIONAL_HEADER64, SizeOfStackCommit), sizeof(optionalHeader->SizeOfStackCommit), optionalHeader->SizeOfStackCommit);
-    printf("    ('SizeOfHeapReserve',           0x%05llX,    %llu,          0x%08llX),\n", offset + FIELD_OFFSET(IMAGE_OPTIONAL_HEADER64, SizeOfHeapReserve), sizeof(optionalHeader->SizeOfHeapReserve), optionalHeader->SizeOfHeapReserve);
-    printf("    ('SizeOfHeapCommit',            0x%05llX,    %llu,          0x%08llX),\n", offset + FIELD_OFFSET(IMAGE_OPTIONAL_HEADER64, SizeOfHeapCommit), sizeof(optionalHeader->SizeOfHeapCommit), optionalHeader->SizeOfHeapCommit);
-    printf("    ('NumberOfRvaAndSizes',         0x%05llX,    %llu,          %u),\n", offset + FIELD_OFFSET(IMAGE_OPTIONAL_HEADER64, NumberOfRvaAndSizes), sizeof(optionalHeader->NumberOfRvaAndSizes), optionalHeader->NumberOfRvaAndSizes);
-}
-
+static int scanArgDirectory(const OPTIONS *options) {
 
-static void printDataDirectories(PCIMAGE_NT_HEADERS64 NTHeaders) {
-    PCIMAGE_OPTIONAL_HEADER64 optionalHeader = &(NTHeaders->OptionalHeader);
-    size_t offset = (uint8_t *) optionalHeader - imageBase;
-    printf("    ('DataDirectory',               0x%05llX,    %llu,        [\n", offset + FIELD_OFFSET(IMAGE_OPTIONAL_HEADER64, DataDirectory), sizeof(optionalHeader->DataDirectory));
-    printf("        # offset  type   VirtualAddress    Size\n");
-    PCIMAGE_DATA_DIRECTORY dataDir;
-    // print each data directory's data up to amount specified in the optional header
-    for (int idx = 0; idx < optionalHeader->NumberOfRvaAndSizes; idx++) {
-        dataDir = &(optionalHeader->DataDirectory[idx]);
-        offset = (uint8_t *) dataDir - imageBase;
-        printf("        (0x%05llX, '%2u',     0x%06X,      0x%04X),\n", offset, idx, dataDir->VirtualAddress, dataDir->Size);
+    PE_SCAN_FORMAT format = options->columns ? PE_SCAN_COLUMNS : options->json ? PE_SCAN_JSON : PE_SCAN_PYTHON;
+    FILE *stream = options->columns ? fopen(options->columns, "wb") : stdout;
+    if (!stream) {
+        fprintf(stderr, "ERROR: Open columns file for write failed. File: '%s',  Error: %d\n", options->columns, errno);
+        return 1;
     }
-    printf("    ]),\n");
-}
 
-
-static void printSectionHeaders(PCIMAGE_NT_HEADERS64 NTHeaders){
-    PCIMAGE_SECTION_HEADER section = IMAGE_FIRST_SECTION(NTHeaders);
-    size_t offset = (uint8_t *) section - imageBase;
-    uint16_t numSections = NTHeaders->FileHeader.NumberOfSections;
-    printf("    ('Section Headers',            0x%05llX,    %llu,         [\n", offset, sizeof(*section) * numSections);
-    printf("        # Name        VirtualSize  VirtualAddress  SizeOfRawData  PointerToRawData\n");
-    // print each section header's data up to amount specified in the file header 
-    for (int idx = 0; idx < numSections; idx++) {
-        printf("        ('%-8s',   0x%06X,      0x%06X,       0x%06X,      0x%06X),\n", section->Name, section->Misc.VirtualSize, section->VirtualAddress, section->SizeOfRawData, section->PointerToRawData);
-        section = (PCIMAGE_SECTION_HEADER) ((uint8_t *) section + sizeof(*section));
+    PE_DIRECTORY_TIMES times = { 0 };
+    PE_SCAN_STATS stats;
+    int result = peScanDirectory(options->path, 0, format, options->queries, options->queryCount, stream, options->timed ? &times : NULL, &stats);
+    // the scan flushed the stream and checked it for write errors, closing the file can still fail
+    if (options->columns && fclose(stream) != 0 && result == 0) {
+        result = -1;
+    }
+    if (result != 0) {
+        fprintf(stderr, "ERROR: Scan of directory failed. Directory: '%s',  Error: %d\n", options->path, errno);
+        return 1;
     }
-    printf("    ]),\n");
+    double seconds = stats.nanoseconds / 1e9;
+    fprintf(stderr, "# %llu files, %llu errors, %.1f MB parsed in %.3f s on %u threads, %.0f files/min\n",
+        (unsigned long long) stats.files, (unsigned long long) stats.errors, stats.bytes / 1e6, seconds, stats.threads,
+        seconds > 0 ? stats.files * 60.0 / seconds : 0.0);
+    if (options->timed) {
+        printDirectoryTimes(stderr, &times);
+    }
+    return 0;
 }
 
 
-/**
- * @brief Parses the second command line argument as a filepath and opens the file to buffer in process memory
- * @remark Use free() to release buffer when no longer needed
- * 
- * @param[out] fileName Name and path of file read
- * @param[out] fileSize Size of the file read
- * @return Returns allocated buffer containing file (free() when no longer needed) | 0 = ERROR
- */
-static uint8_t *loadArgFile(char **fileName, size_t *fileSize, int argc, char *argv[]) {
+static int readArgColumns(const OPTIONS *options) {
 
-    // check number of arguments is 2, then take filename argument
-    const int FILENAME_ARG = 1;
-    if (argc != 2) {
-        fprintf(stderr, "Invalid number of arguments given.\nUsage: pehdr <filename|filepath>\n");
-        return 0;
+    // the columns are read in place, only the pages of the records printed are touched
+    MAPPED_FILE file;
+    if (mapArgFile(options->path, &file)) {
+        return 1;
     }
-    *fileName = argv[FILENAME_ARG];
-
-    // open a handle to the file
-    FILE* fp;
-    if (fopen_s(&fp, *fileName, "rb") != 0) {
-        fprintf(stderr, "ERROR: Open input file for read failed. File: '%s',  Error: %d\n", *fileName, errno);
-        return 0;
+    PE_COLUMNS columns;
+    if (!peOpenColumns(file.base, file.size, &columns)) {
+        fprintf(stderr, "Aborting, '%s' is not a columns file of this version.\n", options->path);
+        unmapFile(&file);
+        return 1;
     }
 
-    // find the size of the file
-    size_t size = FileSize(fp);
-    if ((int64_t)size == -1) {
-        fprintf(stderr, "ERROR: Get input file size file failed. File: '%s',  Error: %d\n", *fileName, errno);
-        fclose(fp);
-        return 0;
+    // queries are answered by the index alone, only the records of the files matching are read
+    uint8_t *hits = NULL;
+    if (options->queryCount) {
+        PE_IMPORT_INDEX index;
+        if (!peColumnsIndex(&columns, &index)) {
+            fprintf(stderr, "Aborting, '%s' has no valid import index, scan it again with --columns.\n", options->path);
+            unmapFile(&file);
+            return 1;
+        }
+        hits = calloc(columns.rows[PE_TABLE_FILES] ? columns.rows[PE_TABLE_FILES] : 1, sizeof(*hits));
+        if (!hits) {
+            fprintf(stderr, "Aborting, out of memory for %llu files.\n", (unsigned long long) columns.rows[PE_TABLE_FILES]);
+            unmapFile(&file);
+            return 1;
+        }
+        for (unsigned query = 0; query < options->queryCount; query++) {
+            peIndexMatch(&index, &options->queries[query], hits, (uint8_t) query);
+        }
     }
-    *fileSize = size;
 
-    // allocate buffer for file
-    uint8_t *buffer = (uint8_t *) calloc(size, 1);
-    if (buffer == NULL) {
-        fprintf(stderr, "ERROR: Allocate read buffer failed.\n");
-        goto cleanup;
+    PE_ROW_FORMAT format = options->json ? PE_ROW_JSON : PE_ROW_PYTHON;
+    if (format == PE_ROW_PYTHON) {
+        printf("# Columns of '%s', %llu files, %llu sections, %llu DLLs\n", options->path, (unsigned long long) columns.rows[PE_TABLE_FILES],
+            (unsigned long long) columns.rows[PE_TABLE_SECTIONS], (unsigned long long) columns.rows[PE_TABLE_DLLS]);
+        printf("# %s\n", options->tables ? PE_TABLE_FIELDS : PE_ROW_FIELDS);
+        printf("[\n");
     }
-
-    // block to limit scope of fread() return value
-    {
-        // read file into the buffer
-        size_t rv = fread(buffer, 1, size, fp);
-        if (rv != size)
-        {
-            fprintf(stderr, "ERROR: Read input file failed. File: '%s',  Error: %d\n", *fileName, errno);
-            goto cleanup;
+    int result = 0;
+    char *record = NULL;
+    size_t size = 0;
+    PE_FILE_ROW row;
+    for (uint64_t idx = 0; idx < columns.rows[PE_TABLE_FILES]; idx++) {
+        if (hits && hits[idx] != options->queryCount) {
+            continue;
+        }
+        peColumnsFile(&columns, idx, &row);
+        size_t length = options->tables ? peFormatFileTables(record, size, &columns, idx, format) : peFormatFileRow(record, size, &row, format);
+        if (length >= size) {
+            char *grown = realloc(record, length + 1);
+            if (!grown) {
+                fprintf(stderr, "Aborting, out of memory for a record of %zu bytes.\n", length);
+                result = 1;
+                break;
+            }
+            record = grown;
+            size = length + 1;
+            if (options->tables) {
+                peFormatFileTables(record, size, &columns, idx, format);
+            }
+            else {
+                peFormatFileRow(record, size, &row, format);
+            }
+        }
+        if (fwrite(record, 1, length, stdout) != length) {
+            break;
         }
     }
-    fclose(fp);
-    return buffer;
-
-cleanup:
-    fclose(fp);
-    if (buffer) {
-        free(buffer);
-    }
-    *fileSize = 0;
-    return 0;
-}
-
-
-/**
- * @brief Get length of an open file
- * @remark Limited to 2GiB
- *
- * @param[in] fp Open file pointer
- * @return Returns the length of the file, on error returns 0
- */
-static uint32_t FileSize(FILE* fp) {
-    int64_t start = ftell(fp);
-    if (start == -1){
-        return 0;
+    if (format == PE_ROW_PYTHON) {
+        printf("]\n");
     }
-    uint8_t rv = fseek(fp, 0, SEEK_END);
-    if (rv != 0){
-        return 0;
+    // a failed write, such as to a full disk, leaves the error on the stream
+    if (result == 0 && (fflush(stdout) != 0 || ferror(stdout))) {
+        fprintf(stderr, "ERROR: Write of the records failed. Error: %d\n", errno);
+        result = 1;
     }
-    uint32_t size = ftell(fp);
-    fseek(fp, start, SEEK_SET);
-    return size;
-}
\ No newline at end of file
+    free(record);
+    free(hits);
+    unmapFile(&file);
+    return result;
+}
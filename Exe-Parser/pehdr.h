@@ -1,7 +1,7 @@
 //-------------------------------------------------------------------------------------------------
 // pehdr.h
 //
-// Definitions and structures related to parsing a PE64 file
+// Definitions and structures related to parsing a PE32 or PE32+ (PE64) file
 //-------------------------------------------------------------------------------------------------
 #pragma once
 
@@ -19,6 +19,10 @@
 
 #define IMAGE_FILE_MACHINE_AMD64            0x8664  // AMD64 (K8)
 #define IMAGE_FILE_MACHINE_I386             0x014c  // Intel 386.
+#define IMAGE_FILE_MACHINE_ARMNT            0x01c4  // ARM Thumb-2 Little-Endian
+#define IMAGE_FILE_MACHINE_ARM64            0xAA64  // ARM64 Little-Endian
+#define IMAGE_FILE_MACHINE_ARM64EC          0xA641  // ARM64 code emulation compatible
+#define IMAGE_FILE_MACHINE_ARM64X           0xA64E  // ARM64 and ARM64EC in one image
 
 
 typedef struct _IMAGE_DOS_HEADER {      // DOS .EXE header
@@ -72,6 +76,43 @@ typedef const IMAGE_DATA_DIRECTORY* PCIMAGE_DATA_DIRECTORY;
 #define IMAGE_NT_OPTIONAL_HDR32_MAGIC      0x10b
 #define IMAGE_NT_OPTIONAL_HDR64_MAGIC      0x20b
 
+typedef struct _IMAGE_OPTIONAL_HEADER {
+    uint16_t    Magic;
+    uint8_t     MajorLinkerVersion;
+    uint8_t     MinorLinkerVersion;
+    uint32_t    SizeOfCode;
+    uint32_t    SizeOfInitializedData;
+    uint32_t    SizeOfUninitializedData;
+    uint32_t    AddressOfEntryPoint;
+    uint32_t    BaseOfCode;
+    uint32_t    BaseOfData;
+    uint32_t    ImageBase;
+    uint32_t    SectionAlignment;
+    uint32_t    FileAlignment;
+    uint16_t    MajorOperatingSystemVersion;
+    uint16_t    MinorOperatingSystemVersion;
+    uint16_t    MajorImageVersion;
+    uint16_t    MinorImageVersion;
+    uint16_t    MajorSubsystemVersion;
+    uint16_t    MinorSubsystemVersion;
+    uint32_t    Win32VersionValue;
+    uint32_t    SizeOfImage;
+    uint32_t    SizeOfHeaders;
+    uint32_t    CheckSum;
+    uint16_t    Subsystem;
+    uint16_t    DllCharacteristics;
+    uint32_t    SizeOfStackReserve;
+    uint32_t    SizeOfStackCommit;
+    uint32_t    SizeOfHeapReserve;
+    uint32_t    SizeOfHeapCommit;
+    uint32_t    LoaderFlags;
+    uint32_t    NumberOfRvaAndSizes;
+    IMAGE_DATA_DIRECTORY DataDirectory[IMAGE_NUMBEROF_DIRECTORY_ENTRIES];
+} IMAGE_OPTIONAL_HEADER32, *PIMAGE_OPTIONAL_HEADER32;
+
+typedef const IMAGE_OPTIONAL_HEADER32* PCIMAGE_OPTIONAL_HEADER32;
+
+
 typedef struct _IMAGE_OPTIONAL_HEADER64 {
     uint16_t    Magic;
     uint8_t     MajorLinkerVersion;
@@ -116,6 +157,15 @@ typedef struct _IMAGE_NT_HEADERS64 {
 
 typedef const IMAGE_NT_HEADERS64* PCIMAGE_NT_HEADERS64;
 
+
+typedef struct _IMAGE_NT_HEADERS {
+    uint32_t    Signature;
+    IMAGE_FILE_HEADER FileHeader;
+    IMAGE_OPTIONAL_HEADER32 OptionalHeader;
+} IMAGE_NT_HEADERS32, *PIMAGE_NT_HEADERS32;
+
+typedef const IMAGE_NT_HEADERS32* PCIMAGE_NT_HEADERS32;
+
 // Directory Entries (indexes into OptionalHeader.DataDirectory[])
 
 #define IMAGE_DIRECTORY_ENTRY_EXPORT          0   // Export Directory
@@ -163,3 +213,309 @@ typedef struct _IMAGE_SECTION_HEADER {
 typedef const IMAGE_SECTION_HEADER* PCIMAGE_SECTION_HEADER;
 
 #define IMAGE_SIZEOF_SECTION_HEADER          40
+
+
+//
+// Export Format
+//
+
+typedef struct _IMAGE_EXPORT_DIRECTORY {
+    uint32_t    Characteristics;
+    uint32_t    TimeDateStamp;
+    uint16_t    MajorVersion;
+    uint16_t    MinorVersion;
+    uint32_t    Name;
+    uint32_t    Base;
+    uint32_t    NumberOfFunctions;
+    uint32_t    NumberOfNames;
+    uint32_t    AddressOfFunctions;     // RVA from base of image
+    uint32_t    AddressOfNames;         // RVA from base of image
+    uint32_t    AddressOfNameOrdinals;  // RVA from base of image
+} IMAGE_EXPORT_DIRECTORY, *PIMAGE_EXPORT_DIRECTORY;
+
+typedef const IMAGE_EXPORT_DIRECTORY* PCIMAGE_EXPORT_DIRECTORY;
+
+
+//
+// Import Format
+//
+
+typedef struct _IMAGE_IMPORT_BY_NAME {
+    uint16_t    Hint;
+    char        Name[1];
+} IMAGE_IMPORT_BY_NAME, *PIMAGE_IMPORT_BY_NAME;
+
+typedef const IMAGE_IMPORT_BY_NAME* PCIMAGE_IMPORT_BY_NAME;
+
+#define IMAGE_ORDINAL_FLAG64                0x8000000000000000ull
+#define IMAGE_ORDINAL_FLAG32                0x80000000u
+#define IMAGE_ORDINAL64(Ordinal)            (Ordinal & 0xffff)
+#define IMAGE_ORDINAL32(Ordinal)            (Ordinal & 0xffff)
+
+typedef struct _IMAGE_IMPORT_DESCRIPTOR {
+    union {
+        uint32_t    Characteristics;            // 0 for terminating null import descriptor
+        uint32_t    OriginalFirstThunk;         // RVA to original unbound IAT (PIMAGE_THUNK_DATA)
+    };
+    uint32_t    TimeDateStamp;                  // 0 if not bound,
+                                                // -1 if bound, and real date\time stamp
+                                                //     in IMAGE_DIRECTORY_ENTRY_BOUND_IMPORT (new BIND)
+                                                // O.W. date/time stamp of DLL bound to (Old BIND)
+
+    uint32_t    ForwarderChain;                 // -1 if no forwarders
+    uint32_t    Name;
+    uint32_t    FirstThunk;                     // RVA to IAT (if bound this IAT has actual addresses)
+} IMAGE_IMPORT_DESCRIPTOR, *PIMAGE_IMPORT_DESCRIPTOR;
+
+typedef const IMAGE_IMPORT_DESCRIPTOR* PCIMAGE_IMPORT_DESCRIPTOR;
+
+
+//
+// Based relocation format.
+//
+
+typedef struct _IMAGE_BASE_RELOCATION {
+    uint32_t    VirtualAddress;
+    uint32_t    SizeOfBlock;
+//  uint16_t    TypeOffset[1];
+} IMAGE_BASE_RELOCATION, *PIMAGE_BASE_RELOCATION;
+
+typedef const IMAGE_BASE_RELOCATION* PCIMAGE_BASE_RELOCATION;
+
+//
+// Based relocation types.
+//
+
+#define IMAGE_REL_BASED_ABSOLUTE              0
+#define IMAGE_REL_BASED_HIGH                  1
+#define IMAGE_REL_BASED_LOW                   2
+#define IMAGE_REL_BASED_HIGHLOW               3
+#define IMAGE_REL_BASED_HIGHADJ               4
+#define IMAGE_REL_BASED_ARM_MOV32             5
+#define IMAGE_REL_BASED_THUMB_MOV32           7
+#define IMAGE_REL_BASED_DIR64                 10
+
+
+//
+// Thread Local Storage
+//
+
+typedef struct _IMAGE_TLS_DIRECTORY64 {
+    uint64_t    StartAddressOfRawData;
+    uint64_t    EndAddressOfRawData;
+    uint64_t    AddressOfIndex;         // PDWORD
+    uint64_t    AddressOfCallBacks;     // PIMAGE_TLS_CALLBACK *;
+    uint32_t    SizeOfZeroFill;
+    uint32_t    Characteristics;
+} IMAGE_TLS_DIRECTORY64, *PIMAGE_TLS_DIRECTORY64;
+
+typedef const IMAGE_TLS_DIRECTORY64* PCIMAGE_TLS_DIRECTORY64;
+
+typedef struct _IMAGE_TLS_DIRECTORY32 {
+    uint32_t    StartAddressOfRawData;
+    uint32_t    EndAddressOfRawData;
+    uint32_t    AddressOfIndex;         // PDWORD
+    uint32_t    AddressOfCallBacks;     // PIMAGE_TLS_CALLBACK *
+    uint32_t    SizeOfZeroFill;
+    uint32_t    Characteristics;
+} IMAGE_TLS_DIRECTORY32, *PIMAGE_TLS_DIRECTORY32;
+
+typedef const IMAGE_TLS_DIRECTORY32* PCIMAGE_TLS_DIRECTORY32;
+
+
+//
+// Load Configuration Directory Entry
+//
+
+typedef struct _IMAGE_LOAD_CONFIG_CODE_INTEGRITY {
+    uint16_t    Flags;          // Flags to indicate if CI information is available, etc.
+    uint16_t    Catalog;        // 0xFFFF means not available
+    uint32_t    CatalogOffset;
+    uint32_t    Reserved;       // Additional bitmask to be defined later
+} IMAGE_LOAD_CONFIG_CODE_INTEGRITY, *PIMAGE_LOAD_CONFIG_CODE_INTEGRITY;
+
+typedef struct _IMAGE_LOAD_CONFIG_DIRECTORY32 {
+    uint32_t    Size;
+    uint32_t    TimeDateStamp;
+    uint16_t    MajorVersion;
+    uint16_t    MinorVersion;
+    uint32_t    GlobalFlagsClear;
+    uint32_t    GlobalFlagsSet;
+    uint32_t    CriticalSectionDefaultTimeout;
+    uint32_t    DeCommitFreeBlockThreshold;
+    uint32_t    DeCommitTotalFreeThreshold;
+    uint32_t    LockPrefixTable;                // VA
+    uint32_t    MaximumAllocationSize;
+    uint32_t    VirtualMemoryThreshold;
+    uint32_t    ProcessHeapFlags;
+    uint32_t    ProcessAffinityMask;
+    uint16_t    CSDVersion;
+    uint16_t    DependentLoadFlags;
+    uint32_t    EditList;                       // VA
+    uint32_t    SecurityCookie;                 // VA
+    uint32_t    SEHandlerTable;                 // VA
+    uint32_t    SEHandlerCount;
+    uint32_t    GuardCFCheckFunctionPointer;    // VA
+    uint32_t    GuardCFDispatchFunctionPointer; // VA
+    uint32_t    GuardCFFunctionTable;           // VA
+    uint32_t    GuardCFFunctionCount;
+    uint32_t    GuardFlags;
+    IMAGE_LOAD_CONFIG_CODE_INTEGRITY CodeIntegrity;
+    uint32_t    GuardAddressTakenIatEntryTable; // VA
+    uint32_t    GuardAddressTakenIatEntryCount;
+    uint32_t    GuardLongJumpTargetTable;       // VA
+    uint32_t    GuardLongJumpTargetCount;
+} IMAGE_LOAD_CONFIG_DIRECTORY32, *PIMAGE_LOAD_CONFIG_DIRECTORY32;
+
+typedef const IMAGE_LOAD_CONFIG_DIRECTORY32* PCIMAGE_LOAD_CONFIG_DIRECTORY32;
+
+typedef struct _IMAGE_LOAD_CONFIG_DIRECTORY64 {
+    uint32_t    Size;
+    uint32_t    TimeDateStamp;
+    uint16_t    MajorVersion;
+    uint16_t    MinorVersion;
+    uint32_t    GlobalFlagsClear;
+    uint32_t    GlobalFlagsSet;
+    uint32_t    CriticalSectionDefaultTimeout;
+    uint64_t    DeCommitFreeBlockThreshold;
+    uint64_t    DeCommitTotalFreeThreshold;
+    uint64_t    LockPrefixTable;                // VA
+    uint64_t    MaximumAllocationSize;
+    uint64_t    VirtualMemoryThreshold;
+    uint64_t    ProcessAffinityMask;
+    uint32_t    ProcessHeapFlags;
+    uint16_t    CSDVersion;
+    uint16_t    DependentLoadFlags;
+    uint64_t    EditList;                       // VA
+    uint64_t    SecurityCookie;                 // VA
+    uint64_t    SEHandlerTable;                 // VA
+    uint64_t    SEHandlerCount;
+    uint64_t    GuardCFCheckFunctionPointer;    // VA
+    uint64_t    GuardCFDispatchFunctionPointer; // VA
+    uint64_t    GuardCFFunctionTable;           // VA
+    uint64_t    GuardCFFunctionCount;
+    uint32_t    GuardFlags;
+    IMAGE_LOAD_CONFIG_CODE_INTEGRITY CodeIntegrity;
+    uint64_t    GuardAddressTakenIatEntryTable; // VA
+    uint64_t    GuardAddressTakenIatEntryCount;
+    uint64_t    GuardLongJumpTargetTable;       // VA
+    uint64_t    GuardLongJumpTargetCount;
+} IMAGE_LOAD_CONFIG_DIRECTORY64, *PIMAGE_LOAD_CONFIG_DIRECTORY64;
+
+typedef const IMAGE_LOAD_CONFIG_DIRECTORY64* PCIMAGE_LOAD_CONFIG_DIRECTORY64;
+
+#define IMAGE_GUARD_CF_INSTRUMENTED                    0x00000100 // Module performs control flow integrity checks using system-supplied support
+#define IMAGE_GUARD_CFW_INSTRUMENTED                   0x00000200 // Module performs control flow and write integrity checks
+#define IMAGE_GUARD_CF_FUNCTION_TABLE_PRESENT          0x00000400 // Module contains valid control flow target metadata
+#define IMAGE_GUARD_SECURITY_COOKIE_UNUSED             0x00000800 // Module does not make use of the /GS security cookie
+#define IMAGE_GUARD_CF_LONGJUMP_TABLE_PRESENT          0x00010000 // Module contains longjmp target information
+#define IMAGE_GUARD_CF_FUNCTION_TABLE_SIZE_MASK        0xF0000000 // Stride of Guard CF function table encoded in these bits (additional count of bytes per element)
+#define IMAGE_GUARD_CF_FUNCTION_TABLE_SIZE_SHIFT       28         // Shift to right-justify Guard CF function table stride
+
+
+//
+// Resource Format.
+//
+
+typedef struct _IMAGE_RESOURCE_DIRECTORY {
+    uint32_t    Characteristics;
+    uint32_t    TimeDateStamp;
+    uint16_t    MajorVersion;
+    uint16_t    MinorVersion;
+    uint16_t    NumberOfNamedEntries;
+    uint16_t    NumberOfIdEntries;
+//  IMAGE_RESOURCE_DIRECTORY_ENTRY DirectoryEntries[];
+} IMAGE_RESOURCE_DIRECTORY, *PIMAGE_RESOURCE_DIRECTORY;
+
+typedef const IMAGE_RESOURCE_DIRECTORY* PCIMAGE_RESOURCE_DIRECTORY;
+
+#define IMAGE_RESOURCE_NAME_IS_STRING        0x80000000
+#define IMAGE_RESOURCE_DATA_IS_DIRECTORY     0x80000000
+
+//
+// Each directory contains the 32-bit Name of the entry and an offset,
+// relative to the beginning of the resource directory of the data associated
+// with this directory entry.  If the name of the entry is an actual text
+// string instead of an integer Id, then the high order bit of the name field
+// is set to one and the low order 31-bits are an offset, relative to the
+// beginning of the resource directory of the string, which is of type
+// IMAGE_RESOURCE_DIR_STRING_U.  Otherwise the high bit is clear and the
+// low-order 16-bits are the integer Id that identify this resource directory
+// entry. If the directory entry is yet another resource directory (i.e. a
+// subdirectory), then the high order bit of the offset field will be
+// set to indicate this.  Otherwise the high bit is clear and the offset
+// field points to a resource data entry.
+//
+
+typedef struct _IMAGE_RESOURCE_DIRECTORY_ENTRY {
+    uint32_t    Name;                   // NameOffset:31 NameIsString:1 | Id:16
+    uint32_t    OffsetToData;           // OffsetToDirectory:31 DataIsDirectory:1
+} IMAGE_RESOURCE_DIRECTORY_ENTRY, *PIMAGE_RESOURCE_DIRECTORY_ENTRY;
+
+typedef const IMAGE_RESOURCE_DIRECTORY_ENTRY* PCIMAGE_RESOURCE_DIRECTORY_ENTRY;
+
+typedef struct _IMAGE_RESOURCE_DIR_STRING_U {
+    uint16_t    Length;
+    uint16_t    NameString[1];          // WCHAR, not NUL terminated
+} IMAGE_RESOURCE_DIR_STRING_U, *PIMAGE_RESOURCE_DIR_STRING_U;
+
+typedef const IMAGE_RESOURCE_DIR_STRING_U* PCIMAGE_RESOURCE_DIR_STRING_U;
+
+typedef struct _IMAGE_RESOURCE_DATA_ENTRY {
+    uint32_t    OffsetToData;           // RVA, not an offset into the resource directory
+    uint32_t    Size;
+    uint32_t    CodePage;
+    uint32_t    Reserved;
+} IMAGE_RESOURCE_DATA_ENTRY, *PIMAGE_RESOURCE_DATA_ENTRY;
+
+typedef const IMAGE_RESOURCE_DATA_ENTRY* PCIMAGE_RESOURCE_DATA_ENTRY;
+
+//
+// Predefined Resource Types (winuser.h, MAKEINTRESOURCE ids)
+//
+
+#define RT_CURSOR           1
+#define RT_BITMAP           2
+#define RT_ICON             3
+#define RT_MENU             4
+#define RT_DIALOG           5
+#define RT_STRING           6
+#define RT_FONTDIR          7
+#define RT_FONT             8
+#define RT_ACCELERATOR      9
+#define RT_RCDATA           10
+#define RT_MESSAGETABLE     11
+#define RT_GROUP_CURSOR     12
+#define RT_GROUP_ICON       14
+#define RT_VERSION          16
+#define RT_DLGINCLUDE       17
+#define RT_PLUGPLAY         19
+#define RT_VXD              20
+#define RT_ANICURSOR        21
+#define RT_ANIICON          22
+#define RT_HTML             23
+#define RT_MANIFEST         24
+
+//
+// Version Information (verrsrc.h)
+//
+
+#define VS_FFI_SIGNATURE    0xFEEF04BD
+
+typedef struct _VS_FIXEDFILEINFO {
+    uint32_t    dwSignature;            // e.g. 0xfeef04bd
+    uint32_t    dwStrucVersion;         // e.g. 0x00000042 = "0.42"
+    uint32_t    dwFileVersionMS;        // e.g. 0x00030075 = "3.75"
+    uint32_t    dwFileVersionLS;        // e.g. 0x00000031 = "0.31"
+    uint32_t    dwProductVersionMS;     // e.g. 0x00030010 = "3.10"
+    uint32_t    dwProductVersionLS;     // e.g. 0x00000031 = "0.31"
+    uint32_t    dwFileFlagsMask;        // = 0x3F for version "0.42"
+    uint32_t    dwFileFlags;            // e.g. VFF_DEBUG | VFF_PRERELEASE
+    uint32_t    dwFileOS;               // e.g. VOS_DOS_WINDOWS16
+    uint32_t    dwFileType;             // e.g. VFT_DRIVER
+    uint32_t    dwFileSubtype;          // e.g. VFT2_DRV_KEYBOARD
+    uint32_t    dwFileDateMS;           // e.g. 0
+    uint32_t    dwFileDateLS;           // e.g. 0
+} VS_FIXEDFILEINFO, *PVS_FIXEDFILEINFO;
+
+typedef const VS_FIXEDFILEINFO* PCVS_FIXEDFILEINFO;
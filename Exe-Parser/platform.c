@@ -0,0 +1,286 @@
+/**
+ * @file platform.c
+ * @brief Threads, locks, atomics and directory listing on Windows (Win32) and POSIX (pthreads, dirent)
+ * @date 2026-10-16
+ *
+ * Kept apart from pehdr.h, which redefines winnt.h types that windows.h brings along.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+#include "platform.h"
+
+
+//*********************************************************************************
+// DECLARATIONS
+//*********************************************************************************
+
+/**
+ * @brief a thread started by runThreads()
+ */
+typedef struct _THREAD_START {
+    THREAD_ROUTINE  routine;
+    void            *context;
+    unsigned        index;
+} THREAD_START, *PTHREAD_START;
+
+
+//*********************************************************************************
+// DEFINITIONS
+//********************************************************************************
+
+#ifdef _WIN32
+
+struct _LOCK {
+    CRITICAL_SECTION    section;
+};
+
+
+PLOCK createLock(void) {
+    PLOCK lock = malloc(sizeof(*lock));
+    if (lock) {
+        InitializeCriticalSection(&lock->section);
+    }
+    return lock;
+}
+
+
+void destroyLock(PLOCK lock) {
+    if (lock) {
+        DeleteCriticalSection(&lock->section);
+        free(lock);
+    }
+}
+
+
+void acquireLock(PLOCK lock) {
+    EnterCriticalSection(&lock->section);
+}
+
+
+void releaseLock(PLOCK lock) {
+    LeaveCriticalSection(&lock->section);
+}
+
+
+static DWORD WINAPI threadStart(LPVOID parameter) {
+    PTHREAD_START start = parameter;
+    start->routine(start->context, start->index);
+    return 0;
+}
+
+
+unsigned runThreads(unsigned count, THREAD_ROUTINE routine, void *context) {
+
+    // without memory for the thread table the routine still runs, on the calling thread only
+    HANDLE *handles = count > 1 ? malloc(count * sizeof(*handles)) : NULL;
+    PTHREAD_START starts = count > 1 ? malloc(count * sizeof(*starts)) : NULL;
+    if (!handles || !starts) {
+        count = 1;
+    }
+    unsigned started = 1;
+    for (unsigned idx = 1; idx < count; idx++) {
+        starts[started] = (THREAD_START) { routine, context, started };
+        handles[started] = CreateThread(NULL, 0, threadStart, &starts[started], 0, NULL);
+        if (!handles[started]) {
+            break;
+        }
+        started++;
+    }
+    routine(context, 0);
+    for (unsigned idx = 1; idx < started; idx++) {
+        WaitForSingleObject(handles[idx], INFINITE);
+        CloseHandle(handles[idx]);
+    }
+    free(handles);
+    free(starts);
+    return started;
+}
+
+
+void yieldThread(void) {
+    SwitchToThread();
+}
+
+
+void sleepThread(unsigned milliseconds) {
+    Sleep(milliseconds);
+}
+
+
+unsigned processorCount(void) {
+    DWORD count = GetActiveProcessorCount(ALL_PROCESSOR_GROUPS);
+    return count ? (unsigned) count : 1;
+}
+
+
+int64_t atomicAdd(volatile int64_t *value, int64_t delta) {
+    return InterlockedExchangeAdd64((volatile LONG64 *) value, delta) + delta;
+}
+
+
+int listDirectory(const char *path, LIST_CALLBACK callback, void *context) {
+
+    // "<path>\*", the pattern FindFirstFile expects
+    size_t length = strlen(path);
+    char *pattern = malloc(length + 3);
+    if (!pattern) {
+        errno = ENOMEM;
+        return -1;
+    }
+    memcpy(pattern, path, length);
+    memcpy(pattern + length, "\\*", 3);
+
+    WIN32_FIND_DATAA data;
+    HANDLE find = FindFirstFileExA(pattern, FindExInfoBasic, &data, FindExSearchNameMatch, NULL, FIND_FIRST_EX_LARGE_FETCH);
+    free(pattern);
+    if (find == INVALID_HANDLE_VALUE) {
+        errno = GetLastError() == ERROR_ACCESS_DENIED ? EACCES : ENOENT;
+        return -1;
+    }
+    do {
+        if (!strcmp(data.cFileName, ".") || !strcmp(data.cFileName, "..")
+                || data.dwFileAttributes & (FILE_ATTRIBUTE_REPARSE_POINT | FILE_ATTRIBUTE_DEVICE)) {
+            continue;
+        }
+        callback(context, data.cFileName, data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY ? ENTRY_DIRECTORY : ENTRY_FILE);
+    } while (FindNextFileA(find, &data));
+    FindClose(find);
+    return 0;
+}
+
+#else
+
+struct _LOCK {
+    pthread_mutex_t     mutex;
+};
+
+
+PLOCK createLock(void) {
+    PLOCK lock = malloc(sizeof(*lock));
+    if (lock && pthread_mutex_init(&lock->mutex, NULL)) {
+        free(lock);
+        return NULL;
+    }
+    return lock;
+}
+
+
+void destroyLock(PLOCK lock) {
+    if (lock) {
+        pthread_mutex_destroy(&lock->mutex);
+        free(lock);
+    }
+}
+
+
+void acquireLock(PLOCK lock) {
+    pthread_mutex_lock(&lock->mutex);
+}
+
+
+void releaseLock(PLOCK lock) {
+    pthread_mutex_unlock(&lock->mutex);
+}
+
+
+static void *threadStart(void *parameter) {
+    PTHREAD_START start = parameter;
+    start->routine(start->context, start->index);
+    return NULL;
+}
+
+
+unsigned runThreads(unsigned count, THREAD_ROUTINE routine, void *context) {
+
+    // without memory for the thread table the routine still runs, on the calling thread only
+    pthread_t *threads = count > 1 ? malloc(count * sizeof(*threads)) : NULL;
+    PTHREAD_START starts = count > 1 ? malloc(count * sizeof(*starts)) : NULL;
+    if (!threads || !starts) {
+        count = 1;
+    }
+    unsigned started = 1;
+    for (unsigned idx = 1; idx < count; idx++) {
+        starts[started] = (THREAD_START) { routine, context, started };
+        if (pthread_create(&threads[started], NULL, threadStart, &starts[started])) {
+            break;
+        }
+        started++;
+    }
+    routine(context, 0);
+    for (unsigned idx = 1; idx < started; idx++) {
+        pthread_join(threads[idx], NULL);
+    }
+    free(threads);
+    free(starts);
+    return started;
+}
+
+
+void yieldThread(void) {
+    sched_yield();
+}
+
+
+void sleepThread(unsigned milliseconds) {
+    struct timespec duration = { milliseconds / 1000, (long) (milliseconds % 1000) * 1000000 };
+    nanosleep(&duration, NULL);
+}
+
+
+unsigned processorCount(void) {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (unsigned) count : 1;
+}
+
+
+int64_t atomicAdd(volatile int64_t *value, int64_t delta) {
+    return __atomic_add_fetch(value, delta, __ATOMIC_SEQ_CST);
+}
+
+
+int listDirectory(const char *path, LIST_CALLBACK callback, void *context) {
+
+    DIR *directory = opendir(path);
+    if (!directory) {
+        return -1;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(directory))) {
+        if (!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, "..")) {
+            continue;
+        }
+
+        // file systems that do not report the type in the entry need a stat, without following links
+        unsigned char type = entry->d_type;
+        if (type == DT_UNKNOWN) {
+            struct stat st;
+            if (fstatat(dirfd(directory), entry->d_name, &st, AT_SYMLINK_NOFOLLOW) == -1) {
+                continue;
+            }
+            type = S_ISREG(st.st_mode) ? DT_REG : S_ISDIR(st.st_mode) ? DT_DIR : DT_UNKNOWN;
+        }
+        if (type == DT_REG || type == DT_DIR) {
+            callback(context, entry->d_name, type == DT_DIR ? ENTRY_DIRECTORY : ENTRY_FILE);
+        }
+    }
+    closedir(directory);
+    return 0;
+}
+
+#endif
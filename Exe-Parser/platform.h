@@ -0,0 +1,107 @@
+//-------------------------------------------------------------------------------------------------
+// platform.h
+//
+// Threads, locks, atomics and directory listing on Windows (Win32) and POSIX (pthreads, dirent),
+// the little the corpus scanner needs from the operating system
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+#include <stdint.h>
+
+#ifdef _WIN32
+#define PATH_SEPARATOR '\\'
+#else
+#define PATH_SEPARATOR '/'
+#endif
+
+
+/**
+ * @brief a mutual exclusion lock, opaque
+ */
+typedef struct _LOCK LOCK, *PLOCK;
+
+/**
+ * @brief kind of a directory entry, entries of other kinds (links, devices) are not listed
+ */
+typedef enum _ENTRY_KIND {
+    ENTRY_FILE,
+    ENTRY_DIRECTORY,
+} ENTRY_KIND;
+
+/**
+ * @brief Receives one entry of a directory listing
+ *
+ * @param[in] context Context given to listDirectory()
+ * @param[in] name Name of the entry, without the directory
+ * @param[in] kind Kind of the entry
+ */
+typedef void (*LIST_CALLBACK)(void *context, const char *name, ENTRY_KIND kind);
+
+/**
+ * @brief Runs on each thread started by runThreads()
+ *
+ * @param[in] context Context given to runThreads()
+ * @param[in] index 0 for the calling thread, 1 to count - 1 for the others
+ */
+typedef void (*THREAD_ROUTINE)(void *context, unsigned index);
+
+
+/**
+ * @brief Creates a lock
+ *
+ * @return Lock to free with destroyLock() | NULL if out of memory
+ */
+PLOCK createLock(void);
+
+/**
+ * @brief Frees a lock created by createLock(), NULL is ignored
+ */
+void destroyLock(PLOCK lock);
+
+void acquireLock(PLOCK lock);
+
+void releaseLock(PLOCK lock);
+
+/**
+ * @brief Runs a routine on count threads, the calling thread being one of them, and waits for all to return
+ * @remark Threads that cannot be created are not retried, the routine runs on fewer threads instead
+ *
+ * @param[in] count Threads, at least 1
+ * @param[in] routine Routine to run
+ * @param[in] context Passed to each call of the routine
+ * @return Threads the routine ran on
+ */
+unsigned runThreads(unsigned count, THREAD_ROUTINE routine, void *context);
+
+/**
+ * @brief Gives the rest of the time slice of the calling thread to other threads
+ */
+void yieldThread(void);
+
+/**
+ * @brief Suspends the calling thread for about the given time, for threads waiting on others
+ */
+void sleepThread(unsigned milliseconds);
+
+/**
+ * @brief Returns the number of logical processors, at least 1
+ */
+unsigned processorCount(void);
+
+/**
+ * @brief Adds to a value shared between threads, atomically and with full ordering
+ *
+ * @return The value after the addition
+ */
+int64_t atomicAdd(volatile int64_t *value, int64_t delta);
+
+/**
+ * @brief Lists the files and subdirectories of a directory, without "." and ".."
+ * @remark Links are not followed, so a link to a parent directory cannot make a walk loop
+ *
+ * @param[in] path Directory to list
+ * @param[in] callback Called for each file and subdirectory, in no particular order
+ * @param[in] context Passed to each call of the callback
+ * @return 0 = SUCCESS | -1 = ERROR (errno set)
+ */
+int listDirectory(const char *path, LIST_CALLBACK callback, void *context);
@@ -0,0 +1,388 @@
+/**
+ * @file batch.c
+ * @brief Batch mode: dumps many inputs in one run, on a worker pool, in command line order
+ * @date 2026-10-16
+ *
+ * Each job is one input. Workers open, dump and close small inputs on their own, into a slot buffer sized
+ * for the whole dump so nothing is written out of order; the main thread copies finished dumps to the
+ * output in list order, behind their header. Inputs larger than BATCH_INLINE_MAX (or of unknown size)
+ * are left to the main thread, which dumps them straight to the output when their turn comes.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "batch.h"
+#include "pool.h"
+
+
+//*********************************************************************************
+// DECLARATIONS
+//*********************************************************************************
+
+// job slots per worker, small inputs are quick so each worker gets a few queued
+#define SLOTS_PER_WORKER 4
+
+// bytes of a list file read per read() call
+#define LIST_READ_SIZE (64u << 10)
+
+/**
+ * @brief result of one input, filled by the worker and reported by the consumer
+ */
+typedef struct batch_file {
+	const char *path;
+	int error;				// errno of the failed step, 0 = SUCCESS
+	bool deferred;			// too large for a slot buffer, dumped by the consumer
+} batch_file;
+
+/**
+ * @brief state shared by the callbacks of a batch
+ */
+typedef struct batch_run {
+	batch_file *files;
+	size_t count;
+	size_t next;			// next file to hand out
+	size_t printed;			// inputs whose header has been written
+	size_t failed;
+	const dump_options *options;
+	const input_range *range;
+	out_buffer *out;
+} batch_run;
+
+/**
+ * @brief Reads a whole list file (or stdin for "-") into a NUL terminated buffer
+ *
+ * @param path list file
+ * @return Returns the buffer, to be freed | NULL = ERROR (errno set)
+ */
+static char *read_list(const char *path);
+
+/**
+ * @brief Appends one path to a batch, growing the path array as needed
+ *
+ * @return 0 = SUCCESS | -1 = ERROR
+ */
+static int add_path(batch_list *list, const char *path);
+
+/**
+ * @brief Opens an input and selects the batch range in it
+ *
+ * @return 0 = SUCCESS | -1 = ERROR (errno set, in is closed)
+ */
+static int open_input(input_source *in, const char *path, const input_range *range);
+
+/**
+ * @brief Stages the header that goes in front of an input's dump
+ *
+ * @return 0 = SUCCESS | 1 = ERROR
+ */
+static int print_file_header(batch_run *run, const char *path);
+
+/**
+ * @brief Reports a failed input on stderr after writing everything before it, so the message shows up in order
+ *
+ * @return 0 = SUCCESS | 1 = ERROR
+ */
+static int report_failure(batch_run *run, const batch_file *file);
+
+/**
+ * @brief pool_ops.produce: hands out the next input
+ */
+static int batch_produce(void *ctx, pool_job *job);
+
+/**
+ * @brief pool_ops.work: dumps a small input into the slot buffer, or marks it deferred
+ */
+static int batch_work(void *ctx, pool_job *job);
+
+/**
+ * @brief pool_ops.consume: writes an input's header and dump, dumping deferred inputs on the spot
+ */
+static int batch_consume(void *ctx, pool_job *job);
+
+
+//*********************************************************************************
+// DEFINITIONS
+//*********************************************************************************
+
+int batch_add(batch_list *list, const char *arg){
+
+	if (arg[0] != '@'){
+		return add_path(list, arg);
+	}
+
+	char *text = read_list(arg + 1);
+	if (!text){
+		return -1;
+	}
+	char **lists = realloc(list->lists, (list->list_count + 1) * sizeof(*lists));
+	if (!lists){
+		free(text);
+		return -1;
+	}
+	list->lists = lists;
+	list->lists[list->list_count++] = text;
+
+	// split the list in place, one path per line
+	for (char *line = text; *line; ){
+		char *end = strchr(line, '\n');
+		char *next = end ? end + 1 : line + strlen(line);
+		if (!end){
+			end = next;
+		}
+		if (end > line && end[-1] == '\r'){
+			end--;
+		}
+		*end = '\0';
+		if (*line && add_path(list, line)){
+			return -1;
+		}
+		line = next;
+	}
+	return 0;
+}
+
+
+void batch_free(batch_list *list){
+
+	for (size_t idx = 0; idx < list->list_count; idx++){
+		free(list->lists[idx]);
+	}
+	free(list->lists);
+	free(list->paths);
+	*list = (batch_list) { 0 };
+}
+
+
+int batch_dump(const batch_list *list, const dump_options *options, const input_range *range, out_buffer *out, size_t *failed){
+
+	if (!list || !options || !range || !out || !failed) {
+		return EXIT_FAILURE;
+	}
+
+	batch_run run = { .count = list->count, .options = options, .range = range, .out = out };
+	run.files = calloc(list->count ? list->count : 1, sizeof(*run.files));
+	if (!run.files){
+		return EXIT_FAILURE;
+	}
+	for (size_t idx = 0; idx < list->count; idx++){
+		run.files[idx].path = list->paths[idx];
+	}
+
+	const pool_ops ops = {
+		.produce = batch_produce,
+		.work = batch_work,
+		.consume = batch_consume,
+	};
+	int retval = pool_run(options->jobs, options->jobs * SLOTS_PER_WORKER, &ops, &run) ? EXIT_FAILURE : EXIT_SUCCESS;
+	*failed = run.failed;
+	free(run.files);
+	return retval;
+}
+
+
+static char *read_list(const char *path){
+
+	int fd = strcmp(path, "-") ? open(path, O_RDONLY | O_CLOEXEC) : STDIN_FILENO;
+	if (fd == -1){
+		return NULL;
+	}
+
+	size_t len = 0, cap = LIST_READ_SIZE;
+	char *text = malloc(cap + 1);
+	while (text){
+		if (cap - len < LIST_READ_SIZE){
+			char *grown = realloc(text, cap * 2 + 1);
+			if (!grown){
+				break;
+			}
+			text = grown;
+			cap *= 2;
+		}
+		ssize_t got = read(fd, text + len, cap - len);
+		if (got < 0 && errno == EINTR){
+			continue;
+		}
+		if (got <= 0){
+			if (got == 0){
+				text[len] = '\0';
+				if (fd != STDIN_FILENO){
+					close(fd);
+				}
+				return text;
+			}
+			break;
+		}
+		len += (size_t) got;
+	}
+
+	int error = text ? errno : ENOMEM;
+	free(text);
+	if (fd != STDIN_FILENO){
+		close(fd);
+	}
+	errno = error;
+	return NULL;
+}
+
+
+static int add_path(batch_list *list, const char *path){
+
+	if (list->count == list->cap){
+		size_t cap = list->cap ? list->cap * 2 : 64;
+		const char **paths = realloc(list->paths, cap * sizeof(*paths));
+		if (!paths){
+			return -1;
+		}
+		list->paths = paths;
+		list->cap = cap;
+	}
+	list->paths[list->count++] = path;
+	return 0;
+}
+
+
+static int open_input(input_source *in, const char *path, const input_range *range){
+
+	*in = (input_source) { .fd = -1 };
+	if (input_open(in, path)){
+		return -1;
+	}
+	if (input_select(in, range)){
+		int error = errno;
+		input_close(in);
+		errno = error;
+		return -1;
+	}
+	return 0;
+}
+
+
+static int print_file_header(batch_run *run, const char *path){
+
+	// a blank line between inputs, C arrays carry their own name
+	if (run->printed++ > 0 && outbuf_append(run->out, "\n", 1)){
+		return EXIT_FAILURE;
+	}
+	if (run->options->line.style == OUTPUT_C){
+		return EXIT_SUCCESS;
+	}
+	const char *name = strcmp(path, "-") ? path : "<stdin>";
+	if (outbuf_append(run->out, "==> ", 4) || outbuf_append(run->out, name, strlen(name)) || outbuf_append(run->out, " <==\n", 5)){
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
+
+
+static int report_failure(batch_run *run, const batch_file *file){
+
+	if (outbuf_flush(run->out)){
+		return EXIT_FAILURE;
+	}
+	fprintf(stderr, "Could not dump \"%s\". Error: %d\n", file->path, file->error);
+	run->failed++;
+	return EXIT_SUCCESS;
+}
+
+
+static int batch_produce(void *ctx, pool_job *job){
+
+	batch_run *run = ctx;
+	if (run->next == run->count){
+		return 0;
+	}
+	job->arg = &run->files[run->next++];
+	return 1;
+}
+
+
+static int batch_work(void *ctx, pool_job *job){
+
+	batch_run *run = ctx;
+	batch_file *file = job->arg;
+	dump_options options = *run->options;
+	options.jobs = 1;
+	options.name = file->path;
+	job->out.len = 0;
+
+	input_source in;
+	if (open_input(&in, file->path, run->range)){
+		file->error = errno;
+		return 0;
+	}
+
+	// the slot buffer holds the whole dump, so it never has to be flushed before its turn
+	uint64_t end = in.size < in.limit ? in.size : in.limit;
+	if (!in.size_known || end - in.pos > BATCH_INLINE_MAX){
+		file->deferred = true;
+	}
+	else {
+		size_t width = options.line.width;
+		size_t lines = (size_t) ((end - in.pos + width - 1) / width);
+		size_t need = (lines + 2) * format_line_len(&options.line) + 2 * strlen(file->path) + 64;
+		if (job->out.cap < need){
+			outbuf_free(&job->out);
+			if (outbuf_init(&job->out, -1, need > OUTPUT_BUFFER_SIZE ? need : OUTPUT_BUFFER_SIZE)){
+				input_close(&in);
+				return -1;
+			}
+		}
+		if (dump_file(&in, &options, &job->out)){
+			file->error = errno ? errno : EIO;
+		}
+	}
+	if (input_close(&in) && !file->error){
+		file->error = errno;
+	}
+	return 0;
+}
+
+
+static int batch_consume(void *ctx, pool_job *job){
+
+	batch_run *run = ctx;
+	batch_file *file = job->arg;
+	int retval = EXIT_SUCCESS;
+
+	if (file->error){
+		retval = report_failure(run, file);
+	}
+	else if (!file->deferred){
+		if (print_file_header(run, file->path) || outbuf_append(run->out, job->out.buf, job->out.len)){
+			retval = EXIT_FAILURE;
+		}
+	}
+	else {
+		// large inputs stream through the output buffer like a single dump
+		dump_options options = *run->options;
+		options.jobs = 1;
+		options.name = file->path;
+		input_source in;
+		if (open_input(&in, file->path, run->range)){
+			file->error = errno;
+			retval = report_failure(run, file);
+		}
+		else {
+			if (print_file_header(run, file->path)){
+				retval = EXIT_FAILURE;
+			}
+			else if (dump_file(&in, &options, run->out)){
+				file->error = errno ? errno : EIO;
+			}
+			if (input_close(&in) && !file->error){
+				file->error = errno;
+			}
+			if (file->error && retval == EXIT_SUCCESS){
+				retval = report_failure(run, file);
+			}
+		}
+	}
+	job->out.len = 0;
+	return retval ? -1 : 0;
+}
@@ -0,0 +1,71 @@
+/**
+ * @file batch.h
+ * @brief Batch mode: dumps many inputs in one run, on a worker pool, in command line order
+ * @date 2026-10-16
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "input.h"
+#include "format.h"
+#include "dump.h"
+
+
+//*********************************************************************************
+// DEFINITIONS
+//*********************************************************************************
+
+// inputs up to this many bytes are dumped by the workers into memory, larger ones by the main thread in order
+#define BATCH_INLINE_MAX (4u << 20)
+
+/**
+ * @brief paths given on the command line, with @listfile arguments expanded
+ */
+typedef struct batch_list {
+	const char **paths;		// inputs in command line order
+	size_t count;			// number of paths
+	size_t cap;				// capacity of paths
+	char **lists;			// contents of the list files, the paths of a list point into them
+	size_t list_count;		// number of list files read
+} batch_list;
+
+
+//*********************************************************************************
+// DECLARATIONS
+//*********************************************************************************
+
+/**
+ * @brief Adds a command line argument to a batch: a path, or "@file" to add every line of file as a path
+ * @remark "@-" reads the list from stdin. Empty lines and trailing '\r' are ignored.
+ *
+ * @param list batch to add to, zero initialized before the first call
+ * @param arg path or @listfile
+ * @return 0 = SUCCESS | -1 = ERROR (errno set)
+ */
+int batch_add(batch_list *list, const char *arg);
+
+/**
+ * @brief Frees the paths and list file contents of a batch
+ *
+ * @param list batch to free
+ */
+void batch_free(batch_list *list);
+
+/**
+ * @brief Dumps every input of a batch like dump_file() does, each behind a "==> path <==" header,
+ * in list order on options->jobs worker threads
+ * @remark Every input is opened, dumped and closed on its own: one that cannot be opened or read is
+ * reported on stderr (in order with the output) and the batch goes on. C arrays (-i) need no header,
+ * they are named after their input and separated by an empty line.
+ *
+ * @param list inputs to dump
+ * @param options dump options, name is set per input
+ * @param range range selected in every input
+ * @param out output buffer
+ * @param[out] failed receives the number of inputs that could not be dumped
+ * @return 0 = SUCCESS | 1 = ERROR (output could not be written)
+ */
+int batch_dump(const batch_list *list, const dump_options *options, const input_range *range, out_buffer *out, size_t *failed);
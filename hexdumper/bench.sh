@@ -0,0 +1,273 @@
+#!/usr/bin/env bash
+#
+# bench.sh
+#
+# Checks hexdump output against the golden files in golden/, then measures throughput
+# on synthetic inputs. Any golden mismatch fails the run before a single number is printed.
+#
+#   BENCH_SIZES   input sizes to measure, K/M/G suffixes (default "1K 1M 256M", up to 8G)
+#   BENCH_KINDS   input kinds: random, zero, text (default all three)
+#   BENCH_MODES   flag sets to run, separated by commas (default covers every format and mode)
+#   BASELINE      another hexdump binary to measure alongside
+#   DIFF_SIZE     size of the two random images --diff is measured on, 0 skips it (default 1G)
+#   GOLDEN_UPDATE set to 1 to rewrite the golden files from the current binary
+#
+# ./bench.sh check runs the golden checks only.
+#
+set -euo pipefail
+cd "$(dirname "$0")"
+
+HEXDUMP=${HEXDUMP:-./hexdump}
+BENCH_SIZES=${BENCH_SIZES:-1K 1M 256M}
+BENCH_KINDS=${BENCH_KINDS:-random zero text}
+BENCH_MODES=${BENCH_MODES:--h,-a,-h -a,-s -h -a,-w 64 -h -a,-g 4 -e,-j 0 -h -a,-i,--json -h -a,--csv -h -a,--entropy,-r}
+DIFF_SIZE=${DIFF_SIZE:-$((1 << 30))}
+BENCH_DIR=${BENCH_DIR:-${TMPDIR:-/tmp}/hexdump-bench}
+GOLDEN_DIR=golden
+
+# golden cases: name|flags, every case is also run with -j 4 and on every encoder kernel
+GOLDEN_CASES=(
+	"hex|-h"
+	"ascii|-a"
+	"both|-h -a"
+	"squeeze|-s -h -a"
+	"width8|-w 8 -h -a"
+	"width32|-w 32"
+	"width64|-w 64 -h -a"
+	"group2|-g 2"
+	"group4le|-g 4 -e -h -a"
+	"group8le32|-w 32 -g 8 -e"
+	"range|--skip 0x1F --length 200 -h -a"
+	"tail|--skip -100 -s"
+	"find|--find FEFF --find Hello -C 1"
+	"findtext|--find-text AB --find AB"
+	"entropy|--entropy"
+	"json|--json -h -a"
+	"csv|--csv -a -h -w 32"
+)
+
+mkdir -p "$BENCH_DIR"
+output="$BENCH_DIR/out.txt"
+dump="$BENCH_DIR/dump.txt"
+PYTHON=$(command -v python3 || true)
+
+now() { date +%s.%N; }
+
+# "1K" -> 1024
+to_bytes() {
+	local n=${1%[KkMmGg]}
+	case $1 in
+		*[Kk]) echo $((n << 10)) ;;
+		*[Mm]) echo $((n << 20)) ;;
+		*[Gg]) echo $((n << 30)) ;;
+		*) echo "$n" ;;
+	esac
+}
+
+DIFF_SIZE=$(to_bytes "$DIFF_SIZE")
+
+# run a command with stdout to a file, print "<seconds> <peak RSS in KiB>"
+measure() {
+	local out=$1; shift
+	if [ -n "$PYTHON" ]; then
+		"$PYTHON" -c '
+import resource, subprocess, sys, time
+with open(sys.argv[1], "wb") as out:
+	start = time.monotonic()
+	subprocess.run(sys.argv[2:], stdin=subprocess.DEVNULL, stdout=out, check=True)
+	end = time.monotonic()
+print("%.6f %d" % (end - start, resource.getrusage(resource.RUSAGE_CHILDREN).ru_maxrss))
+' "$out" "$@"
+	else
+		local start end
+		start=$(now)
+		"$@" < /dev/null > "$out"
+		end=$(now)
+		awk -v s="$start" -v e="$end" 'BEGIN { printf "%.6f -\n", e - s }'
+	fi
+}
+
+# golden input: text, every byte value, a zero run, repeated lines and a short last line
+make_sample() {
+	cat testfile.txt
+	for value in $(seq 0 255); do
+		printf "\\$(printf %o "$value")"
+	done
+	head -c 300 /dev/zero
+	for _ in 1 2 3 4 5 6; do
+		printf 'repeated line!!\n'
+	done
+	printf 'end of sample'
+}
+
+# compare every golden case on every kernel, serial and parallel, plus -r round trips
+check_golden() {
+	local sample="$BENCH_DIR/sample.bin"
+	local failed=0 checked=0
+	make_sample > "$sample"
+	mkdir -p "$GOLDEN_DIR"
+
+	for entry in "${GOLDEN_CASES[@]}"; do
+		local name=${entry%%|*} flags=${entry#*|}
+		local golden="$GOLDEN_DIR/$name.txt"
+		if [ "${GOLDEN_UPDATE:-0}" = 1 ]; then
+			# shellcheck disable=SC2086
+			"$HEXDUMP" "$sample" $flags > "$golden"
+			continue
+		fi
+		for kernel in scalar ssse3 avx2; do
+			for jobs in 1 4; do
+				# shellcheck disable=SC2086
+				HEXDUMP_KERNEL=$kernel "$HEXDUMP" "$sample" $flags -j $jobs > "$output"
+				checked=$((checked + 1))
+				if ! cmp -s "$output" "$golden"; then
+					printf "golden mismatch: %s (%s) kernel=%s -j %s\n" "$name" "$flags" "$kernel" "$jobs"
+					diff "$golden" "$output" | head -n 10 || true
+					failed=$((failed + 1))
+				fi
+			done
+		done
+	done
+	if [ "${GOLDEN_UPDATE:-0}" = 1 ]; then
+		printf "golden files rewritten in %s/\n" "$GOLDEN_DIR"
+		return
+	fi
+
+	# -r has to give back the exact bytes of every layout it can read
+	for flags in "-h" "-s -h -a" "-w 8 -a -h" "-w 64" "-g 2"; do
+		# shellcheck disable=SC2086
+		"$HEXDUMP" "$sample" $flags | "$HEXDUMP" - -r > "$output"
+		checked=$((checked + 1))
+		if ! cmp -s "$output" "$sample"; then
+			printf "round trip mismatch: %s | -r\n" "$flags"
+			failed=$((failed + 1))
+		fi
+	done
+	# -e dumps are read back with the same group size and byte order
+	for flags in "-g 4 -e -h -a" "-s -w 32 -g 8 -e" "-w 8 -g 2 -e"; do
+		# shellcheck disable=SC2086
+		"$HEXDUMP" "$sample" $flags | "$HEXDUMP" - -r $flags > "$output"
+		checked=$((checked + 1))
+		if ! cmp -s "$output" "$sample"; then
+			printf "round trip mismatch: %s | -r %s\n" "$flags" "$flags"
+			failed=$((failed + 1))
+		fi
+	done
+
+	: > "$BENCH_DIR/empty.bin"
+	"$HEXDUMP" "$BENCH_DIR/empty.bin" > "$output"
+	checked=$((checked + 1))
+	if [ "$(cat "$output")" != "File is empty." ]; then
+		printf "empty file mismatch\n"
+		failed=$((failed + 1))
+	fi
+
+	# files that report a size of 0 but have bytes are read to their end by every read-ahead backend
+	if [ -r /proc/version ]; then
+		HEXDUMP_READAHEAD=off "$HEXDUMP" /proc/version > "$dump"
+		for backend in uring thread; do
+			HEXDUMP_READAHEAD=$backend "$HEXDUMP" /proc/version > "$output"
+			checked=$((checked + 1))
+			if [ "$(cat "$output")" = "File is empty." ] || ! cmp -s "$output" "$dump"; then
+				printf "size 0 file mismatch: HEXDUMP_READAHEAD=%s\n" "$backend"
+				failed=$((failed + 1))
+			fi
+		done
+	fi
+
+	if [ "$failed" -gt 0 ]; then
+		printf "%d of %d golden checks failed\n" "$failed" "$checked"
+		exit 1
+	fi
+	printf "golden: %d checks passed\n" "$checked"
+}
+
+# synthetic input of a kind and size, kept between runs
+make_input() {
+	local kind=$1 size=$2 file="$BENCH_DIR/$1-$2.bin"
+	if [ ! -f "$file" ] || [ "$(stat -c %s "$file")" -ne "$size" ]; then
+		case $kind in
+			random) head -c "$size" /dev/urandom > "$file" ;;
+			zero) head -c "$size" /dev/zero > "$file" ;;
+			text)
+				# repeat testfile.txt up to size bytes by doubling it
+				cp testfile.txt "$file.tmp"
+				while [ "$(stat -c %s "$file.tmp")" -lt "$size" ]; do
+					cat "$file.tmp" "$file.tmp" > "$file.tmp2"
+					mv "$file.tmp2" "$file.tmp"
+				done
+				head -c "$size" "$file.tmp" > "$file"
+				rm -f "$file.tmp"
+				;;
+		esac
+	fi
+	echo "$file"
+}
+
+# one row: binary, flags, input; throughput against the bytes read and the dump lines they make (or hold, for -r)
+bench_row() {
+	local label=$1 bin=$2 flags=$3 input=$4 size=$5 lines=${6:-}
+	local width=16 result
+	case " $flags " in
+		*" -w 8 "*) width=8 ;;
+		*" -w 32 "*) width=32 ;;
+		*" -w 64 "*) width=64 ;;
+	esac
+	lines=${lines:-$(((size + width - 1) / width))}
+	# shellcheck disable=SC2086
+	result=$(measure /dev/null "$bin" "$input" $flags)
+	awk -v r="$result" -v n="$size" -v k="$lines" -v f="$flags" -v l="$label" \
+		'BEGIN { split(r, a, " "); t = a[1] > 0 ? a[1] : 1e-6;
+			printf "  %-14s %-9s %9.4fs %10.1f MB/s %12.0f lines/s %8s KiB RSS\n", f, l, t, n / t / 1e6, k / t, a[2] }'
+}
+
+check_golden
+if [ "${1:-}" = check ] || [ "${GOLDEN_UPDATE:-0}" = 1 ]; then
+	exit 0
+fi
+
+IFS=, read -r -a modes <<< "$BENCH_MODES"
+for size_text in $BENCH_SIZES; do
+	size=$(to_bytes "$size_text")
+	for kind in $BENCH_KINDS; do
+		input=$(make_input "$kind" "$size")
+		printf "%s %s\n" "$kind" "$size_text"
+		for flags in "${modes[@]}"; do
+			# -r reads back the plain dump of the same input
+			if [ "$flags" = "-r" ]; then
+				"$HEXDUMP" "$input" -h > "$dump"
+				bench_row hexdump "$HEXDUMP" -r "$dump" "$(stat -c %s "$dump")" "$(wc -l < "$dump")"
+				continue
+			fi
+			bench_row hexdump "$HEXDUMP" "$flags" "$input" "$size"
+			if [ -n "${BASELINE:-}" ]; then
+				bench_row baseline "$BASELINE" "$flags" "$input" "$size"
+			fi
+		done
+	done
+done
+rm -f "$dump"
+
+if [ "$DIFF_SIZE" -gt 0 ]; then
+	left="$BENCH_DIR/diff_a.bin"
+	right="$BENCH_DIR/diff_b.bin"
+	if [ ! -f "$left" ] || [ "$(stat -c %s "$left")" -ne "$DIFF_SIZE" ]; then
+		head -c "$DIFF_SIZE" /dev/urandom > "$left"
+	fi
+	# patch a handful of bytes spread over the image
+	cp "$left" "$right"
+	for at in 4097 $((DIFF_SIZE / 3)) $((DIFF_SIZE / 2 + 7)) $((DIFF_SIZE - 100)); do
+		printf 'PATCH' | dd of="$right" bs=1 seek="$at" conv=notrunc status=none
+	done
+
+	printf "diff %s\n" "$DIFF_SIZE"
+	result=$(measure "$output" "$HEXDUMP" --diff "$left" "$right" -h -a)
+	awk -v r="$result" -v n="$DIFF_SIZE" -v l="$(($(wc -l < "$output") - 1))" \
+		'BEGIN { split(r, a, " "); printf "  %-14s %-9s %9.4fs %10.1f MB/s per input %5d lines differ %8s KiB RSS\n", "--diff", "hexdump", a[1], n / a[1] / 1e6, l, a[2] }'
+	start=$(now)
+	cmp -l "$left" "$right" | wc -l > /dev/null || true		# cmp stops early when writing to /dev/null
+	end=$(now)
+	awk -v s="$start" -v e="$end" -v n="$DIFF_SIZE" \
+		'BEGIN { t = e - s; printf "  %-14s %-9s %9.4fs %10.1f MB/s per input\n", "--diff", "cmp -l", t, n / t / 1e6 }'
+fi
+rm -f "$output"
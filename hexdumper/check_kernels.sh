@@ -0,0 +1,60 @@
+#!/usr/bin/env bash
+#
+# check_kernels.sh
+#
+# Compares the SSSE3 and AVX2 line encoding kernels byte for byte with the scalar path, on random
+# inputs of sizes around the 16 and 32 byte blocks the kernels work on. Kernels the CPU lacks are
+# skipped with a note, since HEXDUMP_KERNEL would silently fall back to another one.
+#
+#   CHECK_SIZES   input sizes in bytes (default "0 1 15 16 17 31 32 33 48 1000003")
+#
+set -euo pipefail
+cd "$(dirname "$0")"
+
+HEXDUMP=${HEXDUMP:-./hexdump}
+CHECK_SIZES=${CHECK_SIZES:-0 1 15 16 17 31 32 33 48 1000003}
+CHECK_DIR=${CHECK_DIR:-${TMPDIR:-/tmp}/hexdump-kernels}
+
+# flag sets: hex, ASCII and both, plus the wide lines that reuse the 128-bit kernel
+CHECK_FLAGS=("-h" "-a" "-h -a" "-w 32 -h -a" "-w 64 -h -a")
+
+mkdir -p "$CHECK_DIR"
+expected="$CHECK_DIR/scalar.txt"
+output="$CHECK_DIR/out.txt"
+
+kernels=()
+for kernel in ssse3 avx2; do
+	if grep -qw "$kernel" /proc/cpuinfo 2>/dev/null; then
+		kernels+=("$kernel")
+	else
+		printf "kernel %s: not supported by this CPU, skipped\n" "$kernel"
+	fi
+done
+
+failed=0
+checked=0
+for size in $CHECK_SIZES; do
+	input="$CHECK_DIR/random-$size.bin"
+	head -c "$size" /dev/urandom > "$input"
+	for flags in "${CHECK_FLAGS[@]}"; do
+		# shellcheck disable=SC2086
+		HEXDUMP_KERNEL=scalar "$HEXDUMP" "$input" $flags > "$expected"
+		for kernel in "${kernels[@]}"; do
+			# shellcheck disable=SC2086
+			HEXDUMP_KERNEL=$kernel "$HEXDUMP" "$input" $flags > "$output"
+			checked=$((checked + 1))
+			if ! cmp -s "$output" "$expected"; then
+				printf "kernel mismatch: %s bytes (%s) kernel=%s\n" "$size" "$flags" "$kernel"
+				diff "$expected" "$output" | head -n 10 || true
+				failed=$((failed + 1))
+			fi
+		done
+	done
+done
+rm -rf "$CHECK_DIR"
+
+if [ "$failed" -gt 0 ]; then
+	printf "%d of %d kernel checks failed\n" "$failed" "$checked"
+	exit 1
+fi
+printf "kernels: %d checks passed\n" "$checked"
@@ -0,0 +1,162 @@
+/**
+ * @file diff.c
+ * @brief Diff mode: prints the lines that differ between two inputs side by side
+ * @date 2026-10-16
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include "diff.h"
+
+
+//*********************************************************************************
+// DECLARATIONS
+//*********************************************************************************
+
+/**
+ * @brief state of a diff run
+ */
+typedef struct diff_state {
+	const line_format *fmt;
+	out_buffer *out;
+	size_t line_len;			// characters of one side by side line, including the newline
+	uint64_t differences;		// differing lines printed so far
+} diff_state;
+
+/**
+ * @brief Compares one chunk of each input and prints the lines that differ
+ *
+ * @param st diff state
+ * @param a chunk of the left input
+ * @param a_len bytes at a, 0 once the left input has ended
+ * @param b chunk of the right input
+ * @param b_len bytes at b, 0 once the right input has ended
+ * @param offset absolute offset of both chunks
+ * @return 0 = SUCCESS | 1 = ERROR
+ */
+static int diff_chunk(diff_state *st, const uint8_t *a, size_t a_len, const uint8_t *b, size_t b_len, uint64_t offset);
+
+/**
+ * @brief Stages one side by side line, printing the column header before the first one
+ *
+ * @return 0 = SUCCESS | 1 = ERROR
+ */
+static int print_difference(diff_state *st, const uint8_t *a, size_t a_len, const uint8_t *b, size_t b_len, uint64_t offset);
+
+
+//*********************************************************************************
+// DEFINITIONS
+//*********************************************************************************
+
+int diff_files(input_source *a, input_source *b, const dump_options *options, out_buffer *out, uint64_t *differences){
+
+	if (!a || !b || !options || !out || !differences) {
+		return EXIT_FAILURE;
+	}
+
+	const line_format *fmt = &options->line;
+	size_t width = fmt->width;
+	diff_state st = {
+		.fmt = fmt,
+		.out = out,
+		.line_len = format_line_len(fmt) * 2 - OFFSET_COLUMN - 1 + strlen(DIFF_SEPARATOR),
+	};
+
+	while (true){
+		// holes both sides share hold nothing to compare
+		if (a->pos == b->pos){
+			uint64_t next_a = input_next_data(a, a->pos);
+			uint64_t next_b = input_next_data(b, b->pos);
+			uint64_t skip = (next_a < next_b ? next_a : next_b) - a->pos;
+			skip -= skip % width;
+			if (skip >= DUMP_HOLE_MIN && (input_seek(a, a->pos + skip) || input_seek(b, b->pos + skip))){
+				return EXIT_FAILURE;
+			}
+		}
+
+		// both inputs advance by the same full chunks until one of them ends
+		uint64_t offset = a->pos < b->pos ? b->pos : a->pos;
+		const uint8_t *chunk_a = NULL;
+		const uint8_t *chunk_b = NULL;
+		int64_t read_a = input_next(a, &chunk_a, 0, width);
+		int64_t read_b = input_next(b, &chunk_b, 0, width);
+		if (read_a < 0 || read_b < 0){
+			return EXIT_FAILURE;
+		}
+		if (read_a == 0 && read_b == 0){
+			break;
+		}
+		if (diff_chunk(&st, chunk_a, (size_t) read_a, chunk_b, (size_t) read_b, offset)){
+			return EXIT_FAILURE;
+		}
+	}
+
+	*differences = st.differences;
+	if (st.differences == 0){
+		return outbuf_append(out, "Files are identical.\n", 21) ? EXIT_FAILURE : EXIT_SUCCESS;
+	}
+	return EXIT_SUCCESS;
+}
+
+
+static int diff_chunk(diff_state *st, const uint8_t *a, size_t a_len, const uint8_t *b, size_t b_len, uint64_t offset){
+
+	size_t width = st->fmt->width;
+	size_t len = a_len > b_len ? a_len : b_len;
+	size_t common = a_len < b_len ? a_len : b_len;
+
+	size_t done = 0;
+	while (done < len){
+		// equal blocks go by at memory speed, libc's memcmp() compares a vector at a time
+		if (done + DIFF_BLOCK <= common && !memcmp(a + done, b + done, DIFF_BLOCK)){
+			done += DIFF_BLOCK;
+			continue;
+		}
+
+		// a block that differs somewhere: find the lines, a word at a time
+		size_t end = done + DIFF_BLOCK < len ? done + DIFF_BLOCK : len;
+		for (; done < end; done += width){
+			size_t line_a = a_len > done ? (a_len - done < width ? a_len - done : width) : 0;
+			size_t line_b = b_len > done ? (b_len - done < width ? b_len - done : width) : 0;
+			bool equal = line_a == line_b && (line_a == width ? lines_equal(a + done, b + done, width) : !memcmp(a + done, b + done, line_a));
+			if (!equal && print_difference(st, a + done, line_a, b + done, line_b, offset + done)){
+				return EXIT_FAILURE;
+			}
+		}
+	}
+	return EXIT_SUCCESS;
+}
+
+
+static int print_difference(diff_state *st, const uint8_t *a, size_t a_len, const uint8_t *b, size_t b_len, uint64_t offset){
+
+	// the header is the left header with the right one's columns appended
+	if (st->differences++ == 0){
+		char *dst = outbuf_reserve(st->out, st->line_len + OFFSET_COLUMN);
+		if (!dst){
+			return EXIT_FAILURE;
+		}
+		char *p = dst + format_header(dst, st->fmt) - 1;
+		memcpy(p, DIFF_SEPARATOR, strlen(DIFF_SEPARATOR));
+		p += strlen(DIFF_SEPARATOR);
+		size_t right = format_header(p, st->fmt) - OFFSET_COLUMN;
+		memmove(p, p + OFFSET_COLUMN, right);
+		outbuf_commit(st->out, (size_t) (p + right - dst));
+	}
+
+	char *dst = outbuf_reserve(st->out, st->line_len);
+	if (!dst){
+		return EXIT_FAILURE;
+	}
+	char *p = dst + format_line(dst, a, offset, st->fmt, a_len) - 1;
+	memcpy(p, DIFF_SEPARATOR, strlen(DIFF_SEPARATOR));
+	p += strlen(DIFF_SEPARATOR);
+	p += format_columns(p, b, st->fmt, b_len);
+	*p++ = '\n';
+	outbuf_commit(st->out, (size_t) (p - dst));
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,45 @@
+/**
+ * @file diff.h
+ * @brief Diff mode: prints the lines that differ between two inputs side by side
+ * @date 2026-10-16
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "input.h"
+#include "format.h"
+#include "dump.h"
+
+
+//*********************************************************************************
+// DEFINITIONS
+//*********************************************************************************
+
+// equal regions are skipped one memcmp() of this many bytes at a time, a multiple of every line width
+#define DIFF_BLOCK (4u << 10)
+
+// printed between the two sides of a line
+#define DIFF_SEPARATOR " | "
+
+
+//*********************************************************************************
+// DECLARATIONS
+//*********************************************************************************
+
+/**
+ * @brief Compares two inputs in lockstep and prints every line that differs, with a's columns on the
+ * left and b's on the right. Past the end of the shorter input its side is left blank.
+ * @remark Sparse holes both inputs share are skipped with SEEK_DATA, equal data is skipped DIFF_BLOCK
+ * bytes per memcmp(), so only differing lines cost formatting time
+ *
+ * @param a open input shown on the left
+ * @param b open input shown on the right, positioned at the same offset as a
+ * @param options dump options, only the line layout is used
+ * @param out output buffer
+ * @param[out] differences receives the number of differing lines printed
+ * @return 0 = SUCCESS | 1 = ERROR
+ */
+int diff_files(input_source *a, input_source *b, const dump_options *options, out_buffer *out, uint64_t *differences);
@@ -0,0 +1,359 @@
+/**
+ * @file dump.c
+ * @brief Dump engine: serial and multi-threaded dumping of an input to an output buffer
+ * @date 2026-10-16
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include "dump.h"
+#include "pool.h"
+
+
+//*********************************************************************************
+// DECLARATIONS
+//*********************************************************************************
+
+// context kept in front of every chunk: the two lines squeezing compares against, at the widest layout
+#define LEAD_ROOM (2 * LINE_SIZE_MAX)
+
+/**
+ * @brief chunk reader shared by the serial and parallel dumps
+ */
+typedef struct dump_stream {
+	input_source *input;
+	const dump_options *options;
+	uint64_t start;					// absolute offset of the first byte dumped
+	uint8_t tail[LEAD_ROOM];		// last bytes read, handed to the next chunk as lead
+	size_t tail_len;				// valid bytes in tail
+} dump_stream;
+
+/**
+ * @brief state shared by the callbacks of a parallel dump
+ */
+typedef struct parallel_dump {
+	dump_stream stream;
+	out_buffer *out;
+	size_t line_len;
+	bool started;			// header has been written
+} parallel_dump;
+
+/**
+ * @brief Stages the prologue of the output style, or the empty file notice if a text dump read nothing
+ *
+ * @param out output buffer
+ * @param options dump options
+ * @param empty true if the input had no bytes
+ * @return 0 = SUCCESS | 1 = ERROR
+ */
+static int print_header(out_buffer *out, const dump_options *options, bool empty);
+
+/**
+ * @brief Stages the epilogue of the output style once the whole range has been dumped
+ *
+ * @param stream chunk reader at the end of the range
+ * @param out output buffer
+ * @return 0 = SUCCESS | 1 = ERROR
+ */
+static int print_footer(const dump_stream *stream, out_buffer *out);
+
+/**
+ * @brief Returns the next chunk of the input with up to LEAD_ROOM bytes of the previous lines readable before it
+ * @remark When squeezing, a zero run that reaches a sparse hole skips the hole without reading it
+ *
+ * @param stream chunk reader
+ * @param[out] src receives a pointer to the chunk
+ * @param[out] lead receives the number of context bytes before src
+ * @param[out] offset receives the absolute offset of the chunk
+ * @param buf LEAD_ROOM + max_len byte buffer used when the input is streamed, ignored when mapped
+ * @param max_len largest chunk wanted
+ * @return Returns the number of bytes in the chunk | 0 = EOF | -1 = ERROR
+ */
+static int64_t stream_next(dump_stream *stream, const uint8_t **src, size_t *lead, uint64_t *offset, uint8_t *buf, size_t max_len);
+
+/**
+ * @brief Formats a block of lines, squeezed if requested
+ *
+ * @return Returns the number of characters written
+ */
+static size_t format_block(char *dst, const uint8_t *src, size_t len, uint64_t offset, const dump_options *options, size_t lead);
+
+/**
+ * @brief Stages the last line if a squeezed run reaches the end of the input, so the dump still shows where it ends
+ *
+ * @param stream chunk reader, after EOF
+ * @param out output buffer
+ * @return 0 = SUCCESS | 1 = ERROR
+ */
+static int print_final_repeat(const dump_stream *stream, out_buffer *out);
+
+/**
+ * @brief pool_ops.produce: reads or maps the next chunk of the input
+ */
+static int parallel_produce(void *ctx, pool_job *job);
+
+/**
+ * @brief pool_ops.work: formats a chunk into the job's output buffer
+ */
+static int parallel_work(void *ctx, pool_job *job);
+
+/**
+ * @brief pool_ops.consume: writes a formatted chunk and releases the input pages before it
+ */
+static int parallel_consume(void *ctx, pool_job *job);
+
+
+//*********************************************************************************
+// DEFINITIONS
+//*********************************************************************************
+
+int dump_file(input_source *input, const dump_options *options, out_buffer *out){
+
+	if (!input || !options || !out) {
+		return EXIT_FAILURE;
+	}
+
+	int retval = EXIT_FAILURE;
+	const line_format *fmt = &options->line;
+	size_t width = fmt->width;
+	dump_stream stream = { .input = input, .options = options, .start = input->pos };
+
+	// streamed inputs are read behind room for the previous chunk's last lines
+	uint8_t *buf = NULL;
+	if (!input->mapped){
+		buf = malloc(LEAD_ROOM + INPUT_WINDOW_SIZE);
+		if (!buf){
+			return EXIT_FAILURE;
+		}
+	}
+
+	// pull the first chunk up front so empty pipes are reported like empty files
+	const uint8_t *chunk = NULL;
+	size_t lead = 0;
+	uint64_t offset = 0;
+	int64_t read = stream_next(&stream, &chunk, &lead, &offset, buf, INPUT_WINDOW_SIZE);
+	if (read < 0){
+		goto cleanup;
+	}
+	if (print_header(out, options, read == 0)){
+		goto cleanup;
+	}
+	if (read == 0){
+		retval = print_footer(&stream, out);
+		goto cleanup;
+	}
+
+	// format each chunk into the output buffer as many whole lines at a time as fit. chunks are line aligned, so only the last line may be short
+	size_t line_len = format_line_len(fmt);
+	do {
+		size_t done = 0;
+		while (done < (size_t) read){
+			size_t lines = (out->cap - out->len) / line_len;
+			if (lines == 0){
+				if (outbuf_flush(out)){
+					goto cleanup;
+				}
+				continue;
+			}
+			size_t bytes = lines * width;
+			if (bytes > (size_t) read - done){
+				bytes = (size_t) read - done;
+			}
+			size_t piece_lead = lead + done < LEAD_ROOM ? lead + done : LEAD_ROOM;
+			outbuf_commit(out, format_block(out->buf + out->len, chunk + done, bytes, offset + done, options, piece_lead));
+			done += bytes;
+		}
+		// pages before this chunk are no longer needed, this chunk's tail is the next one's lead
+		input_release(input, offset);
+		read = stream_next(&stream, &chunk, &lead, &offset, buf, INPUT_WINDOW_SIZE);
+	} while (read > 0);
+
+	if (read == 0 && !print_final_repeat(&stream, out) && !print_footer(&stream, out)){
+		retval = EXIT_SUCCESS;
+	}
+
+	cleanup:
+	free(buf);
+	return retval;
+}
+
+
+int dump_parallel(input_source *input, const dump_options *options, out_buffer *out){
+
+	if (!input || !options || !out) {
+		return EXIT_FAILURE;
+	}
+
+	parallel_dump state = {
+		.stream = { .input = input, .options = options, .start = input->pos },
+		.out = out,
+		.line_len = format_line_len(&options->line),
+	};
+	const pool_ops ops = {
+		.produce = parallel_produce,
+		.work = parallel_work,
+		.consume = parallel_consume,
+	};
+
+	// two slots per worker keeps every thread busy while the main thread writes
+	if (pool_run(options->jobs, options->jobs * 2, &ops, &state)){
+		return EXIT_FAILURE;
+	}
+	if (!state.started){
+		return print_header(out, options, true) || print_footer(&state.stream, out) ? EXIT_FAILURE : EXIT_SUCCESS;
+	}
+	return print_final_repeat(&state.stream, out) || print_footer(&state.stream, out) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+
+static int print_header(out_buffer *out, const dump_options *options, bool empty){
+
+	// exit if file size is 0, machine readable styles still print their (empty) document
+	if (empty && options->line.style == OUTPUT_TEXT){
+		return outbuf_append(out, "File is empty.\n", 15) ? EXIT_FAILURE : EXIT_SUCCESS;
+	}
+	return format_prologue(out, &options->line, options->name ? options->name : "stdin");
+}
+
+
+static int print_footer(const dump_stream *stream, out_buffer *out){
+
+	const dump_options *options = stream->options;
+	return format_epilogue(out, &options->line, options->name ? options->name : "stdin", stream->input->pos - stream->start);
+}
+
+
+static int64_t stream_next(dump_stream *stream, const uint8_t **src, size_t *lead, uint64_t *offset, uint8_t *buf, size_t max_len){
+
+	input_source *input = stream->input;
+	size_t width = stream->options->line.width;
+
+	// deep inside a squeezed zero run nothing is printed until data shows up again, so a sparse hole can be jumped over
+	if (stream->options->squeeze && stream->tail_len >= 2 * width && line_is_zero(stream->tail + stream->tail_len - 2 * width, 2 * width)){
+		uint64_t skip = input_next_data(input, input->pos) - input->pos;
+		skip -= skip % width;
+		if (skip >= DUMP_HOLE_MIN && input_seek(input, input->pos + skip)){
+			return -1;
+		}
+	}
+
+	*offset = input->pos;
+	int64_t read = input_next_into(input, src, buf ? buf + LEAD_ROOM : NULL, max_len, width);
+	if (read <= 0){
+		return read;
+	}
+
+	// mapped chunks can look back into the map, streamed ones get the saved tail copied in front
+	if (input->mapped){
+		uint64_t before = *offset - stream->start;
+		*lead = before < LEAD_ROOM ? (size_t) before : LEAD_ROOM;
+	}
+	else {
+		memcpy(buf + LEAD_ROOM - stream->tail_len, stream->tail, stream->tail_len);
+		*lead = stream->tail_len;
+	}
+
+	// remember the last lines for the next chunk
+	size_t len = (size_t) read;
+	if (len >= LEAD_ROOM){
+		memcpy(stream->tail, *src + len - LEAD_ROOM, LEAD_ROOM);
+		stream->tail_len = LEAD_ROOM;
+	}
+	else {
+		size_t keep = stream->tail_len < LEAD_ROOM - len ? stream->tail_len : LEAD_ROOM - len;
+		memmove(stream->tail, stream->tail + stream->tail_len - keep, keep);
+		memcpy(stream->tail + keep, *src, len);
+		stream->tail_len = keep + len;
+	}
+	return read;
+}
+
+
+static size_t format_block(char *dst, const uint8_t *src, size_t len, uint64_t offset, const dump_options *options, size_t lead){
+
+	if (options->squeeze){
+		return format_lines_squeezed(dst, src, len, offset, &options->line, lead);
+	}
+	return format_lines(dst, src, len, offset, &options->line);
+}
+
+
+static int print_final_repeat(const dump_stream *stream, out_buffer *out){
+
+	const line_format *fmt = &stream->options->line;
+	size_t width = fmt->width;
+	uint64_t end = stream->input->pos;
+	const uint8_t *last = stream->tail + stream->tail_len - width;
+	if (!stream->options->squeeze || stream->tail_len < 2 * width || (end - stream->start) % width || !lines_equal(last, last - width, width)){
+		return EXIT_SUCCESS;
+	}
+
+	char *dst = outbuf_reserve(out, format_line_len(fmt));
+	if (!dst){
+		return EXIT_FAILURE;
+	}
+	outbuf_commit(out, format_line(dst, last, end - width, fmt, width));
+	return EXIT_SUCCESS;
+}
+
+
+static int parallel_produce(void *ctx, pool_job *job){
+
+	parallel_dump *state = ctx;
+
+	// streamed inputs need a buffer per slot since several chunks are in flight at once
+	if (!state->stream.input->mapped && !job->in_buf){
+		job->in_buf = malloc(LEAD_ROOM + DUMP_CHUNK_SIZE);
+		if (!job->in_buf){
+			return -1;
+		}
+		job->in_cap = LEAD_ROOM + DUMP_CHUNK_SIZE;
+	}
+
+	int64_t read = stream_next(&state->stream, &job->src, &job->lead, &job->offset, job->in_buf, DUMP_CHUNK_SIZE);
+	if (read <= 0){
+		return read < 0 ? -1 : 0;
+	}
+
+	// the header goes out ahead of the first chunk
+	if (!state->started){
+		if (print_header(state->out, state->stream.options, false) || outbuf_flush(state->out)){
+			return -1;
+		}
+		state->started = true;
+	}
+
+	job->len = (size_t) read;
+	return 1;
+}
+
+
+static int parallel_work(void *ctx, pool_job *job){
+
+	parallel_dump *state = ctx;
+
+	// one output buffer per slot, sized for a full chunk so it is allocated once
+	if (!job->out.buf){
+		size_t cap = (DUMP_CHUNK_SIZE / state->stream.options->line.width) * state->line_len;
+		if (outbuf_init(&job->out, state->out->fd, cap)){
+			return -1;
+		}
+	}
+	job->out.len = format_block(job->out.buf, job->src, job->len, job->offset, state->stream.options, job->lead);
+	return 0;
+}
+
+
+static int parallel_consume(void *ctx, pool_job *job){
+
+	parallel_dump *state = ctx;
+	if (outbuf_flush(&job->out)){
+		return -1;
+	}
+	input_release(state->stream.input, job->offset);
+	return 0;
+}
@@ -0,0 +1,61 @@
+/**
+ * @file dump.h
+ * @brief Dump engine: serial and multi-threaded dumping of an input to an output buffer
+ * @date 2026-10-16
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "input.h"
+#include "format.h"
+
+
+//*********************************************************************************
+// DEFINITIONS
+//*********************************************************************************
+
+// input bytes per parallel job, a multiple of every line width
+#define DUMP_CHUNK_SIZE (256u << 10)
+
+// squeezed zero runs at least this long are skipped with SEEK_DATA instead of being read
+#define DUMP_HOLE_MIN (64u << 10)
+
+/**
+ * @brief options selected on the command line that shape a dump
+ */
+typedef struct dump_options {
+	line_format line;	// output format and line layout
+	unsigned jobs;		// worker threads, 1 = serial
+	bool squeeze;		// replace runs of identical lines with "*"
+	const char *name;	// input name, used by output styles that name their data (the C array of -i)
+} dump_options;
+
+
+//*********************************************************************************
+// DECLARATIONS
+//*********************************************************************************
+
+/**
+ * @brief Prints the contents of an input as hex and/or ascii, formatting as many lines
+ * as fit in the output buffer per pass and flushing each full buffer with one write
+ *
+ * @param input open input to be dumped, mapped or streamed
+ * @param options dump options
+ * @param out output buffer to stage lines in
+ * @return 0 = SUCCESS | 1 = ERROR
+ */
+int dump_file(input_source *input, const dump_options *options, out_buffer *out);
+
+/**
+ * @brief Same output as dump_file(), but DUMP_CHUNK_SIZE chunks are formatted on options->jobs
+ * worker threads and written to out's fd in input order
+ *
+ * @param input open input to be dumped, mapped or streamed
+ * @param options dump options
+ * @param out output buffer, used for the header and footer and flushed before chunks are written
+ * @return 0 = SUCCESS | 1 = ERROR
+ */
+int dump_parallel(input_source *input, const dump_options *options, out_buffer *out);
@@ -0,0 +1,274 @@
+/**
+ * @file encode_simd.c
+ * @brief SSSE3/AVX2 line encoding kernels, selected at runtime by format_init()
+ * @date 2026-10-16
+ *
+ * Each byte is split into its two nibbles, which index a 16 entry digit table with pshufb.
+ * The resulting digit pairs are then spread out to "XX " groups with one more shuffle per
+ * output register, and the gaps are filled with spaces. ASCII substitution is a signed
+ * range compare and a blend. AVX2 runs the same shuffles on two lines at once, one per lane.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "format.h"
+#include "encode_simd.h"
+
+#if HAVE_X86_KERNELS
+
+#include <immintrin.h>
+
+
+//*********************************************************************************
+// DEFINITIONS
+//*********************************************************************************
+
+#define TARGET_SSSE3 __attribute__((target("ssse3")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+
+// -1 selects zero in pshufb, those slots are filled with spaces afterwards
+#define Z -1
+
+// digit pairs of bytes 0-7 (a) and 8-15 (b) spread over the three 16 char "XX " output registers
+#define SHUF_0A   0, 1, Z, 2, 3, Z, 4, 5, Z, 6, 7, Z, 8, 9, Z,10
+#define SHUF_1A  11, Z,12,13, Z,14,15, Z, Z, Z, Z, Z, Z, Z, Z, Z
+#define SHUF_1B   Z, Z, Z, Z, Z, Z, Z, Z, 0, 1, Z, 2, 3, Z, 4, 5
+#define SHUF_2B   Z, 6, 7, Z, 8, 9, Z,10,11, Z,12,13, Z,14,15, Z
+
+// spaces between the groups of each output register
+#define S ' '
+#define SPACE_0   0, 0, S, 0, 0, S, 0, 0, S, 0, 0, S, 0, 0, S, 0
+#define SPACE_1   0, S, 0, 0, S, 0, 0, S, 0, 0, S, 0, 0, S, 0, 0
+#define SPACE_2   S, 0, 0, S, 0, 0, S, 0, 0, S, 0, 0, S, 0, 0, S
+
+#define DIGITS    '0','1','2','3','4','5','6','7','8','9','A','B','C','D','E','F'
+
+// character offsets of each column within a PRINT_BOTH line
+#define HEX_AT    OFFSET_COLUMN
+#define ASCII_AT  (OFFSET_COLUMN + HEX_COLUMN)
+
+
+bool cpu_has_ssse3(void){
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("ssse3");
+}
+
+
+bool cpu_has_avx2(void){
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+}
+
+
+//---------------------------------------------------------------------------------
+// 128-bit kernel
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief Converts the low 8 bytes of v into 16 hex digits, most significant nibble first
+ */
+TARGET_SSSE3 static inline __m128i hex_digits_128(__m128i v){
+	const __m128i digits = _mm_setr_epi8(DIGITS);
+	const __m128i low = _mm_set1_epi8(0x0F);
+	__m128i hi = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(v, 4), low));
+	__m128i lo = _mm_shuffle_epi8(digits, _mm_and_si128(v, low));
+	return _mm_unpacklo_epi8(hi, lo);
+}
+
+/**
+ * @brief Converts 16 bytes into the 48 character "XX XX ..." run of a line
+ */
+TARGET_SSSE3 static inline void hex_groups_128(__m128i v, __m128i out[3]){
+	const __m128i digits = _mm_setr_epi8(DIGITS);
+	const __m128i low = _mm_set1_epi8(0x0F);
+	__m128i hi = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(v, 4), low));
+	__m128i lo = _mm_shuffle_epi8(digits, _mm_and_si128(v, low));
+	__m128i a = _mm_unpacklo_epi8(hi, lo);
+	__m128i b = _mm_unpackhi_epi8(hi, lo);
+	out[0] = _mm_or_si128(_mm_shuffle_epi8(a, _mm_setr_epi8(SHUF_0A)), _mm_setr_epi8(SPACE_0));
+	out[1] = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, _mm_setr_epi8(SHUF_1A)), _mm_shuffle_epi8(b, _mm_setr_epi8(SHUF_1B))), _mm_setr_epi8(SPACE_1));
+	out[2] = _mm_or_si128(_mm_shuffle_epi8(b, _mm_setr_epi8(SHUF_2B)), _mm_setr_epi8(SPACE_2));
+}
+
+/**
+ * @brief Replaces every byte outside 0x20-0x7E with '.'
+ */
+TARGET_SSSE3 static inline __m128i ascii_128(__m128i v){
+	// signed compare: bytes >= 0x80 are negative and fail the > 0x1F test
+	__m128i printable = _mm_andnot_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(0x7F)), _mm_cmpgt_epi8(v, _mm_set1_epi8(0x1F)));
+	return _mm_or_si128(_mm_and_si128(printable, v), _mm_andnot_si128(printable, _mm_set1_epi8('.')));
+}
+
+/**
+ * @brief Encodes one full line of blocks * 16 bytes, format and blocks are constants at every call site so the branches fold away
+ */
+TARGET_SSSE3 static inline char *line_128(char *p, const uint8_t *src, uint64_t offset, uint8_t format, size_t blocks){
+	uint64_t be = __builtin_bswap64(offset);
+
+	memcpy(p, "0x", 2);
+	_mm_storeu_si128((__m128i *) (p + 2), hex_digits_128(_mm_loadl_epi64((const __m128i *) &be)));
+	memcpy(p + 18, "    ", 4);
+	p += OFFSET_COLUMN;
+
+	// wide lines are runs of 16 byte blocks, each block's 48 hex characters follow the previous ones
+	if (format == PRINT_HEX || format == PRINT_BOTH){
+		for (size_t block = 0; block < blocks; block++){
+			__m128i hex[3];
+			hex_groups_128(_mm_loadu_si128((const __m128i *) (src + block * LINE_SIZE)), hex);
+			_mm_storeu_si128((__m128i *) p, hex[0]);
+			_mm_storeu_si128((__m128i *) (p + 16), hex[1]);
+			_mm_storeu_si128((__m128i *) (p + 32), hex[2]);
+			p += LINE_SIZE * 3;
+		}
+		memcpy(p, "   ", 3);
+		p += 3;
+	}
+	if (format == PRINT_ASCII || format == PRINT_BOTH){
+		for (size_t block = 0; block < blocks; block++){
+			_mm_storeu_si128((__m128i *) p, ascii_128(_mm_loadu_si128((const __m128i *) (src + block * LINE_SIZE))));
+			p += LINE_SIZE;
+		}
+	}
+	*p++ = '\n';
+	return p;
+}
+
+/**
+ * @brief Body of the 128-bit encode_lines_fn kernels, one per line width
+ */
+TARGET_SSSE3 static inline char *lines_128(char *dst, const uint8_t *src, size_t lines, uint64_t offset, uint8_t format, size_t blocks){
+
+	size_t width = blocks * LINE_SIZE;
+	switch (format){
+		case PRINT_ASCII:
+			for (size_t line = 0; line < lines; line++, src += width, offset += width){
+				dst = line_128(dst, src, offset, PRINT_ASCII, blocks);
+			}
+			break;
+		case PRINT_BOTH:
+			for (size_t line = 0; line < lines; line++, src += width, offset += width){
+				dst = line_128(dst, src, offset, PRINT_BOTH, blocks);
+			}
+			break;
+		default:
+			for (size_t line = 0; line < lines; line++, src += width, offset += width){
+				dst = line_128(dst, src, offset, PRINT_HEX, blocks);
+			}
+			break;
+	}
+	return dst;
+}
+
+
+TARGET_SSSE3 char *encode_lines_ssse3(char *dst, const uint8_t *src, size_t lines, uint64_t offset, uint8_t format){
+	return lines_128(dst, src, lines, offset, format, 1);
+}
+
+
+TARGET_SSSE3 char *encode_lines_ssse3_32(char *dst, const uint8_t *src, size_t lines, uint64_t offset, uint8_t format){
+	return lines_128(dst, src, lines, offset, format, 2);
+}
+
+
+TARGET_SSSE3 char *encode_lines_ssse3_64(char *dst, const uint8_t *src, size_t lines, uint64_t offset, uint8_t format){
+	return lines_128(dst, src, lines, offset, format, 4);
+}
+
+
+//---------------------------------------------------------------------------------
+// 256-bit kernel
+//---------------------------------------------------------------------------------
+
+/**
+ * @brief Stores the low lane of v at lo and the high lane at hi
+ */
+TARGET_AVX2 static inline void store_lanes(char *lo, char *hi, __m256i v){
+	_mm_storeu_si128((__m128i *) lo, _mm256_castsi256_si128(v));
+	_mm_storeu_si128((__m128i *) hi, _mm256_extracti128_si256(v, 1));
+}
+
+/**
+ * @brief Encodes two consecutive full lines, one per 128-bit lane
+ */
+TARGET_AVX2 static inline char *lines_256(char *p, const uint8_t *src, uint64_t offset, uint8_t format, size_t line_len){
+	const __m256i digits = _mm256_setr_epi8(DIGITS, DIGITS);
+	const __m256i low = _mm256_set1_epi8(0x0F);
+	char *q = p + line_len;
+	__m256i v = _mm256_loadu_si256((const __m256i *) src);
+
+	// both offsets at once: lane 0 holds this line's, lane 1 the next line's
+	__m256i off = _mm256_set_epi64x(0, (long long) __builtin_bswap64(offset + LINE_SIZE), 0, (long long) __builtin_bswap64(offset));
+	__m256i off_hex = _mm256_unpacklo_epi8(
+		_mm256_shuffle_epi8(digits, _mm256_and_si256(_mm256_srli_epi16(off, 4), low)),
+		_mm256_shuffle_epi8(digits, _mm256_and_si256(off, low)));
+	memcpy(p, "0x", 2);
+	memcpy(q, "0x", 2);
+	store_lanes(p + 2, q + 2, off_hex);
+	memcpy(p + 18, "    ", 4);
+	memcpy(q + 18, "    ", 4);
+	p += OFFSET_COLUMN;
+	q += OFFSET_COLUMN;
+
+	if (format == PRINT_HEX || format == PRINT_BOTH){
+		__m256i hi = _mm256_shuffle_epi8(digits, _mm256_and_si256(_mm256_srli_epi16(v, 4), low));
+		__m256i lo = _mm256_shuffle_epi8(digits, _mm256_and_si256(v, low));
+		__m256i a = _mm256_unpacklo_epi8(hi, lo);
+		__m256i b = _mm256_unpackhi_epi8(hi, lo);
+		__m256i hex0 = _mm256_or_si256(_mm256_shuffle_epi8(a, _mm256_setr_epi8(SHUF_0A, SHUF_0A)), _mm256_setr_epi8(SPACE_0, SPACE_0));
+		__m256i hex1 = _mm256_or_si256(_mm256_or_si256(_mm256_shuffle_epi8(a, _mm256_setr_epi8(SHUF_1A, SHUF_1A)),
+			_mm256_shuffle_epi8(b, _mm256_setr_epi8(SHUF_1B, SHUF_1B))), _mm256_setr_epi8(SPACE_1, SPACE_1));
+		__m256i hex2 = _mm256_or_si256(_mm256_shuffle_epi8(b, _mm256_setr_epi8(SHUF_2B, SHUF_2B)), _mm256_setr_epi8(SPACE_2, SPACE_2));
+		store_lanes(p, q, hex0);
+		store_lanes(p + 16, q + 16, hex1);
+		store_lanes(p + 32, q + 32, hex2);
+		memcpy(p + 48, "   ", 3);
+		memcpy(q + 48, "   ", 3);
+		p += HEX_COLUMN;
+		q += HEX_COLUMN;
+	}
+	if (format == PRINT_ASCII || format == PRINT_BOTH){
+		__m256i printable = _mm256_andnot_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(0x7F)), _mm256_cmpgt_epi8(v, _mm256_set1_epi8(0x1F)));
+		__m256i text = _mm256_blendv_epi8(_mm256_set1_epi8('.'), v, printable);
+		store_lanes(p, q, text);
+		p += LINE_SIZE;
+		q += LINE_SIZE;
+	}
+	*p = '\n';
+	*q++ = '\n';
+	return q;
+}
+
+
+TARGET_AVX2 char *encode_lines_avx2(char *dst, const uint8_t *src, size_t lines, uint64_t offset, uint8_t format){
+
+	const line_format layout = { .format = format, .width = LINE_SIZE, .group = 1 };
+	size_t pairs = lines / 2;
+	size_t line_len = format_line_len(&layout);
+
+	switch (format){
+		case PRINT_ASCII:
+			for (size_t pair = 0; pair < pairs; pair++, src += 2 * LINE_SIZE, offset += 2 * LINE_SIZE){
+				dst = lines_256(dst, src, offset, PRINT_ASCII, line_len);
+			}
+			break;
+		case PRINT_BOTH:
+			for (size_t pair = 0; pair < pairs; pair++, src += 2 * LINE_SIZE, offset += 2 * LINE_SIZE){
+				dst = lines_256(dst, src, offset, PRINT_BOTH, line_len);
+			}
+			break;
+		default:
+			for (size_t pair = 0; pair < pairs; pair++, src += 2 * LINE_SIZE, offset += 2 * LINE_SIZE){
+				dst = lines_256(dst, src, offset, PRINT_HEX, line_len);
+			}
+			break;
+	}
+
+	// odd line out goes through the 128-bit path, every AVX2 CPU has SSSE3
+	if (lines % 2){
+		dst = encode_lines_ssse3(dst, src, 1, offset, format);
+	}
+	return dst;
+}
+
+#endif
@@ -0,0 +1,74 @@
+/**
+ * @file encode_simd.h
+ * @brief SSSE3/AVX2 line encoding kernels, selected at runtime by format_init()
+ * @date 2026-10-16
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+
+//*********************************************************************************
+// DEFINITIONS
+//*********************************************************************************
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_X86_KERNELS 1
+#else
+#define HAVE_X86_KERNELS 0
+#endif
+
+/**
+ * @brief encodes a run of full lines of one layout: offset column, hex and/or ascii, newline
+ * @remark The line width, grouping and byte order are fixed per kernel, the SIMD kernels handle the default
+ * LINE_SIZE layout with single byte groups
+ *
+ * @param[out] dst destination, must hold lines * format_line_len() characters
+ * @param src the bytes to be printed, lines * width of them
+ * @param lines number of full lines to encode
+ * @param offset offset of src[0]
+ * @param format PRINT_FORMAT value for desired output format
+ * @return Returns dst advanced past the written characters
+ */
+typedef char *(*encode_lines_fn)(char *dst, const uint8_t *src, size_t lines, uint64_t offset, uint8_t format);
+
+
+//*********************************************************************************
+// DECLARATIONS
+//*********************************************************************************
+
+#if HAVE_X86_KERNELS
+
+/**
+ * @brief Returns true if the CPU supports the instructions required by encode_lines_ssse3()
+ */
+bool cpu_has_ssse3(void);
+
+/**
+ * @brief Returns true if the CPU and OS support the instructions required by encode_lines_avx2()
+ */
+bool cpu_has_avx2(void);
+
+/**
+ * @brief encode_lines_fn using 128-bit nibble shuffles, one line per iteration
+ */
+char *encode_lines_ssse3(char *dst, const uint8_t *src, size_t lines, uint64_t offset, uint8_t format);
+
+/**
+ * @brief encode_lines_ssse3() for 32 byte lines of single byte groups, two blocks per line
+ */
+char *encode_lines_ssse3_32(char *dst, const uint8_t *src, size_t lines, uint64_t offset, uint8_t format);
+
+/**
+ * @brief encode_lines_ssse3() for 64 byte lines of single byte groups, four blocks per line
+ */
+char *encode_lines_ssse3_64(char *dst, const uint8_t *src, size_t lines, uint64_t offset, uint8_t format);
+
+/**
+ * @brief encode_lines_fn using 256-bit nibble shuffles, two lines per iteration (one per lane)
+ */
+char *encode_lines_avx2(char *dst, const uint8_t *src, size_t lines, uint64_t offset, uint8_t format);
+
+#endif
@@ -0,0 +1,389 @@
+/**
+ * @file entropy.c
+ * @brief Entropy mode: Shannon entropy and byte histogram of every fixed size block of an input
+ * @date 2026-10-16
+ *
+ * Workers take ENTROPY_CHUNK pieces of the input and count every block with eight interleaved
+ * histograms, so consecutive bytes of equal value (runs, text) increment different counters
+ * instead of stalling on the same one. The rows are formatted by the worker and written in order.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+
+#include "entropy.h"
+#include "pool.h"
+
+
+//*********************************************************************************
+// DECLARATIONS
+//*********************************************************************************
+
+// column header of the table rows
+#define TABLE_HEADER "OFFSET                ENTROPY  DISTINCT    TOP          BAR\n"
+
+// bar characters per bit of entropy, a random block gets 32
+#define BAR_SCALE 4
+
+// interleaved histograms per block, one per byte of a 64 bit word
+#define COUNT_TABLES 8
+
+/**
+ * @brief state shared by the callbacks of an entropy run
+ */
+typedef struct entropy_run {
+	input_source *input;
+	out_buffer *out;
+	bool csv;
+	bool started;				// header has been written
+	uint64_t bytes;				// bytes profiled so far
+	uint64_t blocks;			// blocks profiled so far
+	uint64_t totals[256];		// byte counts over the whole range, summed by the workers
+} entropy_run;
+
+// c * log2(c) for every count a block can hold, XLOGX[0] = 0
+static double XLOGX[ENTROPY_BLOCK + 1];
+
+/**
+ * @brief Counts the byte values of a block into COUNT_TABLES interleaved tables and sums them
+ *
+ * @param[out] hist receives the count of every byte value
+ * @param src block bytes
+ * @param len bytes in the block, at most ENTROPY_BLOCK
+ */
+static void count_block(uint16_t hist[256], const uint8_t *src, size_t len);
+
+/**
+ * @brief Returns the Shannon entropy of a block in bits per byte, 0.0 to 8.0
+ */
+static double block_entropy(const uint16_t hist[256], size_t len);
+
+/**
+ * @brief Writes the row of one block
+ *
+ * @param[out] dst destination, at least ENTROPY_ROW_MAX characters
+ * @param hist byte counts of the block
+ * @param len bytes in the block
+ * @param offset absolute offset of the block
+ * @param csv true for a CSV row, false for a table row
+ * @return Returns dst advanced past the written characters
+ */
+static char *put_row(char *dst, const uint16_t hist[256], size_t len, uint64_t offset, bool csv);
+
+/**
+ * @brief Writes value in decimal, right aligned to width characters
+ *
+ * @return Returns dst advanced past the written characters
+ */
+static char *put_uint(char *dst, uint64_t value, size_t width);
+
+/**
+ * @brief Writes an entropy as "d.ddd"
+ *
+ * @return Returns dst advanced past the written characters
+ */
+static char *put_entropy(char *dst, double entropy);
+
+/**
+ * @brief pool_ops.produce: reads or maps the next chunk of the input
+ */
+static int entropy_produce(void *ctx, pool_job *job);
+
+/**
+ * @brief pool_ops.work: profiles the blocks of a chunk into the job's output buffer
+ */
+static int entropy_work(void *ctx, pool_job *job);
+
+/**
+ * @brief pool_ops.consume: writes a chunk's rows and releases its input pages
+ */
+static int entropy_consume(void *ctx, pool_job *job);
+
+
+//*********************************************************************************
+// DEFINITIONS
+//*********************************************************************************
+
+int entropy_blocks(input_source *input, const dump_options *options, bool csv, out_buffer *out){
+
+	if (!input || !options || !out) {
+		return EXIT_FAILURE;
+	}
+
+	for (size_t count = 1; count <= ENTROPY_BLOCK; count++){
+		XLOGX[count] = (double) count * log2((double) count);
+	}
+
+	entropy_run run = { .input = input, .out = out, .csv = csv };
+	const pool_ops ops = {
+		.produce = entropy_produce,
+		.work = entropy_work,
+		.consume = entropy_consume,
+	};
+	if (pool_run(options->jobs, options->jobs * 2, &ops, &run)){
+		return EXIT_FAILURE;
+	}
+	if (!run.started){
+		return outbuf_append(out, "File is empty.\n", 15) ? EXIT_FAILURE : EXIT_SUCCESS;
+	}
+	if (csv){
+		return EXIT_SUCCESS;
+	}
+
+	// entropy of the whole range from the summed histograms
+	double sum = 0.0;
+	for (size_t value = 0; value < 256; value++){
+		if (run.totals[value]){
+			double count = (double) run.totals[value];
+			sum += count * log2(count);
+		}
+	}
+	double bytes = (double) run.bytes;
+	char line[128];
+	int line_len = snprintf(line, sizeof(line), "Overall entropy %.3f over %llu bytes in %llu blocks.\n",
+			fmax(0.0, log2(bytes) - sum / bytes), (unsigned long long) run.bytes, (unsigned long long) run.blocks);
+	return outbuf_append(out, line, (size_t) line_len) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+
+static void count_block(uint16_t hist[256], const uint8_t *src, size_t len){
+
+	// blocks of one repeated byte (zero fill, padding) are common in images and the slowest case for the tables
+	uint64_t fill = src[0] * 0x0101010101010101ull;
+	size_t same = 0;
+	for (uint64_t word; same + 8 <= len && (memcpy(&word, src + same, 8), word == fill); same += 8);
+	while (same < len && src[same] == src[0]){
+		same++;
+	}
+	if (same == len){
+		memset(hist, 0, 256 * sizeof(*hist));
+		hist[src[0]] = (uint16_t) len;
+		return;
+	}
+
+	// one table per byte lane of a word, a block adds at most ENTROPY_BLOCK / 8 to any one of them
+	uint16_t counts[COUNT_TABLES][256];
+	memset(counts, 0, sizeof(counts));
+
+	size_t idx = 0;
+	for (; idx + 8 <= len; idx += 8){
+		uint64_t word;
+		memcpy(&word, src + idx, 8);
+		counts[0][word & 0xFF]++;
+		counts[1][(word >> 8) & 0xFF]++;
+		counts[2][(word >> 16) & 0xFF]++;
+		counts[3][(word >> 24) & 0xFF]++;
+		counts[4][(word >> 32) & 0xFF]++;
+		counts[5][(word >> 40) & 0xFF]++;
+		counts[6][(word >> 48) & 0xFF]++;
+		counts[7][word >> 56]++;
+	}
+	for (; idx < len; idx++){
+		counts[0][src[idx]]++;
+	}
+
+	for (size_t value = 0; value < 256; value++){
+		unsigned sum = 0;
+		for (size_t table = 0; table < COUNT_TABLES; table++){
+			sum += counts[table][value];
+		}
+		hist[value] = (uint16_t) sum;
+	}
+}
+
+
+static double block_entropy(const uint16_t hist[256], size_t len){
+
+	// H = log2(n) - sum(c * log2(c)) / n
+	double sum = 0.0;
+	for (size_t value = 0; value < 256; value++){
+		sum += XLOGX[hist[value]];
+	}
+	double entropy = (XLOGX[len] - sum) / (double) len;
+	return entropy > 0.0 ? entropy : 0.0;
+}
+
+
+static char *put_row(char *dst, const uint16_t hist[256], size_t len, uint64_t offset, bool csv){
+
+	double entropy = block_entropy(hist, len);
+	unsigned distinct = 0;
+	unsigned top = 0;
+	for (unsigned value = 0; value < 256; value++){
+		distinct += hist[value] != 0;
+		top = hist[value] > hist[top] ? value : top;
+	}
+
+	// offset,length,entropy,distinct,top,x00..xff
+	if (csv){
+		dst = put_uint(dst, offset, 0);
+		*dst++ = ',';
+		dst = put_uint(dst, len, 0);
+		*dst++ = ',';
+		dst = put_entropy(dst, entropy);
+		*dst++ = ',';
+		dst = put_uint(dst, distinct, 0);
+		*dst++ = ',';
+		dst = put_uint(dst, top, 0);
+		for (size_t value = 0; value < 256; value++){
+			*dst++ = ',';
+			dst = put_uint(dst, hist[value], 0);
+		}
+		*dst++ = '\n';
+		return dst;
+	}
+
+	// columns line up with TABLE_HEADER
+	memcpy(dst, "0x", 2);
+	for (int idx = 0; idx < 8; idx++){
+		memcpy(dst + 2 + idx * 2, HEX_PAIRS[(offset >> (56 - idx * 8)) & 0xFF], 2);
+	}
+	memset(dst + 18, ' ', 4);
+	dst = put_entropy(dst + OFFSET_COLUMN, entropy);
+	memset(dst, ' ', 4);
+	dst = put_uint(dst + 4, distinct, 8);
+	memset(dst, ' ', 4);
+	memcpy(dst + 4, "0x", 2);
+	memcpy(dst + 6, HEX_PAIRS[top], 2);
+	dst[8] = ' ';
+	dst = put_uint(dst + 9, hist[top], 4);
+	size_t bar = (size_t) (entropy * BAR_SCALE + 0.5);
+	if (bar){
+		memset(dst, ' ', 4);
+		memset(dst + 4, '#', bar);
+		dst += 4 + bar;
+	}
+	*dst++ = '\n';
+	return dst;
+}
+
+
+static char *put_uint(char *dst, uint64_t value, size_t width){
+
+	char digits[20];
+	size_t count = 0;
+	do {
+		digits[count++] = (char) ('0' + value % 10);
+		value /= 10;
+	} while (value);
+
+	for (; width > count; width--){
+		*dst++ = ' ';
+	}
+	while (count){
+		*dst++ = digits[--count];
+	}
+	return dst;
+}
+
+
+static char *put_entropy(char *dst, double entropy){
+
+	unsigned milli = (unsigned) (entropy * 1000.0 + 0.5);
+	dst[0] = (char) ('0' + milli / 1000);
+	dst[1] = '.';
+	dst[2] = (char) ('0' + milli / 100 % 10);
+	dst[3] = (char) ('0' + milli / 10 % 10);
+	dst[4] = (char) ('0' + milli % 10);
+	return dst + 5;
+}
+
+
+static int entropy_produce(void *ctx, pool_job *job){
+
+	entropy_run *run = ctx;
+	input_source *input = run->input;
+
+	// streamed inputs need a buffer per slot since several chunks are in flight at once
+	if (!input->mapped && !job->in_buf){
+		job->in_buf = malloc(ENTROPY_CHUNK);
+		if (!job->in_buf){
+			return -1;
+		}
+		job->in_cap = ENTROPY_CHUNK;
+	}
+
+	uint64_t offset = input->pos;
+	int64_t read = input_next_into(input, &job->src, job->in_buf, ENTROPY_CHUNK, ENTROPY_BLOCK);
+	if (read <= 0){
+		return read < 0 ? -1 : 0;
+	}
+
+	// the header goes out ahead of the first chunk
+	if (!run->started){
+		if (!run->csv && outbuf_append(run->out, TABLE_HEADER, sizeof(TABLE_HEADER) - 1)){
+			return -1;
+		}
+		if (run->csv){
+			char header[2048] = "offset,length,entropy,distinct,top";
+			char *dst = header + strlen(header);
+			for (size_t value = 0; value < 256; value++){
+				memcpy(dst, ",x", 2);
+				memcpy(dst + 2, HEX_PAIRS[value], 2);
+				dst += 4;
+			}
+			*dst++ = '\n';
+			if (outbuf_append(run->out, header, (size_t) (dst - header))){
+				return -1;
+			}
+		}
+		if (outbuf_flush(run->out)){
+			return -1;
+		}
+		run->started = true;
+	}
+
+	job->offset = offset;
+	job->len = (size_t) read;
+	run->bytes += (uint64_t) read;
+	run->blocks += ((uint64_t) read + ENTROPY_BLOCK - 1) / ENTROPY_BLOCK;
+	return 1;
+}
+
+
+static int entropy_work(void *ctx, pool_job *job){
+
+	entropy_run *run = ctx;
+
+	// one output buffer per slot, sized for a full chunk of the longest rows so it is allocated once
+	if (!job->out.buf){
+		if (outbuf_init(&job->out, run->out->fd, (ENTROPY_CHUNK / ENTROPY_BLOCK) * ENTROPY_ROW_MAX)){
+			return -1;
+		}
+	}
+
+	uint32_t totals[256] = { 0 };
+	uint16_t hist[256];
+	char *dst = job->out.buf;
+	for (size_t done = 0; done < job->len; done += ENTROPY_BLOCK){
+		size_t len = job->len - done < ENTROPY_BLOCK ? job->len - done : ENTROPY_BLOCK;
+		count_block(hist, job->src + done, len);
+		for (size_t value = 0; value < 256; value++){
+			totals[value] += hist[value];
+		}
+		dst = put_row(dst, hist, len, job->offset + done, run->csv);
+	}
+	job->out.len = (size_t) (dst - job->out.buf);
+
+	for (size_t value = 0; value < 256; value++){
+		if (totals[value]){
+			__atomic_fetch_add(&run->totals[value], totals[value], __ATOMIC_RELAXED);
+		}
+	}
+	return 0;
+}
+
+
+static int entropy_consume(void *ctx, pool_job *job){
+
+	entropy_run *run = ctx;
+	if (outbuf_flush(&job->out)){
+		return -1;
+	}
+	input_release(run->input, job->offset + job->len);
+	return 0;
+}
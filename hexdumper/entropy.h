@@ -0,0 +1,47 @@
+/**
+ * @file entropy.h
+ * @brief Entropy mode: Shannon entropy and byte histogram of every fixed size block of an input
+ * @date 2026-10-16
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "input.h"
+#include "format.h"
+#include "dump.h"
+
+
+//*********************************************************************************
+// DEFINITIONS
+//*********************************************************************************
+
+// bytes per profiled block, the last block of the input may be shorter
+#define ENTROPY_BLOCK (4u << 10)
+
+// bytes handed to a worker at a time, a multiple of ENTROPY_BLOCK
+#define ENTROPY_CHUNK (1u << 20)
+
+// longest row printed for a block, a CSV row with 256 four digit counts
+#define ENTROPY_ROW_MAX 1400
+
+
+//*********************************************************************************
+// DECLARATIONS
+//*********************************************************************************
+
+/**
+ * @brief Profiles every ENTROPY_BLOCK of an input and prints one row per block, followed by the entropy of the whole range
+ * @remark Table rows show the offset, entropy in bits per byte, number of distinct byte values, the most common
+ * byte and a bar of the entropy. CSV rows show the offset, length, entropy, distinct values, most common byte and
+ * all 256 counts. Blocks are counted on options->jobs worker threads and printed in input order.
+ *
+ * @param input open input, profiled from its position up to its end or limit, blocks are aligned to that position
+ * @param options dump options, only the job count is used
+ * @param csv true to print CSV rows instead of the table
+ * @param out output buffer
+ * @return 0 = SUCCESS | 1 = ERROR
+ */
+int entropy_blocks(input_source *input, const dump_options *options, bool csv, out_buffer *out);
@@ -0,0 +1,330 @@
+/**
+ * @file find.c
+ * @brief Find mode: scans an input for byte patterns and prints every hit with its surrounding lines
+ * @date 2026-10-16
+ *
+ * The input is scanned in FIND_WINDOW steps. Within a window every pattern looks for its next hit,
+ * and the hits are reported lowest offset first, so all patterns share one pass over memory.
+ * Single bytes use memchr(), short patterns compare their first and last byte sixteen positions at
+ * a time with SSE2 and verify the candidates, long patterns use Horspool's skip table.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "find.h"
+
+
+//*********************************************************************************
+// DECLARATIONS
+//*********************************************************************************
+
+// search result when a pattern has no hit left in the window
+#define NO_HIT SIZE_MAX
+
+/**
+ * @brief state of a find run
+ */
+typedef struct find_state {
+	const uint8_t *hay;			// the whole range being searched
+	size_t hay_len;				// bytes at hay
+	uint64_t start;				// absolute offset of hay[0], lines are aligned to it
+	const line_format *fmt;
+	size_t line_len;
+	unsigned context;
+	out_buffer *out;
+	size_t printed;				// lines before this offset into hay have been printed
+	uint64_t matches;
+} find_state;
+
+/**
+ * @brief Returns the value of a hex digit, -1 for anything else
+ */
+static int hex_value(char c);
+
+/**
+ * @brief Returns the first hit of a pattern starting in [from, to), NO_HIT if there is none
+ *
+ * @param pat pattern
+ * @param hay bytes to search, hits have to end within hay_len
+ * @param hay_len bytes at hay
+ * @param from first start position to try
+ * @param to first start position not to try
+ */
+static size_t search(const find_pattern *pat, const uint8_t *hay, size_t hay_len, size_t from, size_t to);
+
+/**
+ * @brief Prints a hit: the "Match at" line, then its lines and context not printed yet
+ *
+ * @return 0 = SUCCESS | 1 = ERROR
+ */
+static int report(find_state *st, size_t pos, const find_pattern *pat);
+
+/**
+ * @brief Formats the lines of hay[from, to) as many at a time as fit in the output buffer
+ *
+ * @return 0 = SUCCESS | 1 = ERROR
+ */
+static int print_range(find_state *st, size_t from, size_t to);
+
+
+//*********************************************************************************
+// DEFINITIONS
+//*********************************************************************************
+
+static int hex_value(char c){
+
+	if (c >= '0' && c <= '9'){
+		return c - '0';
+	}
+	if (c >= 'a' && c <= 'f'){
+		return c - 'a' + 10;
+	}
+	if (c >= 'A' && c <= 'F'){
+		return c - 'A' + 10;
+	}
+	return -1;
+}
+
+
+int find_parse(find_pattern *pat, const char *text, bool literal){
+
+	memset(pat, 0, sizeof(*pat));
+	pat->text = text;
+
+	// hex digit pairs, spaces allowed between them
+	const char *p = text;
+	if (p[0] == '0' && (p[1] == 'x' || p[1] == 'X')){
+		p += 2;
+	}
+	size_t len = 0;
+	bool hex = !literal && *p != '\0';
+	while (hex && *p){
+		if (*p == ' '){
+			p++;
+			continue;
+		}
+		int hi = hex_value(p[0]);
+		int lo = hi < 0 ? -1 : hex_value(p[1]);
+		if (lo < 0 || len == FIND_PATTERN_MAX){
+			hex = false;
+			break;
+		}
+		pat->bytes[len++] = (uint8_t) (hi << 4 | lo);
+		p += 2;
+	}
+
+	// anything else is a literal string
+	if (!hex){
+		len = strlen(text);
+		if (len > FIND_PATTERN_MAX){
+			return EXIT_FAILURE;
+		}
+		memcpy(pat->bytes, text, len);
+	}
+	if (len == 0){
+		return EXIT_FAILURE;
+	}
+	pat->len = len;
+
+	// Horspool: shift by the distance from the last occurrence of a byte to the end of the pattern
+	if (len >= FIND_HORSPOOL_MIN){
+		for (size_t idx = 0; idx < 256; idx++){
+			pat->skip[idx] = (uint16_t) len;
+		}
+		for (size_t idx = 0; idx + 1 < len; idx++){
+			pat->skip[pat->bytes[idx]] = (uint16_t) (len - 1 - idx);
+		}
+	}
+	return EXIT_SUCCESS;
+}
+
+
+int find_patterns(input_source *input, const find_pattern *patterns, size_t count, const dump_options *options,
+		unsigned context, out_buffer *out, uint64_t *matches){
+
+	if (!input || !patterns || !options || !out || !matches || count == 0 || count > FIND_MAX_PATTERNS) {
+		return EXIT_FAILURE;
+	}
+	find_state st = {
+		.start = input->pos,
+		.fmt = &options->line,
+		.line_len = format_line_len(&options->line),
+		.context = context,
+		.out = out,
+	};
+	// hits and their context are read straight from the map
+	int64_t read = input_view(input, &st.hay);
+	if (read < 0){
+		return EXIT_FAILURE;
+	}
+	st.hay_len = (size_t) read;
+
+	size_t next[FIND_MAX_PATTERNS];
+	for (size_t from = 0; from < st.hay_len; from += FIND_WINDOW){
+		size_t to = st.hay_len - from > FIND_WINDOW ? from + FIND_WINDOW : st.hay_len;
+
+		// every pattern's first hit in the window, then the lowest one is reported and that pattern moves on
+		for (size_t idx = 0; idx < count; idx++){
+			next[idx] = search(&patterns[idx], st.hay, st.hay_len, from, to);
+		}
+		while (true){
+			size_t best = 0;
+			for (size_t idx = 1; idx < count; idx++){
+				if (next[idx] < next[best]){
+					best = idx;
+				}
+			}
+			if (next[best] == NO_HIT){
+				break;
+			}
+			if (report(&st, next[best], &patterns[best])){
+				return EXIT_FAILURE;
+			}
+			next[best] = search(&patterns[best], st.hay, st.hay_len, next[best] + 1, to);
+		}
+
+		// pages well behind the scan are no longer needed, unless context still reaches back into them
+		size_t keep = ((size_t) context + 1) * st.fmt->width;
+		input_release(input, st.start + (to > keep ? to - keep : 0));
+	}
+
+	*matches = st.matches;
+	if (st.matches == 0){
+		return outbuf_append(out, "No matches.\n", 12) ? EXIT_FAILURE : EXIT_SUCCESS;
+	}
+	return EXIT_SUCCESS;
+}
+
+
+static size_t search(const find_pattern *pat, const uint8_t *hay, size_t hay_len, size_t from, size_t to){
+
+	size_t len = pat->len;
+	if (len > hay_len){
+		return NO_HIT;
+	}
+	if (to > hay_len - len + 1){
+		to = hay_len - len + 1;
+	}
+
+	// single bytes: libc's memchr() is already vectorized
+	if (len == 1){
+		const uint8_t *hit = from < to ? memchr(hay + from, pat->bytes[0], to - from) : NULL;
+		return hit ? (size_t) (hit - hay) : NO_HIT;
+	}
+
+	// long patterns: Horspool, compare the last byte first and skip ahead by the table
+	if (len >= FIND_HORSPOOL_MIN){
+		size_t last = len - 1;
+		uint8_t tail = pat->bytes[last];
+		for (size_t pos = from; pos < to; pos += pat->skip[hay[pos + last]]){
+			if (hay[pos + last] == tail && !memcmp(hay + pos, pat->bytes, last)){
+				return pos;
+			}
+		}
+		return NO_HIT;
+	}
+
+	size_t pos = from;
+#if defined(__SSE2__)
+	// short patterns: positions whose first and last byte both match, 16 at a time, then verify the middle
+	const __m128i first = _mm_set1_epi8((char) pat->bytes[0]);
+	const __m128i last = _mm_set1_epi8((char) pat->bytes[len - 1]);
+	while (pos < to && hay_len - pos >= 16 + len - 1){
+		__m128i at_first = _mm_cmpeq_epi8(first, _mm_loadu_si128((const __m128i *) (hay + pos)));
+		__m128i at_last = _mm_cmpeq_epi8(last, _mm_loadu_si128((const __m128i *) (hay + pos + len - 1)));
+		unsigned mask = (unsigned) _mm_movemask_epi8(_mm_and_si128(at_first, at_last));
+		while (mask){
+			size_t hit = pos + (size_t) __builtin_ctz(mask);
+			if (hit >= to){
+				return NO_HIT;
+			}
+			if (!memcmp(hay + hit + 1, pat->bytes + 1, len - 2)){
+				return hit;
+			}
+			mask &= mask - 1;
+		}
+		pos += 16;
+	}
+#endif
+
+	// the last few positions, or no SSE2: memchr() for the first byte, then verify
+	while (pos < to){
+		const uint8_t *hit = memchr(hay + pos, pat->bytes[0], to - pos);
+		if (!hit){
+			return NO_HIT;
+		}
+		pos = (size_t) (hit - hay);
+		if (!memcmp(hit + 1, pat->bytes + 1, len - 1)){
+			return pos;
+		}
+		pos++;
+	}
+	return NO_HIT;
+}
+
+
+static int report(find_state *st, size_t pos, const find_pattern *pat){
+
+	size_t width = st->fmt->width;
+
+	// column header ahead of the first hit
+	if (st->matches++ == 0){
+		char *dst = outbuf_reserve(st->out, st->line_len);
+		if (!dst){
+			return EXIT_FAILURE;
+		}
+		outbuf_commit(st->out, format_header(dst, st->fmt));
+	}
+
+	char marker[64];
+	int marker_len = snprintf(marker, sizeof(marker), "Match at 0x%016llX: ", (unsigned long long) (st->start + pos));
+	if (outbuf_append(st->out, marker, (size_t) marker_len) || outbuf_append(st->out, pat->text, strlen(pat->text))
+			|| outbuf_append(st->out, "\n", 1)){
+		return EXIT_FAILURE;
+	}
+
+	// lines holding the hit plus context on either side, minus what an earlier hit already showed
+	size_t first = pos - pos % width;
+	first = first > (size_t) st->context * width ? first - (size_t) st->context * width : 0;
+	size_t end = pos + pat->len - 1;
+	end = end - end % width + ((size_t) st->context + 1) * width;
+	if (end > st->hay_len){
+		end = st->hay_len;
+	}
+	if (first < st->printed){
+		first = st->printed;
+	}
+	if (first >= end){
+		return EXIT_SUCCESS;
+	}
+	st->printed = end;
+	return print_range(st, first, end);
+}
+
+
+static int print_range(find_state *st, size_t from, size_t to){
+
+	out_buffer *out = st->out;
+	size_t width = st->fmt->width;
+	while (from < to){
+		size_t lines = (out->cap - out->len) / st->line_len;
+		if (lines == 0){
+			if (outbuf_flush(out)){
+				return EXIT_FAILURE;
+			}
+			continue;
+		}
+		size_t bytes = lines * width < to - from ? lines * width : to - from;
+		outbuf_commit(out, format_lines(out->buf + out->len, st->hay + from, bytes, st->start + from, st->fmt));
+		from += bytes;
+	}
+	return EXIT_SUCCESS;
+}
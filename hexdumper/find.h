@@ -0,0 +1,78 @@
+/**
+ * @file find.h
+ * @brief Find mode: scans an input for byte patterns and prints every hit with its surrounding lines
+ * @date 2026-10-16
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "input.h"
+#include "format.h"
+#include "dump.h"
+
+
+//*********************************************************************************
+// DEFINITIONS
+//*********************************************************************************
+
+// most --find patterns searched in one pass
+#define FIND_MAX_PATTERNS 16
+
+// longest pattern in bytes
+#define FIND_PATTERN_MAX 256
+
+// most context lines (-C) on either side of a hit
+#define FIND_CONTEXT_MAX (1u << 20)
+
+// patterns at least this long are searched with Horspool instead of the first/last byte filter
+#define FIND_HORSPOOL_MIN 32
+
+// bytes scanned by every pattern before moving on, small enough to stay in cache between patterns
+#define FIND_WINDOW (256u << 10)
+
+/**
+ * @brief one search pattern, prepared by find_parse()
+ */
+typedef struct find_pattern {
+	const char *text;					// pattern as given on the command line
+	uint8_t bytes[FIND_PATTERN_MAX];	// bytes to search for
+	size_t len;							// number of bytes, at least 1
+	uint16_t skip[256];					// Horspool shift per byte value, long patterns only
+} find_pattern;
+
+
+//*********************************************************************************
+// DECLARATIONS
+//*********************************************************************************
+
+/**
+ * @brief Prepares a pattern from its command line text
+ * @remark Text of hex digit pairs, optionally prefixed with "0x" and separated by spaces, is a byte
+ * pattern ("4D5A9000", "0x7f 45 4c 46"), anything else is searched for as a literal string. With literal
+ * set the text is always a string, so words made of hex digits ("cafe", "1234") can be searched too.
+ *
+ * @param[out] pat pattern to fill in, keeps a pointer to text
+ * @param text pattern text
+ * @param literal true to take text as a string even if it reads as hex
+ * @return 0 = SUCCESS | 1 = ERROR (empty or longer than FIND_PATTERN_MAX)
+ */
+int find_parse(find_pattern *pat, const char *text, bool literal);
+
+/**
+ * @brief Scans a mapped input for all patterns in one pass and prints each hit as a "Match at" line
+ * followed by the lines holding it and context lines on either side, lines shown for an earlier hit are not repeated
+ *
+ * @param input open mapped input, scanned from its position up to its end or limit
+ * @param patterns patterns to search for
+ * @param count number of patterns, at most FIND_MAX_PATTERNS
+ * @param options dump options, only the line layout is used
+ * @param context lines to show before and after the lines of each hit
+ * @param out output buffer
+ * @param[out] matches receives the number of hits
+ * @return 0 = SUCCESS | 1 = ERROR (errno set, EINVAL if the input is not mapped)
+ */
+int find_patterns(input_source *input, const find_pattern *patterns, size_t count, const dump_options *options,
+		unsigned context, out_buffer *out, uint64_t *matches);
@@ -0,0 +1,298 @@
+/**
+ * @file follow.c
+ * @brief Follow mode: dumps a growing file and then every byte appended to it, like tail -f
+ * @date 2026-10-16
+ *
+ * The bytes already in the file go through the regular dump engine, up to the last full line. After that
+ * the file is read with pread() from the first byte not yet printed: appends are never read twice and the
+ * file is never read again from the start. Whole lines are printed as soon as they are read, a partial
+ * last line waits in front of the read buffer for the bytes that complete it.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/inotify.h>
+
+#include "follow.h"
+
+
+//*********************************************************************************
+// DECLARATIONS
+//*********************************************************************************
+
+/**
+ * @brief state of a followed file
+ */
+typedef struct follower {
+	input_source *input;
+	const dump_options *options;
+	out_buffer *out;
+	uint8_t *buf;			// partial line not printed yet, followed by the bytes just read
+	size_t pending;			// bytes at buf, less than a line between bursts
+	uint64_t printed;		// absolute offset of buf[0], every byte before it has been printed
+	uint64_t changed_ms;	// monotonic time the last bytes were read
+	int watch;				// inotify descriptor, -1 = checking the size every FOLLOW_POLL_MS
+} follower;
+
+/**
+ * @brief Returns the monotonic clock in milliseconds
+ */
+static uint64_t now_ms(void);
+
+/**
+ * @brief Dumps the bytes already in the file up to its last full line, or only the prologue if there are none
+ *
+ * @param fl follower, printed is set to where the dump stopped
+ * @return 0 = SUCCESS | 1 = ERROR
+ */
+static int dump_existing(follower *fl);
+
+/**
+ * @brief Reads everything appended since the last call and prints the whole lines of it
+ * @remark A shrunken file is reported on stderr and followed again from offset 0.
+ *
+ * @param fl follower
+ * @return Returns the number of bytes read | -1 = ERROR
+ */
+static int64_t catch_up(follower *fl);
+
+/**
+ * @brief Formats the first len bytes at fl->buf into the output buffer, flushing it whenever it fills up
+ *
+ * @param fl follower
+ * @param len bytes to print, only the last line may be short
+ * @return 0 = SUCCESS | 1 = ERROR
+ */
+static int print_bytes(follower *fl, size_t len);
+
+/**
+ * @brief Waits until the file may have changed or timeout_ms passes, and drains the inotify events
+ *
+ * @param fl follower
+ * @param timeout_ms longest wait, -1 = no limit
+ * @return 0 = SUCCESS | 1 = ERROR
+ */
+static int wait_change(follower *fl, int timeout_ms);
+
+
+//*********************************************************************************
+// DEFINITIONS
+//*********************************************************************************
+
+int follow_file(input_source *input, const dump_options *options, out_buffer *out){
+
+	if (!input || !options || !out) {
+		return EXIT_FAILURE;
+	}
+
+	int retval = EXIT_FAILURE;
+	follower fl = { .input = input, .options = options, .out = out, .watch = -1 };
+	fl.buf = malloc(FOLLOW_READ_SIZE + LINE_SIZE_MAX);
+	if (!fl.buf || dump_existing(&fl) || outbuf_flush(out)){
+		goto cleanup;
+	}
+
+	// watch before reading again, so nothing appended in between goes unnoticed
+	fl.watch = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (fl.watch != -1 && inotify_add_watch(fl.watch, input->name, IN_MODIFY | IN_ATTRIB) == -1){
+		close(fl.watch);
+		fl.watch = -1;
+	}
+
+	fl.changed_ms = now_ms();
+	while (fl.printed + fl.pending < input->limit){
+		int64_t read = catch_up(&fl);
+		if (read < 0){
+			goto cleanup;
+		}
+		if (read > 0){
+			fl.changed_ms = now_ms();
+		}
+
+		// a partial line goes out once the writer has been quiet for a while, later lines continue from its end
+		int timeout = fl.watch == -1 ? FOLLOW_POLL_MS : -1;
+		if (fl.pending){
+			uint64_t quiet = now_ms() - fl.changed_ms;
+			if (quiet >= FOLLOW_IDLE_MS){
+				if (print_bytes(&fl, fl.pending) || outbuf_flush(out)){
+					goto cleanup;
+				}
+				fl.printed += fl.pending;
+				fl.pending = 0;
+				continue;
+			}
+			if (timeout == -1 || FOLLOW_IDLE_MS - quiet < (uint64_t) timeout){
+				timeout = (int) (FOLLOW_IDLE_MS - quiet);
+			}
+		}
+		if (wait_change(&fl, timeout)){
+			goto cleanup;
+		}
+	}
+
+	// the limit was reached, whatever is left of the last line is printed
+	if (!print_bytes(&fl, fl.pending) && !outbuf_flush(out)){
+		retval = EXIT_SUCCESS;
+	}
+
+	cleanup:
+	if (fl.watch != -1){
+		close(fl.watch);
+	}
+	free(fl.buf);
+	return retval;
+}
+
+
+static uint64_t now_ms(void){
+
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000 + (uint64_t) ts.tv_nsec / 1000000;
+}
+
+
+static int dump_existing(follower *fl){
+
+	input_source *input = fl->input;
+	const dump_options *options = fl->options;
+	size_t width = options->line.width;
+	uint64_t start = input->pos;
+	uint64_t limit = input->limit;
+
+	struct stat st;
+	if (fstat(input->fd, &st)){
+		return EXIT_FAILURE;
+	}
+	uint64_t end = (uint64_t) st.st_size < limit ? (uint64_t) st.st_size : limit;
+
+	// a map only holds what the file had when it was opened, catch_up() reads whatever came after
+	if (input->mapped && input->size < end){
+		end = input->size;
+	}
+	uint64_t aligned = end > start ? end - (end - start) % width : start;
+	fl->printed = aligned;
+
+	// an empty file gets its prologue instead of the empty file notice, lines may still come
+	if (aligned == start){
+		return format_prologue(fl->out, &options->line, options->name ? options->name : "stdin");
+	}
+
+	input_set_limit(input, aligned);
+	int dumped = options->jobs > 1 ? dump_parallel(input, options, fl->out) : dump_file(input, options, fl->out);
+	input_set_limit(input, limit);
+	input_release(input, aligned);
+	return dumped;
+}
+
+
+static int64_t catch_up(follower *fl){
+
+	input_source *input = fl->input;
+	int64_t total = 0;
+
+	struct stat st;
+	if (fstat(input->fd, &st)){
+		return -1;
+	}
+	if ((uint64_t) st.st_size < fl->printed + fl->pending){
+		fprintf(stderr, "\"%s\" was truncated, following it from the start.\n", input->name);
+		fl->printed = 0;
+		fl->pending = 0;
+	}
+
+	// read until the end of the burst, printing whole lines and keeping the partial one in front
+	size_t width = fl->options->line.width;
+	for (;;){
+		uint64_t at = fl->printed + fl->pending;
+		size_t room = FOLLOW_READ_SIZE + LINE_SIZE_MAX - fl->pending;
+		if (input->limit - at < room){
+			room = (size_t) (input->limit - at);
+		}
+		if (room == 0){
+			break;
+		}
+		ssize_t got = pread(input->fd, fl->buf + fl->pending, room, (off_t) at);
+		if (got < 0){
+			if (errno == EINTR){
+				continue;
+			}
+			return -1;
+		}
+		if (got == 0){
+			break;
+		}
+		total += got;
+		fl->pending += (size_t) got;
+
+		size_t whole = fl->pending - fl->pending % width;
+		if (whole){
+			if (print_bytes(fl, whole)){
+				return -1;
+			}
+			memmove(fl->buf, fl->buf + whole, fl->pending - whole);
+			fl->printed += whole;
+			fl->pending -= whole;
+		}
+	}
+
+	if (total && outbuf_flush(fl->out)){
+		return -1;
+	}
+	return total;
+}
+
+
+static int print_bytes(follower *fl, size_t len){
+
+	out_buffer *out = fl->out;
+	const line_format *fmt = &fl->options->line;
+	size_t width = fmt->width;
+	size_t line_len = format_line_len(fmt);
+
+	// as many lines at a time as fit in the output buffer, like dump_file()
+	size_t done = 0;
+	while (done < len){
+		size_t lines = (out->cap - out->len) / line_len;
+		if (lines == 0){
+			if (outbuf_flush(out)){
+				return EXIT_FAILURE;
+			}
+			continue;
+		}
+		size_t bytes = lines * width < len - done ? lines * width : len - done;
+		outbuf_commit(out, format_lines(out->buf + out->len, fl->buf + done, bytes, fl->printed + done, fmt));
+		done += bytes;
+	}
+	return EXIT_SUCCESS;
+}
+
+
+static int wait_change(follower *fl, int timeout_ms){
+
+	if (fl->watch == -1){
+		if (timeout_ms > 0){
+			struct timespec ts = { .tv_sec = timeout_ms / 1000, .tv_nsec = (long) (timeout_ms % 1000) * 1000000 };
+			nanosleep(&ts, NULL);
+		}
+		return EXIT_SUCCESS;
+	}
+
+	struct pollfd pfd = { .fd = fl->watch, .events = POLLIN };
+	if (poll(&pfd, 1, timeout_ms) < 0){
+		return errno == EINTR ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	// the events only say that something changed, what changed is read from the file itself
+	char events[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+	while (read(fl->watch, events, sizeof(events)) > 0){
+	}
+	return EXIT_SUCCESS;
+}
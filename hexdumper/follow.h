@@ -0,0 +1,48 @@
+/**
+ * @file follow.h
+ * @brief Follow mode: dumps a growing file and then every byte appended to it, like tail -f
+ * @date 2026-10-16
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "input.h"
+#include "format.h"
+#include "dump.h"
+
+
+//*********************************************************************************
+// DEFINITIONS
+//*********************************************************************************
+
+// a trailing partial line is printed once the file has been quiet this long
+#define FOLLOW_IDLE_MS 200
+
+// how often the size is checked when inotify is not available
+#define FOLLOW_POLL_MS 50
+
+// bytes read per pread() while catching up with a burst of appends
+#define FOLLOW_READ_SIZE (1u << 20)
+
+
+//*********************************************************************************
+// DECLARATIONS
+//*********************************************************************************
+
+/**
+ * @brief Dumps a regular file up to its last full line, then waits for appends and dumps the new bytes as they
+ * arrive, with offsets continuing where the previous line ended
+ * @remark Appends are noticed through inotify, or by checking the size every FOLLOW_POLL_MS if inotify is not
+ * available. A burst of appends is read and formatted in one pass and written with one flush. A partial last
+ * line is held back until it fills up or the file stays quiet for FOLLOW_IDLE_MS. Runs until the input limit is
+ * reached or an error occurs; a truncated file is followed again from its start.
+ *
+ * @param input open regular file, dumped from its position
+ * @param options dump options, squeezing and the C array style are not supported
+ * @param out output buffer, flushed after every burst
+ * @return 0 = SUCCESS | 1 = ERROR
+ */
+int follow_file(input_source *input, const dump_options *options, out_buffer *out);
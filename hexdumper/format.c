@@ -0,0 +1,909 @@
+/**
+ * @file format.c
+ * @brief Table-driven line formatter and bulk output buffer for the dump engine
+ * @date 2026-10-16
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "format.h"
+#include "encode_simd.h"
+
+
+//*********************************************************************************
+// DECLARATIONS
+//*********************************************************************************
+
+/**
+ * @brief Writes "0x" + 16 hex digits + column padding for an offset
+ *
+ * @param[out] dst destination, OFFSET_COLUMN characters are written
+ * @param offset offset to print
+ * @return Returns dst advanced past the written characters
+ */
+static inline char *put_offset(char *dst, uint64_t offset);
+
+/**
+ * @brief Writes a full line as hex groups, "XX " for single bytes, "XXXX " and up for wider groups
+ * @remark Meant to be inlined with constant arguments, the loops then unroll without branches
+ *
+ * @param[out] dst destination, width * 2 + width / group characters are written
+ * @param src bytes to print
+ * @param width bytes in the line
+ * @param group bytes per group
+ * @param little print the bytes of each group last to first
+ * @return Returns dst advanced past the written characters
+ */
+static inline char *put_hex(char *dst, const uint8_t *src, size_t width, size_t group, bool little);
+
+/**
+ * @brief Writes width bytes as printable ASCII, '.' for the rest
+ *
+ * @param[out] dst destination, width characters are written
+ * @param src bytes to print
+ * @param width bytes in the line
+ * @return Returns dst advanced past the written characters
+ */
+static inline char *put_ascii(char *dst, const uint8_t *src, size_t width);
+
+/**
+ * @brief Returns the width in characters of the DATA column of a layout, including the gap before TEXT
+ */
+static inline size_t hex_column(const line_format *fmt);
+
+/**
+ * @brief Returns the encoder for runs of full lines in a layout
+ */
+static encode_lines_fn select_encoder(const line_format *fmt);
+
+/**
+ * @brief Counts the all-zero bytes at the start of src, a page at a time while possible
+ *
+ * @param src bytes to scan
+ * @param len number of bytes in src, a multiple of width
+ * @param width bytes per line
+ * @return Returns the length of the zero run rounded down to whole lines
+ */
+static size_t zero_run(const uint8_t *src, size_t len, size_t width);
+
+/**
+ * @brief emitter of one output style: the dump engine hands it runs of full lines and single short lines
+ */
+typedef struct emitter {
+	// length in characters of the longest line, including the newline
+	size_t (*line_len)(const line_format *fmt);
+	// writes lines full lines of fmt->width bytes, returns dst advanced past them
+	char *(*lines)(char *dst, const uint8_t *src, size_t lines, uint64_t offset, const line_format *fmt);
+	// writes one line of len bytes, at most fmt->width, returns dst advanced past it
+	char *(*line)(char *dst, const uint8_t *src, size_t len, uint64_t offset, const line_format *fmt);
+} emitter;
+
+/**
+ * @brief decimal rendering of an offset that is stepped forward without dividing, right aligned in digits
+ */
+typedef struct decimal {
+	char digits[20];
+	size_t start;		// index of the first digit
+} decimal;
+
+/**
+ * @brief Sets a decimal counter to value
+ */
+static void decimal_set(decimal *dec, uint64_t value);
+
+/**
+ * @brief Adds a small amount (a line width) to a decimal counter, carrying through as few digits as needed
+ */
+static inline void decimal_add(decimal *dec, unsigned amount);
+
+/**
+ * @brief Copies the digits of a decimal counter to dst
+ *
+ * @return Returns dst advanced past the digits
+ */
+static inline char *put_decimal(char *dst, const decimal *dec);
+
+/**
+ * @brief Writes bytes as contiguous hex digit pairs in input order
+ *
+ * @return Returns dst advanced past the written characters
+ */
+static inline char *put_hex_raw(char *dst, const uint8_t *src, size_t len);
+
+/**
+ * @brief Writes bytes as printable ASCII, escaping quote characters for JSON (\" and \\) or CSV ("")
+ *
+ * @param[out] dst destination, up to 2 * len characters are written
+ * @param src bytes to print
+ * @param len number of bytes
+ * @param csv true for CSV quoting, false for JSON escapes
+ * @return Returns dst advanced past the written characters
+ */
+static inline char *put_text_quoted(char *dst, const uint8_t *src, size_t len, bool csv);
+
+/**
+ * @brief Appends name as a C identifier the way xxd -i does: anything but letters and digits becomes '_',
+ * a leading digit gets a '_' in front
+ *
+ * @return 0 = SUCCESS | 1 = ERROR
+ */
+static int put_c_name(out_buffer *out, const char *name);
+
+/**
+ * @brief Emitter callbacks of the text style, the OFFSET/DATA/TEXT columns
+ */
+static size_t text_line_len(const line_format *fmt);
+static char *text_lines(char *dst, const uint8_t *src, size_t lines, uint64_t offset, const line_format *fmt);
+static char *text_line(char *dst, const uint8_t *src, size_t len, uint64_t offset, const line_format *fmt);
+
+/**
+ * @brief Emitter callbacks of the C array style, "  0x48, 0x65, ...," per line
+ */
+static size_t c_line_len(const line_format *fmt);
+static char *c_lines(char *dst, const uint8_t *src, size_t lines, uint64_t offset, const line_format *fmt);
+static char *c_line(char *dst, const uint8_t *src, size_t len, uint64_t offset, const line_format *fmt);
+
+/**
+ * @brief Emitter callbacks of the JSON lines style, {"offset":N,"hex":"...","text":"..."} per line
+ */
+static size_t json_line_len(const line_format *fmt);
+static char *json_lines(char *dst, const uint8_t *src, size_t lines, uint64_t offset, const line_format *fmt);
+static char *json_line(char *dst, const uint8_t *src, size_t len, uint64_t offset, const line_format *fmt);
+
+/**
+ * @brief Emitter callbacks of the CSV style, N,HEX,"TEXT" per line
+ */
+static size_t csv_line_len(const line_format *fmt);
+static char *csv_lines(char *dst, const uint8_t *src, size_t lines, uint64_t offset, const line_format *fmt);
+static char *csv_line(char *dst, const uint8_t *src, size_t len, uint64_t offset, const line_format *fmt);
+
+/**
+ * @brief Writes one JSON or CSV record of len bytes at offset dec, with the fields selected by format
+ *
+ * @return Returns dst advanced past the record and its newline
+ */
+static inline __attribute__((always_inline)) char *put_record(char *dst, const uint8_t *src, size_t len, const decimal *dec, uint8_t format, bool csv);
+
+/**
+ * @brief JSON/CSV counterpart of encode_lines_layout(): full lines of a width that is a constant at every call site
+ */
+static inline __attribute__((always_inline)) char *records_layout(char *dst, const uint8_t *src, size_t lines, uint64_t offset,
+		uint8_t format, size_t width, bool csv);
+
+/**
+ * @brief Calls records_layout() with fmt->width as a constant
+ */
+static char *records_for_width(char *dst, const uint8_t *src, size_t lines, uint64_t offset, const line_format *fmt, bool csv);
+
+/**
+ * @brief Portable encode_lines_fn body built on the lookup tables
+ * @remark Always inlined into the ENCODER() instances below, so width, group and byte order are
+ * compile time constants in each of them and only the format is tested, once per call
+ */
+static inline __attribute__((always_inline)) char *encode_lines_layout(char *dst, const uint8_t *src, size_t lines, uint64_t offset,
+		uint8_t format, size_t width, size_t group, bool little);
+
+
+//*********************************************************************************
+// DEFINITIONS
+//*********************************************************************************
+
+#define HEX_ROW(hi) \
+	{hi,'0'}, {hi,'1'}, {hi,'2'}, {hi,'3'}, {hi,'4'}, {hi,'5'}, {hi,'6'}, {hi,'7'}, \
+	{hi,'8'}, {hi,'9'}, {hi,'A'}, {hi,'B'}, {hi,'C'}, {hi,'D'}, {hi,'E'}, {hi,'F'}
+
+const char HEX_PAIRS[256][2] = {
+	HEX_ROW('0'), HEX_ROW('1'), HEX_ROW('2'), HEX_ROW('3'),
+	HEX_ROW('4'), HEX_ROW('5'), HEX_ROW('6'), HEX_ROW('7'),
+	HEX_ROW('8'), HEX_ROW('9'), HEX_ROW('A'), HEX_ROW('B'),
+	HEX_ROW('C'), HEX_ROW('D'), HEX_ROW('E'), HEX_ROW('F')
+};
+
+// same range isprint() accepts in the C locale
+#define PRINT_CHAR(c) (char) ((c) >= 0x20 && (c) <= 0x7E ? (c) : '.')
+#define PRINT_ROW(r) \
+	PRINT_CHAR(r+0x0), PRINT_CHAR(r+0x1), PRINT_CHAR(r+0x2), PRINT_CHAR(r+0x3), \
+	PRINT_CHAR(r+0x4), PRINT_CHAR(r+0x5), PRINT_CHAR(r+0x6), PRINT_CHAR(r+0x7), \
+	PRINT_CHAR(r+0x8), PRINT_CHAR(r+0x9), PRINT_CHAR(r+0xA), PRINT_CHAR(r+0xB), \
+	PRINT_CHAR(r+0xC), PRINT_CHAR(r+0xD), PRINT_CHAR(r+0xE), PRINT_CHAR(r+0xF)
+
+const char PRINTABLE[256] = {
+	PRINT_ROW(0x00), PRINT_ROW(0x10), PRINT_ROW(0x20), PRINT_ROW(0x30),
+	PRINT_ROW(0x40), PRINT_ROW(0x50), PRINT_ROW(0x60), PRINT_ROW(0x70),
+	PRINT_ROW(0x80), PRINT_ROW(0x90), PRINT_ROW(0xA0), PRINT_ROW(0xB0),
+	PRINT_ROW(0xC0), PRINT_ROW(0xD0), PRINT_ROW(0xE0), PRINT_ROW(0xF0)
+};
+
+// "0xXY, " item of every byte value in a C array
+#define C_ITEM(hi, lo) {'0','x',hi,lo,',',' '}
+#define C_ROW(hi) \
+	C_ITEM(hi,'0'), C_ITEM(hi,'1'), C_ITEM(hi,'2'), C_ITEM(hi,'3'), C_ITEM(hi,'4'), C_ITEM(hi,'5'), C_ITEM(hi,'6'), C_ITEM(hi,'7'), \
+	C_ITEM(hi,'8'), C_ITEM(hi,'9'), C_ITEM(hi,'A'), C_ITEM(hi,'B'), C_ITEM(hi,'C'), C_ITEM(hi,'D'), C_ITEM(hi,'E'), C_ITEM(hi,'F')
+
+static const char C_ITEMS[256][6] = {
+	C_ROW('0'), C_ROW('1'), C_ROW('2'), C_ROW('3'),
+	C_ROW('4'), C_ROW('5'), C_ROW('6'), C_ROW('7'),
+	C_ROW('8'), C_ROW('9'), C_ROW('A'), C_ROW('B'),
+	C_ROW('C'), C_ROW('D'), C_ROW('E'), C_ROW('F')
+};
+
+// indexed by OUTPUT_STYLE
+static const emitter EMITTERS[] = {
+	[OUTPUT_TEXT] = { text_line_len, text_lines, text_line },
+	[OUTPUT_C] = { c_line_len, c_lines, c_line },
+	[OUTPUT_JSON] = { json_line_len, json_lines, json_line },
+	[OUTPUT_CSV] = { csv_line_len, csv_lines, csv_line },
+};
+
+// zero runs are first skipped in blocks of this many bytes
+#define ZERO_BLOCK 4096
+
+// one scalar encoder per layout: encode_<width>_<group>_<byte order>
+#define ENCODER(W, G, ORDER, LITTLE) \
+	static char *encode_##W##_##G##_##ORDER(char *dst, const uint8_t *src, size_t lines, uint64_t offset, uint8_t format){ \
+		return encode_lines_layout(dst, src, lines, offset, format, W, G, LITTLE); \
+	}
+#define ENCODER_WIDTH(W) \
+	ENCODER(W, 1, be, false) ENCODER(W, 2, be, false) ENCODER(W, 4, be, false) ENCODER(W, 8, be, false) \
+	ENCODER(W, 2, le, true) ENCODER(W, 4, le, true) ENCODER(W, 8, le, true)
+
+ENCODER_WIDTH(8)
+ENCODER_WIDTH(16)
+ENCODER_WIDTH(32)
+ENCODER_WIDTH(64)
+
+// single byte groups have no byte order
+#define ENCODER_ROW(W) { \
+	{ encode_##W##_1_be, encode_##W##_1_be }, { encode_##W##_2_be, encode_##W##_2_le }, \
+	{ encode_##W##_4_be, encode_##W##_4_le }, { encode_##W##_8_be, encode_##W##_8_le } }
+
+// indexed by [log2(width / 8)][log2(group)][little endian]
+static const encode_lines_fn ENCODERS[4][4][2] = {
+	ENCODER_ROW(8), ENCODER_ROW(16), ENCODER_ROW(32), ENCODER_ROW(64)
+};
+
+// kernels used by format_lines() for runs of full single byte group lines, indexed by log2(width / 8),
+// replaced by SIMD kernels if available
+static encode_lines_fn encode_lines[4] = { encode_8_1_be, encode_16_1_be, encode_32_1_be, encode_64_1_be };
+
+
+const char *format_init(void){
+
+	const char *forced = getenv("HEXDUMP_KERNEL");
+
+	encode_lines[1] = encode_16_1_be;
+	encode_lines[2] = encode_32_1_be;
+	encode_lines[3] = encode_64_1_be;
+	const char *name = "scalar";
+#if HAVE_X86_KERNELS
+	if (cpu_has_avx2() && (!forced || !strcmp(forced, "avx2"))){
+		encode_lines[1] = encode_lines_avx2;
+		name = "avx2";
+	}
+	else if (cpu_has_ssse3() && (!forced || !strcmp(forced, "ssse3"))){
+		encode_lines[1] = encode_lines_ssse3;
+		name = "ssse3";
+	}
+	// wide lines are runs of 16 byte blocks, the 128-bit kernel covers them on every SIMD capable CPU
+	if (encode_lines[1] != encode_16_1_be){
+		encode_lines[2] = encode_lines_ssse3_32;
+		encode_lines[3] = encode_lines_ssse3_64;
+	}
+#else
+	(void) forced;
+#endif
+	return name;
+}
+
+
+bool format_valid(const line_format *fmt){
+
+	bool width_ok = fmt->width == 8 || fmt->width == 16 || fmt->width == 32 || fmt->width == LINE_SIZE_MAX;
+	bool group_ok = fmt->group == 1 || fmt->group == 2 || fmt->group == 4 || fmt->group == 8;
+	return width_ok && group_ok && fmt->format <= PRINT_BOTH && fmt->style <= OUTPUT_CSV;
+}
+
+
+size_t format_line_len(const line_format *fmt){
+	return EMITTERS[fmt->style].line_len(fmt);
+}
+
+
+static size_t text_line_len(const line_format *fmt){
+
+	size_t len = OFFSET_COLUMN + 1;		// offset column and newline
+	if (fmt->format == PRINT_HEX || fmt->format == PRINT_BOTH){
+		len += hex_column(fmt);
+	}
+	if (fmt->format == PRINT_ASCII || fmt->format == PRINT_BOTH){
+		len += fmt->width;
+	}
+	return len;
+}
+
+
+size_t format_header(char *dst, const line_format *fmt){
+
+	size_t len = format_line_len(fmt);
+	memset(dst, ' ', len - 1);
+	memcpy(dst, "OFFSET", 6);
+	char *p = dst + OFFSET_COLUMN;
+	if (fmt->format == PRINT_HEX || fmt->format == PRINT_BOTH){
+		memcpy(p, "DATA", 4);
+		p += hex_column(fmt);
+	}
+	if (fmt->format == PRINT_ASCII || fmt->format == PRINT_BOTH){
+		memcpy(p, "TEXT", 4);
+	}
+	dst[len - 1] = '\n';
+	return len;
+}
+
+
+int format_prologue(out_buffer *out, const line_format *fmt, const char *name){
+
+	switch (fmt->style){
+		case OUTPUT_TEXT: {
+			char *dst = outbuf_reserve(out, format_line_len(fmt));
+			if (!dst){
+				return EXIT_FAILURE;
+			}
+			outbuf_commit(out, format_header(dst, fmt));
+			return EXIT_SUCCESS;
+		}
+		case OUTPUT_C:
+			if (outbuf_append(out, "unsigned char ", 14) || put_c_name(out, name) || outbuf_append(out, "[] = {\n", 7)){
+				return EXIT_FAILURE;
+			}
+			return EXIT_SUCCESS;
+		case OUTPUT_CSV: {
+			const char *header = fmt->format == PRINT_HEX ? "offset,hex\n" : fmt->format == PRINT_ASCII ? "offset,text\n" : "offset,hex,text\n";
+			return outbuf_append(out, header, strlen(header)) ? EXIT_FAILURE : EXIT_SUCCESS;
+		}
+		default:
+			return EXIT_SUCCESS;
+	}
+}
+
+
+int format_epilogue(out_buffer *out, const line_format *fmt, const char *name, uint64_t total){
+
+	if (fmt->style != OUTPUT_C){
+		return EXIT_SUCCESS;
+	}
+	if (outbuf_append(out, "};\nunsigned int ", 16) || put_c_name(out, name)){
+		return EXIT_FAILURE;
+	}
+	char length[48];
+	int length_len = snprintf(length, sizeof(length), "_len = %llu;\n", (unsigned long long) total);
+	return outbuf_append(out, length, (size_t) length_len) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+
+size_t format_line(char *dst, const uint8_t *line, uint64_t offset, const line_format *fmt, size_t len){
+	return (size_t) (EMITTERS[fmt->style].line(dst, line, len, offset, fmt) - dst);
+}
+
+
+size_t format_columns(char *dst, const uint8_t *line, const line_format *fmt, size_t len){
+
+	size_t width = fmt->width;
+	size_t group = fmt->group;
+	char *p = dst;
+
+	// print data in the line as hex groups, blanks past the end of the buffer
+	if (fmt->format == PRINT_HEX || fmt->format == PRINT_BOTH){
+		for (size_t start = 0; start < width; start += group){
+			for (size_t idx = 0; idx < group; idx++){
+				size_t at = start + (fmt->little_endian ? group - 1 - idx : idx);
+				if (at < len){
+					memcpy(p, HEX_PAIRS[line[at]], 2);
+				}
+				else {
+					memcpy(p, "  ", 2);
+				}
+				p += 2;
+			}
+			*p++ = ' ';
+		}
+		memcpy(p, "   ", 3);
+		p += 3;
+	}
+	// print data in line as ASCII characters, blanks past the end of the buffer
+	if (fmt->format == PRINT_ASCII || fmt->format == PRINT_BOTH){
+		for (size_t idx = 0; idx < width; idx++){
+			*p++ = idx < len ? PRINTABLE[line[idx]] : ' ';
+		}
+	}
+	return (size_t) (p - dst);
+}
+
+
+size_t format_lines(char *dst, const uint8_t *src, size_t len, uint64_t offset, const line_format *fmt){
+
+	const emitter *emit = &EMITTERS[fmt->style];
+	size_t width = fmt->width;
+	char *p = emit->lines(dst, src, len / width, offset, fmt);
+	src += len - len % width;
+	offset += len - len % width;
+
+	// trailing partial line
+	if (len % width){
+		p = emit->line(p, src, len % width, offset, fmt);
+	}
+	return (size_t) (p - dst);
+}
+
+
+size_t format_lines_squeezed(char *dst, const uint8_t *src, size_t len, uint64_t offset, const line_format *fmt, size_t lead){
+
+	encode_lines_fn encode = select_encoder(fmt);
+	uint8_t format = fmt->format;
+	size_t width = fmt->width;
+	char *p = dst;
+	size_t lines = len / width;
+	size_t idx = 0;		// line being examined
+	size_t run = 0;		// first line not yet printed
+
+	while (idx < lines){
+		const uint8_t *line = src + idx * width;
+		bool has_prev = idx >= 1 || lead >= width;
+		if (!has_prev || !lines_equal(line, line - width, width)){
+			idx++;
+			continue;
+		}
+
+		// line repeats the one before it: print the distinct lines collected so far in bulk
+		p = encode(p, src + run * width, idx - run, offset + run * width, format);
+
+		// the "*" was already printed if the previous line was itself a repeat
+		bool has_prev2 = idx >= 2 || lead >= (2 - idx) * width;
+		if (!has_prev2 || !lines_equal(line - width, line - 2 * width, width)){
+			memcpy(p, "*\n", 2);
+			p += 2;
+		}
+
+		// skip to the end of the run, zero runs a page at a time
+		idx++;
+		if (line_is_zero(line, width)){
+			idx += zero_run(src + idx * width, (lines - idx) * width, width) / width;
+		}
+		while (idx < lines && lines_equal(src + idx * width, src + (idx - 1) * width, width)){
+			idx++;
+		}
+		run = idx;
+	}
+	p = encode(p, src + run * width, lines - run, offset + run * width, format);
+
+	// trailing partial line is never a repeat
+	if (len % width){
+		p += format_line(p, src + lines * width, offset + lines * width, fmt, len % width);
+	}
+	return (size_t) (p - dst);
+}
+
+
+static encode_lines_fn select_encoder(const line_format *fmt){
+
+	// single byte groups may have a SIMD kernel
+	size_t width_idx = (size_t) __builtin_ctz(fmt->width) - 3;
+	if (fmt->group == 1){
+		return encode_lines[width_idx];
+	}
+	return ENCODERS[width_idx][__builtin_ctz(fmt->group)][fmt->little_endian];
+}
+
+
+static size_t zero_run(const uint8_t *src, size_t len, size_t width){
+
+	size_t done = 0;
+
+	// OR-reduce whole blocks, the compiler vectorizes this loop
+	while (len - done >= ZERO_BLOCK){
+		uint64_t acc = 0;
+		for (size_t idx = 0; idx < ZERO_BLOCK; idx += 8){
+			uint64_t word;
+			memcpy(&word, src + done + idx, 8);
+			acc |= word;
+		}
+		if (acc){
+			break;
+		}
+		done += ZERO_BLOCK;
+	}
+	while (len - done >= width && line_is_zero(src + done, width)){
+		done += width;
+	}
+	return done;
+}
+
+
+static inline __attribute__((always_inline)) char *encode_lines_layout(char *dst, const uint8_t *src, size_t lines, uint64_t offset,
+		uint8_t format, size_t width, size_t group, bool little){
+
+	// one loop per format so the format is not re-tested per line
+	switch (format){
+		case PRINT_ASCII:
+			for (size_t line = 0; line < lines; line++){
+				dst = put_offset(dst, offset);
+				dst = put_ascii(dst, src, width);
+				*dst++ = '\n';
+				src += width;
+				offset += width;
+			}
+			break;
+		case PRINT_BOTH:
+			for (size_t line = 0; line < lines; line++){
+				dst = put_offset(dst, offset);
+				dst = put_hex(dst, src, width, group, little);
+				memcpy(dst, "   ", 3);
+				dst = put_ascii(dst + 3, src, width);
+				*dst++ = '\n';
+				src += width;
+				offset += width;
+			}
+			break;
+		default:
+			for (size_t line = 0; line < lines; line++){
+				dst = put_offset(dst, offset);
+				dst = put_hex(dst, src, width, group, little);
+				memcpy(dst, "   ", 3);
+				dst[3] = '\n';
+				dst += 4;
+				src += width;
+				offset += width;
+			}
+			break;
+	}
+	return dst;
+}
+
+
+int outbuf_init(out_buffer *out, int fd, size_t cap){
+
+	if (cap == 0){
+		cap = OUTPUT_BUFFER_SIZE;
+	}
+	out->fd = fd;
+	out->len = 0;
+	out->cap = cap;
+	out->buf = malloc(cap);
+	return out->buf ? 0 : -1;
+}
+
+
+int outbuf_flush(out_buffer *out){
+
+	size_t done = 0;
+	while (done < out->len){
+		ssize_t wrote = write(out->fd, out->buf + done, out->len - done);
+		if (wrote < 0){
+			if (errno == EINTR){
+				continue;
+			}
+			return -1;
+		}
+		done += (size_t) wrote;
+	}
+	out->len = 0;
+	return 0;
+}
+
+
+char *outbuf_reserve(out_buffer *out, size_t len){
+
+	if (out->cap - out->len < len && outbuf_flush(out)){
+		return NULL;
+	}
+	return out->buf + out->len;
+}
+
+
+int outbuf_append(out_buffer *out, const char *str, size_t len){
+
+	while (len){
+		if (out->len == out->cap && outbuf_flush(out)){
+			return -1;
+		}
+		size_t room = out->cap - out->len;
+		size_t part = len < room ? len : room;
+		memcpy(out->buf + out->len, str, part);
+		out->len += part;
+		str += part;
+		len -= part;
+	}
+	return 0;
+}
+
+
+int outbuf_free(out_buffer *out){
+
+	int retval = out->buf ? outbuf_flush(out) : 0;
+	free(out->buf);
+	out->buf = NULL;
+	out->len = out->cap = 0;
+	return retval;
+}
+
+
+static inline char *put_offset(char *dst, uint64_t offset){
+
+	dst[0] = '0';
+	dst[1] = 'x';
+	for (int idx = 0; idx < 8; idx++){
+		memcpy(dst + 2 + idx * 2, HEX_PAIRS[(offset >> (56 - idx * 8)) & 0xFF], 2);
+	}
+	memcpy(dst + 18, "    ", 4);
+	return dst + OFFSET_COLUMN;
+}
+
+
+static inline char *put_hex(char *dst, const uint8_t *src, size_t width, size_t group, bool little){
+
+	for (size_t start = 0; start < width; start += group){
+		for (size_t idx = 0; idx < group; idx++){
+			memcpy(dst, HEX_PAIRS[src[start + (little ? group - 1 - idx : idx)]], 2);
+			dst += 2;
+		}
+		*dst++ = ' ';
+	}
+	return dst;
+}
+
+
+static inline char *put_ascii(char *dst, const uint8_t *src, size_t width){
+
+	for (size_t idx = 0; idx < width; idx++){
+		dst[idx] = PRINTABLE[src[idx]];
+	}
+	return dst + width;
+}
+
+
+static inline size_t hex_column(const line_format *fmt){
+	return fmt->width * 2u + fmt->width / fmt->group + 3;
+}
+
+
+static char *text_lines(char *dst, const uint8_t *src, size_t lines, uint64_t offset, const line_format *fmt){
+	return select_encoder(fmt)(dst, src, lines, offset, fmt->format);
+}
+
+
+static char *text_line(char *dst, const uint8_t *src, size_t len, uint64_t offset, const line_format *fmt){
+
+	char *p = put_offset(dst, offset);
+	p += format_columns(p, src, fmt, len);
+	*p++ = '\n';
+	return p;
+}
+
+
+static size_t c_line_len(const line_format *fmt){
+	return 2 + sizeof(C_ITEMS[0]) * fmt->width;		// indent, items, the last item's space becomes the newline
+}
+
+
+static char *c_lines(char *dst, const uint8_t *src, size_t lines, uint64_t offset, const line_format *fmt){
+
+	// every item keeps its comma, a trailing comma is valid in an initializer and chunks need not know which line is last
+	size_t width = fmt->width;
+	for (size_t line = 0; line < lines; line++){
+		dst = c_line(dst, src, width, offset, fmt);
+		src += width;
+	}
+	return dst;
+}
+
+
+static char *c_line(char *dst, const uint8_t *src, size_t len, uint64_t offset, const line_format *fmt){
+
+	(void) offset;
+	(void) fmt;
+	memcpy(dst, "  ", 2);
+	dst += 2;
+	for (size_t idx = 0; idx < len; idx++){
+		memcpy(dst, C_ITEMS[src[idx]], sizeof(C_ITEMS[0]));
+		dst += sizeof(C_ITEMS[0]);
+	}
+	dst[-1] = '\n';
+	return dst;
+}
+
+
+static size_t json_line_len(const line_format *fmt){
+	// {"offset":<20 digits>,"hex":"<2 per byte>","text":"<up to 2 per byte>"}
+	return 12 + 20 + 9 + 2 * (size_t) fmt->width + 9 + 2 * (size_t) fmt->width + 2;
+}
+
+
+static char *json_lines(char *dst, const uint8_t *src, size_t lines, uint64_t offset, const line_format *fmt){
+	return records_for_width(dst, src, lines, offset, fmt, false);
+}
+
+
+static char *json_line(char *dst, const uint8_t *src, size_t len, uint64_t offset, const line_format *fmt){
+
+	decimal dec;
+	decimal_set(&dec, offset);
+	return put_record(dst, src, len, &dec, fmt->format, false);
+}
+
+
+static size_t csv_line_len(const line_format *fmt){
+	// <20 digits>,<2 per byte>,"<up to 2 per byte>"
+	return 20 + 1 + 2 * (size_t) fmt->width + 2 + 2 * (size_t) fmt->width + 2;
+}
+
+
+static char *csv_lines(char *dst, const uint8_t *src, size_t lines, uint64_t offset, const line_format *fmt){
+	return records_for_width(dst, src, lines, offset, fmt, true);
+}
+
+
+static char *csv_line(char *dst, const uint8_t *src, size_t len, uint64_t offset, const line_format *fmt){
+
+	decimal dec;
+	decimal_set(&dec, offset);
+	return put_record(dst, src, len, &dec, fmt->format, true);
+}
+
+
+static inline __attribute__((always_inline)) char *put_record(char *dst, const uint8_t *src, size_t len, const decimal *dec, uint8_t format, bool csv){
+
+	if (!csv){
+		memcpy(dst, "{\"offset\":", 10);
+		dst += 10;
+	}
+	dst = put_decimal(dst, dec);
+	if (format & PRINT_HEX){
+		if (csv){
+			*dst++ = ',';
+			dst = put_hex_raw(dst, src, len);
+		}
+		else {
+			memcpy(dst, ",\"hex\":\"", 8);
+			dst = put_hex_raw(dst + 8, src, len);
+			*dst++ = '"';
+		}
+	}
+	if (format & PRINT_ASCII){
+		if (csv){
+			memcpy(dst, ",\"", 2);
+			dst += 2;
+		}
+		else {
+			memcpy(dst, ",\"text\":\"", 9);
+			dst += 9;
+		}
+		dst = put_text_quoted(dst, src, len, csv);
+		*dst++ = '"';
+	}
+	if (!csv){
+		*dst++ = '}';
+	}
+	*dst++ = '\n';
+	return dst;
+}
+
+
+static inline __attribute__((always_inline)) char *records_layout(char *dst, const uint8_t *src, size_t lines, uint64_t offset,
+		uint8_t format, size_t width, bool csv){
+
+	decimal dec;
+	decimal_set(&dec, offset);
+	for (size_t line = 0; line < lines; line++){
+		dst = put_record(dst, src, width, &dec, format, csv);
+		src += width;
+		decimal_add(&dec, (unsigned) width);
+	}
+	return dst;
+}
+
+
+static char *records_for_width(char *dst, const uint8_t *src, size_t lines, uint64_t offset, const line_format *fmt, bool csv){
+
+	// the line width becomes a constant of each case, like the text encoders get it from ENCODER()
+	switch (fmt->width){
+		case 8:
+			return csv ? records_layout(dst, src, lines, offset, fmt->format, 8, true) : records_layout(dst, src, lines, offset, fmt->format, 8, false);
+		case 16:
+			return csv ? records_layout(dst, src, lines, offset, fmt->format, 16, true) : records_layout(dst, src, lines, offset, fmt->format, 16, false);
+		case 32:
+			return csv ? records_layout(dst, src, lines, offset, fmt->format, 32, true) : records_layout(dst, src, lines, offset, fmt->format, 32, false);
+		default:
+			return csv ? records_layout(dst, src, lines, offset, fmt->format, 64, true) : records_layout(dst, src, lines, offset, fmt->format, 64, false);
+	}
+}
+
+
+static void decimal_set(decimal *dec, uint64_t value){
+
+	size_t idx = sizeof(dec->digits);
+	do {
+		dec->digits[--idx] = (char) ('0' + value % 10);
+		value /= 10;
+	} while (value);
+	dec->start = idx;
+}
+
+
+static inline void decimal_add(decimal *dec, unsigned amount){
+
+	// amount is at most a line width, so it only ever touches the last few digits before carrying
+	size_t idx = sizeof(dec->digits);
+	unsigned carry = amount;
+	while (carry){
+		if (idx == dec->start){
+			dec->digits[--dec->start] = '0';
+		}
+		idx--;
+		unsigned digit = (unsigned) (dec->digits[idx] - '0') + carry;
+		dec->digits[idx] = (char) ('0' + digit % 10);
+		carry = digit / 10;
+	}
+}
+
+
+static inline char *put_decimal(char *dst, const decimal *dec){
+
+	size_t len = sizeof(dec->digits) - dec->start;
+	memcpy(dst, dec->digits + dec->start, len);
+	return dst + len;
+}
+
+
+static inline char *put_hex_raw(char *dst, const uint8_t *src, size_t len){
+
+	for (size_t idx = 0; idx < len; idx++){
+		memcpy(dst + idx * 2, HEX_PAIRS[src[idx]], 2);
+	}
+	return dst + len * 2;
+}
+
+
+static inline char *put_text_quoted(char *dst, const uint8_t *src, size_t len, bool csv){
+
+	// quote characters are rare, so the line is written like put_ascii() and only redone if one turned up
+	bool quoted = false;
+	for (size_t idx = 0; idx < len; idx++){
+		char c = PRINTABLE[src[idx]];
+		dst[idx] = c;
+		quoted |= c == '"' || (!csv && c == '\\');
+	}
+	if (!quoted){
+		return dst + len;
+	}
+
+	for (size_t idx = 0; idx < len; idx++){
+		char c = PRINTABLE[src[idx]];
+		if (c == '"'){
+			*dst++ = csv ? '"' : '\\';
+		}
+		else if (c == '\\' && !csv){
+			*dst++ = '\\';
+		}
+		*dst++ = c;
+	}
+	return dst;
+}
+
+
+static int put_c_name(out_buffer *out, const char *name){
+
+	if (*name >= '0' && *name <= '9' && outbuf_append(out, "_", 1)){
+		return EXIT_FAILURE;
+	}
+	for (const char *p = name; *p; p++){
+		char c = (*p >= '0' && *p <= '9') || (*p >= 'a' && *p <= 'z') || (*p >= 'A' && *p <= 'Z') ? *p : '_';
+		if (outbuf_append(out, &c, 1)){
+			return EXIT_FAILURE;
+		}
+	}
+	return EXIT_SUCCESS;
+}
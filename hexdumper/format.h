@@ -0,0 +1,267 @@
+/**
+ * @file format.h
+ * @brief Table-driven line formatter and bulk output buffer for the dump engine
+ * @date 2026-10-16
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+
+
+//*********************************************************************************
+// DEFINITIONS
+//*********************************************************************************
+
+// default bytes per line, the layout the SIMD kernels are built for
+#define LINE_SIZE 16
+
+// widest line selectable with -w
+#define LINE_SIZE_MAX 64
+
+// default capacity of an out_buffer, each flush is one write() of up to this many bytes
+#define OUTPUT_BUFFER_SIZE (1u << 20)
+
+// width of the offset column: "0x" + 16 hex digits + 4 spaces
+#define OFFSET_COLUMN 22
+
+// width of the DATA column of a default line: LINE_SIZE "XX " groups plus a 3 space gap before TEXT
+#define HEX_COLUMN (LINE_SIZE * 3 + 3)
+
+/**
+ * @brief enumeration for output print format, uses bits to signal inclusivity of format
+ */
+typedef enum PRINT_FORMAT{
+	PRINT_NONE = 0,
+	PRINT_HEX,
+	PRINT_ASCII,
+	PRINT_BOTH
+} PRINT_FORMAT;
+
+/**
+ * @brief output style of a dump, each has its own emitter
+ */
+typedef enum OUTPUT_STYLE{
+	OUTPUT_TEXT = 0,	// OFFSET/DATA/TEXT columns for people
+	OUTPUT_C,			// C array initializer, like xxd -i
+	OUTPUT_JSON,		// one JSON object per line
+	OUTPUT_CSV			// one CSV record per line, text quoted
+} OUTPUT_STYLE;
+
+/**
+ * @brief layout of a dumped line, every combination has its own compiled encoder
+ */
+typedef struct line_format {
+	uint8_t format;			// PRINT_FORMAT value for desired output format
+	uint8_t width;			// bytes per line: 8, 16, 32 or 64
+	uint8_t group;			// bytes per hex group: 1, 2, 4 or 8, OUTPUT_TEXT only
+	bool little_endian;		// print the bytes of each group last to first, OUTPUT_TEXT only
+	uint8_t style;			// OUTPUT_STYLE value, selects the emitter
+} line_format;
+
+/**
+ * @brief output staging buffer, flushed to fd with a single write() when full
+ */
+typedef struct out_buffer {
+	int fd;			// descriptor the buffer is flushed to
+	char *buf;		// staged output
+	size_t len;		// bytes currently staged
+	size_t cap;		// capacity of buf
+} out_buffer;
+
+// "XY" hex digit pair of every byte value
+extern const char HEX_PAIRS[256][2];
+
+// the byte itself if printable ASCII, otherwise '.'
+extern const char PRINTABLE[256];
+
+
+//*********************************************************************************
+// DECLARATIONS
+//*********************************************************************************
+
+/**
+ * @brief Selects the fastest line encoding kernel the CPU supports (cpuid), call once before formatting
+ * @remark Setting HEXDUMP_KERNEL=scalar|ssse3|avx2 in the environment forces a kernel, unsupported choices fall back to scalar
+ *
+ * @return Returns the name of the selected kernel
+ */
+const char *format_init(void);
+
+/**
+ * @brief Returns true if a line layout has a width and group size an encoder exists for
+ */
+bool format_valid(const line_format *fmt);
+
+/**
+ * @brief Returns the length in characters of the longest formatted line, including the newline
+ *
+ * @param fmt line layout
+ * @return size_t line length
+ */
+size_t format_line_len(const line_format *fmt);
+
+/**
+ * @brief Writes the column header line for the given format
+ *
+ * @param[out] dst destination, must hold at least format_line_len(fmt) characters
+ * @param fmt line layout
+ * @return Returns the number of characters written
+ */
+size_t format_header(char *dst, const line_format *fmt);
+
+/**
+ * @brief Writes the lines that open a dump: the column header, the C array declaration or the CSV header record
+ *
+ * @param out output buffer
+ * @param fmt line layout
+ * @param name input name, the C array is named after it
+ * @return 0 = SUCCESS | 1 = ERROR
+ */
+int format_prologue(out_buffer *out, const line_format *fmt, const char *name);
+
+/**
+ * @brief Writes the lines that close a dump, only the C array has any: its closing brace and length
+ *
+ * @param out output buffer
+ * @param fmt line layout
+ * @param name input name, the C array is named after it
+ * @param total bytes dumped
+ * @return 0 = SUCCESS | 1 = ERROR
+ */
+int format_epilogue(out_buffer *out, const line_format *fmt, const char *name, uint64_t total);
+
+/**
+ * @brief Writes one line through the emitter of fmt->style: for text the offset as 64 bit hex, then up to
+ * fmt->width bytes as hex and/or ascii
+ *
+ * @param[out] dst destination, must hold at least format_line_len(fmt) characters
+ * @param line the bytes to be printed
+ * @param offset the offset to be printed as hex
+ * @param fmt line layout
+ * @param len number of bytes in line, at most fmt->width
+ * @return Returns the number of characters written
+ */
+size_t format_line(char *dst, const uint8_t *line, uint64_t offset, const line_format *fmt, size_t len);
+
+/**
+ * @brief Writes the DATA and/or TEXT columns of a text line, without the offset column and the newline
+ *
+ * @param[out] dst destination, must hold at least format_line_len(fmt) - OFFSET_COLUMN - 1 characters
+ * @param line the bytes to be printed
+ * @param fmt line layout
+ * @param len number of bytes in line, at most fmt->width, blanks fill the rest
+ * @return Returns the number of characters written
+ */
+size_t format_columns(char *dst, const uint8_t *line, const line_format *fmt, size_t len);
+
+/**
+ * @brief Writes every line of a block of input, fmt->width bytes per line, only the last may be short
+ *
+ * @param[out] dst destination, must hold ceil(len / fmt->width) * format_line_len(fmt) characters
+ * @param src the bytes to be printed
+ * @param len number of bytes in src
+ * @param offset offset of src[0]
+ * @param fmt line layout
+ * @return Returns the number of characters written
+ */
+size_t format_lines(char *dst, const uint8_t *src, size_t len, uint64_t offset, const line_format *fmt);
+
+/**
+ * @brief Like format_lines(), but a full line identical to the one before it is squeezed:
+ * the first repeat of a run prints "*", the rest of the run prints nothing
+ *
+ * @param[out] dst destination, must hold ceil(len / fmt->width) * format_line_len(fmt) characters
+ * @param src the bytes to be printed
+ * @param len number of bytes in src
+ * @param offset offset of src[0]
+ * @param fmt line layout
+ * @param lead bytes of the preceding lines readable before src, only up to two lines are looked at
+ * @return Returns the number of characters written
+ */
+size_t format_lines_squeezed(char *dst, const uint8_t *src, size_t len, uint64_t offset, const line_format *fmt, size_t lead);
+
+/**
+ * @brief Returns true if two lines of width bytes (a multiple of 8) hold the same bytes, compared a word at a time
+ */
+static inline bool lines_equal(const uint8_t *a, const uint8_t *b, size_t width){
+	uint64_t diff = 0;
+	for (size_t idx = 0; idx < width; idx += 8){
+		uint64_t wa, wb;
+		memcpy(&wa, a + idx, 8);
+		memcpy(&wb, b + idx, 8);
+		diff |= wa ^ wb;
+	}
+	return diff == 0;
+}
+
+/**
+ * @brief Returns true if a line of width bytes (a multiple of 8) is all zero bytes
+ */
+static inline bool line_is_zero(const uint8_t *line, size_t width){
+	uint64_t acc = 0;
+	for (size_t idx = 0; idx < width; idx += 8){
+		uint64_t word;
+		memcpy(&word, line + idx, 8);
+		acc |= word;
+	}
+	return acc == 0;
+}
+
+/**
+ * @brief Allocates an output buffer that flushes to fd
+ *
+ * @param[out] out buffer to initialize
+ * @param fd descriptor to flush to
+ * @param cap capacity in bytes, 0 for OUTPUT_BUFFER_SIZE
+ * @return 0 = SUCCESS | -1 = ERROR
+ */
+int outbuf_init(out_buffer *out, int fd, size_t cap);
+
+/**
+ * @brief Writes all staged bytes to the buffer's fd
+ *
+ * @param out output buffer
+ * @return 0 = SUCCESS | -1 = ERROR (errno set)
+ */
+int outbuf_flush(out_buffer *out);
+
+/**
+ * @brief Returns space for at least len more bytes, flushing first if needed
+ * @remark Use outbuf_commit() with the number of bytes actually written
+ *
+ * @param out output buffer
+ * @param len bytes needed, at most out->cap
+ * @return Returns a pointer to the free space | NULL = ERROR
+ */
+char *outbuf_reserve(out_buffer *out, size_t len);
+
+/**
+ * @brief Marks len reserved bytes as staged
+ *
+ * @param out output buffer
+ * @param len bytes written into the reserved space
+ */
+static inline void outbuf_commit(out_buffer *out, size_t len){
+	out->len += len;
+}
+
+/**
+ * @brief Stages a string, flushing as needed
+ *
+ * @param out output buffer
+ * @param str bytes to stage
+ * @param len number of bytes in str
+ * @return 0 = SUCCESS | -1 = ERROR
+ */
+int outbuf_append(out_buffer *out, const char *str, size_t len);
+
+/**
+ * @brief Flushes and frees an output buffer
+ *
+ * @param out output buffer
+ * @return 0 = SUCCESS | -1 = ERROR (final flush failed)
+ */
+int outbuf_free(out_buffer *out);
@@ -9,61 +9,91 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
-#include <ctype.h>
 #include <errno.h>
 #include <stdbool.h>
+#include <unistd.h>
+
+#include "input.h"
+#include "format.h"
+#include "dump.h"
+#include "pool.h"
+#include "reverse.h"
+#include "diff.h"
+#include "find.h"
+#include "entropy.h"
+#include "follow.h"
+#include "batch.h"
 
 
 //*********************************************************************************
-// DECLARATIONS
-//*********************************************************************************
+// DEFINITIONS
+//********************************************************************************
 
-/**
- * @brief Get length of an open file
- * @remark Limited to 2GiB
- *
- * @param[in] fp Pointer to open file
- * @return Returns the length of the file | 0 = ERROR
- */
-static uint32_t file_size(FILE* fp);
+// upper bound for -j, keeps the reorder ring a sane size
+#define MAX_JOBS 256
+
+#define USAGE "Usage: %s <input_file|-> [-h|--hex] [-a|--ascii] [-s|--squeeze] [-j|--jobs N] [-w|--width 8|16|32|64] [-g|--group 1|2|4|8] [-e|--little-endian] [--skip [-]OFFSET] [--length N] [-r|--reverse] [-f|--follow]\n" \
+	"       %s <input_file|@list_file> <input_file|@list_file> ... [-h|--hex] [-a|--ascii] [-s|--squeeze] [-i|--include] [-j|--jobs N] [-w ...] [-g ...] [-e] [--skip [-]OFFSET] [--length N]\n" \
+	"       %s <input_file|-> -i|--include|--json|--csv [-h|--hex] [-a|--ascii] [-j|--jobs N] [-w|--width 8|16|32|64] [--skip [-]OFFSET] [--length N]\n" \
+	"       %s <input_file> --find <hex|string> [--find-text <string>] [--find ...] [-C|--context N] [options]\n" \
+	"       %s <input_file|-> --entropy [--csv] [-j|--jobs N] [--skip [-]OFFSET] [--length N]\n" \
+	"       %s --diff <file_a> <file_b> [options]\n"
 
 /**
- * @brief prints an offset as 64 bit hex and prints a character buffer as hex and/or ascii
- * 
- * @param line the character buffer to be printed
- * @param offset the offset to be printed as hex
- * @param format PRINT_FORMAT value for desired output format
- * @param end the last index of the character buffer to print
- */
-static void print_line(uint8_t *line, size_t offset, uint8_t format, uint8_t end);
- 
-/**
- * @brief Prints the contents of a file line by line as hex and/or ascii
- * 
- * @param input_file file to be dumped
- * @param size size of the file
- * @param format PRINT_FORMAT value for desired output format
+ * @brief Parses a byte count or offset: decimal, 0x hex or 0 octal, with an optional K, M or G (1024 based) suffix
+ *
+ * @param text argument to parse
+ * @param[out] value receives the parsed magnitude
+ * @param[out] negative receives true if text starts with '-', NULL if a sign is not allowed
  * @return 0 = SUCCESS | 1 = ERROR
  */
-int dump_file(FILE* input_file, uint32_t size, uint8_t format);
-
+static int parse_size(const char *text, uint64_t *value, bool *negative){
 
-//*********************************************************************************
-// DEFINITIONS
-//********************************************************************************
+	if (negative){
+		*negative = *text == '-';
+		text += *negative;
+	}
+	if (*text < '0' || *text > '9'){
+		return EXIT_FAILURE;
+	}
 
-#define LINE_SIZE 16
+	char *end = NULL;
+	errno = 0;
+	unsigned long long number = strtoull(text, &end, 0);
+	unsigned shift = 0;
+	switch (*end){
+		case 'k': case 'K': shift = 10; end++; break;
+		case 'm': case 'M': shift = 20; end++; break;
+		case 'g': case 'G': shift = 30; end++; break;
+	}
+	if (errno || *end || number > (UINT64_MAX >> shift)){
+		return EXIT_FAILURE;
+	}
+	*value = (uint64_t) number << shift;
+	return EXIT_SUCCESS;
+}
 
 /**
- * @brief enumeration for output print format, uses bits to signal inclusivity of format
+ * @brief Positions an input at the range selected with --skip/--length, reporting errors on stderr
+ *
+ * @param in open input
+ * @param range range to select
+ * @return 0 = SUCCESS | 1 = ERROR
  */
-typedef enum PRINT_FORMAT{
-	PRINT_NONE = 0,
-	PRINT_HEX,
-	PRINT_ASCII,
-	PRINT_BOTH
-} PRINT_FORMAT;
+static int select_range(input_source *in, const input_range *range){
 
+	if (!input_select(in, range)){
+		return EXIT_SUCCESS;
+	}
+	if (errno == ESPIPE && range->from_end){
+		fprintf(stderr, "Offsets from the end need an input of known size.\n");
+	}
+	else {
+		fprintf(stderr, "Could not seek to offset %s0x%llX in \"%s\". Error: %d\n", range->from_end ? "-" : "",
+				(unsigned long long) range->skip, in->name, errno);
+	}
+	return EXIT_FAILURE;
+}
 
 /**
  * ---------------------------- MAIN ---------------------------- 
@@ -75,146 +105,337 @@ typedef enum PRINT_FORMAT{
 int main(int argc, char *argv[]){
 
 	const uint8_t ARG_MIN = 2;
-	bool retval = EXIT_SUCCESS;
+	int retval = EXIT_SUCCESS;
+	input_source input = { .fd = -1 };
+	input_source other = { .fd = -1 };		// right side of --diff
+	out_buffer out = { .fd = -1 };
+	dump_options options = { .line = { .format = PRINT_NONE, .width = LINE_SIZE, .group = 1 }, .jobs = 1 };
+	char * file_name = NULL;
+	char * other_name = NULL;
+	input_range range = { .length = UINT64_MAX };
+	bool reverse = false;
+	find_pattern patterns[FIND_MAX_PATTERNS];
+	size_t pattern_count = 0;
+	unsigned context = 0;
+	bool jobs_given = false;
+	bool entropy = false;
+	bool follow = false;
+	batch_list batch = { 0 };
 
 	// if no args supplied, give usage hint
 	if (argc < ARG_MIN){
 		fprintf(stderr, "Too few arguments supplied.\n");
-		fprintf(stderr, "Usage: %s <input_file> [-h|--hex] [-a|--ascii]\n", argv[0]);
+		fprintf(stderr, USAGE, argv[0], argv[0], argv[0], argv[0], argv[0], argv[0]);
 		retval = EXIT_FAILURE;
 		goto cleanup;
 	}
 
-	// parse args for hex or ascii flags
-	uint8_t format = PRINT_NONE;
-	char * file_name = NULL;
+	// parse args for format flags and options
 	for (int idx = ARG_MIN-1; idx < argc; idx++){
 		if (!strcasecmp(argv[idx], "--ascii") || !strcasecmp(argv[idx], "-a")){
-			format |= PRINT_ASCII;	// set enum bit for ascii printing	
+			options.line.format |= PRINT_ASCII;	// set enum bit for ascii printing	
 		}
 		else if (!strcasecmp(argv[idx], "--hex") || !strcasecmp(argv[idx], "-h")){
-			format |= PRINT_HEX;	// set enum bit for hex printing
+			options.line.format |= PRINT_HEX;	// set enum bit for hex printing
+		}
+		else if (!strcmp(argv[idx], "--squeeze") || !strcmp(argv[idx], "-s")){
+			options.squeeze = true;		// collapse repeated lines into "*"
 		}
-		else {						// else interpret as the file name
-			file_name = argv[idx];
+		else if ((!strcmp(argv[idx], "--jobs") || !strcmp(argv[idx], "-j")) && idx + 1 < argc){
+			char *end = NULL;
+			unsigned long jobs = strtoul(argv[++idx], &end, 0);
+			if (*end || jobs > MAX_JOBS){
+				fprintf(stderr, "Invalid job count \"%s\", expected 0-%u.\n", argv[idx], MAX_JOBS);
+				retval = EXIT_FAILURE;
+				goto cleanup;
+			}
+			options.jobs = jobs ? (unsigned) jobs : pool_cpu_count();	// 0 = one per CPU
+			jobs_given = true;
+		}
+		else if ((!strcmp(argv[idx], "--width") || !strcmp(argv[idx], "-w")) && idx + 1 < argc){
+			char *end = NULL;
+			unsigned long width = strtoul(argv[++idx], &end, 0);
+			options.line.width = !*end && width <= LINE_SIZE_MAX ? (uint8_t) width : 0;	// 0 fails format_valid()
+		}
+		else if ((!strcmp(argv[idx], "--group") || !strcmp(argv[idx], "-g")) && idx + 1 < argc){
+			char *end = NULL;
+			unsigned long group = strtoul(argv[++idx], &end, 0);
+			options.line.group = !*end && group <= LINE_SIZE_MAX ? (uint8_t) group : 0;
+		}
+		else if (!strcmp(argv[idx], "--little-endian") || !strcmp(argv[idx], "-e")){
+			options.line.little_endian = true;	// groups print their bytes last to first
+		}
+		else if (!strcmp(argv[idx], "--reverse") || !strcmp(argv[idx], "-r")){
+			reverse = true;				// hex dump text in, bytes out
+		}
+		else if (!strcmp(argv[idx], "--diff") && idx + 2 < argc){
+			file_name = argv[++idx];	// compare two inputs instead of dumping one
+			other_name = argv[++idx];
+		}
+		else if ((!strcmp(argv[idx], "--find") || !strcmp(argv[idx], "--find-text")) && idx + 1 < argc){
+			bool literal = !strcmp(argv[idx], "--find-text");	// a string even if it reads as hex
+			if (pattern_count == FIND_MAX_PATTERNS || find_parse(&patterns[pattern_count], argv[++idx], literal)){
+				fprintf(stderr, "Invalid pattern \"%s\", at most %u patterns of 1-%u bytes.\n", argv[idx], FIND_MAX_PATTERNS, FIND_PATTERN_MAX);
+				retval = EXIT_FAILURE;
+				goto cleanup;
+			}
+			pattern_count++;
+		}
+		else if ((!strcmp(argv[idx], "--context") || !strcmp(argv[idx], "-C")) && idx + 1 < argc){
+			char *end = NULL;
+			unsigned long lines = strtoul(argv[++idx], &end, 0);		// lines around each --find hit
+			if (end == argv[idx] || *end || argv[idx][0] == '-' || lines > FIND_CONTEXT_MAX){
+				fprintf(stderr, "Invalid context \"%s\", expected 0-%u lines.\n", argv[idx], FIND_CONTEXT_MAX);
+				retval = EXIT_FAILURE;
+				goto cleanup;
+			}
+			context = (unsigned) lines;
+		}
+		else if (!strcmp(argv[idx], "--entropy")){
+			entropy = true;				// per block entropy and histogram instead of a dump
+		}
+		else if (!strcmp(argv[idx], "--follow") || !strcmp(argv[idx], "-f")){
+			follow = true;				// keep dumping what is appended to the file
+		}
+		else if (!strcmp(argv[idx], "--include") || !strcmp(argv[idx], "-i")){
+			options.line.style = OUTPUT_C;		// C array initializer
+		}
+		else if (!strcmp(argv[idx], "--json")){
+			options.line.style = OUTPUT_JSON;	// one JSON object per line
+		}
+		else if (!strcmp(argv[idx], "--csv")){
+			options.line.style = OUTPUT_CSV;	// one CSV record per line, also for --entropy rows
+		}
+		else if (!strcmp(argv[idx], "--skip") && idx + 1 < argc){
+			if (parse_size(argv[++idx], &range.skip, &range.from_end)){	// a leading '-' counts back from the end
+				fprintf(stderr, "Invalid offset \"%s\".\n", argv[idx]);
+				retval = EXIT_FAILURE;
+				goto cleanup;
+			}
+		}
+		else if (!strcmp(argv[idx], "--length") && idx + 1 < argc){
+			if (parse_size(argv[++idx], &range.length, NULL)){
+				fprintf(stderr, "Invalid length \"%s\".\n", argv[idx]);
+				retval = EXIT_FAILURE;
+				goto cleanup;
+			}
+		}
+		else if (argv[idx][0] == '-' && argv[idx][1]){
+			fprintf(stderr, "Ignoring unknown option \"%s\".\n", argv[idx]);	// unrecognized flags are ignored, "-" is stdin
+		}
+		else if (batch_add(&batch, argv[idx])){		// else interpret as a file name or @list of file names
+			fprintf(stderr, "Could not read file list \"%s\". Error: %d\n", argv[idx] + 1, errno);
+			retval = EXIT_FAILURE;
+			goto cleanup;
 		}
 	}
 	// default to print hex if no option given
-	if (format == PRINT_NONE){
-		format = PRINT_HEX;
+	if (options.line.format == PRINT_NONE){
+		options.line.format = PRINT_HEX;
+	}
+	if (!format_valid(&options.line)){
+		fprintf(stderr, "Invalid line layout, expected a width of 8, 16, 32 or 64 and a group of 1, 2, 4 or 8 bytes.\n");
+		retval = EXIT_FAILURE;
+		goto cleanup;
 	}
 
-	FILE* input_file = fopen(file_name, "r");
-	if (!input_file){	// if file cannot be opened, exit with an error
-		fprintf(stderr, "Could not open file \"%s\". Error: %d", file_name, errno);
+	// machine readable styles print plain lines, the modes with their own layout only know text (and CSV for --entropy)
+	if (options.line.style != OUTPUT_TEXT && (options.squeeze || reverse || other_name || pattern_count ||
+			(entropy && options.line.style != OUTPUT_CSV))){
+		fprintf(stderr, "-i, --json and --csv cannot be combined with -s, -r, --diff or --find, and --entropy only takes --csv.\n");
 		retval = EXIT_FAILURE;
 		goto cleanup;
 	}
 
-	uint32_t size = file_size(input_file);
+	// follow mode prints plain lines as they arrive, nothing that needs the whole input first
+	if (follow && (options.squeeze || reverse || other_name || pattern_count || entropy || options.line.style == OUTPUT_C)){
+		fprintf(stderr, "-f cannot be combined with -s, -r, -i, --diff, --find or --entropy.\n");
+		retval = EXIT_FAILURE;
+		goto cleanup;
+	}
 
-	// read and print contents of the file in requested format
-	if (dump_file(input_file, size, format)){
-		fprintf(stderr, "File contents could not be dumped. Error: %d\n", errno);
+	// several inputs (or a list of them) are dumped one after the other, any other mode takes a single input
+	bool batch_mode = batch.count > 1 || batch.list_count > 0;
+	if (batch_mode && (follow || reverse || other_name || pattern_count || entropy ||
+			options.line.style == OUTPUT_JSON || options.line.style == OUTPUT_CSV)){
+		fprintf(stderr, "Several inputs can only be dumped as text or C arrays, without -f, -r, --diff, --find or --entropy.\n");
+		retval = EXIT_FAILURE;
+		goto cleanup;
+	}
+	if (other_name && batch.count){
+		fprintf(stderr, "--diff takes exactly two inputs.\n");
 		retval = EXIT_FAILURE;
 		goto cleanup;
 	}
+	if (batch.count == 1 && !batch_mode){
+		file_name = (char *) batch.paths[0];
+	}
 
-	cleanup:
-	if (input_file){
-		if(fclose(input_file)){
-			fprintf(stderr, "Could not close file \"%s\". Error: %d", file_name, errno);
+	if (batch_mode){
+		size_t failed = 0;
+		if (!jobs_given){
+			options.jobs = pool_cpu_count();
+		}
+		format_init();
+		if (outbuf_init(&out, STDOUT_FILENO, 0)){
+			fprintf(stderr, "Could not allocate output buffer.\n");
 			retval = EXIT_FAILURE;
 		}
+		else {
+			if (batch_dump(&batch, &options, &range, &out, &failed)){
+				fprintf(stderr, "Files could not be dumped. Error: %d\n", errno);
+				retval = EXIT_FAILURE;
+			}
+			else if (failed){
+				outbuf_flush(&out);		// the dumps go out before the summary, a write error is reported by outbuf_free() at cleanup
+			}
+			if (failed){
+				fprintf(stderr, "%zu of %zu files could not be dumped.\n", failed, batch.count);
+				retval = EXIT_FAILURE;
+			}
+		}
+		goto cleanup;
 	}
 
-	return retval;
-}
+	if (!file_name){
+		fprintf(stderr, "No input file given.\n");
+		fprintf(stderr, USAGE, argv[0], argv[0], argv[0], argv[0], argv[0], argv[0]);
+		retval = EXIT_FAILURE;
+		goto cleanup;
+	}
 
+	if (input_open(&input, file_name)){	// if file cannot be opened, exit with an error
+		fprintf(stderr, "Could not open file \"%s\". Error: %d\n", file_name, errno);
+		retval = EXIT_FAILURE;
+		goto cleanup;
+	}
 
-void print_line(uint8_t *line, size_t offset, uint8_t format, uint8_t len){
-		// print offset as 0 padded 16 bit hex
-		printf("0x%016X    ", offset);
+	if (other_name && input_open(&other, other_name)){
+		fprintf(stderr, "Could not open file \"%s\". Error: %d\n", other_name, errno);
+		retval = EXIT_FAILURE;
+		goto cleanup;
+	}
 
-		// print data in the line as hex values
-		if (format == PRINT_HEX || format == PRINT_BOTH){
-			for (int idx = 0; idx < LINE_SIZE; idx++){
-				if (idx < len) { // if current index is within buffer len, print it
-					printf("%02X ", line[idx]);
-				} 
-				else { 	// otherwise print blank spaces
-					printf("   ");
-				}
-			}
-			printf("   ");
-		}
-		// print data in line as ASCII characters
-		if (format == PRINT_ASCII || format == PRINT_BOTH){
-			for(int idx = 0; idx < LINE_SIZE; idx++){
-				if (idx >= len) { // if current index outside of buffer len, print blank
-					printf(" ");
-				}		// if char falls within printable ASCII range, print char
-				else if (isprint(line[idx])){
-					putchar(line[idx]);
-				}
-				else { 	// otherwise print a dot
-					putchar('.');
-				}
-			}
+	// a diff compares the same offsets of both files, so an offset from the end counts back from the
+	// end of the shorter one and is then applied to both
+	if (other_name && range.from_end){
+		if (!input.size_known || !other.size_known){
+			fprintf(stderr, "Offsets from the end need an input of known size.\n");
+			retval = EXIT_FAILURE;
+			goto cleanup;
 		}
-		printf("\n");
-}
-
+		uint64_t shorter = input.size < other.size ? input.size : other.size;
+		range.skip = range.skip < shorter ? shorter - range.skip : 0;
+		range.from_end = false;
+	}
 
-int dump_file(FILE* input_file, uint32_t size, uint8_t format){
+	// jump straight to the requested range
+	if (select_range(&input, &range) || (other_name && select_range(&other, &range))){
+		retval = EXIT_FAILURE;
+		goto cleanup;
+	}
 
-	if (!input_file) {
-		return EXIT_FAILURE;
+	format_init();
+	if (outbuf_init(&out, STDOUT_FILENO, 0)){
+		fprintf(stderr, "Could not allocate output buffer.\n");
+		retval = EXIT_FAILURE;
+		goto cleanup;
 	}
 
-	// exit if file size is 0
-	if (size == 0){
-		printf("File is empty.\n");
-		return EXIT_SUCCESS;
+	// turn dump text back into bytes
+	if (reverse){
+		uint64_t bad_line = 0;
+		size_t swap_group = options.line.little_endian ? options.line.group : 1;
+		if (reverse_file(&input, &out, swap_group, &bad_line)){
+			if (bad_line){
+				fprintf(stderr, "Malformed hex dump at line %llu.\n", (unsigned long long) bad_line);
+			}
+			else {
+				fprintf(stderr, "Could not write reversed data. Error: %d\n", errno);
+			}
+			retval = EXIT_FAILURE;
+		}
+		goto cleanup;
 	}
 
-	// print headers
-	printf("%-22s", "OFFSET");
-	if (format == PRINT_HEX || format == PRINT_BOTH){
-		printf("%-51s", "DATA");
+	// print the lines that differ between the two inputs
+	if (other_name){
+		uint64_t differences = 0;
+		if (diff_files(&input, &other, &options, &out, &differences)){
+			fprintf(stderr, "Files could not be compared. Error: %d\n", errno);
+			retval = EXIT_FAILURE;
+		}
+		goto cleanup;
 	}
-    if (format == PRINT_ASCII || format == PRINT_BOTH){
-		printf("%-16s", "TEXT");
+
+	// print the hits of the search patterns
+	if (pattern_count){
+		uint64_t matches = 0;
+		if (find_patterns(&input, patterns, pattern_count, &options, context, &out, &matches)){
+			if (errno == EINVAL){
+				fprintf(stderr, "--find needs a file that can be memory-mapped.\n");
+			}
+			else {
+				fprintf(stderr, "File could not be searched. Error: %d\n", errno);
+			}
+			retval = EXIT_FAILURE;
+		}
+		goto cleanup;
 	}
-	printf("\n");
 
-	// fill buffer up to desired line size, then print. Break if no characters read
-	size_t offset = 0;
-	uint8_t buffer[LINE_SIZE];
-	unsigned read = 0;
-	do {
-		read = fread(buffer, 1, LINE_SIZE, input_file);
-		if (read > 0){
-			print_line(buffer, offset, format, read);
+	// profile the blocks of the input, on every CPU unless -j says otherwise
+	if (entropy){
+		if (!jobs_given){
+			options.jobs = pool_cpu_count();
+		}
+		if (entropy_blocks(&input, &options, options.line.style == OUTPUT_CSV, &out)){
+			fprintf(stderr, "File could not be profiled. Error: %d\n", errno);
+			retval = EXIT_FAILURE;
 		}
-		offset += LINE_SIZE;
+		goto cleanup;
+	}
 
-	} while (read > 0);
+	// read and print contents of the file in requested format, -i names its array after the file
+	options.name = strcmp(file_name, "-") ? file_name : NULL;
 
-	return EXIT_SUCCESS;
-}
+	// dump what is there, then keep dumping what gets appended
+	if (follow){
+		if (!input.seekable || !input.size_known){
+			fprintf(stderr, "-f needs a regular file.\n");
+			retval = EXIT_FAILURE;
+		}
+		else if (follow_file(&input, &options, &out)){
+			fprintf(stderr, "File could not be followed. Error: %d\n", errno);
+			retval = EXIT_FAILURE;
+		}
+		goto cleanup;
+	}
+	int dumped = options.jobs > 1 ? dump_parallel(&input, &options, &out) : dump_file(&input, &options, &out);
+	if (dumped){
+		fprintf(stderr, "File contents could not be dumped. Error: %d\n", errno);
+		retval = EXIT_FAILURE;
+		goto cleanup;
+	}
 
+	cleanup:
+	if (out.buf && outbuf_free(&out)){
+		fprintf(stderr, "Could not write output. Error: %d\n", errno);
+		retval = EXIT_FAILURE;
+	}
+	if (input.fd != -1){
+		if(input_close(&input)){
+			fprintf(stderr, "Could not close file \"%s\". Error: %d\n", file_name, errno);
+			retval = EXIT_FAILURE;
+		}
+	}
+	if (other.fd != -1){
+		if(input_close(&other)){
+			fprintf(stderr, "Could not close file \"%s\". Error: %d\n", other_name, errno);
+			retval = EXIT_FAILURE;
+		}
+	}
 
-static uint32_t file_size(FILE* fp) {
-    int64_t start = ftell(fp);
-    if (start == -1){
-        return 0;
-    }
-    uint8_t rv = fseek(fp, 0, SEEK_END);
-    if (rv != 0){
-        return 0;
-    }
-    uint32_t size = ftell(fp);
-    fseek(fp, start, SEEK_SET);
-    return size;
+	batch_free(&batch);
+	return retval;
 }
+
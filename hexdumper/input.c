@@ -0,0 +1,406 @@
+/**
+ * @file input.c
+ * @brief Input sources for the dump engine: whole-file memory maps with a large read window fallback
+ * @date 2026-10-16
+ */
+
+#define _GNU_SOURCE		// SEEK_DATA
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "input.h"
+
+
+//*********************************************************************************
+// DECLARATIONS
+//*********************************************************************************
+
+/**
+ * @brief Maps the whole input read-only and hints sequential access
+ *
+ * @param in input source with fd and size set
+ * @return true if the input is now mapped, false to fall back to reading
+ */
+static bool map_input(input_source *in);
+
+/**
+ * @brief Reads until len bytes are buffered or EOF is hit, short reads from pipes are common
+ *
+ * @param fd descriptor to read
+ * @param buf destination
+ * @param len bytes wanted
+ * @return Returns the number of bytes read | -1 = ERROR
+ */
+static int64_t read_full(int fd, uint8_t *buf, size_t len);
+
+/**
+ * @brief Reads up to len bytes of a streamed input, from the read-ahead ring once it runs, straight from fd otherwise
+ *
+ * @param in streamed input source
+ * @param buf destination
+ * @param len bytes wanted
+ * @return Returns the number of bytes read, fewer only at EOF | -1 = ERROR
+ */
+static int64_t stream_read(input_source *in, uint8_t *buf, size_t len);
+
+/**
+ * @brief Stops the read-ahead stage of a streamed input, the next read starts a new one at the read position
+ *
+ * @param in streamed input source
+ */
+static void stop_ahead(input_source *in);
+
+/**
+ * @brief Asks for the mapped pages INPUT_PREFETCH bytes ahead of an offset with MADV_WILLNEED
+ * @remark Only issues the hint once the previous prefetch is half used up
+ *
+ * @param in mapped input source
+ * @param from offset the reader is at
+ */
+static void prefetch_map(input_source *in, uint64_t from);
+
+
+//*********************************************************************************
+// DEFINITIONS
+//*********************************************************************************
+
+int input_open(input_source *in, const char *path){
+
+	memset(in, 0, sizeof(*in));
+	in->fd = -1;
+	in->name = path;
+	in->limit = UINT64_MAX;
+
+	if (!strcmp(path, "-")){
+		in->fd = STDIN_FILENO;
+		in->name = "<stdin>";
+	}
+	else {
+		in->fd = open(path, O_RDONLY);
+		if (in->fd == -1){
+			return -1;
+		}
+	}
+
+	struct stat st;
+	if (fstat(in->fd, &st)){
+		input_close(in);
+		return -1;
+	}
+
+	// regular files and block devices have a real size and can be seeked/mapped
+	if (S_ISREG(st.st_mode)){
+		in->size = (uint64_t) st.st_size;
+		in->size_known = true;
+		in->seekable = true;
+	}
+	else if (S_ISBLK(st.st_mode)){
+		off_t end = lseek(in->fd, 0, SEEK_END);
+		if (end != -1 && lseek(in->fd, 0, SEEK_SET) != -1){
+			in->size = (uint64_t) end;
+			in->size_known = true;
+			in->seekable = true;
+		}
+	}
+
+	if (in->size_known && in->size > 0 && map_input(in)){
+		return 0;
+	}
+
+	// pipes, stdin, special files and unmappable inputs go through a large read window
+	in->window_cap = INPUT_WINDOW_SIZE;
+	in->window = malloc(in->window_cap);
+	if (!in->window){
+		input_close(in);
+		errno = ENOMEM;
+		return -1;
+	}
+	return 0;
+}
+
+
+int64_t input_next(input_source *in, const uint8_t **data, size_t max_len, size_t align){
+
+	// the previous chunk is dead once the next one is asked for
+	input_release(in, in->pos);
+	return input_next_into(in, data, in->window, max_len, align);
+}
+
+
+int64_t input_next_into(input_source *in, const uint8_t **data, uint8_t *buf, size_t max_len, size_t align){
+
+	if (max_len == 0 || max_len > INPUT_WINDOW_SIZE){
+		max_len = INPUT_WINDOW_SIZE;
+	}
+	// keep chunks line aligned so no line is split across two of them
+	if (align > 1 && max_len > align){
+		max_len -= max_len % align;
+	}
+
+	// never hand out bytes past the limit
+	if (in->pos >= in->limit){
+		return 0;
+	}
+	if (in->limit - in->pos < max_len){
+		max_len = (size_t) (in->limit - in->pos);
+	}
+
+	if (in->mapped){
+		uint64_t remaining = in->size - in->pos;
+		size_t len = remaining < max_len ? (size_t) remaining : max_len;
+		*data = in->map + in->pos;
+		in->pos += len;
+		prefetch_map(in, in->pos);
+		return (int64_t) len;
+	}
+
+	int64_t len = stream_read(in, buf, max_len);
+	if (len < 0){
+		return -1;
+	}
+	*data = buf;
+	in->pos += (uint64_t) len;
+	return len;
+}
+
+
+int64_t input_view(input_source *in, const uint8_t **data){
+
+	if (!in->mapped){
+		errno = EINVAL;
+		return -1;
+	}
+	uint64_t end = in->size < in->limit ? in->size : in->limit;
+	uint64_t len = end > in->pos ? end - in->pos : 0;
+	*data = in->map + in->pos;
+	in->pos += len;
+	return (int64_t) len;
+}
+
+
+void input_release(input_source *in, uint64_t upto){
+
+	if (!in->mapped){
+		return;
+	}
+
+	// only whole pages behind the consumed offset can be dropped
+	uint64_t end = upto - (upto % in->page_size);
+	if (end > in->released){
+		madvise((void *) (in->map + in->released), (size_t) (end - in->released), MADV_DONTNEED);
+		in->released = end;
+	}
+	prefetch_map(in, upto);
+}
+
+
+int input_seek(input_source *in, uint64_t pos){
+
+	if (in->size_known && pos > in->size){
+		errno = EINVAL;
+		return -1;
+	}
+	if (in->mapped){
+		in->pos = pos;
+		return 0;
+	}
+	if (in->seekable){
+		stop_ahead(in);
+		if (lseek(in->fd, (off_t) pos, SEEK_SET) == -1){
+			return -1;
+		}
+		in->pos = pos;
+		return 0;
+	}
+
+	// pipes only go forward: read through the window and throw the bytes away
+	if (pos < in->pos){
+		errno = ESPIPE;
+		return -1;
+	}
+	while (in->pos < pos){
+		uint64_t want = pos - in->pos;
+		int64_t got = stream_read(in, in->window, want < in->window_cap ? (size_t) want : in->window_cap);
+		if (got <= 0){
+			if (got == 0){
+				errno = EINVAL;		// input ended before the requested offset
+			}
+			return -1;
+		}
+		in->pos += (uint64_t) got;
+	}
+	return 0;
+}
+
+
+void input_set_limit(input_source *in, uint64_t limit){
+	in->limit = limit;
+}
+
+
+int input_select(input_source *in, const input_range *range){
+
+	uint64_t skip = range->skip;
+	if (range->from_end){
+		if (!in->size_known){
+			errno = ESPIPE;
+			return -1;
+		}
+		skip = skip < in->size ? in->size - skip : 0;
+	}
+	if (input_seek(in, skip)){
+		return -1;
+	}
+	if (range->length != UINT64_MAX){
+		input_set_limit(in, range->length < UINT64_MAX - skip ? skip + range->length : UINT64_MAX);
+	}
+	return 0;
+}
+
+
+uint64_t input_next_data(input_source *in, uint64_t from){
+
+#ifdef SEEK_DATA
+	uint64_t end = in->size < in->limit ? in->size : in->limit;
+	if (!in->seekable || !in->size_known || from >= end){
+		return from;
+	}
+	off_t data = lseek(in->fd, (off_t) from, SEEK_DATA);
+	int saved = errno;
+
+	// streamed reads rely on the descriptor offset, put it back
+	if (!in->mapped){
+		lseek(in->fd, (off_t) in->pos, SEEK_SET);
+	}
+	if (data == -1){
+		return saved == ENXIO ? end : from;		// ENXIO: nothing but hole up to EOF
+	}
+	return (uint64_t) data < end ? (uint64_t) data : end;
+#else
+	(void) in;
+	return from;
+#endif
+}
+
+
+int input_close(input_source *in){
+
+	int retval = 0;
+	stop_ahead(in);
+	if (in->mapped && in->map){
+		munmap((void *) in->map, (size_t) in->size);
+	}
+	free(in->window);
+	if (in->fd > STDIN_FILENO){
+		retval = close(in->fd);
+	}
+	memset(in, 0, sizeof(*in));
+	in->fd = -1;
+	return retval;
+}
+
+
+static bool map_input(input_source *in){
+
+	// a 32-bit address space cannot hold a multi-GB view, stream those instead
+	if (in->size > (uint64_t) SIZE_MAX){
+		return false;
+	}
+
+	void *view = mmap(NULL, (size_t) in->size, PROT_READ, MAP_PRIVATE, in->fd, 0);
+	if (view == MAP_FAILED){
+		return false;
+	}
+	madvise(view, (size_t) in->size, MADV_SEQUENTIAL);
+
+	// read once per input here, batch workers release and prefetch their maps concurrently
+	in->map = view;
+	in->mapped = true;
+	in->page_size = (size_t) sysconf(_SC_PAGESIZE);
+	return true;
+}
+
+
+static int64_t read_full(int fd, uint8_t *buf, size_t len){
+
+	size_t done = 0;
+	while (done < len){
+		ssize_t got = read(fd, buf + done, len - done);
+		if (got == 0){
+			break;
+		}
+		if (got < 0){
+			if (errno == EINTR){
+				continue;
+			}
+			return -1;
+		}
+		done += (size_t) got;
+	}
+	return (int64_t) done;
+}
+
+
+static int64_t stream_read(input_source *in, uint8_t *buf, size_t len){
+
+	// the stage starts at the first read, after --skip has positioned the input; it reads up to --length or
+	// a 0-byte read, st_size is not trusted since files like /proc/self/status report 0 and still have bytes
+	if (!in->ahead && !in->ahead_tried){
+		in->ahead = readahead_start(in->fd, in->seekable, in->pos, in->seekable ? in->limit : UINT64_MAX);
+		in->ahead_tried = true;
+	}
+	if (!in->ahead){
+		return read_full(in->fd, buf, len);
+	}
+
+	size_t done = 0;
+	while (done < len){
+		if (in->ahead_used == in->ahead_len){
+			int64_t got = readahead_next(in->ahead, &in->ahead_data);
+			if (got < 0){
+				return -1;
+			}
+			in->ahead_len = (size_t) got;
+			in->ahead_used = 0;
+			if (got == 0){
+				break;
+			}
+		}
+		size_t take = in->ahead_len - in->ahead_used < len - done ? in->ahead_len - in->ahead_used : len - done;
+		memcpy(buf + done, in->ahead_data + in->ahead_used, take);
+		in->ahead_used += take;
+		done += take;
+	}
+	return (int64_t) done;
+}
+
+
+static void stop_ahead(input_source *in){
+
+	readahead_stop(in->ahead);
+	in->ahead = NULL;
+	in->ahead_tried = false;
+	in->ahead_data = NULL;
+	in->ahead_len = in->ahead_used = 0;
+}
+
+
+static void prefetch_map(input_source *in, uint64_t from){
+
+	if (in->prefetched >= from + INPUT_PREFETCH / 2 || in->prefetched >= in->size){
+		return;
+	}
+	uint64_t start = in->prefetched > from ? in->prefetched : from;
+	start -= start % in->page_size;
+	uint64_t end = from + INPUT_PREFETCH < in->size ? from + INPUT_PREFETCH : in->size;
+	madvise((void *) (in->map + start), (size_t) (end - start), MADV_WILLNEED);
+	in->prefetched = end;
+}
@@ -0,0 +1,164 @@
+/**
+ * @file input.h
+ * @brief Input sources for the dump engine: whole-file memory maps with a large read window fallback
+ * @date 2026-10-16
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "readahead.h"
+
+//*********************************************************************************
+// DEFINITIONS
+//*********************************************************************************
+
+// bytes handed out per chunk, both for mapped views and the read() window
+#define INPUT_WINDOW_SIZE (4u << 20)
+
+// mapped bytes ahead of the reader that are asked for with MADV_WILLNEED, so slow storage reads while chunks are formatted
+#define INPUT_PREFETCH (2 * INPUT_WINDOW_SIZE)
+
+/**
+ * @brief an open input, either mapped into memory or streamed through a read window
+ */
+typedef struct input_source {
+	int fd;					// underlying descriptor (0 for stdin)
+	const char *name;		// display name of the input
+	bool mapped;			// true if map covers the whole input
+	bool seekable;			// true if fd supports lseek (regular files, block devices)
+	uint64_t size;			// size in bytes, only meaningful if size_known
+	bool size_known;		// false for pipes, sockets and ttys
+	const uint8_t *map;		// mapped view of the whole file when mapped
+	size_t page_size;		// system page size, set when the input is mapped
+	uint8_t *window;		// read buffer when streaming
+	size_t window_cap;		// capacity of window
+	uint64_t pos;			// absolute offset of the next byte to be returned
+	uint64_t limit;			// reads stop at this absolute offset, UINT64_MAX = EOF
+	uint64_t released;		// mapped bytes before this offset have been dropped from the page cache hint
+	uint64_t prefetched;	// mapped bytes before this offset have been asked for with MADV_WILLNEED
+	read_ahead *ahead;		// read-ahead stage of a streamed input, NULL until the first read or if unavailable
+	bool ahead_tried;		// readahead_start() has been called since the last seek
+	const uint8_t *ahead_data;	// buffer handed out by the read-ahead stage
+	size_t ahead_len;		// bytes at ahead_data
+	size_t ahead_used;		// bytes of ahead_data already copied out
+} input_source;
+
+/**
+ * @brief byte range of an input selected with --skip/--length
+ */
+typedef struct input_range {
+	uint64_t skip;			// offset to start at, or bytes back from the end if from_end
+	bool from_end;			// skip counts back from the end of the input
+	uint64_t length;		// bytes to read at most, UINT64_MAX for up to EOF
+} input_range;
+
+
+//*********************************************************************************
+// DECLARATIONS
+//*********************************************************************************
+
+/**
+ * @brief Opens an input file, mapping it read-only when possible
+ * @remark A path of "-" reads from stdin. Call input_close() when done. Mapped inputs prefetch
+ * INPUT_PREFETCH bytes ahead of the reader, streamed inputs are read ahead into a readahead ring
+ * from their first read on.
+ *
+ * @param[out] in input source to initialize
+ * @param[in] path path of the file to open
+ * @return 0 = SUCCESS | -1 = ERROR (errno set)
+ */
+int input_open(input_source *in, const char *path);
+
+/**
+ * @brief Returns the next chunk of input, up to max_len bytes
+ * @remark Every chunk except the last is a multiple of align bytes, so lines never straddle chunks.
+ * The returned pointer is valid until the next call.
+ *
+ * @param in open input source
+ * @param[out] data receives a pointer to the chunk
+ * @param max_len largest chunk wanted, 0 for INPUT_WINDOW_SIZE
+ * @param align chunk length granularity (line size)
+ * @return Returns the number of bytes in the chunk | 0 = EOF | -1 = ERROR
+ */
+int64_t input_next(input_source *in, const uint8_t **data, size_t max_len, size_t align);
+
+/**
+ * @brief Like input_next(), but streamed inputs are read into the caller's buffer instead of the shared window
+ * @remark Mapped chunks still point into the map and are not released, use input_release() once they are consumed.
+ * This lets several chunks stay valid at the same time.
+ *
+ * @param in open input source
+ * @param[out] data receives a pointer to the chunk
+ * @param buf buffer to read into when the input is streamed
+ * @param max_len largest chunk wanted, at most the size of buf
+ * @param align chunk length granularity (line size)
+ * @return Returns the number of bytes in the chunk | 0 = EOF | -1 = ERROR
+ */
+int64_t input_next_into(input_source *in, const uint8_t **data, uint8_t *buf, size_t max_len, size_t align);
+
+/**
+ * @brief Returns the rest of a mapped input as one view, from the read position up to the end or limit
+ * @remark The read position moves to the end of the view. Use input_release() on the parts already consumed.
+ *
+ * @param in open input source
+ * @param[out] data receives a pointer to the view
+ * @return Returns the number of bytes in the view | -1 = ERROR (EINVAL if the input is not mapped)
+ */
+int64_t input_view(input_source *in, const uint8_t **data);
+
+/**
+ * @brief Drops the mapped pages before an absolute offset, they are no longer needed in memory
+ * @remark No-op for streamed inputs
+ *
+ * @param in open input source
+ * @param upto absolute offset that has been fully consumed
+ */
+void input_release(input_source *in, uint64_t upto);
+
+/**
+ * @brief Moves the read position to an absolute offset
+ * @remark Inputs that cannot seek (pipes) can only move forward, the bytes in between are read and discarded
+ *
+ * @param in open input source
+ * @param pos absolute offset of the next byte to return, at most the size of the input
+ * @return 0 = SUCCESS | -1 = ERROR (errno set)
+ */
+int input_seek(input_source *in, uint64_t pos);
+
+/**
+ * @brief Stops reads at an absolute offset, as if the input ended there
+ *
+ * @param in open input source
+ * @param limit absolute offset reads stop at, UINT64_MAX for no limit
+ */
+void input_set_limit(input_source *in, uint64_t limit);
+
+/**
+ * @brief Seeks to the start of a range and limits reads to its end; offsets stay relative to the start of the input
+ *
+ * @param in open input source, at offset 0
+ * @param range range to select
+ * @return 0 = SUCCESS | -1 = ERROR (errno set, ESPIPE if the range counts from the end of an input of unknown size)
+ */
+int input_select(input_source *in, const input_range *range);
+
+/**
+ * @brief Finds the first offset at or after from that may hold data, skipping sparse file holes with SEEK_DATA
+ *
+ * @param in open input source
+ * @param from absolute offset to search from
+ * @return Returns the start of the next data region, the input size (or limit) if only a hole remains,
+ * or from itself if the input or filesystem cannot report holes
+ */
+uint64_t input_next_data(input_source *in, uint64_t from);
+
+/**
+ * @brief Unmaps/frees the input buffers and closes the descriptor
+ *
+ * @param in input source to close
+ * @return 0 = SUCCESS | -1 = ERROR (errno set)
+ */
+int input_close(input_source *in);
@@ -0,0 +1,201 @@
+/**
+ * @file pool.c
+ * @brief Worker thread pool that processes jobs concurrently and hands them back in submission order
+ * @date 2026-10-16
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "pool.h"
+
+
+//*********************************************************************************
+// DEFINITIONS
+//*********************************************************************************
+
+/**
+ * @brief lifecycle of a slot in the reorder ring
+ */
+typedef enum SLOT_STATE{
+	SLOT_FREE = 0,	// available to the producer
+	SLOT_READY,		// produced, waiting for a worker
+	SLOT_BUSY,		// being worked on
+	SLOT_DONE		// worked, waiting for its turn to be consumed
+} SLOT_STATE;
+
+/**
+ * @brief shared state of a pool run
+ */
+typedef struct pool {
+	pthread_mutex_t lock;
+	pthread_cond_t work_ready;		// signaled when a job is produced or the pool shuts down
+	pthread_cond_t work_done;		// signaled when a worker finishes a job
+	const pool_ops *ops;
+	void *ctx;
+	pool_job *jobs;
+	SLOT_STATE *state;
+	unsigned slots;
+	uint64_t produced;				// jobs handed to the ring
+	uint64_t taken;					// jobs picked up by workers
+	uint64_t consumed;				// jobs drained in order
+	bool quit;
+} pool;
+
+
+/**
+ * @brief Worker thread: takes ready jobs in order and runs ops->work on them
+ *
+ * @param arg the pool
+ * @return NULL
+ */
+static void *pool_worker(void *arg){
+
+	pool *p = arg;
+	pthread_mutex_lock(&p->lock);
+	while (true){
+		unsigned slot = (unsigned) (p->taken % p->slots);
+		if (p->taken < p->produced && p->state[slot] == SLOT_READY){
+			p->state[slot] = SLOT_BUSY;
+			p->taken++;
+			pthread_mutex_unlock(&p->lock);
+
+			int status = p->ops->work(p->ctx, &p->jobs[slot]);
+
+			pthread_mutex_lock(&p->lock);
+			p->jobs[slot].status = status;
+			p->state[slot] = SLOT_DONE;
+			pthread_cond_signal(&p->work_done);
+			continue;
+		}
+		if (p->quit){
+			break;
+		}
+		pthread_cond_wait(&p->work_ready, &p->lock);
+	}
+	pthread_mutex_unlock(&p->lock);
+	return NULL;
+}
+
+
+unsigned pool_cpu_count(void){
+
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return count > 0 ? (unsigned) count : 1;
+}
+
+
+int pool_run(unsigned threads, unsigned slots, const pool_ops *ops, void *ctx){
+
+	int retval = 0;
+	unsigned started = 0;
+	pthread_t *workers = NULL;
+
+	if (threads == 0){
+		threads = 1;
+	}
+	if (slots < threads){
+		slots = threads;
+	}
+
+	pool p = {
+		.ops = ops,
+		.ctx = ctx,
+		.slots = slots,
+	};
+	pthread_mutex_init(&p.lock, NULL);
+	pthread_cond_init(&p.work_ready, NULL);
+	pthread_cond_init(&p.work_done, NULL);
+	p.jobs = calloc(slots, sizeof(*p.jobs));
+	p.state = calloc(slots, sizeof(*p.state));
+	workers = calloc(threads, sizeof(*workers));
+	if (!p.jobs || !p.state || !workers){
+		retval = -1;
+		goto cleanup;
+	}
+	for (unsigned idx = 0; idx < slots; idx++){
+		p.jobs[idx].out.fd = -1;
+	}
+
+	for (; started < threads; started++){
+		if (pthread_create(&workers[started], NULL, pool_worker, &p)){
+			retval = -1;
+			goto cleanup;
+		}
+	}
+
+	// the calling thread produces into free slots and consumes finished slots in order
+	bool exhausted = false;
+	pthread_mutex_lock(&p.lock);
+	while (true){
+		unsigned next_out = (unsigned) (p.consumed % slots);
+		if (p.consumed < p.produced && p.state[next_out] == SLOT_DONE){
+			pool_job *job = &p.jobs[next_out];
+			pthread_mutex_unlock(&p.lock);
+			int status = job->status ? job->status : ops->consume(ctx, job);
+			pthread_mutex_lock(&p.lock);
+			p.state[next_out] = SLOT_FREE;
+			p.consumed++;
+			if (status){
+				retval = -1;
+				break;
+			}
+			continue;
+		}
+
+		unsigned next_in = (unsigned) (p.produced % slots);
+		if (!exhausted && p.state[next_in] == SLOT_FREE){
+			pool_job *job = &p.jobs[next_in];
+			job->seq = p.produced;
+			pthread_mutex_unlock(&p.lock);
+			int status = ops->produce(ctx, job);
+			pthread_mutex_lock(&p.lock);
+			if (status == 1){
+				p.state[next_in] = SLOT_READY;
+				p.produced++;
+				pthread_cond_signal(&p.work_ready);
+				continue;
+			}
+			exhausted = true;
+			if (status < 0){
+				retval = -1;
+				break;
+			}
+			continue;
+		}
+
+		if (exhausted && p.consumed == p.produced){
+			break;
+		}
+		pthread_cond_wait(&p.work_done, &p.lock);
+	}
+	pthread_mutex_unlock(&p.lock);
+
+	cleanup:
+	pthread_mutex_lock(&p.lock);
+	p.quit = true;
+	pthread_cond_broadcast(&p.work_ready);
+	pthread_mutex_unlock(&p.lock);
+	for (unsigned idx = 0; idx < started; idx++){
+		pthread_join(workers[idx], NULL);
+	}
+
+	if (p.jobs){
+		for (unsigned idx = 0; idx < slots; idx++){
+			p.jobs[idx].out.len = 0;	// discard anything not consumed
+			outbuf_free(&p.jobs[idx].out);
+			free(p.jobs[idx].in_buf);
+		}
+	}
+	free(p.jobs);
+	free(p.state);
+	free(workers);
+	pthread_cond_destroy(&p.work_done);
+	pthread_cond_destroy(&p.work_ready);
+	pthread_mutex_destroy(&p.lock);
+	return retval;
+}
@@ -0,0 +1,68 @@
+/**
+ * @file pool.h
+ * @brief Worker thread pool that processes jobs concurrently and hands them back in submission order
+ * @date 2026-10-16
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "format.h"
+
+
+//*********************************************************************************
+// DEFINITIONS
+//*********************************************************************************
+
+/**
+ * @brief one unit of work, slots are reused so buffers persist from job to job
+ */
+typedef struct pool_job {
+	uint64_t seq;			// submission order
+	const uint8_t *src;		// input bytes of the job
+	size_t len;				// number of bytes at src
+	uint64_t offset;		// absolute input offset of src[0]
+	size_t lead;			// bytes of preceding input readable before src, context for the worker
+	void *arg;				// producer defined job data
+	uint8_t *in_buf;		// slot owned input buffer for streamed inputs, NULL until needed
+	size_t in_cap;			// capacity of in_buf
+	out_buffer out;			// slot owned output, filled by the worker and drained by the consumer
+	int status;				// worker result, 0 = SUCCESS
+} pool_job;
+
+/**
+ * @brief callbacks driving a pool run
+ */
+typedef struct pool_ops {
+	// main thread: fill in the next job. Returns 1 = job ready | 0 = no more jobs | -1 = ERROR
+	int (*produce)(void *ctx, pool_job *job);
+	// worker thread: process a job, typically formatting into job->out. Returns 0 = SUCCESS
+	int (*work)(void *ctx, pool_job *job);
+	// main thread: take a finished job, called in submission order. Returns 0 = SUCCESS
+	int (*consume)(void *ctx, pool_job *job);
+} pool_ops;
+
+
+//*********************************************************************************
+// DECLARATIONS
+//*********************************************************************************
+
+/**
+ * @brief Returns the number of online CPUs, at least 1
+ */
+unsigned pool_cpu_count(void);
+
+/**
+ * @brief Runs produce -> work -> consume over a reorder ring of job slots until produce runs dry
+ * @remark produce and consume run on the calling thread, work runs on threads workers.
+ * At most slots jobs are in flight, which bounds memory use.
+ *
+ * @param threads number of worker threads, at least 1
+ * @param slots number of job slots in the reorder ring, at least threads
+ * @param ops job callbacks
+ * @param ctx passed to every callback
+ * @return 0 = SUCCESS | -1 = ERROR (any callback failed, remaining jobs are discarded)
+ */
+int pool_run(unsigned threads, unsigned slots, const pool_ops *ops, void *ctx);
@@ -0,0 +1,582 @@
+/**
+ * @file readahead.c
+ * @brief Asynchronous read-ahead for streamed inputs: io_uring where the kernel allows it, a reader thread otherwise
+ * @date 2026-10-16
+ *
+ * Both backends fill the same ring of buffers in stream order while the consumer formats the
+ * previous one, so a dump takes about as long as the slower of reading and formatting instead of
+ * their sum. For files io_uring keeps every free buffer's read in flight at once without an extra
+ * thread. Pipes and kernels or sandboxes that refuse io_uring get the reader thread, which keeps
+ * draining a pipe while the consumer is busy where an io_uring read would wait to be reaped.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#define HAVE_IO_URING 1
+#endif
+#endif
+
+#include "readahead.h"
+
+
+//*********************************************************************************
+// DECLARATIONS
+//*********************************************************************************
+
+// user_data of cancel requests, never a slot index
+#define CANCEL_TAG UINT64_MAX
+
+/**
+ * @brief lifecycle of a buffer in the ring
+ */
+typedef enum AHEAD_STATE{
+	AHEAD_FREE = 0,		// available to the reader
+	AHEAD_READING,		// read in flight
+	AHEAD_FILLED		// holds data for the consumer, 0 bytes = EOF
+} AHEAD_STATE;
+
+#if HAVE_IO_URING
+/**
+ * @brief mapped io_uring submission and completion rings
+ */
+typedef struct uring {
+	int fd;
+	void *sq_ring;
+	void *cq_ring;
+	size_t sq_ring_len;
+	size_t cq_ring_len;
+	struct io_uring_sqe *sqes;
+	size_t sqes_len;
+	unsigned *sq_tail;
+	unsigned sq_mask;
+	unsigned *sq_array;
+	unsigned *cq_head;
+	unsigned *cq_tail;
+	unsigned cq_mask;
+	struct io_uring_cqe *cqes;
+} uring;
+#endif
+
+struct read_ahead {
+	int fd;
+	bool seekable;
+	uint64_t next_offset;					// file offset the next buffer is read from, seekable inputs only
+	uint64_t end;							// reads stop at this offset, UINT64_MAX = EOF
+	uint8_t *buffers;						// READAHEAD_SLOTS * READAHEAD_SLOT_SIZE bytes
+	AHEAD_STATE state[READAHEAD_SLOTS];
+	size_t len[READAHEAD_SLOTS];			// bytes filled so far
+	size_t want[READAHEAD_SLOTS];			// bytes requested, io_uring only
+	uint64_t offset[READAHEAD_SLOTS];		// file offset of the buffer, io_uring only
+	uint64_t issued;						// buffers handed to the reader, in stream order
+	uint64_t consumed;						// buffers returned by readahead_next()
+	bool holding;							// the consumer holds buffer consumed - 1
+	bool done;								// the reader reached EOF or failed and issues nothing more
+	bool ended;								// a short file buffer was handed out, what later reads found is past EOF
+	int error;								// errno of a failed read, 0 otherwise
+
+	bool threaded;							// reader thread backend, io_uring otherwise
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t filled;					// signaled when the reader fills a buffer or fails
+	pthread_cond_t freed;					// signaled when the consumer hands a buffer back or stops
+	bool quit;								// readahead_stop() is shutting the reader down
+#if HAVE_IO_URING
+	uring ring;
+#endif
+};
+
+/**
+ * @brief Reader thread: fills free buffers in order until EOF, an error or readahead_stop()
+ *
+ * @param arg the stage
+ * @return NULL
+ */
+static void *reader_main(void *arg);
+
+/**
+ * @brief Reads until len bytes are buffered, EOF is hit or the end offset is reached
+ *
+ * @return Returns the number of bytes read | -1 = ERROR
+ */
+static int64_t read_chunk(read_ahead *ra, uint8_t *buf, size_t len, uint64_t offset);
+
+#if HAVE_IO_URING
+/**
+ * @brief Sets up an io_uring with room for READAHEAD_SLOTS reads and maps its rings
+ * @remark Kernels 5.1-5.5 have io_uring but no IORING_OP_READ, the probe for it (5.6) fails there
+ *
+ * @return 0 = SUCCESS | -1 = ERROR (io_uring missing, not permitted or without IORING_OP_READ)
+ */
+static int uring_setup(uring *ring);
+
+/**
+ * @brief Unmaps the rings and closes the io_uring
+ */
+static void uring_close(uring *ring);
+
+/**
+ * @brief Queues one request and submits it, addr is the user_data to cancel for IORING_OP_ASYNC_CANCEL
+ *
+ * @return 0 = SUCCESS | -1 = ERROR
+ */
+static int uring_submit(uring *ring, uint8_t opcode, int fd, void *addr, unsigned len, uint64_t offset, uint64_t user_data);
+
+/**
+ * @brief Issues reads into every free buffer the consumer does not hold, only one at a time for pipes
+ *
+ * @return 0 = SUCCESS | -1 = ERROR
+ */
+static int uring_issue(read_ahead *ra);
+
+/**
+ * @brief Submits the read for the unfilled rest of a buffer
+ *
+ * @return 0 = SUCCESS | -1 = ERROR
+ */
+static int uring_read(read_ahead *ra, unsigned slot);
+
+/**
+ * @brief Handles every completion posted so far, waiting for at least one if wait is set
+ *
+ * @return 0 = SUCCESS | -1 = ERROR
+ */
+static int uring_reap(read_ahead *ra, bool wait);
+#endif
+
+
+//*********************************************************************************
+// DEFINITIONS
+//*********************************************************************************
+
+read_ahead *readahead_start(int fd, bool seekable, uint64_t pos, uint64_t end){
+
+	const char *forced = getenv("HEXDUMP_READAHEAD");
+	if (forced && !strcmp(forced, "off")){
+		return NULL;
+	}
+
+	read_ahead *ra = calloc(1, sizeof(*ra));
+	if (!ra){
+		return NULL;
+	}
+	ra->fd = fd;
+	ra->seekable = seekable;
+	ra->next_offset = pos;
+	ra->end = end;
+	ra->buffers = malloc((size_t) READAHEAD_SLOTS * READAHEAD_SLOT_SIZE);
+	if (!ra->buffers){
+		free(ra);
+		return NULL;
+	}
+
+#if HAVE_IO_URING
+	// pipe reads only make progress while the consumer reaps them, a thread keeps draining the pipe on its own
+	bool uring_wanted = forced ? !strcmp(forced, "uring") : seekable;
+	if (uring_wanted && !uring_setup(&ra->ring)){
+		if (!uring_issue(ra)){
+			return ra;
+		}
+		readahead_stop(ra);
+		return NULL;
+	}
+#endif
+
+	ra->threaded = true;
+	pthread_mutex_init(&ra->lock, NULL);
+	pthread_cond_init(&ra->filled, NULL);
+	pthread_cond_init(&ra->freed, NULL);
+	if (pthread_create(&ra->thread, NULL, reader_main, ra)){
+		pthread_cond_destroy(&ra->freed);
+		pthread_cond_destroy(&ra->filled);
+		pthread_mutex_destroy(&ra->lock);
+		free(ra->buffers);
+		free(ra);
+		return NULL;
+	}
+	return ra;
+}
+
+
+int64_t readahead_next(read_ahead *ra, const uint8_t **data){
+
+	unsigned slot = (unsigned) (ra->consumed % READAHEAD_SLOTS);
+
+	if (ra->threaded){
+		pthread_mutex_lock(&ra->lock);
+		// the buffer handed out last time goes back to the reader
+		if (ra->holding){
+			ra->state[(ra->consumed - 1) % READAHEAD_SLOTS] = AHEAD_FREE;
+			ra->holding = false;
+			pthread_cond_signal(&ra->freed);
+		}
+		while (ra->state[slot] != AHEAD_FILLED && !ra->error){
+			pthread_cond_wait(&ra->filled, &ra->lock);
+		}
+		int error = ra->state[slot] == AHEAD_FILLED ? 0 : ra->error;
+		pthread_mutex_unlock(&ra->lock);
+		if (error){
+			errno = error;
+			return -1;
+		}
+	}
+#if HAVE_IO_URING
+	else {
+		if (ra->holding){
+			ra->state[(ra->consumed - 1) % READAHEAD_SLOTS] = AHEAD_FREE;
+			ra->holding = false;
+		}
+		// reads past a short buffer were issued before EOF was known, bytes appended since would leave a gap
+		if (ra->ended){
+			return 0;
+		}
+		if (uring_issue(ra)){
+			return -1;
+		}
+		while (ra->state[slot] != AHEAD_FILLED){
+			if (ra->error){
+				errno = ra->error;
+				return -1;
+			}
+			// a short file read ended the input before this buffer was issued
+			if (ra->state[slot] == AHEAD_FREE && ra->done){
+				return 0;
+			}
+			if (uring_reap(ra, true) || uring_issue(ra)){
+				return -1;
+			}
+		}
+	}
+#endif
+
+	// an empty buffer marks EOF and stays in place, so every later call sees EOF again
+	if (ra->len[slot] == 0){
+		return 0;
+	}
+	*data = ra->buffers + (size_t) slot * READAHEAD_SLOT_SIZE;
+	ra->consumed++;
+	ra->holding = true;
+	ra->ended = !ra->threaded && ra->seekable && ra->len[slot] < ra->want[slot];
+	return (int64_t) ra->len[slot];
+}
+
+
+void readahead_stop(read_ahead *ra){
+
+	if (!ra){
+		return;
+	}
+
+	if (ra->threaded){
+		pthread_mutex_lock(&ra->lock);
+		ra->quit = true;
+		pthread_cond_signal(&ra->freed);
+		pthread_mutex_unlock(&ra->lock);
+		// a pipe read can block for as long as the writer likes, the reader is only cancelable inside read()
+		pthread_cancel(ra->thread);
+		pthread_join(ra->thread, NULL);
+		pthread_cond_destroy(&ra->freed);
+		pthread_cond_destroy(&ra->filled);
+		pthread_mutex_destroy(&ra->lock);
+	}
+#if HAVE_IO_URING
+	else {
+		// the kernel may still write into the buffers until every read in flight has completed or been canceled
+		for (unsigned slot = 0; slot < READAHEAD_SLOTS; slot++){
+			if (ra->state[slot] == AHEAD_READING){
+				uring_submit(&ra->ring, IORING_OP_ASYNC_CANCEL, -1, (void *) (uintptr_t) slot, 0, 0, CANCEL_TAG);
+			}
+		}
+		ra->quit = true;
+		bool reading = true;
+		while (reading){
+			reading = false;
+			for (unsigned slot = 0; slot < READAHEAD_SLOTS; slot++){
+				reading |= ra->state[slot] == AHEAD_READING;
+			}
+			if (reading && uring_reap(ra, true)){
+				break;
+			}
+		}
+		uring_close(&ra->ring);
+	}
+#endif
+
+	free(ra->buffers);
+	free(ra);
+}
+
+
+static void *reader_main(void *arg){
+
+	read_ahead *ra = arg;
+	pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
+
+	pthread_mutex_lock(&ra->lock);
+	while (!ra->quit && !ra->done){
+		unsigned slot = (unsigned) (ra->issued % READAHEAD_SLOTS);
+		if (ra->state[slot] != AHEAD_FREE){
+			pthread_cond_wait(&ra->freed, &ra->lock);
+			continue;
+		}
+		ra->state[slot] = AHEAD_READING;
+		pthread_mutex_unlock(&ra->lock);
+
+		int64_t got = read_chunk(ra, ra->buffers + (size_t) slot * READAHEAD_SLOT_SIZE, READAHEAD_SLOT_SIZE, ra->next_offset);
+		int error = errno;
+
+		pthread_mutex_lock(&ra->lock);
+		if (got < 0){
+			ra->state[slot] = AHEAD_FREE;
+			ra->error = error;
+			ra->done = true;
+		}
+		else {
+			ra->len[slot] = (size_t) got;
+			ra->state[slot] = AHEAD_FILLED;
+			ra->next_offset += (uint64_t) got;
+			ra->issued++;
+			ra->done = got == 0;
+		}
+		pthread_cond_signal(&ra->filled);
+	}
+	pthread_mutex_unlock(&ra->lock);
+	return NULL;
+}
+
+
+static int64_t read_chunk(read_ahead *ra, uint8_t *buf, size_t len, uint64_t offset){
+
+	if (ra->seekable && ra->end - offset < len){
+		len = offset < ra->end ? (size_t) (ra->end - offset) : 0;
+	}
+
+	size_t done = 0;
+	while (done < len){
+		pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
+		ssize_t got = ra->seekable ? pread(ra->fd, buf + done, len - done, (off_t) (offset + done))
+				: read(ra->fd, buf + done, len - done);
+		pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
+		if (got == 0){
+			break;
+		}
+		if (got < 0){
+			if (errno == EINTR){
+				continue;
+			}
+			return -1;
+		}
+		done += (size_t) got;
+	}
+	return (int64_t) done;
+}
+
+
+#if HAVE_IO_URING
+static int uring_setup(uring *ring){
+
+	struct io_uring_params params;
+	memset(&params, 0, sizeof(params));
+	memset(ring, 0, sizeof(*ring));
+	ring->fd = (int) syscall(__NR_io_uring_setup, READAHEAD_SLOTS, &params);
+	if (ring->fd < 0){
+		return -1;
+	}
+
+	// the reads need IORING_OP_READ, older kernels get the reader thread instead of failing the first read
+	size_t probe_len = sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op);
+	struct io_uring_probe *probe = calloc(1, probe_len);
+	bool can_read = probe && !syscall(__NR_io_uring_register, ring->fd, IORING_REGISTER_PROBE, probe, 256) &&
+			probe->last_op >= IORING_OP_READ && (probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED);
+	free(probe);
+	if (!can_read){
+		uring_close(ring);
+		return -1;
+	}
+
+	ring->sq_ring_len = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	ring->cq_ring_len = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+	bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+	if (single){
+		ring->sq_ring_len = ring->cq_ring_len = ring->sq_ring_len > ring->cq_ring_len ? ring->sq_ring_len : ring->cq_ring_len;
+	}
+	ring->sqes_len = params.sq_entries * sizeof(struct io_uring_sqe);
+
+	ring->sq_ring = mmap(NULL, ring->sq_ring_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+	ring->cq_ring = single ? ring->sq_ring
+			: mmap(NULL, ring->cq_ring_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+	ring->sqes = mmap(NULL, ring->sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+	if (ring->sq_ring == MAP_FAILED || ring->cq_ring == MAP_FAILED || ring->sqes == MAP_FAILED){
+		uring_close(ring);
+		return -1;
+	}
+
+	uint8_t *sq = ring->sq_ring;
+	uint8_t *cq = ring->cq_ring;
+	ring->sq_tail = (unsigned *) (sq + params.sq_off.tail);
+	ring->sq_mask = *(unsigned *) (sq + params.sq_off.ring_mask);
+	ring->sq_array = (unsigned *) (sq + params.sq_off.array);
+	ring->cq_head = (unsigned *) (cq + params.cq_off.head);
+	ring->cq_tail = (unsigned *) (cq + params.cq_off.tail);
+	ring->cq_mask = *(unsigned *) (cq + params.cq_off.ring_mask);
+	ring->cqes = (struct io_uring_cqe *) (cq + params.cq_off.cqes);
+	return 0;
+}
+
+
+static void uring_close(uring *ring){
+
+	if (ring->sqes && ring->sqes != MAP_FAILED){
+		munmap(ring->sqes, ring->sqes_len);
+	}
+	if (ring->cq_ring && ring->cq_ring != MAP_FAILED && ring->cq_ring != ring->sq_ring){
+		munmap(ring->cq_ring, ring->cq_ring_len);
+	}
+	if (ring->sq_ring && ring->sq_ring != MAP_FAILED){
+		munmap(ring->sq_ring, ring->sq_ring_len);
+	}
+	if (ring->fd >= 0){
+		close(ring->fd);
+	}
+	memset(ring, 0, sizeof(*ring));
+	ring->fd = -1;
+}
+
+
+static int uring_submit(uring *ring, uint8_t opcode, int fd, void *addr, unsigned len, uint64_t offset, uint64_t user_data){
+
+	// single submitter: the tail is only written here, the kernel reads it after the release store
+	unsigned tail = *ring->sq_tail;
+	unsigned index = tail & ring->sq_mask;
+	struct io_uring_sqe *sqe = &ring->sqes[index];
+	memset(sqe, 0, sizeof(*sqe));
+	sqe->opcode = opcode;
+	sqe->fd = fd;
+	sqe->addr = (uint64_t) (uintptr_t) addr;
+	sqe->len = len;
+	sqe->off = offset;
+	sqe->user_data = user_data;
+	ring->sq_array[index] = index;
+	__atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+	while (syscall(__NR_io_uring_enter, ring->fd, 1, 0, 0, NULL, 0) < 0){
+		if (errno != EINTR && errno != EAGAIN){
+			return -1;
+		}
+	}
+	return 0;
+}
+
+
+static int uring_issue(read_ahead *ra){
+
+	while (!ra->done){
+		unsigned slot = (unsigned) (ra->issued % READAHEAD_SLOTS);
+		if (ra->state[slot] != AHEAD_FREE){
+			return 0;
+		}
+		// pipes have no offsets, a second read could complete first and swap the data
+		if (!ra->seekable && ra->issued > 0 && ra->state[(ra->issued - 1) % READAHEAD_SLOTS] == AHEAD_READING){
+			return 0;
+		}
+
+		size_t want = READAHEAD_SLOT_SIZE;
+		if (ra->seekable && ra->end - ra->next_offset < want){
+			want = ra->next_offset < ra->end ? (size_t) (ra->end - ra->next_offset) : 0;
+		}
+		ra->len[slot] = 0;
+		ra->want[slot] = want;
+		ra->offset[slot] = ra->next_offset;
+		ra->next_offset += want;
+		ra->issued++;
+
+		// past the end: the buffer is the EOF marker, nothing to read
+		if (want == 0){
+			ra->state[slot] = AHEAD_FILLED;
+			ra->done = true;
+			return 0;
+		}
+		ra->state[slot] = AHEAD_READING;
+		if (uring_read(ra, slot)){
+			return -1;
+		}
+	}
+	return 0;
+}
+
+
+static int uring_read(read_ahead *ra, unsigned slot){
+
+	uint8_t *buf = ra->buffers + (size_t) slot * READAHEAD_SLOT_SIZE + ra->len[slot];
+	uint64_t offset = ra->seekable ? ra->offset[slot] + ra->len[slot] : (uint64_t) -1;	// -1 = current file position
+	return uring_submit(&ra->ring, IORING_OP_READ, ra->fd, buf, (unsigned) (ra->want[slot] - ra->len[slot]), offset, slot);
+}
+
+
+static int uring_reap(read_ahead *ra, bool wait){
+
+	uring *ring = &ra->ring;
+	unsigned head = *ring->cq_head;
+	if (wait && head == __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE)){
+		while (syscall(__NR_io_uring_enter, ring->fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0){
+			if (errno != EINTR){
+				return -1;
+			}
+		}
+	}
+
+	for (; head != __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE); head++){
+		struct io_uring_cqe *cqe = &ring->cqes[head & ring->cq_mask];
+		uint64_t slot = cqe->user_data;
+		int res = cqe->res;
+		if (slot == CANCEL_TAG || slot >= READAHEAD_SLOTS || ra->state[slot] != AHEAD_READING){
+			continue;
+		}
+
+		// stopping: the read is over, whatever it returned
+		if (ra->quit){
+			ra->state[slot] = AHEAD_FREE;
+			continue;
+		}
+		if (res == -EINTR || res == -EAGAIN){
+			if (uring_read(ra, (unsigned) slot)){
+				return -1;
+			}
+			continue;
+		}
+		if (res < 0){
+			ra->state[slot] = AHEAD_FREE;
+			ra->error = -res;
+			ra->done = true;
+			continue;
+		}
+
+		// files are filled completely unless EOF cuts them short, pipes hand out every read as it comes
+		ra->len[slot] += (size_t) res;
+		if (res > 0 && ra->seekable && ra->len[slot] < ra->want[slot]){
+			if (uring_read(ra, (unsigned) slot)){
+				return -1;
+			}
+			continue;
+		}
+		ra->state[slot] = AHEAD_FILLED;
+		if (res == 0){
+			ra->done = true;
+		}
+	}
+	__atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+	return 0;
+}
+#endif
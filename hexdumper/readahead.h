@@ -0,0 +1,63 @@
+/**
+ * @file readahead.h
+ * @brief Asynchronous read-ahead for streamed inputs: io_uring where the kernel allows it, a reader thread otherwise
+ * @date 2026-10-16
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+
+//*********************************************************************************
+// DEFINITIONS
+//*********************************************************************************
+
+// buffers in the ring: one held by the consumer, the rest being read ahead of it
+#define READAHEAD_SLOTS 4
+
+// bytes per buffer, large enough that every read is one big request to the storage
+#define READAHEAD_SLOT_SIZE (2u << 20)
+
+/**
+ * @brief a running read-ahead stage, opaque to its users
+ */
+typedef struct read_ahead read_ahead;
+
+
+//*********************************************************************************
+// DECLARATIONS
+//*********************************************************************************
+
+/**
+ * @brief Starts reading fd ahead of the consumer into a ring of READAHEAD_SLOTS buffers
+ * @remark Seekable descriptors are read at explicit offsets from pos on, so their file offset is left alone,
+ * through io_uring when available. Pipes are read from their current position by a reader thread.
+ * HEXDUMP_READAHEAD=uring|thread|off forces a backend or turns read-ahead off.
+ *
+ * @param fd descriptor to read
+ * @param seekable true if fd supports positioned reads
+ * @param pos offset of the first byte to read, ignored for pipes
+ * @param end offset reads stop at, UINT64_MAX to read until EOF
+ * @return Returns the stage | NULL = read-ahead is off or could not be started, read fd directly
+ */
+read_ahead *readahead_start(int fd, bool seekable, uint64_t pos, uint64_t end);
+
+/**
+ * @brief Returns the next filled buffer in stream order, waiting for it if the reads have not caught up
+ * @remark The buffer returned by the previous call goes back to the reader, so only the latest one stays valid.
+ * Buffers may be shorter than READAHEAD_SLOT_SIZE, pipes hand out whatever one read returned.
+ *
+ * @param ra running stage
+ * @param[out] data receives a pointer to the buffer
+ * @return Returns the number of bytes in the buffer | 0 = EOF | -1 = ERROR (errno set)
+ */
+int64_t readahead_next(read_ahead *ra, const uint8_t **data);
+
+/**
+ * @brief Cancels the reads in flight, stops the stage and frees its buffers
+ *
+ * @param ra stage to stop, NULL is ignored
+ */
+void readahead_stop(read_ahead *ra);
@@ -0,0 +1,471 @@
+/**
+ * @file reverse.c
+ * @brief Reverse mode: turns hex dump text back into the bytes it describes
+ * @date 2026-10-16
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "reverse.h"
+
+
+//*********************************************************************************
+// DECLARATIONS
+//*********************************************************************************
+
+/**
+ * @brief parser state carried from line to line and across input chunks
+ */
+typedef struct reverse_state {
+	out_buffer *out;
+	bool seekable;				// out's fd can seek, so gaps become holes
+	bool has_data;				// the dump has a DATA column, false for ASCII-only dumps
+	bool repeat;				// a "*" line is waiting for the next offset
+	size_t swap_group;			// group size of a -e dump, whose groups print last byte first; 1 for none
+	int nibble;					// pending high digit of a plain hex pair split by whitespace, -1 if none
+	uint64_t pos;				// output offset of the next byte staged
+	uint64_t line;				// number of lines parsed so far
+	uint8_t last[LINE_SIZE_MAX];	// bytes of the previous dump line, what "*" repeats
+	size_t last_len;			// valid bytes in last
+} reverse_state;
+
+/**
+ * @brief Parses the complete lines of a block of text
+ *
+ * @param st parser state
+ * @param src text to parse
+ * @param len number of bytes at src
+ * @param last true if src ends the input, its final line then needs no newline
+ * @param[out] used receives the number of bytes consumed, the rest is a partial line
+ * @return 0 = SUCCESS | 1 = ERROR
+ */
+static int parse_lines(reverse_state *st, const uint8_t *src, size_t len, bool last, size_t *used);
+
+/**
+ * @brief Parses one line, without its newline
+ *
+ * @return 0 = SUCCESS | 1 = ERROR
+ */
+static int parse_line(reverse_state *st, const uint8_t *line, size_t len);
+
+/**
+ * @brief Parses a "0x<offset>    XX XX ...   TEXT" line, the TEXT column is ignored
+ *
+ * @return 0 = SUCCESS | 1 = ERROR
+ */
+static int parse_dump_line(reverse_state *st, const uint8_t *line, size_t len);
+
+/**
+ * @brief Parses a line of plain hex digits, whitespace between digits is ignored
+ *
+ * @return 0 = SUCCESS | 1 = ERROR
+ */
+static int parse_plain_line(reverse_state *st, const uint8_t *line, size_t len);
+
+/**
+ * @brief Decodes the DATA column of a -e dump line, group by group, back into memory order
+ * @remark Every group sits in a fixed slot of 2 * group digits and a space. A partial last group is
+ * printed right aligned, blanks first, so its digits are read after the leading blanks.
+ *
+ * @param hex start of the DATA column
+ * @param end end of the line
+ * @param group bytes per group
+ * @param dst receives at most LINE_SIZE_MAX bytes
+ * @return number of bytes decoded, 0 if the column holds none
+ */
+static size_t parse_swapped_groups(const uint8_t *hex, const uint8_t *end, size_t group, uint8_t *dst);
+
+/**
+ * @brief Moves the output position, seeking when possible and writing zeros forward otherwise
+ *
+ * @param st parser state
+ * @param target absolute output offset
+ * @return 0 = SUCCESS | 1 = ERROR
+ */
+static int move_to(reverse_state *st, uint64_t target);
+
+/**
+ * @brief Writes copies of a line's bytes from the output position up to target
+ *
+ * @param st parser state
+ * @param target absolute output offset to stop at
+ * @param pattern bytes to repeat
+ * @param width number of bytes in pattern, at most LINE_SIZE_MAX
+ * @return 0 = SUCCESS | 1 = ERROR
+ */
+static int fill(reverse_state *st, uint64_t target, const uint8_t *pattern, size_t width);
+
+
+//*********************************************************************************
+// DEFINITIONS
+//*********************************************************************************
+
+// value of every hex digit, 0xFF for anything else
+#define DIGIT_VALUE(c) (uint8_t) ((c) >= '0' && (c) <= '9' ? (c) - '0' : \
+	(c) >= 'A' && (c) <= 'F' ? (c) - 'A' + 10 : (c) >= 'a' && (c) <= 'f' ? (c) - 'a' + 10 : 0xFF)
+#define DIGIT_ROW(r) \
+	DIGIT_VALUE(r+0x0), DIGIT_VALUE(r+0x1), DIGIT_VALUE(r+0x2), DIGIT_VALUE(r+0x3), \
+	DIGIT_VALUE(r+0x4), DIGIT_VALUE(r+0x5), DIGIT_VALUE(r+0x6), DIGIT_VALUE(r+0x7), \
+	DIGIT_VALUE(r+0x8), DIGIT_VALUE(r+0x9), DIGIT_VALUE(r+0xA), DIGIT_VALUE(r+0xB), \
+	DIGIT_VALUE(r+0xC), DIGIT_VALUE(r+0xD), DIGIT_VALUE(r+0xE), DIGIT_VALUE(r+0xF)
+
+static const uint8_t HEX_VALUE[256] = {
+	DIGIT_ROW(0x00), DIGIT_ROW(0x10), DIGIT_ROW(0x20), DIGIT_ROW(0x30),
+	DIGIT_ROW(0x40), DIGIT_ROW(0x50), DIGIT_ROW(0x60), DIGIT_ROW(0x70),
+	DIGIT_ROW(0x80), DIGIT_ROW(0x90), DIGIT_ROW(0xA0), DIGIT_ROW(0xB0),
+	DIGIT_ROW(0xC0), DIGIT_ROW(0xD0), DIGIT_ROW(0xE0), DIGIT_ROW(0xF0)
+};
+
+static const uint8_t ZERO_LINE[LINE_SIZE_MAX] = { 0 };
+
+
+int reverse_file(input_source *input, out_buffer *out, size_t swap_group, uint64_t *bad_line){
+
+	if (!input || !out || !bad_line || swap_group == 0 || swap_group > LINE_SIZE_MAX) {
+		errno = EINVAL;
+		return EXIT_FAILURE;
+	}
+
+	int retval = EXIT_FAILURE;
+	reverse_state st = { .out = out, .has_data = true, .nibble = -1, .swap_group = swap_group };
+	*bad_line = 0;
+
+	// regular outputs get holes for gaps, everything else a stream of zeros
+	struct stat info;
+	off_t here = lseek(out->fd, 0, SEEK_CUR);
+	if (here != -1 && !fstat(out->fd, &info) && (S_ISREG(info.st_mode) || S_ISBLK(info.st_mode))){
+		st.seekable = true;
+		st.pos = (uint64_t) here;
+	}
+
+	// streamed text is read behind room for the partial line left over from the previous chunk
+	uint8_t *buf = NULL;
+	if (!input->mapped){
+		buf = malloc(REVERSE_LINE_MAX + INPUT_WINDOW_SIZE);
+		if (!buf){
+			return EXIT_FAILURE;
+		}
+	}
+
+	size_t carry = 0;
+	while (true){
+		const uint8_t *chunk = NULL;
+		int64_t read = input_next_into(input, &chunk, buf ? buf + carry : NULL, INPUT_WINDOW_SIZE, 1);
+		if (read < 0){
+			goto cleanup;
+		}
+		const uint8_t *src = buf ? buf : chunk;
+		size_t len = buf ? carry + (size_t) read : (size_t) read;
+		bool last = (size_t) read < INPUT_WINDOW_SIZE;
+
+		size_t used = 0;
+		if (parse_lines(&st, src, len, last, &used)){
+			*bad_line = errno == EINVAL ? st.line : 0;
+			goto cleanup;
+		}
+		if (last){
+			break;
+		}
+
+		// a partial line is parsed again at the start of the next chunk: mapped inputs just step back over it
+		carry = len - used;
+		if (carry > REVERSE_LINE_MAX){
+			errno = EINVAL;
+			*bad_line = st.line + 1;
+			goto cleanup;
+		}
+		if (input->mapped){
+			if (input_seek(input, input->pos - carry)){
+				goto cleanup;
+			}
+			input_release(input, input->pos);
+			carry = 0;
+		}
+		else {
+			memmove(buf, src + used, carry);
+		}
+	}
+
+	// a digit without its partner means the text was cut short
+	if (st.nibble >= 0){
+		errno = EINVAL;
+		*bad_line = st.line;
+		goto cleanup;
+	}
+	retval = outbuf_flush(out) ? EXIT_FAILURE : EXIT_SUCCESS;
+
+	cleanup:
+	free(buf);
+	return retval;
+}
+
+
+static int parse_lines(reverse_state *st, const uint8_t *src, size_t len, bool last, size_t *used){
+
+	size_t done = 0;
+	while (done < len){
+		const uint8_t *newline = memchr(src + done, '\n', len - done);
+		if (!newline && !last){
+			break;
+		}
+		size_t line_len = newline ? (size_t) (newline - (src + done)) : len - done;
+		if (parse_line(st, src + done, line_len)){
+			*used = done;
+			return EXIT_FAILURE;
+		}
+		done += line_len + (newline != NULL);
+	}
+	*used = done;
+	return EXIT_SUCCESS;
+}
+
+
+static int parse_line(reverse_state *st, const uint8_t *line, size_t len){
+
+	st->line++;
+	if (len == 0){
+		return EXIT_SUCCESS;
+	}
+
+	// "0x" + 16 digits + a space starts one of our own lines
+	if (len > OFFSET_COLUMN - 4 && line[0] == '0' && line[1] == 'x' && line[OFFSET_COLUMN - 4] == ' '){
+		uint8_t bad = 0;
+		for (size_t idx = 2; idx < OFFSET_COLUMN - 4; idx++){
+			bad |= HEX_VALUE[line[idx]];
+		}
+		if (bad < 16){
+			return parse_dump_line(st, line, len);
+		}
+	}
+	if (line[0] == '*'){
+		st->repeat = true;
+		return EXIT_SUCCESS;
+	}
+	// the column header tells whether there is a DATA column to read at all
+	if (len >= 6 && !memcmp(line, "OFFSET", 6)){
+		st->has_data = len >= OFFSET_COLUMN + 4 && !memcmp(line + OFFSET_COLUMN, "DATA", 4);
+		return EXIT_SUCCESS;
+	}
+	if (len >= 14 && !memcmp(line, "File is empty.", 14)){
+		return EXIT_SUCCESS;
+	}
+	return parse_plain_line(st, line, len);
+}
+
+
+static int parse_dump_line(reverse_state *st, const uint8_t *line, size_t len){
+
+	if (!st->has_data){
+		errno = EINVAL;		// ASCII-only dumps have lost the bytes that are not printable
+		return EXIT_FAILURE;
+	}
+
+	uint64_t offset = 0;
+	for (size_t idx = 2; idx < OFFSET_COLUMN - 4; idx++){
+		offset = offset << 4 | HEX_VALUE[line[idx]];
+	}
+
+	// "*" stands for copies of the previous line up to this one
+	if (st->repeat){
+		st->repeat = false;
+		if (st->last_len == 0 || st->last_len % 8){
+			errno = EINVAL;
+			return EXIT_FAILURE;
+		}
+		if (offset > st->pos){
+			bool zero = line_is_zero(st->last, st->last_len);
+			int filled = st->seekable && zero ? move_to(st, offset) : fill(st, offset, st->last, st->last_len);
+			if (filled){
+				return EXIT_FAILURE;
+			}
+		}
+	}
+	if (move_to(st, offset)){
+		return EXIT_FAILURE;
+	}
+
+	uint8_t *dst = (uint8_t *) outbuf_reserve(st->out, LINE_SIZE_MAX);
+	if (!dst){
+		return EXIT_FAILURE;
+	}
+
+	// full default lines have every pair at a fixed column, decode them without looking for the end first
+	const uint8_t *hex = line + OFFSET_COLUMN;
+	size_t count = 0;
+	if (st->swap_group > 1){
+		count = parse_swapped_groups(hex, line + len, st->swap_group, dst);
+		if (count == 0){
+			errno = EINVAL;
+			return EXIT_FAILURE;
+		}
+	}
+	else if (len >= OFFSET_COLUMN + LINE_SIZE * 3){
+		uint8_t bad = 0;
+		bool spaced = len == OFFSET_COLUMN + LINE_SIZE * 3 || hex[LINE_SIZE * 3] == ' ';
+		for (size_t idx = 0; idx < LINE_SIZE; idx++){
+			uint8_t hi = HEX_VALUE[hex[idx * 3]];
+			uint8_t lo = HEX_VALUE[hex[idx * 3 + 1]];
+			bad |= hi | lo;
+			spaced &= hex[idx * 3 + 2] == ' ';
+			dst[idx] = (uint8_t) (hi << 4 | lo);
+		}
+		if (bad < 16 && spaced){
+			count = LINE_SIZE;
+		}
+	}
+
+	// short, wide, grouped or hand edited lines: digit pairs in printed order, a single space ends a group,
+	// two spaces end the DATA column
+	if (count == 0){
+		const uint8_t *end = line + len;
+		while (count < LINE_SIZE_MAX && hex + 2 <= end && (HEX_VALUE[hex[0]] | HEX_VALUE[hex[1]]) < 16){
+			dst[count++] = (uint8_t) (HEX_VALUE[hex[0]] << 4 | HEX_VALUE[hex[1]]);
+			hex += 2;
+			if (hex < end && *hex == ' '){
+				hex++;
+				if (hex < end && *hex == ' '){
+					break;
+				}
+			}
+			else if (hex < end && HEX_VALUE[*hex] >= 16){
+				break;
+			}
+		}
+		if (count == 0){
+			errno = EINVAL;
+			return EXIT_FAILURE;
+		}
+	}
+
+	memcpy(st->last, dst, count);
+	st->last_len = count;
+	outbuf_commit(st->out, count);
+	st->pos += count;
+	return EXIT_SUCCESS;
+}
+
+
+static int parse_plain_line(reverse_state *st, const uint8_t *line, size_t len){
+
+	// two digits per byte at most, whitespace only shrinks it
+	uint8_t *dst = (uint8_t *) outbuf_reserve(st->out, len / 2 + 1);
+	if (!dst){
+		return EXIT_FAILURE;
+	}
+
+	size_t count = 0;
+	size_t idx = 0;
+	while (idx < len){
+		// fast path: back to back digit pairs
+		if (st->nibble < 0){
+			while (idx + 1 < len && (HEX_VALUE[line[idx]] | HEX_VALUE[line[idx + 1]]) < 16){
+				dst[count++] = (uint8_t) (HEX_VALUE[line[idx]] << 4 | HEX_VALUE[line[idx + 1]]);
+				idx += 2;
+			}
+			if (idx == len){
+				break;
+			}
+		}
+
+		uint8_t c = line[idx++];
+		uint8_t value = HEX_VALUE[c];
+		if (value < 16){
+			if (st->nibble < 0){
+				st->nibble = value;
+			}
+			else {
+				dst[count++] = (uint8_t) (st->nibble << 4 | value);
+				st->nibble = -1;
+			}
+		}
+		else if (c != ' ' && c != '\t' && c != '\r' && c != '\v' && c != '\f'){
+			errno = EINVAL;
+			return EXIT_FAILURE;
+		}
+	}
+
+	outbuf_commit(st->out, count);
+	st->pos += count;
+	return EXIT_SUCCESS;
+}
+
+
+static size_t parse_swapped_groups(const uint8_t *hex, const uint8_t *end, size_t group, uint8_t *dst){
+
+	size_t count = 0;
+	while (count + group <= LINE_SIZE_MAX && hex + group * 2 <= end){
+		// blanks pad a partial group on the left, the TEXT column's three blanks never make a whole pair
+		size_t blanks = 0;
+		while (blanks < group * 2 && hex[blanks] == ' '){
+			blanks++;
+		}
+		if (blanks % 2 || blanks == group * 2){
+			break;
+		}
+		size_t bytes = group - blanks / 2;
+		uint8_t bad = 0;
+		for (size_t idx = 0; idx < bytes; idx++){
+			const uint8_t *pair = hex + blanks + idx * 2;
+			bad |= HEX_VALUE[pair[0]] | HEX_VALUE[pair[1]];
+			dst[count + bytes - 1 - idx] = (uint8_t) (HEX_VALUE[pair[0]] << 4 | HEX_VALUE[pair[1]]);
+		}
+		if (bad >= 16){
+			break;
+		}
+		count += bytes;
+		hex += group * 2;
+		// a partial group ends the line's data, a full one is followed by a blank or the end of the line
+		if (bytes < group || hex == end || *hex++ != ' '){
+			break;
+		}
+	}
+	return count;
+}
+
+
+static int move_to(reverse_state *st, uint64_t target){
+
+	if (target == st->pos){
+		return EXIT_SUCCESS;
+	}
+	if (st->seekable){
+		if (outbuf_flush(st->out) || lseek(st->out->fd, (off_t) target, SEEK_SET) == -1){
+			return EXIT_FAILURE;
+		}
+		st->pos = target;
+		return EXIT_SUCCESS;
+	}
+
+	// streams can only be padded forward
+	if (target < st->pos){
+		errno = ESPIPE;
+		return EXIT_FAILURE;
+	}
+	return fill(st, target, ZERO_LINE, LINE_SIZE_MAX);
+}
+
+
+static int fill(reverse_state *st, uint64_t target, const uint8_t *pattern, size_t width){
+
+	out_buffer *out = st->out;
+	while (st->pos < target){
+		uint64_t want = target - st->pos;
+		size_t len = want < out->cap - out->cap % width ? (size_t) want : out->cap - out->cap % width;
+		char *dst = outbuf_reserve(out, len);
+		if (!dst){
+			return EXIT_FAILURE;
+		}
+		for (size_t done = 0; done < len; done += width){
+			memcpy(dst + done, pattern, len - done < width ? len - done : width);
+		}
+		outbuf_commit(out, len);
+		st->pos += len;
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,41 @@
+/**
+ * @file reverse.h
+ * @brief Reverse mode: turns hex dump text back into the bytes it describes
+ * @date 2026-10-16
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "input.h"
+#include "format.h"
+
+
+//*********************************************************************************
+// DEFINITIONS
+//*********************************************************************************
+
+// longest text line accepted, a line has to fit in the carry room of a streamed chunk
+#define REVERSE_LINE_MAX (64u << 10)
+
+
+//*********************************************************************************
+// DECLARATIONS
+//*********************************************************************************
+
+/**
+ * @brief Parses hex dump text and writes the bytes it describes to out's fd
+ * @remark Accepts this tool's own OFFSET/DATA/TEXT lines (the TEXT column is ignored, "*" repeats
+ * the previous line up to the next offset) as well as plain hex digits with any whitespace, which
+ * continue at the current offset. Gaps between offsets are seeked over when out's fd is seekable,
+ * leaving sparse holes, and filled with zeros otherwise.
+ *
+ * @param input open input holding the dump text
+ * @param out output buffer the bytes are staged in
+ * @param swap_group group size of a dump printed with -e, its groups are turned back to memory order; 1 for none
+ * @param[out] bad_line receives the 1-based number of the offending line on a parse error, 0 otherwise
+ * @return 0 = SUCCESS | 1 = ERROR (errno set, EINVAL for malformed text)
+ */
+int reverse_file(input_source *input, out_buffer *out, size_t swap_group, uint64_t *bad_line);